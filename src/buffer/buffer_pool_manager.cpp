@@ -29,6 +29,7 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id) {
   // 2.     If R is dirty, write it back to the disk.
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   page_id_t new_page_id = page_id;
   frame_id_t new_frame_id = 0;
 
@@ -67,6 +68,7 @@ Page *BufferPoolManager::NewPage(page_id_t &page_id) {
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   frame_id_t new_frame_id = 0;
   if(free_list_.empty()){
     if(replacer_->Victim(&new_frame_id) == false)
@@ -101,9 +103,14 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
   // 1.   If P does not exist, return true.
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
-  if(page_table_.find(page_id) == page_table_.end()) {// not exist
-    LOG(ERROR) << "DeletePage " << page_id << " does not exist!" << endl;
-    return false;
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+  if(page_table_.find(page_id) == page_table_.end()) {// not in the pool, only its bit is freed
+    if(disk_manager_->IsPageFree(page_id)) {
+      LOG(ERROR) << "DeletePage " << page_id << " does not exist!" << endl;
+      return false;
+    }
+    DeallocatePage(page_id);
+    return true;
   }
   frame_id_t frame_id = page_table_[page_id];
   if(pages_[frame_id].GetPinCount() > 0) {
@@ -112,6 +119,7 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
   }
   else {
     DeallocatePage(page_id);
+    replacer_->Pin(frame_id);
     page_table_.erase(page_id);
     pages_[frame_id].page_id_ = INVALID_PAGE_ID;
     pages_[frame_id].is_dirty_ = false;
@@ -121,7 +129,18 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
   }
 }
 
+void BufferPoolManager::ReadPage(page_id_t page_id, char *page_data) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+  auto it = page_table_.find(page_id);
+  if(it != page_table_.end()) {
+    memcpy(page_data, pages_[it->second].GetData(), PAGE_SIZE);
+    return;
+  }
+  disk_manager_->ReadPage(page_id, page_data);
+}
+
 bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   if(page_table_.find(page_id) == page_table_.end()) {// not exist
     LOG(ERROR) << "UnpinPage " << page_id << " does not exist!" << endl;
     return false;
@@ -134,6 +153,7 @@ bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
 }
 
 bool BufferPoolManager::FlushPage(page_id_t page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   if(page_table_.find(page_id) == page_table_.end()) {// not exist
     LOG(ERROR) << "FlsuhPage " << page_id << " does not exist!" << endl;
     return false;
@@ -157,11 +177,13 @@ void BufferPoolManager::DeallocatePage(page_id_t page_id) {
 }
 
 bool BufferPoolManager::IsPageFree(page_id_t page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   return disk_manager_->IsPageFree(page_id);
 }
 
 // Only used for debug
 bool BufferPoolManager::CheckAllUnpinned() {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   bool res = true;
   for (size_t i = 0; i < pool_size_; i++) {
     if (pages_[i].pin_count_ != 0) {
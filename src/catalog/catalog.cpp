@@ -35,6 +35,15 @@ void CatalogMeta::SerializeTo(char *buf) const {
     MACH_WRITE_TO(page_id_t, buf+ofs, page_id);
     ofs+=sizeof(page_id_t);
   }
+  uint32_t num3=table_statistics_pages_.size();
+  MACH_WRITE_UINT32(buf+ofs, num3);
+  ofs+=sizeof(uint32_t);
+  for(auto itr=table_statistics_pages_.begin();itr!=table_statistics_pages_.end();itr++){
+    MACH_WRITE_TO(table_id_t, buf+ofs, itr->first);
+    ofs+=sizeof(table_id_t);
+    MACH_WRITE_TO(page_id_t, buf+ofs, itr->second);
+    ofs+=sizeof(page_id_t);
+  }
 }
 
 CatalogMeta *CatalogMeta::DeserializeFrom(char *buf, MemHeap *heap) {
@@ -63,15 +72,25 @@ CatalogMeta *CatalogMeta::DeserializeFrom(char *buf, MemHeap *heap) {
     ofs+=sizeof(table_id_t);
     Cata->GetIndexMetaPages()->insert(make_pair(index_id,page_id));
   }
+  uint32_t num3=MACH_READ_UINT32(buf+ofs);
+  ofs+=sizeof(uint32_t);
+  for(uint32_t i=0;i<num3;i++){
+    table_id_t table_id=MACH_READ_FROM(table_id_t, buf+ofs);
+    ofs+=sizeof(table_id_t);
+    page_id_t page_id=MACH_READ_FROM(page_id_t, buf+ofs);
+    ofs+=sizeof(page_id_t);
+    Cata->GetTableStatisticsPages()->insert(make_pair(table_id,page_id));
+  }
   return Cata;
 }
 
 uint32_t CatalogMeta::GetSerializedSize() const {
   uint32_t ofs=0;
-  uint32_t num1=table_meta_pages_.size(),num2=index_meta_pages_.size();
+  uint32_t num1=table_meta_pages_.size(),num2=index_meta_pages_.size(),num3=table_statistics_pages_.size();
   ofs=num1*(sizeof(table_id_t)+sizeof(page_id_t));
   ofs+=num2*(sizeof(index_id_t)+sizeof(page_id_t));
-  ofs+=sizeof(uint32_t)*3;
+  ofs+=num3*(sizeof(table_id_t)+sizeof(page_id_t));
+  ofs+=sizeof(uint32_t)*4;
   return ofs;
 }
 
@@ -170,7 +189,8 @@ dberr_t CatalogManager::GetTables(vector<TableInfo *> &tables) const {
 
 dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string &index_name,
                                     const std::vector<std::string> &index_keys, Transaction *txn,
-                                    IndexInfo *&index_info) {
+                                    IndexInfo *&index_info, IndexType index_type,
+                                    const std::vector<std::string> &include_columns) {
   auto itr=table_names_.find(table_name);
   if(itr==table_names_.end())return DB_TABLE_NOT_EXIST;
   auto itr0=index_names_.find(table_name);
@@ -195,7 +215,14 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
     if(Err0!=DB_SUCCESS)return Err0;
     key_map.push_back(index_);
   }
-  IndexMetadata *meta_data=IndexMetadata::Create(index_id,index_name,table_id,key_map,heap_);
+  std::vector<uint32_t> include_map;
+  for(auto &column_name:include_columns){
+    uint32_t index_=0;
+    dberr_t Err0=Table->GetSchema()->GetColumnIndex(column_name,index_);
+    if(Err0!=DB_SUCCESS)return Err0;
+    include_map.push_back(index_);
+  }
+  IndexMetadata *meta_data=IndexMetadata::Create(index_id,index_name,table_id,key_map,heap_,index_type,include_map);
   catalog_meta_->GetIndexMetaPages()->insert(make_pair(index_id,page_id));
   index_info=IndexInfo::Create(heap_);
   index_info->Init(meta_data, Table, buffer_pool_manager_);
@@ -263,14 +290,22 @@ dberr_t CatalogManager::DropTable(const string &table_name) {
     if(Err1!=DB_SUCCESS)return Err1;
   }
   catalog_meta_->GetTableMetaPages()->erase(itr1);
+  auto itr4=catalog_meta_->GetTableStatisticsPages()->find(table_id);
+  if(itr4!=catalog_meta_->GetTableStatisticsPages()->end()){
+    buffer_pool_manager_->DeletePage(itr4->second);
+    catalog_meta_->GetTableStatisticsPages()->erase(itr4);
+  }
   tables_.erase(itr2);
   table_names_.erase(itr);
   auto itr3=index_names_.find(table_name);
   if(itr3!=index_names_.end())index_names_.erase(itr3);
-  table_info->GetTableHeap()->FreeHeap();
+  BufferPoolManager *buffer_pool_manager=buffer_pool_manager_;
+  page_id_t first_page_id=table_info->GetTableHeap()->GetFirstPageId();
+  reclaimer_.Submit([buffer_pool_manager,first_page_id]{TableHeap::FreePages(buffer_pool_manager,first_page_id);});
   buffer_pool_manager_->UnpinPage(page_id, true);
   buffer_pool_manager_->DeletePage(page_id);
-  delete(table_info);
+  // the memory itself belongs to heap_
+  table_info->~TableInfo();
   Page *page0=buffer_pool_manager_->FetchPage(CATALOG_META_PAGE_ID);
   catalog_meta_->SerializeTo(page0->GetData());
   buffer_pool_manager_->UnpinPage(CATALOG_META_PAGE_ID, true);
@@ -278,6 +313,73 @@ dberr_t CatalogManager::DropTable(const string &table_name) {
   return DB_SUCCESS;
 }
 
+dberr_t CatalogManager::TruncateTable(const string &table_name, Transaction *txn) {
+  TableInfo *table_info=nullptr;
+  dberr_t Err0=GetTable(table_name, table_info);
+  if(Err0!=DB_SUCCESS)return Err0;
+  std::vector<IndexInfo *> indexes;
+  GetTableIndexes(table_name, indexes);
+  for(auto index_info:indexes)index_info->GetIndex()->Release(&reclaimer_);
+  BufferPoolManager *buffer_pool_manager=buffer_pool_manager_;
+  page_id_t first_page_id=table_info->GetTableHeap()->Truncate(txn);
+  reclaimer_.Submit([buffer_pool_manager,first_page_id]{TableHeap::FreePages(buffer_pool_manager,first_page_id);});
+  // the table meta page records the new first page
+  table_id_t table_id=table_info->GetTableId();
+  TableMetadata *table_meta=table_info->GetTableMeta();
+  table_meta->SetFirstPageId(table_info->GetTableHeap()->GetFirstPageId());
+  page_id_t meta_page_id=catalog_meta_->GetTableMetaPages()->at(table_id);
+  Page *meta_page=buffer_pool_manager_->FetchPage(meta_page_id);
+  table_meta->SerializeTo(meta_page->GetData());
+  buffer_pool_manager_->UnpinPage(meta_page_id, true);
+  // statistics of the old rows go away
+  auto itr=catalog_meta_->GetTableStatisticsPages()->find(table_id);
+  if(itr!=catalog_meta_->GetTableStatisticsPages()->end()){
+    buffer_pool_manager_->DeletePage(itr->second);
+    catalog_meta_->GetTableStatisticsPages()->erase(itr);
+    Page *page0=buffer_pool_manager_->FetchPage(CATALOG_META_PAGE_ID);
+    catalog_meta_->SerializeTo(page0->GetData());
+    buffer_pool_manager_->UnpinPage(CATALOG_META_PAGE_ID, true);
+  }
+  table_info->SetStatistics(nullptr);
+  return DB_SUCCESS;
+}
+
+dberr_t CatalogManager::AnalyzeTable(const string &table_name, Transaction *txn) {
+  TableInfo *table_info=nullptr;
+  dberr_t Err0=GetTable(table_name, table_info);
+  if(Err0!=DB_SUCCESS)return Err0;
+  TableStatistics *statistics=TableStatistics::Collect(table_info->GetTableHeap(), table_info->GetSchema());
+  // histograms of wide tables are coarsened until the statistics fit their page
+  while(statistics->GetSerializedSize()>PAGE_SIZE&&statistics->ShrinkHistograms());
+  if(statistics->GetSerializedSize()>PAGE_SIZE){
+    delete statistics;
+    return DB_FAILED;
+  }
+  table_id_t table_id=table_info->GetTableId();
+  auto itr=catalog_meta_->GetTableStatisticsPages()->find(table_id);
+  page_id_t page_id=INVALID_PAGE_ID;
+  Page *page=nullptr;
+  if(itr==catalog_meta_->GetTableStatisticsPages()->end()){
+    page=buffer_pool_manager_->NewPage(page_id);
+    if(page==nullptr){
+      delete statistics;
+      return DB_FAILED;
+    }
+    catalog_meta_->GetTableStatisticsPages()->insert(make_pair(table_id,page_id));
+    Page *page0=buffer_pool_manager_->FetchPage(CATALOG_META_PAGE_ID);
+    catalog_meta_->SerializeTo(page0->GetData());
+    buffer_pool_manager_->UnpinPage(CATALOG_META_PAGE_ID, true);
+  }
+  else {
+    page_id=itr->second;
+    page=buffer_pool_manager_->FetchPage(page_id);
+  }
+  statistics->SerializeTo(page->GetData());
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  table_info->SetStatistics(statistics);
+  return DB_SUCCESS;
+}
+
 dberr_t CatalogManager::DropIndex(const string &table_name, const string &index_name) {
   auto itr=table_names_.find(table_name);
   if(itr==table_names_.end())return DB_TABLE_NOT_EXIST;
@@ -300,8 +402,8 @@ dberr_t CatalogManager::DropIndex(const string &table_name, const string &index_
   index_names_.insert(make_pair(table_name,Map));
   buffer_pool_manager_->UnpinPage(page_id,true);
   buffer_pool_manager_->DeletePage(page_id);
-  index_info->GetIndex()->Destroy();
-  delete(index_info);
+  index_info->GetIndex()->Release(&reclaimer_);
+  index_info->~IndexInfo();
   Page *page0=buffer_pool_manager_->FetchPage(CATALOG_META_PAGE_ID);
   catalog_meta_->SerializeTo(page0->GetData());
   buffer_pool_manager_->UnpinPage(CATALOG_META_PAGE_ID, true);
@@ -330,6 +432,14 @@ dberr_t CatalogManager::LoadTable(const table_id_t table_id, const page_id_t pag
   TableHeap *table_heap=TableHeap::Create(buffer_pool_manager_, table_meta->GetFirstPageId(), table_meta->GetSchema(),
                            log_manager_,lock_manager_,table_info->GetMemHeap());
   table_info->Init(table_meta, table_heap); 
+  auto itr0=catalog_meta_->GetTableStatisticsPages()->find(table_id);
+  if(itr0!=catalog_meta_->GetTableStatisticsPages()->end()){
+    Page *statistics_page=buffer_pool_manager_->FetchPage(itr0->second);
+    TableStatistics *statistics=nullptr;
+    TableStatistics::DeserializeFrom(statistics_page->GetData(),statistics);
+    buffer_pool_manager_->UnpinPage(itr0->second, false);
+    table_info->SetStatistics(statistics);
+  }
   table_names_.insert(make_pair(table_meta->GetTableName(),table_id));
   tables_.insert(make_pair(table_id,table_info));
   return DB_SUCCESS;
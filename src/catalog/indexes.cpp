@@ -5,9 +5,10 @@
 
 IndexMetadata *IndexMetadata::Create(const index_id_t index_id, const string &index_name,
                                      const table_id_t table_id, const vector<uint32_t> &key_map,
-                                     MemHeap *heap) {
+                                     MemHeap *heap, IndexType index_type,
+                                     const vector<uint32_t> &include_map) {
   void *buf = heap->Allocate(sizeof(IndexMetadata));
-  return new(buf)IndexMetadata(index_id, index_name, table_id, key_map);
+  return new(buf)IndexMetadata(index_id, index_name, table_id, key_map, index_type, include_map);
 }
 
 uint32_t IndexMetadata::SerializeTo(char *buf) const {
@@ -30,11 +31,19 @@ uint32_t IndexMetadata::SerializeTo(char *buf) const {
     MACH_WRITE_UINT32(buf+ofs, val_);
     ofs+=sizeof(uint32_t);
   }
+  MACH_WRITE_UINT32(buf+ofs, static_cast<uint32_t>(index_type_));
+  ofs+=sizeof(uint32_t);
+  MACH_WRITE_UINT32(buf+ofs, static_cast<uint32_t>(include_map_.size()));
+  ofs+=sizeof(uint32_t);
+  for(auto column:include_map_){
+    MACH_WRITE_UINT32(buf+ofs, column);
+    ofs+=sizeof(uint32_t);
+  }
   return ofs;
 }
 
 uint32_t IndexMetadata::GetSerializedSize() const {
-  return sizeof(uint32_t)*(GetIndexColumnCount()+2)+sizeof(index_id_t)+sizeof(table_id_t)+MACH_STR_SERIALIZED_SIZE(index_name_);
+  return sizeof(uint32_t)*(GetIndexColumnCount()+include_map_.size()+4)+sizeof(index_id_t)+sizeof(table_id_t)+MACH_STR_SERIALIZED_SIZE(index_name_);
 }
 
 uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta, MemHeap *heap) {
@@ -62,6 +71,15 @@ uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta, M
     ofs+=sizeof(uint32_t);
     Vec.push_back(val_);
   }
-  index_meta=IndexMetadata::Create(index_id, name, table_id, Vec,heap);
+  IndexType index_type=static_cast<IndexType>(MACH_READ_UINT32(buf+ofs));
+  ofs+=sizeof(uint32_t);
+  uint32_t include_len=MACH_READ_UINT32(buf+ofs);
+  ofs+=sizeof(uint32_t);
+  std::vector<uint32_t> include_map;
+  for(uint32_t i=0;i<include_len;i++){
+    include_map.push_back(MACH_READ_UINT32(buf+ofs));
+    ofs+=sizeof(uint32_t);
+  }
+  index_meta=IndexMetadata::Create(index_id, name, table_id, Vec,heap,index_type,include_map);
   return ofs;
 }
\ No newline at end of file
@@ -0,0 +1,226 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <unordered_set>
+
+#include "catalog/statistics.h"
+#include "common/macros.h"
+#include "index/generic_key.h"
+
+HyperLogLog::HyperLogLog(uint32_t precision) : precision_(precision), registers_(1u << precision, 0) {}
+
+/*
+ * 64-bit FNV-1a, mixed by the splitmix64 finalizer so the high bits, which
+ * pick the register, depend on every input byte
+ */
+uint64_t HyperLogLog::Hash(const char *data, size_t len) {
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < len; i++) {
+    hash = (hash ^ static_cast<unsigned char>(data[i])) * 1099511628211ull;
+  }
+  hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+  hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+  return hash ^ (hash >> 31);
+}
+
+void HyperLogLog::Add(const char *data, size_t len) {
+  uint64_t hash = Hash(data, len);
+  uint32_t index = static_cast<uint32_t>(hash >> (64 - precision_));
+  uint64_t rest = hash << precision_;
+  // position of the first 1 bit in the remaining 64 - precision bits
+  uint8_t rank = rest == 0 ? 64 - precision_ + 1 : __builtin_clzll(rest) + 1;
+  registers_[index] = std::max(registers_[index], rank);
+}
+
+uint64_t HyperLogLog::Estimate() const {
+  double m = registers_.size();
+  double sum = 0;
+  uint32_t zeros = 0;
+  for (auto rank : registers_) {
+    sum += std::ldexp(1.0, -rank);
+    zeros += rank == 0;
+  }
+  double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+  // linear counting is more accurate while many registers are still empty
+  if (estimate <= 2.5 * m && zeros > 0) {
+    estimate = m * std::log(m / zeros);
+  }
+  return static_cast<uint64_t>(estimate + 0.5);
+}
+
+std::string TableStatistics::EncodeValue(const Field &value) {
+  std::string buf(value.IsNull() ? 1 : 1 + GenericKey<8>::EncodedSize(value), 0);
+  GenericKey<8>::EncodeField(value, &buf[0]);
+  return buf.substr(0, STATISTICS_VALUE_LENGTH);
+}
+
+TableStatistics *TableStatistics::Collect(TableHeap *table_heap, Schema *schema) {
+  auto *statistics = new TableStatistics();
+  uint32_t column_count = schema->GetColumnCount();
+  statistics->columns_.resize(column_count);
+  std::vector<HyperLogLog> sketches(column_count);
+  // reservoir samples of the non-null values the histograms are built from
+  std::vector<std::vector<std::string>> samples(column_count);
+  std::vector<uint32_t> values_seen(column_count, 0);
+  std::mt19937 random(column_count);
+  std::unordered_set<page_id_t> pages;
+  for (auto it = table_heap->Begin(); it != table_heap->End(); ++it) {
+    statistics->row_count_++;
+    pages.insert(it->GetRowId().GetPageId());
+    for (uint32_t i = 0; i < column_count; i++) {
+      auto &column = statistics->columns_[i];
+      Field *field = it->GetField(i);
+      if (field->IsNull()) {
+        column.null_count_++;
+        continue;
+      }
+      std::string value = EncodeValue(*field);
+      sketches[i].Add(value.data(), value.size());
+      if (values_seen[i] == 0 || value < column.min_) column.min_ = value;
+      if (values_seen[i] == 0 || value > column.max_) column.max_ = value;
+      if (samples[i].size() < STATISTICS_SAMPLE_SIZE) {
+        samples[i].push_back(value);
+      } else {
+        uint32_t slot = random() % (values_seen[i] + 1);
+        if (slot < STATISTICS_SAMPLE_SIZE) samples[i][slot] = value;
+      }
+      values_seen[i]++;
+    }
+  }
+  statistics->page_count_ = pages.size();
+  for (uint32_t i = 0; i < column_count; i++) {
+    auto &column = statistics->columns_[i];
+    column.distinct_count_ = std::min<uint64_t>(sketches[i].Estimate(), values_seen[i]);
+    if (values_seen[i] > 0) column.distinct_count_ = std::max(column.distinct_count_, 1u);
+    auto &sample = samples[i];
+    std::sort(sample.begin(), sample.end());
+    uint32_t buckets = std::min<size_t>(STATISTICS_HISTOGRAM_BUCKETS, sample.size());
+    for (uint32_t b = 1; b <= buckets; b++) {
+      column.bounds_.push_back(sample[b * sample.size() / buckets - 1]);
+    }
+  }
+  return statistics;
+}
+
+namespace {
+uint32_t WriteValue(char *buf, const std::string &value) {
+  MACH_WRITE_UINT32(buf, value.length());
+  MACH_WRITE_STRING(buf + sizeof(uint32_t), value);
+  return MACH_STR_SERIALIZED_SIZE(value);
+}
+
+uint32_t ReadValue(char *buf, std::string &value) {
+  uint32_t len = MACH_READ_UINT32(buf);
+  value.assign(buf + sizeof(uint32_t), len);
+  return sizeof(uint32_t) + len;
+}
+}  // namespace
+
+uint32_t TableStatistics::SerializeTo(char *buf) const {
+  uint32_t ofs = 0;
+  MACH_WRITE_UINT32(buf, TABLE_STATISTICS_MAGIC_NUM);
+  ofs += sizeof(uint32_t);
+  MACH_WRITE_UINT32(buf + ofs, row_count_);
+  ofs += sizeof(uint32_t);
+  MACH_WRITE_UINT32(buf + ofs, page_count_);
+  ofs += sizeof(uint32_t);
+  MACH_WRITE_UINT32(buf + ofs, columns_.size());
+  ofs += sizeof(uint32_t);
+  for (auto &column : columns_) {
+    MACH_WRITE_UINT32(buf + ofs, column.distinct_count_);
+    ofs += sizeof(uint32_t);
+    MACH_WRITE_UINT32(buf + ofs, column.null_count_);
+    ofs += sizeof(uint32_t);
+    ofs += WriteValue(buf + ofs, column.min_);
+    ofs += WriteValue(buf + ofs, column.max_);
+    MACH_WRITE_UINT32(buf + ofs, column.bounds_.size());
+    ofs += sizeof(uint32_t);
+    for (auto &bound : column.bounds_) {
+      ofs += WriteValue(buf + ofs, bound);
+    }
+  }
+  return ofs;
+}
+
+uint32_t TableStatistics::GetSerializedSize() const {
+  uint32_t size = 4 * sizeof(uint32_t);
+  for (auto &column : columns_) {
+    size += 3 * sizeof(uint32_t) + MACH_STR_SERIALIZED_SIZE(column.min_) + MACH_STR_SERIALIZED_SIZE(column.max_);
+    for (auto &bound : column.bounds_) {
+      size += MACH_STR_SERIALIZED_SIZE(bound);
+    }
+  }
+  return size;
+}
+
+uint32_t TableStatistics::DeserializeFrom(char *buf, TableStatistics *&statistics) {
+  uint32_t ofs = 0;
+  if (MACH_READ_UINT32(buf) != TABLE_STATISTICS_MAGIC_NUM) {
+    printf("Deserializing of TableStatistics Failed!");
+    statistics = nullptr;
+    return 0;
+  }
+  ofs += sizeof(uint32_t);
+  statistics = new TableStatistics();
+  statistics->row_count_ = MACH_READ_UINT32(buf + ofs);
+  ofs += sizeof(uint32_t);
+  statistics->page_count_ = MACH_READ_UINT32(buf + ofs);
+  ofs += sizeof(uint32_t);
+  statistics->columns_.resize(MACH_READ_UINT32(buf + ofs));
+  ofs += sizeof(uint32_t);
+  for (auto &column : statistics->columns_) {
+    column.distinct_count_ = MACH_READ_UINT32(buf + ofs);
+    ofs += sizeof(uint32_t);
+    column.null_count_ = MACH_READ_UINT32(buf + ofs);
+    ofs += sizeof(uint32_t);
+    ofs += ReadValue(buf + ofs, column.min_);
+    ofs += ReadValue(buf + ofs, column.max_);
+    column.bounds_.resize(MACH_READ_UINT32(buf + ofs));
+    ofs += sizeof(uint32_t);
+    for (auto &bound : column.bounds_) {
+      ofs += ReadValue(buf + ofs, bound);
+    }
+  }
+  return ofs;
+}
+
+bool TableStatistics::ShrinkHistograms() {
+  bool shrunk = false;
+  for (auto &column : columns_) {
+    if (column.bounds_.size() <= 1) continue;
+    std::vector<std::string> bounds;
+    for (size_t i = 1; i < column.bounds_.size(); i += 2) {
+      bounds.push_back(column.bounds_[i]);
+    }
+    column.bounds_.swap(bounds);
+    shrunk = true;
+  }
+  return shrunk;
+}
+
+double TableStatistics::ShareBelow(const ColumnStatistics &column, const std::string &value, bool inclusive) const {
+  if (column.bounds_.empty()) return 0;
+  auto below = [&](const std::string &other) { return inclusive ? other <= value : other < value; };
+  if (!below(column.min_)) return 0;
+  if (below(column.max_)) return 1;
+  // whole buckets below value, and half of the one it falls in
+  size_t buckets = std::count_if(column.bounds_.begin(), column.bounds_.end(), below);
+  return std::min(1.0, (buckets + 0.5) / column.bounds_.size());
+}
+
+double TableStatistics::EstimateEquality(uint32_t column_index, const Field &value) const {
+  if (row_count_ == 0) return 0;
+  auto &column = columns_[column_index];
+  if (value.IsNull()) return static_cast<double>(column.null_count_) / row_count_;
+  std::string encoded = EncodeValue(value);
+  if (column.distinct_count_ == 0 || encoded < column.min_ || encoded > column.max_) return 0;
+  return static_cast<double>(row_count_ - column.null_count_) / row_count_ / column.distinct_count_;
+}
+
+double TableStatistics::EstimateRange(uint32_t column_index, const IndexRange &range) const {
+  if (row_count_ == 0) return 0;
+  auto &column = columns_[column_index];
+  double low = range.low_ == nullptr ? 0 : ShareBelow(column, EncodeValue(*range.low_), !range.low_inclusive_);
+  double high = range.high_ == nullptr ? 1 : ShareBelow(column, EncodeValue(*range.high_), range.high_inclusive_);
+  return std::max(0.0, high - low) * (row_count_ - column.null_count_) / row_count_;
+}
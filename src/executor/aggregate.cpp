@@ -0,0 +1,204 @@
+#include "executor/aggregate.h"
+#include "index/generic_key.h"
+
+TypeId Aggregate::ResultType(Schema *schema) const {
+  if (type_ == kAggregateCount) return TypeId::kTypeInt;
+  if (type_ == kAggregateAvg) return TypeId::kTypeFloat;
+  return schema->GetColumn(column_)->GetType();
+}
+
+GroupAccumulator::GroupAccumulator(const Row &row, const std::vector<uint32_t> &group_columns,
+                                   size_t aggregate_count)
+        : values_(aggregate_count) {
+  group_fields_.reserve(group_columns.size());
+  for (auto column : group_columns) {
+    group_fields_.emplace_back(*row.GetField(column));
+  }
+}
+
+void GroupAccumulator::Add(const Row &row, const std::vector<Aggregate> &aggregates) {
+  for (size_t i = 0; i < aggregates.size(); i++) {
+    const Aggregate &aggregate = aggregates[i];
+    Value &value = values_[i];
+    if (aggregate.column_ == Aggregate::ALL_ROWS) {
+      value.count_++;
+      continue;
+    }
+    // nulls are skipped by every aggregate
+    Field *field = row.GetField(aggregate.column_);
+    if (field->IsNull()) continue;
+    value.count_++;
+    switch (aggregate.type_) {
+      case kAggregateSum:
+      case kAggregateAvg:
+        if (field->GetTypeId() == TypeId::kTypeInt) {
+          value.int_sum_ += field->value_.integer_;
+        } else {
+          value.float_sum_ += field->value_.float_;
+        }
+        break;
+      case kAggregateMin:
+        if (value.extreme_ == nullptr || field->CompareLessThan(*value.extreme_) == CmpBool::kTrue) {
+          value.extreme_.reset(new Field(*field));
+        }
+        break;
+      case kAggregateMax:
+        if (value.extreme_ == nullptr || field->CompareGreaterThan(*value.extreme_) == CmpBool::kTrue) {
+          value.extreme_.reset(new Field(*field));
+        }
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+Row GroupAccumulator::Result(const std::vector<Aggregate> &aggregates, Schema *schema) const {
+  std::vector<Field> fields;
+  for (auto &field : group_fields_) {
+    fields.emplace_back(field);
+  }
+  for (size_t i = 0; i < aggregates.size(); i++) {
+    const Aggregate &aggregate = aggregates[i];
+    const Value &value = values_[i];
+    TypeId type = aggregate.ResultType(schema);
+    bool int_column = aggregate.column_ != Aggregate::ALL_ROWS &&
+                      schema->GetColumn(aggregate.column_)->GetType() == TypeId::kTypeInt;
+    if (aggregate.type_ == kAggregateCount) {
+      fields.emplace_back(type, static_cast<int32_t>(value.count_));
+    } else if (value.count_ == 0) {
+      // an aggregate of no values is null
+      fields.emplace_back(type);
+    } else if (aggregate.type_ == kAggregateSum) {
+      if (int_column) {
+        fields.emplace_back(type, static_cast<int32_t>(value.int_sum_));
+      } else {
+        fields.emplace_back(type, static_cast<float>(value.float_sum_));
+      }
+    } else if (aggregate.type_ == kAggregateAvg) {
+      double sum = int_column ? static_cast<double>(value.int_sum_) : value.float_sum_;
+      fields.emplace_back(type, static_cast<float>(sum / value.count_));
+    } else {
+      fields.emplace_back(*value.extreme_);
+    }
+  }
+  return Row(fields);
+}
+
+size_t GroupAccumulator::MemoryUsage() const {
+  size_t size = sizeof(GroupAccumulator) + group_fields_.size() * sizeof(Field) + values_.size() * sizeof(Value);
+  for (auto &field : group_fields_) {
+    if (field.GetTypeId() == TypeId::kTypeChar && !field.IsNull()) size += field.GetLength();
+  }
+  for (auto &value : values_) {
+    if (value.extreme_ == nullptr) continue;
+    size += sizeof(Field);
+    if (value.extreme_->GetTypeId() == TypeId::kTypeChar) size += value.extreme_->GetLength();
+  }
+  return size;
+}
+
+HashAggregate::HashAggregate(Schema *schema, std::vector<uint32_t> group_columns, std::vector<Aggregate> aggregates,
+                             size_t memory_budget)
+        : schema_(schema),
+          group_columns_(std::move(group_columns)),
+          aggregates_(std::move(aggregates)),
+          memory_budget_(memory_budget) {}
+
+std::string HashAggregate::EncodeGroup(const Row &row, const std::vector<uint32_t> &group_columns) {
+  std::string key;
+  for (auto column : group_columns) {
+    Field *field = row.GetField(column);
+    size_t ofs = key.size();
+    key.resize(ofs + (field->IsNull() ? 1 : 1 + GenericKey<8>::EncodedSize(*field)));
+    GenericKey<8>::EncodeField(*field, &key[ofs]);
+  }
+  return key;
+}
+
+void HashAggregate::Add(const Row &row) {
+  std::string key = EncodeGroup(row, group_columns_);
+  auto it = table_.find(key);
+  if (it != table_.end()) {
+    groups_[it->second].Add(row, aggregates_);
+    return;
+  }
+  if (IsSpilled()) {
+    partitions_[std::hash<std::string>()(key) % HASH_AGGREGATE_PARTITIONS]->Write(row);
+    return;
+  }
+  table_.emplace(key, groups_.size());
+  groups_.emplace_back(row, group_columns_, aggregates_.size());
+  groups_.back().Add(row, aggregates_);
+  // rough footprint: the group and its hash table entry
+  memory_used_ += groups_.back().MemoryUsage() + key.size() + 64;
+  if (memory_used_ > memory_budget_) Spill();
+}
+
+void HashAggregate::Spill() {
+  for (int i = 0; i < HASH_AGGREGATE_PARTITIONS; i++) {
+    auto file = SpillFile::Create(schema_);
+    if (file == nullptr) {
+      // no spill space, keep aggregating in memory
+      partitions_.clear();
+      memory_budget_ = SIZE_MAX;
+      return;
+    }
+    partitions_.push_back(std::move(file));
+  }
+}
+
+void HashAggregate::Finish(const Emitter &emit) {
+  bool emitted = !groups_.empty();
+  for (auto &group : groups_) {
+    emit(group.Result(aggregates_, schema_));
+  }
+  groups_.clear();
+  table_.clear();
+  memory_used_ = 0;
+  for (auto &partition : partitions_) {
+    // a partition is assumed to fit in memory, its groups are not split further
+    if (partition->GetRowCount() == 0) continue;
+    HashAggregate partition_aggregate(schema_, group_columns_, aggregates_, SIZE_MAX);
+    partition->Rewind();
+    Row row{RowId()};
+    while (partition->Read(row)) {
+      partition_aggregate.Add(row);
+    }
+    partition_aggregate.Finish(emit);
+  }
+  if (!emitted && group_columns_.empty()) {
+    std::vector<Field> no_fields;
+    Row empty(no_fields);
+    emit(GroupAccumulator(empty, group_columns_, aggregates_.size()).Result(aggregates_, schema_));
+  }
+}
+
+StreamAggregate::StreamAggregate(Schema *schema, std::vector<uint32_t> group_columns,
+                                 std::vector<Aggregate> aggregates)
+        : schema_(schema), group_columns_(std::move(group_columns)), aggregates_(std::move(aggregates)) {}
+
+void StreamAggregate::Add(const Row &row, const Emitter &emit) {
+  std::string key = HashAggregate::EncodeGroup(row, group_columns_);
+  if (current_ != nullptr && key != current_key_) {
+    emit(current_->Result(aggregates_, schema_));
+    emitted_ = true;
+    current_.reset();
+  }
+  if (current_ == nullptr) {
+    current_.reset(new GroupAccumulator(row, group_columns_, aggregates_.size()));
+    current_key_ = key;
+  }
+  current_->Add(row, aggregates_);
+}
+
+void StreamAggregate::Finish(const Emitter &emit) {
+  if (current_ != nullptr) {
+    emit(current_->Result(aggregates_, schema_));
+    current_.reset();
+  } else if (!emitted_ && group_columns_.empty()) {
+    std::vector<Field> no_fields;
+    Row empty(no_fields);
+    emit(GroupAccumulator(empty, group_columns_, aggregates_.size()).Result(aggregates_, schema_));
+  }
+}
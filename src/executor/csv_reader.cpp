@@ -0,0 +1,71 @@
+#include "common/config.h"
+#include "executor/csv_reader.h"
+
+std::unique_ptr<CsvReader> CsvReader::Open(const std::string &file_name) {
+  FILE *file = fopen(file_name.c_str(), "rb");
+  if (file == nullptr) return nullptr;
+  return std::unique_ptr<CsvReader>(new CsvReader(file));
+}
+
+CsvReader::CsvReader(FILE *file) : file_(file), buffer_(CSV_READ_BUFFER_SIZE) {}
+
+CsvReader::~CsvReader() { fclose(file_); }
+
+bool CsvReader::Fill() {
+  if (position_ < size_) return true;
+  size_ = fread(buffer_.data(), 1, buffer_.size(), file_);
+  position_ = 0;
+  return size_ > 0;
+}
+
+bool CsvReader::ReadRecord(std::vector<std::string> &fields, std::vector<bool> &nulls) {
+  fields.clear();
+  nulls.clear();
+  // skip blank lines
+  while (Fill() && (buffer_[position_] == '\n' || buffer_[position_] == '\r')) {
+    line_ += buffer_[position_++] == '\n';
+  }
+  if (!Fill()) return false;
+  record_line_ = line_;
+  while (true) {
+    fields.emplace_back();
+    std::string &field = fields.back();
+    bool quoted = Fill() && buffer_[position_] == '"';
+    if (quoted) {
+      position_++;
+      while (Fill()) {
+        // copy up to the next quote at once
+        size_t end = position_;
+        while (end < size_ && buffer_[end] != '"') line_ += buffer_[end++] == '\n';
+        field.append(buffer_.data() + position_, end - position_);
+        position_ = end;
+        if (position_ == size_) continue;
+        position_++;
+        if (!Fill() || buffer_[position_] != '"') break;
+        // a doubled quote stands for one
+        field += '"';
+        position_++;
+      }
+    }
+    // the rest of the field, everything after a closing quote too
+    while (Fill()) {
+      size_t end = position_;
+      while (end < size_ && buffer_[end] != ',' && buffer_[end] != '\n') end++;
+      field.append(buffer_.data() + position_, end - position_);
+      position_ = end;
+      if (position_ < size_) break;
+    }
+    bool last = !Fill() || buffer_[position_] == '\n';
+    if (last && !field.empty() && field.back() == '\r') field.pop_back();
+    nulls.push_back(!quoted && field.empty());
+    if (last) {
+      if (Fill()) {
+        position_++;
+        line_++;
+      }
+      return true;
+    }
+    // skip the comma
+    position_++;
+  }
+}
@@ -1,5 +1,17 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <set>
+#include <unordered_map>
+
 #include "executor/execute_engine.h"
+#include "executor/aggregate.h"
+#include "executor/csv_reader.h"
+#include "executor/external_sort.h"
+#include "executor/hash_join.h"
 #include "glog/logging.h"
+#include "storage/row_id_bitmap.h"
 using namespace std;
 
 ExecuteEngine::ExecuteEngine() {
@@ -23,11 +35,388 @@ ExecuteEngine::ExecuteEngine() {
 }
 
 Field GetField(TypeId tid, char *val) {
+  // null literals carry no value
+  if(val == nullptr) return Field(tid);
   if(tid == kTypeInt) return Field(kTypeInt, (int32_t)atoi(val));
   else if(tid == kTypeFloat) return Field(kTypeFloat, (float)atof(val));
   else if(tid == kTypeChar) return Field(kTypeChar, val, strlen(val) + 1, true);
   else return Field(tid);
 }
+
+/**
+ * Column name without its table qualifier
+ */
+string UnqualifiedName(const string &name) {
+  auto dot = name.find('.');
+  return dot == string::npos ? name : name.substr(dot + 1);
+}
+
+/**
+ * Find a column by name. Columns of a joined schema are named table.column,
+ * and an unqualified name there must belong to a single table; a qualified
+ * name against a single table's schema matches by its column part.
+ * @return DB_COLUMN_NAME_NOT_EXIST, or DB_FAILED if the name is ambiguous
+ */
+dberr_t ResolveColumn(Schema *schema, const string &name, uint32_t &index) {
+  if(schema->GetColumnIndex(name, index) == DB_SUCCESS) return DB_SUCCESS;
+  bool found = false;
+  for(uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    string column_name = schema->GetColumn(i)->GetName();
+    bool qualified = column_name.find('.') != string::npos;
+    if(qualified ? name.find('.') == string::npos && UnqualifiedName(column_name) == name
+                 : column_name == UnqualifiedName(name)) {
+      if(found) return DB_FAILED;
+      found = true;
+      index = i;
+    }
+  }
+  return found ? DB_SUCCESS : DB_COLUMN_NAME_NOT_EXIST;
+}
+
+/**
+ * Key of row in an index, the fields of its key schema columns
+ */
+Row IndexKey(const Row &row, IndexInfo *index_info) {
+  vector<Field> keys;
+  IndexSchema *key_schema = index_info->GetIndexKeySchema();
+  for(uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+    keys.emplace_back(*row.GetField(key_schema->GetColumn(i)->GetTableInd()));
+  }
+  Row key(keys);
+  key.SetRowId(row.GetRowId());
+  return key;
+}
+
+/**
+ * Whether two keys of an index hold the same values in their first
+ * column_count columns, a null matching a null
+ */
+bool SameKey(const Row &lhs, const Row &rhs, uint32_t column_count) {
+  for(uint32_t i = 0; i < column_count; i++) {
+    Field *left = lhs.GetField(i), *right = rhs.GetField(i);
+    if(left->IsNull() != right->IsNull()) return false;
+    if(!left->IsNull() && left->CompareEquals(*right) != CmpBool::kTrue) return false;
+  }
+  return true;
+}
+
+/**
+ * Table row holding the columns an index entry stores, the others are null
+ */
+Row EntryToRow(Row &entry, IndexSchema *key_schema, Schema *schema) {
+  vector<Field> row_fields;
+  for(uint32_t i = 0; i < schema->GetColumnCount(); i++) row_fields.emplace_back(schema->GetColumn(i)->GetType());
+  for(uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+    Field *field = entry.GetField(i);
+    Field &row_field = row_fields[key_schema->GetColumn(i)->GetTableInd()];
+    if(field->GetTypeId() == kTypeChar && !field->IsNull()) {
+      // char fields of table rows count the terminator
+      string value(field->GetData(), field->GetLength());
+      Field char_field = GetField(kTypeChar, const_cast<char *>(value.c_str()));
+      row_field = char_field;
+    } else {
+      row_field = *field;
+    }
+  }
+  Row row(row_fields);
+  row.SetRowId(entry.GetRowId());
+  return row;
+}
+
+/**
+ * Child of a select node holding the given clause, null if the select has none
+ */
+pSyntaxNode SelectClause(pSyntaxNode ast, SyntaxNodeType type) {
+  for(auto pos = ast->child_->next_; pos != nullptr; pos = pos->next_) {
+    if(pos->type_ == type) return pos;
+  }
+  return nullptr;
+}
+
+/**
+ * Whether a select groups its rows or aggregates them into one
+ */
+bool IsAggregation(pSyntaxNode ast) {
+  if(SelectClause(ast, kNodeGroupBy) != nullptr) return true;
+  for(auto pos = ast->child_->child_; pos != nullptr; pos = pos->next_) {
+    if(pos->type_ == kNodeAggregate) return true;
+  }
+  return false;
+}
+
+/**
+ * B+ tree index whose leading key columns are the group columns, in any
+ * order, so it returns the rows of a group one after another
+ */
+IndexInfo *MatchGroupIndex(const vector<IndexInfo *> &index_infos, const vector<uint32_t> &group_columns) {
+  set<uint32_t> groups(group_columns.begin(), group_columns.end());
+  for(auto index_info : index_infos) {
+    IndexSchema *key_schema = index_info->GetIndexKeySchema();
+    if(index_info->GetIndexType() != kIndexBPlusTree || index_info->GetKeyColumnCount() < groups.size()) continue;
+    set<uint32_t> leading;
+    for(uint32_t i = 0; i < groups.size(); i++) leading.insert(key_schema->GetColumn(i)->GetTableInd());
+    if(leading == groups) return index_info;
+  }
+  return nullptr;
+}
+
+/**
+ * B+ tree index whose leading key columns are the ascending sort keys, so
+ * it returns rows in their order
+ */
+IndexInfo *MatchOrderIndex(const vector<IndexInfo *> &index_infos, const vector<SortKey> &sort_keys) {
+  for(auto index_info : index_infos) {
+    IndexSchema *key_schema = index_info->GetIndexKeySchema();
+    if(index_info->GetIndexType() != kIndexBPlusTree || index_info->GetKeyColumnCount() < sort_keys.size()) continue;
+    bool match = true;
+    for(uint32_t i = 0; match && i < sort_keys.size(); i++) {
+      match = !sort_keys[i].descending_ && key_schema->GetColumn(i)->GetTableInd() == sort_keys[i].column_;
+    }
+    if(match) return index_info;
+  }
+  return nullptr;
+}
+
+/**
+ * Whether the entries of an index store every one of columns
+ */
+bool IndexCovers(IndexInfo *index_info, const vector<uint32_t> &columns) {
+  auto &key_columns = index_info->GetIndexKeySchema()->GetColumns();
+  return index_info->GetIndexType() == kIndexBPlusTree && all_of(columns.begin(), columns.end(), [&](uint32_t index) {
+    return any_of(key_columns.begin(), key_columns.end(), [&](Column *column) { return column->GetTableInd() == index; });
+  });
+}
+
+/**
+ * Visit the first limit rows of a table in the order of a B+ tree index. Rows
+ * are built from the index entries alone when they store every one of columns
+ */
+void ScanInIndexOrder(TableInfo *table_info, IndexInfo *index_info, const vector<uint32_t> &columns, size_t limit,
+                      const function<void(const Row &)> &visit) {
+  vector<Field> no_fields;
+  Row all_keys(no_fields);
+  IndexRange range;
+  range.limit_ = limit;
+  if(IndexCovers(index_info, columns)) {
+    vector<Row> entries;
+    index_info->GetIndex()->ScanEntries(all_keys, range, entries, nullptr);
+    for(auto &entry : entries) visit(EntryToRow(entry, index_info->GetIndexKeySchema(), table_info->GetSchema()));
+    return;
+  }
+  vector<RowId> row_ids;
+  index_info->GetIndex()->ScanRange(all_keys, range, row_ids, nullptr);
+  for(auto &rid : row_ids) {
+    Row row(rid);
+    table_info->GetTableHeap()->GetTuple(&row, nullptr);
+    visit(row);
+  }
+}
+
+/**
+ * Schema of aggregated rows, the group columns followed by the aggregate values
+ */
+unique_ptr<Schema> AggregateSchema(Schema *schema, const vector<uint32_t> &group_columns,
+                                   const vector<Aggregate> &aggregates, vector<unique_ptr<Column>> &columns) {
+  vector<Column *> result;
+  auto add = [&](const string &name, TypeId type, uint32_t length) {
+    uint32_t index = result.size();
+    if(type == kTypeChar) columns.emplace_back(new Column(name, type, length, index, true, false));
+    else columns.emplace_back(new Column(name, type, index, true, false));
+    result.push_back(columns.back().get());
+  };
+  for(auto column_index : group_columns) {
+    const Column *column = schema->GetColumn(column_index);
+    add(column->GetName(), column->GetType(), column->GetLength());
+  }
+  for(auto &aggregate : aggregates) {
+    TypeId type = aggregate.ResultType(schema);
+    add("aggregate", type, type == kTypeChar ? schema->GetColumn(aggregate.column_)->GetLength() : 0);
+  }
+  return unique_ptr<Schema>(new Schema(result));
+}
+
+/**
+ * Split a where condition into the terms joined by connector ("and" or "or")
+ */
+void CollectTerms(pSyntaxNode ast, const string &connector, vector<pSyntaxNode> &terms) {
+  if(ast->type_ == kNodeConnector && connector == ast->val_) {
+    for(auto pos = ast->child_; pos != nullptr; pos = pos->next_) CollectTerms(pos, connector, terms);
+  } else {
+    terms.push_back(ast);
+  }
+}
+
+/**
+ * First term comparing column_name with a literal by comparator
+ */
+pSyntaxNode FindConjunct(const vector<pSyntaxNode> &conjuncts, const string &column_name, const string &comparator) {
+  for(auto term : conjuncts) {
+    if(term->type_ != kNodeCompareOperator || comparator != term->val_ || column_name != UnqualifiedName(term->child_->val_))
+      continue;
+    auto value = term->child_->next_;
+    if(value->type_ == kNodeNumber || value->type_ == kNodeString) return term;
+  }
+  return nullptr;
+}
+
+/**
+ * AND-ed terms an index answers: equalities on a prefix of its key columns,
+ * then a lower and an upper bound on the next key column (b+ tree only)
+ */
+struct IndexMatch {
+  IndexInfo *index_info_{nullptr};
+  vector<pSyntaxNode> terms_;
+  pSyntaxNode low_{nullptr};
+  pSyntaxNode high_{nullptr};
+
+  size_t Size() const { return terms_.size() + (low_ != nullptr) + (high_ != nullptr); }
+
+  bool Uses(pSyntaxNode term) const {
+    return term == low_ || term == high_ || find(terms_.begin(), terms_.end(), term) != terms_.end();
+  }
+};
+
+/**
+ * Match index_info against conjuncts, index_info_ stays null if it answers none
+ */
+IndexMatch MatchIndex(IndexInfo *index_info, const vector<pSyntaxNode> &conjuncts) {
+  IndexMatch match;
+  IndexSchema *key_schema = index_info->GetIndexKeySchema();
+  uint32_t key_count = index_info->GetKeyColumnCount();
+  while(match.terms_.size() < key_count) {
+    pSyntaxNode term = FindConjunct(conjuncts, key_schema->GetColumn(match.terms_.size())->GetName(), "=");
+    if(term == nullptr) break;
+    match.terms_.push_back(term);
+  }
+  if(index_info->GetIndexType() == kIndexHash && match.terms_.size() < key_count) return IndexMatch();
+  if(match.terms_.size() < key_count) {
+    string column_name = key_schema->GetColumn(match.terms_.size())->GetName();
+    match.low_ = FindConjunct(conjuncts, column_name, ">");
+    if(match.low_ == nullptr) match.low_ = FindConjunct(conjuncts, column_name, ">=");
+    match.high_ = FindConjunct(conjuncts, column_name, "<");
+    if(match.high_ == nullptr) match.high_ = FindConjunct(conjuncts, column_name, "<=");
+  }
+  if(match.Size() > 0) match.index_info_ = index_info;
+  return match;
+}
+
+/**
+ * Key fields and range of the index probe answering match, bounds must not be
+ * reallocated while range is in use
+ */
+void MakeIndexProbe(const IndexMatch &match, vector<Field> &fields, vector<Field> &bounds, IndexRange &range) {
+  IndexSchema *key_schema = match.index_info_->GetIndexKeySchema();
+  for(uint32_t i = 0; i < match.terms_.size(); i++) {
+    fields.push_back(GetField(key_schema->GetColumn(i)->GetType(), match.terms_[i]->child_->next_->val_));
+  }
+  bounds.reserve(2);
+  if(match.low_ != nullptr) {
+    bounds.push_back(GetField(key_schema->GetColumn(fields.size())->GetType(), match.low_->child_->next_->val_));
+    range.low_ = &bounds.back();
+    range.low_inclusive_ = string(match.low_->val_) == ">=";
+  }
+  if(match.high_ != nullptr) {
+    bounds.push_back(GetField(key_schema->GetColumn(fields.size())->GetType(), match.high_->child_->next_->val_));
+    range.high_ = &bounds.back();
+    range.high_inclusive_ = string(match.high_->val_) == "<=";
+  }
+}
+
+/**
+ * Row ids of the index probe answering match, in index order
+ */
+void ProbeIndex(const IndexMatch &match, vector<RowId> &row_ids) {
+  vector<Field> fields, bounds;
+  IndexRange range;
+  MakeIndexProbe(match, fields, bounds, range);
+  Row key(fields);
+  if(match.low_ == nullptr && match.high_ == nullptr && fields.size() == match.index_info_->GetKeyColumnCount()) {
+    match.index_info_->GetIndex()->ScanKey(key, row_ids, nullptr);
+  } else {
+    match.index_info_->GetIndex()->ScanRange(key, range, row_ids, nullptr);
+  }
+}
+
+/**
+ * Add the row ids of the index probe answering match to bitmap
+ */
+void ScanIndex(const IndexMatch &match, RowIdBitmap &bitmap) {
+  vector<RowId> row_ids;
+  ProbeIndex(match, row_ids);
+  for(auto &rid : row_ids) bitmap.Add(rid);
+}
+
+/**
+ * One index match per disjunct of an OR term, whose probes together return
+ * every row that may satisfy it. False if some disjunct has no index to
+ * answer it.
+ */
+bool MatchDisjuncts(pSyntaxNode term, const vector<IndexInfo *> &index_infos, vector<IndexMatch> &matches) {
+  vector<pSyntaxNode> disjuncts;
+  CollectTerms(term, "or", disjuncts);
+  for(auto disjunct : disjuncts) {
+    vector<pSyntaxNode> conjuncts;
+    CollectTerms(disjunct, "and", conjuncts);
+    IndexMatch best;
+    for(auto index_info : index_infos) {
+      IndexMatch match = MatchIndex(index_info, conjuncts);
+      if(match.Size() > best.Size()) best = match;
+    }
+    if(best.index_info_ == nullptr) return false;
+    matches.push_back(best);
+  }
+  return true;
+}
+
+/**
+ * Cost model of the access paths, in page reads, used once a table has
+ * statistics:
+ *   sequential scan  every table page
+ *   index probe      descent plus the leaf pages of the entries returned
+ *   index scan       probe plus one heap page per row, fetched in key order
+ *   sorted row ids   probe plus each heap page holding a row once, with a
+ *                    small per-row charge for building the bitmap
+ */
+static constexpr double INDEX_FANOUT = 100;           // entries of an index page
+static constexpr double BITMAP_ROW_COST = 0.01;       // bitmap insert and sort, per row
+
+/**
+ * Estimated share of the table rows the index probe answering match returns
+ */
+double EstimateSelectivity(const IndexMatch &match, TableStatistics *statistics) {
+  IndexSchema *key_schema = match.index_info_->GetIndexKeySchema();
+  vector<Field> fields, bounds;
+  IndexRange range;
+  MakeIndexProbe(match, fields, bounds, range);
+  // columns are taken as independent
+  double selectivity = 1;
+  for(uint32_t i = 0; i < fields.size(); i++) {
+    selectivity *= statistics->EstimateEquality(key_schema->GetColumn(i)->GetTableInd(), fields[i]);
+  }
+  if(range.low_ != nullptr || range.high_ != nullptr) {
+    selectivity *= statistics->EstimateRange(key_schema->GetColumn(fields.size())->GetTableInd(), range);
+  }
+  return selectivity;
+}
+
+double IndexProbeCost(IndexInfo *index_info, uint32_t row_count, double rows) {
+  // a hash probe reads the directory and one bucket
+  if(index_info->GetIndexType() == kIndexHash) return 2 + rows / INDEX_FANOUT;
+  return 1 + log(max(row_count, 2u)) / log(INDEX_FANOUT) + rows / INDEX_FANOUT;
+}
+
+/**
+ * Expected distinct pages holding rows random rows of a table of pages pages
+ */
+double PagesTouched(double pages, double rows) {
+  if(pages <= 1) return min(1.0, rows);
+  return pages * (1 - pow(1 - 1 / pages, rows));
+}
+
+double SortedFetchCost(double pages, double rows) {
+  return PagesTouched(pages, rows) + rows * BITMAP_ROW_COST;
+}
+
 void signal(int c) {
   cerr << " !!!!!!!! " << c << endl;
 }
@@ -37,6 +426,7 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast, ExecuteContext *context) {
       dbs_[current_db_]->bpm_->CheckAllUnpinned();
   }
   message_ = &context->message_;
+  result_ = context->result_;
   switch (ast->type_) {
     case kNodeCreateDB:
       return ExecuteCreateDatabase(ast, context);
@@ -52,6 +442,8 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast, ExecuteContext *context) {
       return ExecuteCreateTable(ast, context);
     case kNodeDropTable:
       return ExecuteDropTable(ast, context);
+    case kNodeTruncateTable:
+      return ExecuteTruncateTable(ast, context);
     case kNodeShowIndexes:
       return ExecuteShowIndexes(ast, context);
     case kNodeCreateIndex:
@@ -76,12 +468,86 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast, ExecuteContext *context) {
       return ExecuteExecfile(ast, context);
     case kNodeQuit:
       return ExecuteQuit(ast, context);
+    case kNodeAnalyze:
+      return ExecuteAnalyze(ast, context);
+    case kNodeVacuum:
+      return ExecuteVacuum(ast, context);
+    case kNodeCopy:
+      return ExecuteCopy(ast, context);
     default:
       break;
   }
   return DB_FAILED;
 }
 
+dberr_t ExecuteEngine::ExecuteSql(const char *sql, ExecuteContext *context) {
+  PlanCache::Statement statement;
+  PlanCache::Normalize(sql, statement);
+  pSyntaxNode ast = plan_cache_.Lookup(statement);
+  if(ast != nullptr) return Execute(ast, context);
+  return ParseSql(sql, [&](pSyntaxNode ast) {
+    if(ast != nullptr && statement.parameter_count_ != 0) {
+      context->message_ += "Error: Parameters are only allowed in prepared statements!\n";
+      return DB_FAILED;
+    }
+    plan_cache_.Insert(statement, ast);
+    return Execute(ast, context);
+  });
+}
+
+unique_ptr<PreparedStatement> ExecuteEngine::Prepare(const char *sql, string &message) {
+  unique_ptr<PreparedStatement> statement;
+  ParseSql(sql, [&](pSyntaxNode ast) {
+    if(ast == nullptr) {
+      message += string(MinisqlParserGetErrorMessage()) + "\n";
+      return DB_FAILED;
+    }
+    statement.reset(new PreparedStatement(this, ast));
+    return DB_SUCCESS;
+  });
+  return statement;
+}
+
+dberr_t ExecuteEngine::ParseSql(const char *sql, const function<dberr_t(pSyntaxNode)> &visit) {
+  // create buffer for sql input
+  YY_BUFFER_STATE bp = yy_scan_string(sql);
+  if (bp == nullptr) {
+    LOG(ERROR) << "Failed to create yy buffer state." << std::endl;
+    exit(1);
+  }
+  yy_switch_to_buffer(bp);
+
+  // init parser module
+  MinisqlParserInit();
+
+  // parse
+  yyparse();
+
+  // parse result handle
+  pSyntaxNode ast = nullptr;
+  if (MinisqlParserGetError()) {
+    // error
+    printf("%s\n", MinisqlParserGetErrorMessage());
+  } else {
+#ifdef ENABLE_PARSER_DEBUG
+    static TreeFileManagers syntax_tree_file_mgr("syntax_tree_");
+    static uint32_t syntax_tree_id = 0;
+    printf("[INFO] Sql syntax parse ok!\n");
+    SyntaxTreePrinter printer(MinisqlGetParserRootNode());
+    printer.PrintTree(syntax_tree_file_mgr[syntax_tree_id++]);
+#endif
+    ast = MinisqlGetParserRootNode();
+  }
+
+  dberr_t status = visit(ast);
+
+  // clean memory after parse
+  MinisqlParserFinish();
+  yy_delete_buffer(bp);
+  yylex_destroy();
+  return status;
+}
+
 dberr_t ExecuteEngine::ExecuteCreateDatabase(pSyntaxNode ast, ExecuteContext *context) {
 #ifdef ENABLE_EXECUTE_DEBUG
   LOG(INFO) << "ExecuteCreateDatabase" << std::endl;
@@ -254,6 +720,22 @@ dberr_t ExecuteEngine::ExecuteDropTable(pSyntaxNode ast, ExecuteContext *context
   // signal(0);
   return dbs_[current_db_]->catalog_mgr_->DropTable(table_name);
 }
+dberr_t ExecuteEngine::ExecuteTruncateTable(pSyntaxNode ast, ExecuteContext *context) {
+#ifdef ENABLE_EXECUTE_DEBUG
+  LOG(INFO) << "ExecuteTruncateTable" << std::endl;
+#endif
+  if(current_db_ == "") {
+    *message_ += "Error: No database being used!\n";
+    return DB_FAILED;
+  }
+  string table_name = ast->child_->val_;
+  if(dbs_[current_db_]->catalog_mgr_->TruncateTable(table_name, context->txn_) == DB_TABLE_NOT_EXIST) {
+    *message_ += "Error: Table " + table_name + " does not exist!\n";
+    return DB_FAILED;
+  }
+  return DB_SUCCESS;
+}
+
 dberr_t ExecuteEngine::ExecuteShowIndexes(pSyntaxNode ast, ExecuteContext *context) {
 #ifdef ENABLE_EXECUTE_DEBUG
   LOG(INFO) << "ExecuteShowIndexes" << std::endl;
@@ -291,14 +773,37 @@ dberr_t ExecuteEngine::ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext *conte
     index_keys.push_back(pos->val_);
     pos = pos->next_;
   }
+  IndexType index_type = kIndexBPlusTree;
+  vector<string> include_columns;
+  for(auto option = ast->child_->next_->next_->next_; option != nullptr; option = option->next_) {
+    if(option->type_ == kNodeIndexType) {
+      string type_name = option->child_->val_;
+      for(auto &c : type_name) c = tolower(c);
+      if(type_name == "hash") index_type = kIndexHash;
+      else if(type_name != "btree" && type_name != "bptree") {
+        *message_ += "Error: Unknown index type " + string(option->child_->val_) + "!\n";
+        return DB_FAILED;
+      }
+    } else if(option->type_ == kNodeIncludeColumns) {
+      for(pos = option->child_; pos != nullptr; pos = pos->next_) include_columns.push_back(pos->val_);
+    }
+  }
+  if(index_type == kIndexHash && !include_columns.empty()) {
+    *message_ += "Error: Only b+ tree indexes can include columns!\n";
+    return DB_FAILED;
+  }
   IndexInfo *index_info;
-  dberr_t status = dbs_[current_db_]->catalog_mgr_->CreateIndex(table_name, index_name, index_keys, nullptr, index_info);
+  dberr_t status = dbs_[current_db_]->catalog_mgr_->CreateIndex(table_name, index_name, index_keys, nullptr, index_info,
+                                                                index_type, include_columns);
   if(status == DB_TABLE_NOT_EXIST) {
     *message_ += "Error: Table " + table_name + " does not exist!\n";
     return DB_FAILED;
   } else if(status == DB_INDEX_ALREADY_EXIST) {
     *message_ += "Error: Index " + index_name + " already exists!\n";
     return DB_FAILED;
+  } else if(status == DB_COLUMN_NAME_NOT_EXIST) {
+    *message_ += "Error: Column does not exist!\n";
+    return DB_FAILED;
   }
   TableInfo *table_info;
   dbs_[current_db_]->catalog_mgr_->GetTable(table_name, table_info);
@@ -310,8 +815,10 @@ dberr_t ExecuteEngine::ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext *conte
       fields.push_back(*row.GetField(index_info->GetIndexKeySchema()->GetColumn(i)->GetTableInd()));
     }
     Row key(fields);
-    if(index_info->GetIndex()->InsertEntry(key, row.GetRowId(), nullptr) != DB_SUCCESS) {
-      *message_ += "Error: Creating Index " + index_name + "will cause duplicate tuples!\n";
+    status = index_info->GetIndex()->InsertEntry(key, row.GetRowId(), nullptr);
+    if(status != DB_SUCCESS) {
+      *message_ += status == DB_KEY_ALREADY_EXIST ? "Error: Creating Index " + index_name + "will cause duplicate tuples!\n"
+                                                  : "Error: Creating Index " + index_name + " failed!\n";
       dbs_[current_db_]->catalog_mgr_->DropIndex(table_name, index_name);
       return DB_FAILED;
     }
@@ -343,6 +850,7 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext *context) {
     *message_ += "Error: No database being used!\n";
     return DB_FAILED;
   }
+  if(ast->child_->next_->type_ == kNodeTableList) return ExecuteJoinSelect(ast, context);
   string table_name = ast->child_->next_->val_;
   TableInfo *table_info;
   if(dbs_[current_db_]->catalog_mgr_->GetTable(table_name, table_info) != DB_SUCCESS) {
@@ -352,41 +860,504 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext *context) {
   vector<IndexInfo *> index_infos;
   dbs_[current_db_]->catalog_mgr_->GetTableIndexes(table_name, index_infos);
 
+  // columns the query reads, an index storing them all makes the table heap unnecessary
+  Schema *schema = table_info->GetSchema();
+  vector<uint32_t> columns, group_columns;
+  bool known_columns = true;
+  auto reads = [&](const char *column_name, vector<uint32_t> &read_columns) {
+    uint32_t column_index;
+    if(ResolveColumn(schema, column_name, column_index) != DB_SUCCESS) known_columns = false;
+    else read_columns.push_back(column_index);
+  };
+  if(ast->child_->type_ == kNodeAllColumns) {
+    for(uint32_t i = 0; i < schema->GetColumnCount(); i++) columns.push_back(i);
+  } else {
+    for(auto pos = ast->child_->child_; pos != nullptr; pos = pos->next_) {
+      if(pos->type_ != kNodeAggregate) reads(pos->val_, columns);
+      else if(pos->child_->type_ == kNodeIdentifier) reads(pos->child_->val_, columns);
+    }
+  }
+  pSyntaxNode group_by = SelectClause(ast, kNodeGroupBy);
+  for(auto pos = group_by == nullptr ? nullptr : group_by->child_; pos != nullptr; pos = pos->next_) {
+    reads(pos->val_, group_columns);
+  }
+  columns.insert(columns.end(), group_columns.begin(), group_columns.end());
+  pSyntaxNode conditions = SelectClause(ast, kNodeConditions);
+  if(group_by != nullptr && conditions == nullptr && known_columns) {
+    IndexInfo *group_index = MatchGroupIndex(index_infos, group_columns);
+    if(group_index != nullptr) return ExecuteStreamAggregate(ast, table_info, group_index, columns);
+  }
+  pSyntaxNode order_by = SelectClause(ast, kNodeOrderBy), limit = SelectClause(ast, kNodeLimit);
+  if(!IsAggregation(ast) && conditions == nullptr && known_columns && (order_by != nullptr || limit != nullptr)) {
+    // the scan stops at the end of the limit when the rows come in order
+    size_t count, offset;
+    vector<SortKey> sort_keys;
+    if(GetLimit(ast, count, offset) != DB_SUCCESS || PlanOrder(ast, schema, nullptr, sort_keys) != DB_SUCCESS)
+      return DB_FAILED;
+    size_t end = count == SIZE_MAX ? SIZE_MAX : count + offset;
+    vector<Row> rows;
+    if(sort_keys.empty()) {
+      TableHeap *table_heap = table_info->GetTableHeap();
+      for(auto it = table_heap->Begin(); it != table_heap->End() && rows.size() < end; ++it) rows.emplace_back(*it);
+      return OutputRows(ast, schema, rows, true);
+    }
+    // an index in the sort order skips the sort, reading the heap in index order
+    // only pays off when the limit cuts the scan short
+    IndexInfo *order_index = MatchOrderIndex(index_infos, sort_keys);
+    if(order_index != nullptr && (limit != nullptr || IndexCovers(order_index, columns))) {
+      ScanInIndexOrder(table_info, order_index, columns, end, [&](const Row &row) { rows.push_back(row); });
+      return OutputRows(ast, schema, rows, true);
+    }
+  }
   vector<Row> rows;
-  if(GetRows(ast->child_->next_->next_, table_info, index_infos, &rows) != DB_SUCCESS) {
+  if(GetRows(conditions, table_info, index_infos, &rows, known_columns ? &columns : nullptr) != DB_SUCCESS) {
     return DB_FAILED;
   }
-  vector<Row> projection_rows;
-  if(ast->child_->type_ == kNodeAllColumns) {
-    for(auto &row: rows) projection_rows.emplace_back(row);
-  } else {
-    Schema *schema = table_info->GetSchema();
-    for(auto &row: rows) {
-      vector<Field> projection_fields;
-      auto pos = ast->child_->child_;
-      while(pos != nullptr) {
-        string column_name = pos->val_;
-        uint32_t column_indexex;
-        if (schema->GetColumnIndex(column_name, column_indexex) == DB_COLUMN_NAME_NOT_EXIST) {
-          *message_ += "Error: Column " + column_name + " does not exist!\n";
-          return DB_FAILED;
+  return OutputRows(ast, schema, rows);
+}
+
+dberr_t ExecuteEngine::ExecuteStreamAggregate(pSyntaxNode ast, TableInfo *table_info, IndexInfo *index_info,
+                                              const vector<uint32_t> &columns) {
+  Schema *schema = table_info->GetSchema();
+  vector<uint32_t> group_columns, output_columns;
+  vector<Aggregate> aggregates;
+  if(PlanAggregation(ast, schema, group_columns, aggregates, output_columns) != DB_SUCCESS) return DB_FAILED;
+  vector<SortKey> sort_keys;
+  size_t count, offset;
+  if(PlanOrder(ast, schema, &group_columns, sort_keys) != DB_SUCCESS || GetLimit(ast, count, offset) != DB_SUCCESS)
+    return DB_FAILED;
+  StreamAggregate aggregate(schema, group_columns, aggregates);
+  vector<Row> groups;
+  auto emit = [&](const Row &row) { groups.push_back(row); };
+  ScanInIndexOrder(table_info, index_info, columns, SIZE_MAX, [&](const Row &row) { aggregate.Add(row, emit); });
+  aggregate.Finish(emit);
+  vector<unique_ptr<Column>> group_schema_columns;
+  unique_ptr<Schema> group_schema = AggregateSchema(schema, group_columns, aggregates, group_schema_columns);
+  FinishSelect(groups, group_schema.get(), output_columns, sort_keys, count, offset);
+  return DB_SUCCESS;
+}
+
+/**
+ * Append the fields of right to those of left
+ */
+Row ConcatRows(const Row &left, const Row &right) {
+  vector<Field> fields;
+  for(uint32_t i = 0; i < left.GetFieldCount(); i++) fields.emplace_back(*left.GetField(i));
+  for(uint32_t i = 0; i < right.GetFieldCount(); i++) fields.emplace_back(*right.GetField(i));
+  return Row(fields);
+}
+
+/**
+ * Index of a table that an index nested-loop join can probe: its leading key
+ * columns, the more the better, are all among keys. positions[j] is the place
+ * of key column j in keys.
+ */
+IndexInfo *MatchJoinIndex(const vector<IndexInfo *> &index_infos, Schema *schema, const vector<uint32_t> &keys,
+                          vector<uint32_t> &positions) {
+  IndexInfo *best = nullptr;
+  for(auto index_info : index_infos) {
+    IndexSchema *key_schema = index_info->GetIndexKeySchema();
+    vector<uint32_t> matched;
+    for(uint32_t j = 0; j < index_info->GetKeyColumnCount(); j++) {
+      uint32_t column_index;
+      schema->GetColumnIndex(key_schema->GetColumn(j)->GetName(), column_index);
+      auto key = find(keys.begin(), keys.end(), column_index);
+      if(key == keys.end()) break;
+      matched.push_back(key - keys.begin());
+    }
+    if(matched.empty()) continue;
+    if(index_info->GetIndexType() == kIndexHash && matched.size() < index_info->GetKeyColumnCount()) continue;
+    if(matched.size() > positions.size()) {
+      best = index_info;
+      positions = matched;
+    }
+  }
+  return best;
+}
+
+dberr_t ExecuteEngine::ExecuteJoinSelect(pSyntaxNode ast, ExecuteContext *context) {
+  // tables in join order, the ON conditions are AND-ed to the where condition
+  vector<string> table_names;
+  vector<TableInfo *> table_infos;
+  vector<pSyntaxNode> conjuncts;
+  for(auto pos = ast->child_->next_->child_; pos != nullptr; pos = pos->next_) {
+    if(pos->type_ == kNodeConditions) {
+      CollectTerms(pos->child_, "and", conjuncts);
+      continue;
+    }
+    string table_name = pos->val_;
+    TableInfo *table_info;
+    if(dbs_[current_db_]->catalog_mgr_->GetTable(table_name, table_info) != DB_SUCCESS) {
+      *message_ += "Error: Table " + table_name + " does not exist!\n";
+      return DB_FAILED;
+    }
+    if(find(table_names.begin(), table_names.end(), table_name) != table_names.end()) {
+      *message_ += "Error: Table " + table_name + " appears more than once!\n";
+      return DB_FAILED;
+    }
+    table_names.push_back(table_name);
+    table_infos.push_back(table_info);
+  }
+  pSyntaxNode conditions = SelectClause(ast, kNodeConditions);
+  if(conditions != nullptr) CollectTerms(conditions->child_, "and", conjuncts);
+
+  // the joined schema names its columns table.column
+  vector<unique_ptr<Column>> joined_columns;
+  vector<unique_ptr<Schema>> table_schemas;
+  vector<uint32_t> column_offsets;
+  for(size_t i = 0; i < table_infos.size(); i++) {
+    Schema *schema = table_infos[i]->GetSchema();
+    vector<Column *> columns;
+    column_offsets.push_back(joined_columns.size());
+    for(auto column : schema->GetColumns()) {
+      string name = table_names[i] + "." + column->GetName();
+      uint32_t index = joined_columns.size();
+      if(column->GetType() == kTypeChar) {
+        joined_columns.emplace_back(new Column(name, kTypeChar, column->GetLength(), index, column->IsNullable(), false));
+      } else {
+        joined_columns.emplace_back(new Column(name, column->GetType(), index, column->IsNullable(), false));
+      }
+      columns.push_back(joined_columns.back().get());
+    }
+    table_schemas.emplace_back(new Schema(columns));
+  }
+  // schema of the first i + 1 tables joined
+  auto joined_schema = [&](size_t i) {
+    vector<Column *> columns;
+    for(size_t j = 0; j < column_offsets[i] + table_schemas[i]->GetColumnCount(); j++)
+      columns.push_back(joined_columns[j].get());
+    return unique_ptr<Schema>(new Schema(columns));
+  };
+
+  // the table a column belongs to, by its qualifier or by being the only table with it
+  auto table_of = [&](const string &name, size_t &table) {
+    auto dot = name.find('.');
+    bool found = false;
+    for(size_t i = 0; i < table_infos.size(); i++) {
+      if(dot != string::npos && name.substr(0, dot) != table_names[i]) continue;
+      uint32_t column_index;
+      if(table_infos[i]->GetSchema()->GetColumnIndex(UnqualifiedName(name), column_index) != DB_SUCCESS) continue;
+      if(found) {
+        *message_ += "Error: Column " + name + " is ambiguous!\n";
+        return false;
+      }
+      found = true;
+      table = i;
+    }
+    if(!found) *message_ += "Error: Column " + name + " does not exist!\n";
+    return found;
+  };
+  // the last table in join order each term reads, it is checked once that table is joined
+  vector<vector<pSyntaxNode>> pushed_terms(table_infos.size()), join_terms(table_infos.size());
+  for(auto term : conjuncts) {
+    vector<pSyntaxNode> compares;
+    CollectTerms(term, "or", compares);
+    set<size_t> tables;
+    for(auto compare : compares) {
+      if(compare->type_ != kNodeCompareOperator) {
+        *message_ += "Error: Illegal expression!\n";
+        return DB_FAILED;
+      }
+      for(auto operand = compare->child_; operand != nullptr; operand = operand->next_) {
+        size_t table;
+        if(operand->type_ != kNodeIdentifier) continue;
+        if(!table_of(operand->val_, table)) return DB_FAILED;
+        tables.insert(table);
+      }
+    }
+    if(tables.size() == 1) pushed_terms[*tables.begin()].push_back(term);
+    else join_terms[*tables.rbegin()].push_back(term);
+  }
+
+  vector<Row> rows;
+  unique_ptr<Schema> left_schema = joined_schema(0);
+  vector<IndexInfo *> index_infos;
+  dbs_[current_db_]->catalog_mgr_->GetTableIndexes(table_names[0], index_infos);
+  if(GetRows(pushed_terms[0], table_infos[0], index_infos, &rows) != DB_SUCCESS) return DB_FAILED;
+  for(size_t i = 1; i < table_infos.size(); i++) {
+    index_infos.clear();
+    dbs_[current_db_]->catalog_mgr_->GetTableIndexes(table_names[i], index_infos);
+    unique_ptr<Schema> schema = joined_schema(i);
+
+    // equality of a joined column and a column of table i is a join key, the rest is checked on the joined rows
+    vector<uint32_t> left_keys, right_keys;
+    vector<pSyntaxNode> key_terms, residual_terms;
+    for(auto term : join_terms[i]) {
+      auto value = term->type_ == kNodeCompareOperator ? term->child_->next_ : nullptr;
+      uint32_t column, other;
+      if(value != nullptr && value->type_ == kNodeIdentifier && string(term->val_) == "=" &&
+         ResolveColumn(schema.get(), term->child_->val_, column) == DB_SUCCESS &&
+         ResolveColumn(schema.get(), value->val_, other) == DB_SUCCESS &&
+         schema->GetColumn(column)->GetType() == schema->GetColumn(other)->GetType()) {
+        if(column > other) swap(column, other);
+        if(column < column_offsets[i] && other >= column_offsets[i]) {
+          left_keys.push_back(column);
+          right_keys.push_back(other - column_offsets[i]);
+          key_terms.push_back(term);
+          continue;
         }
-        projection_fields.push_back(*row.GetField(column_indexex));
-        pos = pos->next_;
       }
-      projection_rows.push_back(Row(projection_fields));
+      residual_terms.push_back(term);
+    }
+    vector<Row> joined_rows;
+    dberr_t status = DB_SUCCESS;
+    auto emit = [&](const Row &left, const Row &right) {
+      Row row = ConcatRows(left, right);
+      for(auto term : residual_terms)
+        if(!CheckExpression(term, row, schema.get(), status)) return;
+      joined_rows.push_back(row);
+    };
+    // an index on the keys of table i is probed instead of reading the table when that is cheaper
+    vector<uint32_t> key_positions;
+    IndexInfo *join_index = MatchJoinIndex(index_infos, table_infos[i]->GetSchema(), right_keys, key_positions);
+    TableStatistics *statistics = table_infos[i]->GetStatistics();
+    if(join_index != nullptr && statistics != nullptr) {
+      double row_count = statistics->GetRowCount(), pages = statistics->GetPageCount(), matches = rows.size();
+      IndexSchema *key_schema = join_index->GetIndexKeySchema();
+      for(uint32_t j = 0; j < key_positions.size(); j++) {
+        uint32_t distinct = statistics->GetColumn(key_schema->GetColumn(j)->GetTableInd()).distinct_count_;
+        matches *= row_count / max(1u, distinct);
+      }
+      // sorted probes of a tree read each leaf once
+      double probe_cost = join_index->GetIndexType() == kIndexHash
+                          ? rows.size() * IndexProbeCost(join_index, row_count, 0)
+                          : IndexProbeCost(join_index, row_count, 0) + PagesTouched(row_count / INDEX_FANOUT, rows.size());
+      if(probe_cost + SortedFetchCost(pages, matches) >= pages) join_index = nullptr;
+    }
+    vector<Row> right_rows;
+    if(join_index == nullptr && GetRows(pushed_terms[i], table_infos[i], index_infos, &right_rows) != DB_SUCCESS)
+      return DB_FAILED;
+    if(left_keys.empty()) {
+      for(auto &left : rows)
+        for(auto &right : right_rows) emit(left, right);
+    } else if(join_index != nullptr) {
+      // key terms the index does not answer are checked on the joined rows
+      for(uint32_t j = 0; j < key_terms.size(); j++)
+        if(find(key_positions.begin(), key_positions.end(), j) == key_positions.end())
+          residual_terms.push_back(key_terms[j]);
+      for(size_t begin = 0; begin < rows.size(); begin += INDEX_JOIN_BATCH_SIZE) {
+        // outer rows with a null key match nothing
+        vector<size_t> outer;
+        vector<Row> keys;
+        for(size_t k = begin; k < min(rows.size(), begin + INDEX_JOIN_BATCH_SIZE); k++) {
+          vector<Field> fields;
+          for(auto position : key_positions) fields.emplace_back(*rows[k].GetField(left_keys[position]));
+          if(any_of(fields.begin(), fields.end(), [](const Field &field) { return field.IsNull(); })) continue;
+          outer.push_back(k);
+          keys.emplace_back(fields);
+        }
+        vector<vector<RowId>> results;
+        join_index->GetIndex()->ScanKeys(keys, results, nullptr);
+        // the matches of the batch are read in page order
+        RowIdBitmap bitmap;
+        for(auto &result : results)
+          for(auto &row_id : result) bitmap.Add(row_id);
+        vector<Row> inner_rows;
+        table_infos[i]->GetTableHeap()->GetTuples(bitmap.GetRowIds(), inner_rows, nullptr);
+        unordered_map<int64_t, const Row *> inner;
+        for(auto &row : inner_rows) {
+          bool match = true;
+          for(auto term : pushed_terms[i]) match = match && CheckExpression(term, row, table_infos[i], status);
+          if(match) inner[row.GetRowId().Get()] = &row;
+        }
+        for(size_t k = 0; k < outer.size(); k++) {
+          for(auto &row_id : results[k]) {
+            auto it = inner.find(row_id.Get());
+            if(it != inner.end()) emit(rows[outer[k]], *it->second);
+          }
+        }
+      }
+    } else if(rows.size() <= right_rows.size()) {
+      HashJoin join(left_schema.get(), left_keys, table_schemas[i].get(), right_keys);
+      for(auto &left : rows) join.Build(left);
+      for(auto &right : right_rows) join.Probe(right, emit);
+      join.Finish(emit);
+    } else {
+      auto emit_swapped = [&](const Row &right, const Row &left) { emit(left, right); };
+      HashJoin join(table_schemas[i].get(), right_keys, left_schema.get(), left_keys);
+      for(auto &right : right_rows) join.Build(right);
+      for(auto &left : rows) join.Probe(left, emit_swapped);
+      join.Finish(emit_swapped);
+    }
+    if(status != DB_SUCCESS) return status;
+    rows.swap(joined_rows);
+    left_schema = move(schema);
+  }
+  return OutputRows(ast, left_schema.get(), rows);
+}
+
+dberr_t ExecuteEngine::ResolveSelectColumn(Schema *schema, const string &name, uint32_t &column_index) {
+  dberr_t result = ResolveColumn(schema, name, column_index);
+  if(result == DB_COLUMN_NAME_NOT_EXIST) {
+    *message_ += "Error: Column " + name + " does not exist!\n";
+  } else if(result != DB_SUCCESS) {
+    *message_ += "Error: Column " + name + " is ambiguous!\n";
+  }
+  return result;
+}
+
+dberr_t ExecuteEngine::PlanAggregation(pSyntaxNode ast, Schema *schema, vector<uint32_t> &group_columns,
+                                       vector<Aggregate> &aggregates, vector<uint32_t> &columns) {
+  pSyntaxNode group_by = SelectClause(ast, kNodeGroupBy);
+  for(auto pos = group_by == nullptr ? nullptr : group_by->child_; pos != nullptr; pos = pos->next_) {
+    uint32_t column_index;
+    if(ResolveSelectColumn(schema, pos->val_, column_index) != DB_SUCCESS) return DB_FAILED;
+    group_columns.push_back(column_index);
+  }
+  if(ast->child_->type_ == kNodeAllColumns) {
+    *message_ += "Error: Select * with GROUP BY!\n";
+    return DB_FAILED;
+  }
+  // aggregate values follow the group columns in the aggregated rows
+  for(auto pos = ast->child_->child_; pos != nullptr; pos = pos->next_) {
+    uint32_t column_index = Aggregate::ALL_ROWS;
+    if(pos->type_ == kNodeIdentifier) {
+      if(ResolveSelectColumn(schema, pos->val_, column_index) != DB_SUCCESS) return DB_FAILED;
+      auto group = find(group_columns.begin(), group_columns.end(), column_index);
+      if(group == group_columns.end()) {
+        *message_ += "Error: Column " + string(pos->val_) + " must be grouped by or aggregated!\n";
+        return DB_FAILED;
+      }
+      columns.push_back(group - group_columns.begin());
+      continue;
+    }
+    string function = pos->val_;
+    transform(function.begin(), function.end(), function.begin(), ::tolower);
+    Aggregate aggregate;
+    if(function == "count") aggregate.type_ = kAggregateCount;
+    else if(function == "sum") aggregate.type_ = kAggregateSum;
+    else if(function == "avg") aggregate.type_ = kAggregateAvg;
+    else if(function == "min") aggregate.type_ = kAggregateMin;
+    else if(function == "max") aggregate.type_ = kAggregateMax;
+    else {
+      *message_ += "Error: Unknown aggregate function " + function + "!\n";
+      return DB_FAILED;
+    }
+    if(pos->child_->type_ == kNodeAllColumns) {
+      if(aggregate.type_ != kAggregateCount) {
+        *message_ += "Error: Aggregate function " + function + " needs a column!\n";
+        return DB_FAILED;
+      }
+    } else {
+      if(ResolveSelectColumn(schema, pos->child_->val_, column_index) != DB_SUCCESS) return DB_FAILED;
+      if((aggregate.type_ == kAggregateSum || aggregate.type_ == kAggregateAvg) &&
+         schema->GetColumn(column_index)->GetType() == kTypeChar) {
+        *message_ += "Error: Aggregate function " + function + " needs a numeric column!\n";
+        return DB_FAILED;
+      }
+    }
+    aggregate.column_ = column_index;
+    columns.push_back(group_columns.size() + aggregates.size());
+    aggregates.push_back(aggregate);
+  }
+  return DB_SUCCESS;
+}
+
+dberr_t ExecuteEngine::PlanOrder(pSyntaxNode ast, Schema *schema, const vector<uint32_t> *group_columns,
+                                 vector<SortKey> &sort_keys) {
+  pSyntaxNode order_by = SelectClause(ast, kNodeOrderBy);
+  for(auto pos = order_by == nullptr ? nullptr : order_by->child_; pos != nullptr; pos = pos->next_) {
+    string column_name = pos->child_->val_;
+    SortKey sort_key;
+    if(ResolveSelectColumn(schema, column_name, sort_key.column_) != DB_SUCCESS) return DB_FAILED;
+    if(group_columns != nullptr) {
+      // aggregated rows start with the group columns
+      auto group = find(group_columns->begin(), group_columns->end(), sort_key.column_);
+      if(group == group_columns->end()) {
+        *message_ += "Error: Column " + column_name + " must be grouped by to order by it!\n";
+        return DB_FAILED;
+      }
+      sort_key.column_ = group - group_columns->begin();
     }
+    sort_key.descending_ = string(pos->val_) == "desc";
+    sort_keys.push_back(sort_key);
+  }
+  return DB_SUCCESS;
+}
+
+dberr_t ExecuteEngine::GetLimit(pSyntaxNode ast, size_t &count, size_t &offset) {
+  count = SIZE_MAX;
+  offset = 0;
+  pSyntaxNode limit = SelectClause(ast, kNodeLimit);
+  if(limit == nullptr) return DB_SUCCESS;
+  for(auto pos = limit->child_; pos != nullptr; pos = pos->next_) {
+    if(strspn(pos->val_, "0123456789") != strlen(pos->val_)) {
+      *message_ += "Error: Illegal limit " + string(pos->val_) + "!\n";
+      return DB_FAILED;
+    }
+  }
+  count = strtoull(limit->child_->val_, nullptr, 10);
+  if(limit->child_->next_ != nullptr) offset = strtoull(limit->child_->next_->val_, nullptr, 10);
+  return DB_SUCCESS;
+}
+
+dberr_t ExecuteEngine::OutputRows(pSyntaxNode ast, Schema *schema, vector<Row> &rows, bool ordered) {
+  vector<uint32_t> columns;
+  vector<SortKey> sort_keys;
+  size_t count, offset;
+  if(GetLimit(ast, count, offset) != DB_SUCCESS) return DB_FAILED;
+  if(IsAggregation(ast)) {
+    vector<uint32_t> group_columns;
+    vector<Aggregate> aggregates;
+    if(PlanAggregation(ast, schema, group_columns, aggregates, columns) != DB_SUCCESS ||
+       PlanOrder(ast, schema, &group_columns, sort_keys) != DB_SUCCESS) {
+      return DB_FAILED;
+    }
+    HashAggregate aggregate(schema, group_columns, aggregates);
+    for(auto &row : rows) aggregate.Add(row);
+    vector<Row> groups;
+    aggregate.Finish([&](const Row &row) { groups.push_back(row); });
+    vector<unique_ptr<Column>> group_schema_columns;
+    unique_ptr<Schema> group_schema = AggregateSchema(schema, group_columns, aggregates, group_schema_columns);
+    FinishSelect(groups, group_schema.get(), columns, sort_keys, count, offset);
+    return DB_SUCCESS;
+  }
+  if(ast->child_->type_ == kNodeAllColumns) {
+    for(uint32_t i = 0; i < schema->GetColumnCount(); i++) columns.push_back(i);
+  } else {
+    for(auto pos = ast->child_->child_; pos != nullptr; pos = pos->next_) {
+      uint32_t column_index;
+      if(ResolveSelectColumn(schema, pos->val_, column_index) != DB_SUCCESS) return DB_FAILED;
+      columns.push_back(column_index);
+    }
+  }
+  if(PlanOrder(ast, schema, nullptr, sort_keys) != DB_SUCCESS) return DB_FAILED;
+  if(ordered) sort_keys.clear();
+  FinishSelect(rows, schema, columns, sort_keys, count, offset);
+  return DB_SUCCESS;
+}
+
+void ExecuteEngine::FinishSelect(vector<Row> &rows, Schema *schema, const vector<uint32_t> &columns,
+                                 const vector<SortKey> &sort_keys, size_t count, size_t offset) {
+  if(result_ != nullptr) result_->SetColumns(schema, columns);
+  size_t end = count == SIZE_MAX ? SIZE_MAX : count + offset;
+  if(sort_keys.empty()) {
+    PrintRows(rows, columns, offset, end);
+    return;
+  }
+  // only the rows up to the end of the limit are kept sorted
+  ExternalSort sort(schema, sort_keys, end);
+  for(auto &row : rows) sort.Add(row);
+  vector<Row> sorted;
+  sort.Finish([&](const Row &row) { sorted.push_back(row); });
+  PrintRows(sorted, columns, offset, end);
+}
+
+void ExecuteEngine::PrintRows(const vector<Row> &rows, const vector<uint32_t> &columns, size_t begin, size_t end) {
+  size_t printed = 0;
+  if(result_ != nullptr) {
+    for(size_t r = begin; r < rows.size() && r < end; r++, printed++) result_->AddRow(rows[r], columns);
+    *message_ += "select " + to_string(printed) + " tuples.\n";
+    return;
   }
   *message_ += "Tuple: \n";
-  for(auto it: projection_rows) {
-    vector<Field *> fields = it.GetFields();
-    for(int i = 0; i < (int)it.GetFieldCount(); ++i) {
-      *message_ += (i == 0?"(":", ") + fields[i]->GetString();
+  for(size_t r = begin; r < rows.size() && r < end; r++, printed++) {
+    for(size_t i = 0; i < columns.size(); ++i) {
+      *message_ += (i == 0?"(":", ") + rows[r].GetField(columns[i])->GetString();
     }
     *message_ += ")\n";
   }
-  *message_ += "select " + to_string(projection_rows.size()) + " tuples.\n";
-  return DB_SUCCESS;
+  *message_ += "select " + to_string(printed) + " tuples.\n";
 }
 
 dberr_t ExecuteEngine::ExecuteInsert(pSyntaxNode ast, ExecuteContext *context) {
@@ -405,52 +1376,63 @@ dberr_t ExecuteEngine::ExecuteInsert(pSyntaxNode ast, ExecuteContext *context) {
     return DB_FAILED;
   }
   Schema *schema = table_info->GetSchema();
-  auto pos = ast->child_->next_->child_;
-  vector<Field> fields;
-
-  uint32_t cnt = 0;
-  while(pos != nullptr) {
-    fields.push_back(GetField(schema->GetColumn(cnt)->GetType(), pos->val_));
-    pos = pos->next_;
-    cnt++;
-  }
-  // signal(3);
-  if(cnt != schema->GetColumnCount()) {
-    *message_ += "Error: Invaild tuple!\n";
-    return DB_FAILED;
+  vector<Row> rows;
+  for(auto tuple = ast->child_->next_; tuple != nullptr; tuple = tuple->next_) {
+    vector<Field> fields;
+    uint32_t cnt = 0;
+    for(auto pos = tuple->child_; pos != nullptr; pos = pos->next_, cnt++) {
+      if(cnt < schema->GetColumnCount()) fields.push_back(GetField(schema->GetColumn(cnt)->GetType(), pos->val_));
+    }
+    if(cnt != schema->GetColumnCount()) {
+      *message_ += "Error: Invaild tuple!\n";
+      return DB_FAILED;
+    }
+    rows.emplace_back(fields);
   }
-  Row row(fields);
 
   vector<IndexInfo *> index_infos;
   dbs_[current_db_]->catalog_mgr_->GetTableIndexes(table_name, index_infos);
-
-  for(auto it: index_infos) {
-    vector<Field> keys;
-    for(uint32_t i = 0; i < it->GetIndexKeySchema()->GetColumnCount(); i++) {
-      keys.push_back(*row.GetField(it->GetIndexKeySchema()->GetColumn(i)->GetTableInd()));
+  if(rows.size() > 1) {
+    // several tuples fill the heap pages in one pass and reach each index sorted
+    if(!table_info->GetTableHeap()->InsertTuples(rows, context->txn_)) {
+      *message_ += "Error: insert the tuple failed!\n";
+      return DB_FAILED;
     }
-    vector<RowId> temp;
-    if(it->GetIndex()->ScanKey(Row(keys), temp, nullptr) != DB_KEY_NOT_FOUND) {
+    vector<RowId> row_ids;
+    vector<vector<Row>> keys(index_infos.size());
+    for(auto &row : rows) {
+      row_ids.push_back(row.GetRowId());
+      for(size_t i = 0; i < index_infos.size(); i++) keys[i].push_back(IndexKey(row, index_infos[i]));
+    }
+    return InsertIndexEntries(table_info, index_infos, keys, row_ids, context->txn_);
+  }
+  Row &row = rows[0];
+
+  // claim the keys before the heap insert, each index is searched once
+  vector<Row> keys;
+  vector<IndexReservation> reservations(index_infos.size());
+  auto cancel = [&](size_t begin, size_t end) {
+    for(size_t i = begin; i < end; i++) index_infos[i]->GetIndex()->CancelEntry(keys[i], reservations[i], context->txn_);
+  };
+  for(size_t i = 0; i < index_infos.size(); i++) {
+    keys.push_back(IndexKey(row, index_infos[i]));
+    if(index_infos[i]->GetIndex()->ReserveEntry(keys[i], reservations[i], context->txn_) != DB_SUCCESS) {
+      cancel(0, i);
       *message_ += "Error: duplicate tuples!\n";
       return DB_FAILED;
     }
   }
-  // signal(4);
-  if(!table_info->GetTableHeap()->InsertTuple(row, nullptr)) {
+  if(!table_info->GetTableHeap()->InsertTuple(row, context->txn_)) {
+    cancel(0, index_infos.size());
     *message_ += "Error: insert the tuple failed!\n";
     return DB_FAILED;
   }
-  // signal(6);
-  index_infos.clear();
-  dbs_[current_db_]->catalog_mgr_->GetTableIndexes(table_name, index_infos);
-  for(auto it: index_infos) {
-    vector<Field> keys;
-    for(uint32_t i = 0; i < it->GetIndexKeySchema()->GetColumnCount(); i++) {
-      keys.push_back(*row.GetField(it->GetIndexKeySchema()->GetColumn(i)->GetTableInd()));
-    }
-    Row key(keys);
-    key.SetRowId(row.GetRowId());
-    if(it->GetIndex()->InsertEntry(key, key.GetRowId(), nullptr) != DB_SUCCESS) {
+  for(size_t i = 0; i < index_infos.size(); i++) {
+    if(index_infos[i]->GetIndex()->CompleteEntry(keys[i], row.GetRowId(), reservations[i], context->txn_) != DB_SUCCESS) {
+      // the row leaves the heap and the indexes it already reached
+      for(size_t j = 0; j < i; j++) index_infos[j]->GetIndex()->RemoveEntry(keys[j], row.GetRowId(), context->txn_);
+      cancel(i, index_infos.size());
+      table_info->GetTableHeap()->ApplyDelete(row.GetRowId(), context->txn_);
       *message_ += "Error: Insert index failed!\n";
       return DB_FAILED;
     }
@@ -480,23 +1462,35 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext *context) {
     return DB_FAILED;
   }
 
-  for(auto &row : rows) {
-    if(!table_info->GetTableHeap()->MarkDelete(row.GetRowId(), nullptr)) {
-      *message_ += "Error: delete tuple failed!\n";
-      return DB_FAILED;
+  // the heap is deleted page by page and every index in key order
+  vector<RowId> row_ids, deleted_row_ids;
+  row_ids.reserve(rows.size());
+  for(auto &row : rows) row_ids.push_back(row.GetRowId());
+  bool deleted = table_info->GetTableHeap()->DeleteTuples(row_ids, context->txn_, &deleted_row_ids);
+  // the tuples deleted before a failure still lose their entries
+  if(!deleted) {
+    RowIdBitmap deleted_set;
+    for(auto &row_id : deleted_row_ids) deleted_set.Add(row_id);
+    vector<Row> deleted_rows;
+    for(auto &row : rows) {
+      if(deleted_set.Contains(row.GetRowId())) deleted_rows.push_back(row);
     }
-    for(auto it: index_infos) {
-      vector<Field> keys;
-      for(uint32_t i = 0; i < it->GetIndexKeySchema()->GetColumnCount(); i++) {
-        keys.push_back(*row.GetField(it->GetIndexKeySchema()->GetColumn(i)->GetTableInd()));
-      }
-      Row key(keys);
-      if(it->GetIndex()->RemoveEntry(key, key.GetRowId(), nullptr) != DB_SUCCESS) {
-        *message_ += "Error: Remove index key failed!\n";
-        return DB_FAILED;
-      }
+    rows.swap(deleted_rows);
+    row_ids.clear();
+    for(auto &row : rows) row_ids.push_back(row.GetRowId());
+  }
+  for(auto index_info : index_infos) {
+    vector<Row> keys;
+    keys.reserve(rows.size());
+    for(auto &row : rows) keys.push_back(IndexKey(row, index_info));
+    if(index_info->GetIndex()->RemoveEntries(keys, row_ids, context->txn_) != DB_SUCCESS) {
+      *message_ += "Error: Remove index key failed!\n";
+      return DB_FAILED;
     }
-    table_info->GetTableHeap()->ApplyDelete(row.GetRowId(), nullptr);
+  }
+  if(!deleted) {
+    *message_ += "Error: delete tuple failed!\n";
+    return DB_FAILED;
   }
   *message_ += "delete " + to_string(rows.size()) + " tuples\n";
   return DB_SUCCESS;
@@ -551,42 +1545,112 @@ dberr_t ExecuteEngine::ExecuteUpdate(pSyntaxNode ast, ExecuteContext *context) {
     upd_row.SetRowId(row.GetRowId());
     upd_rows.emplace_back(upd_row);
   }
+  // a row too large for a page is the one way a heap update fails, so every
+  // row is checked before the first one changes
+  for(auto &upd_row : upd_rows) {
+    if(upd_row.GetSerializedSize(schema) > TablePage::SIZE_MAX_ROW) {
+      *message_ += "Error: update the tuple failed!\n";
+      return DB_FAILED;
+    }
+  }
 
-  dbs_[current_db_]->catalog_mgr_->GetTableIndexes(table_name, index_infos);
-  for(auto upd_row : upd_rows) {
-    for(auto index_info: index_infos) {
-      vector<Field> key_fields;
-      for(uint32_t i = 0; i < index_info->GetIndexKeySchema()->GetColumnCount(); i++) {
-        key_fields.push_back(*upd_row.GetField(index_info->GetIndexKeySchema()->GetColumn(i)->GetTableInd()));
-      }
-      Row key(key_fields);
-      vector<RowId> row_ids;
-      if(index_info->GetIndex()->ScanKey(key, row_ids, nullptr) == DB_SUCCESS) {
-        if(row_ids[0] == upd_row.GetRowId()) continue;
+  // only indexes storing a set column need work: those whose key columns are
+  // set may take new keys, the others only rewrite their stored columns
+  vector<IndexInfo *> key_indexes, stored_indexes;
+  for(auto index_info : index_infos) {
+    IndexSchema *key_schema = index_info->GetIndexKeySchema();
+    bool key_set = false, stored_set = false;
+    for(uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+      if(val[key_schema->GetColumn(i)->GetTableInd()] == nullptr) continue;
+      (i < index_info->GetKeyColumnCount() ? key_set : stored_set) = true;
+    }
+    if(key_set) key_indexes.push_back(index_info);
+    else if(stored_set) stored_indexes.push_back(index_info);
+  }
+
+  // the new keys of all rows are claimed before any row changes, so a conflict
+  // leaves the table as it was; entries keeping their key are only rewritten
+  struct KeyChange {
+    size_t row_;
+    IndexInfo *index_info_;
+    Row old_key_, new_key_;
+    bool reserved_;
+    IndexReservation reservation_;
+  };
+  vector<KeyChange> changes;
+  auto cancel = [&](size_t begin) {
+    for(size_t i = begin; i < changes.size(); i++) {
+      if(!changes[i].reserved_) continue;
+      changes[i].index_info_->GetIndex()->CancelEntry(changes[i].new_key_, changes[i].reservation_, context->txn_);
+    }
+  };
+  for(size_t i = 0; i < upd_rows.size(); i++) {
+    for(auto index_info : key_indexes) {
+      Row old_key = IndexKey(rows[i], index_info), new_key = IndexKey(upd_rows[i], index_info);
+      if(SameKey(old_key, new_key, old_key.GetFieldCount())) continue;
+      bool reserved = !SameKey(old_key, new_key, index_info->GetKeyColumnCount());
+      changes.push_back({i, index_info, old_key, new_key, reserved, IndexReservation()});
+      if(reserved && index_info->GetIndex()->ReserveEntry(new_key, changes.back().reservation_,
+                                                          context->txn_) != DB_SUCCESS) {
+        changes.pop_back();
+        cancel(0);
         *message_ += "Error: Updating cause duplicate tuples!\n";
         return DB_FAILED;
       }
     }
+    for(auto index_info : stored_indexes) {
+      Row old_key = IndexKey(rows[i], index_info), new_key = IndexKey(upd_rows[i], index_info);
+      if(!SameKey(old_key, new_key, old_key.GetFieldCount())) {
+        changes.push_back({i, index_info, old_key, new_key, false, IndexReservation()});
+      }
+    }
   }
+  // a failure puts back the first row_count rows and the entries of the first
+  // change_count changes, plus the old entry of the next change if it is gone
+  auto rollback = [&](uint32_t row_count, size_t change_count, bool old_removed) {
+    for(size_t i = 0; i < change_count; i++) {
+      Index *index = changes[i].index_info_->GetIndex();
+      index->RemoveEntry(changes[i].new_key_, rows[changes[i].row_].GetRowId(), context->txn_);
+    }
+    for(size_t i = 0; i < change_count + (old_removed ? 1 : 0); i++) {
+      Index *index = changes[i].index_info_->GetIndex();
+      index->InsertEntry(changes[i].old_key_, rows[changes[i].row_].GetRowId(), context->txn_);
+    }
+    cancel(change_count);
+    for(uint32_t i = 0; i < row_count; i++) {
+      Row old_row(rows[i]);
+      table_info->GetTableHeap()->UpdateTuple(old_row, rows[i].GetRowId(), context->txn_);
+    }
+  };
+  size_t change = 0;
   for(uint32_t i = 0; i < upd_rows.size(); i++) {
-    Row upd_row = upd_rows[i];
-    Row old_row = rows[i];
-    table_info->GetTableHeap()->UpdateTuple(upd_row, old_row.GetRowId(), nullptr);
-    for(auto index_info: index_infos) {
-      vector<Field> old_key_fields;
-      for (uint32_t i = 0; i < index_info->GetIndexKeySchema()->GetColumnCount(); i++) {
-        old_key_fields.push_back(*old_row.GetField(index_info->GetIndexKeySchema()->GetColumn(i)->GetTableInd()));
-      }
-      Row old_key(old_key_fields);
-      old_key.SetRowId(old_row.GetRowId());
-      index_info->GetIndex()->RemoveEntry(old_key, old_key.GetRowId(), nullptr);
-      vector<Field> new_key_fields;
-      for (uint32_t i = 0; i < index_info->GetIndexKeySchema()->GetColumnCount(); i++) {
-        new_key_fields.push_back(*upd_row.GetField(index_info->GetIndexKeySchema()->GetColumn(i)->GetTableInd()));
-      }
-      Row new_key(new_key_fields);
-      new_key.SetRowId(upd_row.GetRowId());
-      index_info->GetIndex()->InsertEntry(new_key, new_key.GetRowId(), nullptr);
+    Row &upd_row = upd_rows[i];
+    Row &old_row = rows[i];
+    if(!table_info->GetTableHeap()->UpdateTuple(upd_row, old_row.GetRowId(), context->txn_)) {
+      rollback(i, change, false);
+      *message_ += "Error: update the tuple failed!\n";
+      return DB_FAILED;
+    }
+    // the tuple keeps its RowId, only entries whose key changed are touched
+    for(; change < changes.size() && changes[change].row_ == i; change++) {
+      KeyChange &key_change = changes[change];
+      Index *index = key_change.index_info_->GetIndex();
+      if(index->RemoveEntry(key_change.old_key_, old_row.GetRowId(), context->txn_) != DB_SUCCESS) {
+        rollback(i + 1, change, false);
+        *message_ += "Error: Update index failed!\n";
+        return DB_FAILED;
+      }
+      dberr_t status;
+      if(key_change.reserved_) {
+        status = index->CompleteEntry(key_change.new_key_, upd_row.GetRowId(), key_change.reservation_, context->txn_);
+      } else {
+        status = index->InsertEntry(key_change.new_key_, upd_row.GetRowId(), context->txn_);
+      }
+      if(status != DB_SUCCESS) {
+        rollback(i + 1, change, true);
+        *message_ += "Error: Updating cause duplicate tuples!\n";
+        return DB_FAILED;
+      }
     }
   }
   *message_ += "update " + to_string(upd_rows.size()) + " tuples.\n";
@@ -624,59 +1688,28 @@ dberr_t ExecuteEngine::ExecuteExecfile(pSyntaxNode ast, ExecuteContext *context)
     *message_ += "Error: Open file failed!\n";
     return DB_FAILED;
   }
-  const int buf_size = 1024;
-  char cmd[buf_size];
+  string cmd;
   int cmd_cnt = 0;
   double tot_time = 0;
   while(true) {
-    memset(cmd, 0, buf_size);
+    cmd.clear();
     bool end = false;
     char ch;
-    int i = 0;
     while(true) {
       if(!file_io_.get(ch)) {
         end = true;
         break;
       }
-      cmd[i++] = ch;
+      cmd.push_back(ch);
       if(ch == ';') break;
     }
     if(end) break;
     file_io_.get();
 
-    YY_BUFFER_STATE bp = yy_scan_string(cmd);
-    if (bp == nullptr) {
-      LOG(ERROR) << "Failed to create yy buffer state." << std::endl;
-      exit(1);
-    }
-    yy_switch_to_buffer(bp);
-
-    // init parser module
-    MinisqlParserInit();
-
-    // parse
-    yyparse();
-
-    // parse result handle
-    if (MinisqlParserGetError()) {
-      // error
-      printf("%s\n", MinisqlParserGetErrorMessage());
-    } else {
-#ifdef ENABLE_PARSER_DEBUG
-      printf("[INFO] Sql syntax parse ok!\n");
-      SyntaxTreePrinter printer(MinisqlGetParserRootNode());
-      primarynter.PrintTree(syntax_tree_file_mgr[0]);
-#endif
-    }
-
     clock_t start = clock();
-    dberr_t status = Execute(MinisqlGetParserRootNode(), context);
+    dberr_t status = ExecuteSql(cmd.c_str(), context);
     clock_t stop = clock();
 
-    MinisqlParserFinish();
-    yy_delete_buffer(bp);
-    yylex_destroy();
-
     if(status != DB_SUCCESS) {
       file_io_.close();
       return DB_FAILED;
@@ -703,58 +1736,394 @@ dberr_t ExecuteEngine::ExecuteQuit(pSyntaxNode ast, ExecuteContext *context) {
   context->flag_quit_ = true;
   return DB_SUCCESS;
 }
-dberr_t ExecuteEngine::GetRows(const pSyntaxNode ast, TableInfo *table_info,vector<IndexInfo *> index_infos, vector<Row> *rows) {
+dberr_t ExecuteEngine::ExecuteAnalyze(pSyntaxNode ast, ExecuteContext *context) {
+#ifdef ENABLE_EXECUTE_DEBUG
+  LOG(INFO) << "ExecuteAnalyze" << std::endl;
+#endif
+  if(current_db_ == "") {
+    *message_ += "Error: No database being used!\n";
+    return DB_FAILED;
+  }
+  auto catalog = dbs_[current_db_]->catalog_mgr_;
+  vector<TableInfo *> tables;
+  if(ast->child_ != nullptr) {
+    string table_name = ast->child_->val_;
+    TableInfo *table_info;
+    if(catalog->GetTable(table_name, table_info) == DB_TABLE_NOT_EXIST) {
+      *message_ += "Error: Table " + table_name + " does not exist!\n";
+      return DB_FAILED;
+    }
+    tables.push_back(table_info);
+  } else {
+    catalog->GetTables(tables);
+  }
+  for(auto table_info : tables) {
+    if(catalog->AnalyzeTable(table_info->GetTableName(), context->txn_) != DB_SUCCESS) {
+      *message_ += "Error: Failed to analyze table " + table_info->GetTableName() + "!\n";
+      return DB_FAILED;
+    }
+    TableStatistics *statistics = table_info->GetStatistics();
+    *message_ += "Table " + table_info->GetTableName() + ": " + to_string(statistics->GetRowCount()) + " rows in " +
+                 to_string(statistics->GetPageCount()) + " pages.\n";
+  }
+  return DB_SUCCESS;
+}
+
+dberr_t ExecuteEngine::ExecuteVacuum(pSyntaxNode ast, ExecuteContext *context) {
+#ifdef ENABLE_EXECUTE_DEBUG
+  LOG(INFO) << "ExecuteVacuum" << std::endl;
+#endif
+  if(current_db_ == "") {
+    *message_ += "Error: No database being used!\n";
+    return DB_FAILED;
+  }
+  auto catalog = dbs_[current_db_]->catalog_mgr_;
+  vector<TableInfo *> tables;
+  if(ast->child_ != nullptr) {
+    string table_name = ast->child_->val_;
+    TableInfo *table_info;
+    if(catalog->GetTable(table_name, table_info) == DB_TABLE_NOT_EXIST) {
+      *message_ += "Error: Table " + table_name + " does not exist!\n";
+      return DB_FAILED;
+    }
+    tables.push_back(table_info);
+  } else {
+    catalog->GetTables(tables);
+  }
+  for(auto table_info : tables) {
+    vector<Row> rows;
+    vector<RowId> old_row_ids;
+    uint32_t freed = table_info->GetTableHeap()->Vacuum(rows, old_row_ids, context->txn_);
+    // the entries of moved tuples are repointed, their keys stay the same
+    vector<RowId> row_ids;
+    row_ids.reserve(rows.size());
+    for(auto &row : rows) row_ids.push_back(row.GetRowId());
+    vector<IndexInfo *> index_infos;
+    catalog->GetTableIndexes(table_info->GetTableName(), index_infos);
+    for(auto index_info : index_infos) {
+      vector<Row> keys;
+      keys.reserve(rows.size());
+      for(auto &row : rows) keys.push_back(IndexKey(row, index_info));
+      if(index_info->GetIndex()->RepointEntries(keys, old_row_ids, row_ids, context->txn_) != DB_SUCCESS) {
+        *message_ += "Error: Failed to vacuum index " + index_info->GetIndexName() + "!\n";
+        return DB_FAILED;
+      }
+    }
+    *message_ += "Table " + table_info->GetTableName() + ": " + to_string(rows.size()) + " tuples moved, " +
+                 to_string(freed) + " pages freed.\n";
+  }
+  return DB_SUCCESS;
+}
+
+dberr_t ExecuteEngine::ExecuteCopy(pSyntaxNode ast, ExecuteContext *context) {
+#ifdef ENABLE_EXECUTE_DEBUG
+  LOG(INFO) << "ExecuteCopy" << std::endl;
+#endif
+  if(current_db_ == "") {
+    *message_ += "Error: No database being used!\n";
+    return DB_FAILED;
+  }
+  string table_name = ast->child_->val_, file_name = ast->child_->next_->val_;
+  TableInfo *table_info;
+  if(dbs_[current_db_]->catalog_mgr_->GetTable(table_name, table_info) != DB_SUCCESS) {
+    *message_ += "Error: Table " + table_name + " does not exist!\n";
+    return DB_FAILED;
+  }
+  auto reader = CsvReader::Open(file_name);
+  if(reader == nullptr) {
+    *message_ += "Error: Open file failed!\n";
+    return DB_FAILED;
+  }
+  Schema *schema = table_info->GetSchema();
   TableHeap *table_heap = table_info->GetTableHeap();
-  if(ast == nullptr) {
+  vector<IndexInfo *> index_infos;
+  dbs_[current_db_]->catalog_mgr_->GetTableIndexes(table_name, index_infos);
+
+  // rows go to the heap in batches, index entries are only collected
+  vector<RowId> row_ids;
+  vector<vector<Row>> keys(index_infos.size());
+  vector<Row> batch;
+  auto flush = [&]() {
+    if(!table_heap->InsertTuples(batch, context->txn_)) {
+      *message_ += "Error: insert the tuple failed!\n";
+      return false;
+    }
+    for(auto &row : batch) {
+      row_ids.push_back(row.GetRowId());
+      for(size_t i = 0; i < index_infos.size(); i++) keys[i].push_back(IndexKey(row, index_infos[i]));
+    }
+    batch.clear();
+    return true;
+  };
+  dberr_t status = DB_SUCCESS;
+  vector<string> values;
+  vector<bool> nulls;
+  while(status == DB_SUCCESS && reader->ReadRecord(values, nulls)) {
+    if(values.size() != schema->GetColumnCount()) {
+      *message_ += "Error: Line " + to_string(reader->GetLineNumber()) + " of " + file_name + " has " +
+                   to_string(values.size()) + " values instead of " + to_string(schema->GetColumnCount()) + "!\n";
+      status = DB_FAILED;
+      break;
+    }
+    vector<Field> fields;
+    for(uint32_t i = 0; i < values.size(); i++) {
+      TypeId type = schema->GetColumn(i)->GetType();
+      fields.push_back(nulls[i] ? Field(type) : GetField(type, &values[i][0]));
+    }
+    batch.emplace_back(fields);
+    if(batch.size() >= COPY_BATCH_SIZE && !flush()) status = DB_FAILED;
+  }
+  if(status == DB_SUCCESS && !flush()) status = DB_FAILED;
+
+  // batches already flushed leave the heap page by page
+  if(status != DB_SUCCESS) {
+    table_heap->DeleteTuples(row_ids, context->txn_);
+    return DB_FAILED;
+  }
+  if(InsertIndexEntries(table_info, index_infos, keys, row_ids, context->txn_) != DB_SUCCESS) {
+    return DB_FAILED;
+  }
+  *message_ += "copy " + to_string(row_ids.size()) + " tuples.\n";
+  return DB_SUCCESS;
+}
+
+dberr_t ExecuteEngine::InsertIndexEntries(TableInfo *table_info, const vector<IndexInfo *> &index_infos,
+                                          const vector<vector<Row>> &keys, const vector<RowId> &row_ids,
+                                          Transaction *txn) {
+  // each index is built from its sorted keys, which also finds duplicates
+  for(size_t i = 0; i < index_infos.size(); i++) {
+    dberr_t status = index_infos[i]->GetIndex()->InsertEntries(keys[i], row_ids, txn);
+    if(status == DB_SUCCESS) continue;
+    *message_ += status == DB_KEY_ALREADY_EXIST ? "Error: duplicate tuples!\n" : "Error: Insert index failed!\n";
+    // the batch leaves the indexes it already reached and the heap
+    while(i-- > 0) index_infos[i]->GetIndex()->RemoveEntries(keys[i], row_ids, txn);
+    table_info->GetTableHeap()->DeleteTuples(row_ids, txn);
+    return DB_FAILED;
+  }
+  return DB_SUCCESS;
+}
+
+dberr_t ExecuteEngine::GetRows(const pSyntaxNode ast, TableInfo *table_info,vector<IndexInfo *> index_infos, vector<Row> *rows,
+                               const vector<uint32_t> *columns) {
+  vector<pSyntaxNode> conjuncts;
+  if(ast != nullptr) CollectTerms(ast->child_, "and", conjuncts);
+  return GetRows(conjuncts, table_info, index_infos, rows, columns);
+}
+
+dberr_t ExecuteEngine::GetRows(const vector<pSyntaxNode> &conjuncts, TableInfo *table_info,
+                               vector<IndexInfo *> index_infos, vector<Row> *rows, const vector<uint32_t> *columns) {
+  TableHeap *table_heap = table_info->GetTableHeap();
+  if(conjuncts.empty()) {
     for(auto it = table_heap->Begin(); it != table_heap->End(); ++it) 
       rows->emplace_back(*it);
     return DB_SUCCESS;
   }
-  if(ast->child_->type_ == kNodeCompareOperator) {
-    string column_name = ast->child_->child_->val_, comparator = ast->child_->val_;
-    uint32_t column_index;
-    if(table_info->GetSchema()->GetColumnIndex(column_name, column_index) == DB_COLUMN_NAME_NOT_EXIST) {
-      *message_ += "Error: Column " + column_name + " does not exist!\n";
-      return DB_FAILED;
+  Schema *schema = table_info->GetSchema();
+  for(auto term : conjuncts) {
+    if(term->type_ != kNodeCompareOperator) continue;
+    for(auto operand = term->child_; operand != nullptr; operand = operand->next_) {
+      if(operand->type_ != kNodeIdentifier) continue;
+      uint32_t column_index;
+      if(ResolveColumn(schema, operand->val_, column_index) != DB_SUCCESS) {
+        *message_ += "Error: Column " + string(operand->val_) + " does not exist!\n";
+        return DB_FAILED;
+      }
     }
-    for(auto index_info : index_infos) {
-      if(index_info->GetIndexKeySchema()->GetColumnCount() == 1 && index_info->GetIndexKeySchema()->GetColumn(0)->GetName() == column_name && comparator == "=") {
-        vector<Field> fields;
-        fields.push_back(GetField(index_info->GetIndexKeySchema()->GetColumn(0)->GetType(), ast->child_->child_->next_->val_));
-        Row key(fields);
-        vector<RowId> row_ids;
-        index_info->GetIndex()->ScanKey(key, row_ids, nullptr);
-        for(auto it: row_ids) {
-          Row row(it);
-          table_heap->GetTuple(&row, nullptr);
-          rows->push_back(row);
+  }
+  // Without statistics prefer the index matching most terms, then one storing
+  // every column read so it answers alone, then a hash index, which needs
+  // fewer page reads for an equality lookup. With statistics take the index
+  // whose probe and heap reads cost least.
+  TableStatistics *statistics = table_info->GetStatistics();
+  uint32_t row_count = statistics == nullptr ? 0 : statistics->GetRowCount();
+  double page_count = statistics == nullptr ? 0 : max(1u, statistics->GetPageCount());
+  IndexMatch best;
+  bool index_only = false;
+  double best_cost = 0, best_rows = 0;
+  for(auto candidate : index_infos) {
+    IndexMatch match = MatchIndex(candidate, conjuncts);
+    if(match.index_info_ == nullptr) continue;
+    IndexSchema *key_schema = candidate->GetIndexKeySchema();
+    auto stores = [&](const string &column_name) {
+      for(auto column : key_schema->GetColumns()) {
+        if(column->GetName() == column_name) return true;
+      }
+      return false;
+    };
+    bool covering = columns != nullptr && candidate->GetIndexType() == kIndexBPlusTree;
+    for(uint32_t i = 0; covering && i < columns->size(); i++) {
+      covering = stores(schema->GetColumn((*columns)[i])->GetName());
+    }
+    for(auto term : conjuncts) {
+      if(covering) covering = term->type_ == kNodeCompareOperator && stores(UnqualifiedName(term->child_->val_)) &&
+                              (term->child_->next_->type_ != kNodeIdentifier ||
+                               stores(UnqualifiedName(term->child_->next_->val_)));
+    }
+    if(statistics != nullptr) {
+      double rows = row_count * EstimateSelectivity(match, statistics);
+      double cost = IndexProbeCost(candidate, row_count, rows);
+      if(!covering) cost += min(rows, SortedFetchCost(page_count, rows));
+      if(best.index_info_ == nullptr || cost < best_cost) {
+        best = match;
+        index_only = covering;
+        best_cost = cost;
+        best_rows = rows;
+      }
+      continue;
+    }
+    if(best.index_info_ == nullptr || match.Size() > best.Size() ||
+       (match.Size() == best.Size() && !index_only && (covering || candidate->GetIndexType() == kIndexHash))) {
+      best = match;
+      index_only = covering;
+    }
+  }
+  // a probe returning a large share of the table costs more than reading it
+  if(statistics != nullptr && best.index_info_ != nullptr && best_cost >= page_count) {
+    best = IndexMatch();
+    index_only = false;
+  }
+  vector<IndexMatch> matches;
+  vector<Row> index_rows;
+  if(index_only) {
+    IndexSchema *key_schema = best.index_info_->GetIndexKeySchema();
+    vector<Field> fields, bounds;
+    IndexRange range;
+    MakeIndexProbe(best, fields, bounds, range);
+    Row key(fields);
+    vector<Row> entries;
+    best.index_info_->GetIndex()->ScanEntries(key, range, entries, nullptr);
+    for(auto &entry : entries) index_rows.push_back(EntryToRow(entry, key_schema, schema));
+    matches.push_back(best);
+  } else if(statistics != nullptr && best.index_info_ != nullptr && best_rows <= SortedFetchCost(page_count, best_rows)) {
+    // so few rows that sorting their row ids saves no page reads
+    vector<RowId> row_ids;
+    ProbeIndex(best, row_ids);
+    for(auto &rid : row_ids) {
+      Row row(rid);
+      table_heap->GetTuple(&row, nullptr);
+      index_rows.push_back(row);
+    }
+    matches.push_back(best);
+  } else {
+    // Collect the row ids of every index probe usable on the terms, AND-ing
+    // them together, then read the heap once in page order. OR terms whose
+    // disjuncts all have an index narrow the row ids down too, but are still
+    // checked on the rows. With statistics a further probe is only made when
+    // it costs less than the heap pages it is expected to save.
+    RowIdBitmap bitmap;
+    bool probed = false;
+    double expected_rows = row_count;
+    auto worth_probing = [&](double probe_cost, double selectivity) {
+      if(statistics == nullptr) return true;
+      double probed_rows = probed ? expected_rows * selectivity : row_count * selectivity;
+      double saved = probed ? SortedFetchCost(page_count, expected_rows) - SortedFetchCost(page_count, probed_rows)
+                            : page_count - SortedFetchCost(page_count, probed_rows);
+      return probe_cost < saved;
+    };
+    if(best.index_info_ != nullptr) {
+      ScanIndex(best, bitmap);
+      matches.push_back(best);
+      probed = true;
+      expected_rows = best_rows;
+      for(auto candidate : index_infos) {
+        if(candidate == best.index_info_ || bitmap.Empty()) continue;
+        vector<pSyntaxNode> rest;
+        for(auto term : conjuncts) {
+          if(none_of(matches.begin(), matches.end(), [&](const IndexMatch &m) { return m.Uses(term); }))
+            rest.push_back(term);
+        }
+        IndexMatch match = MatchIndex(candidate, rest);
+        if(match.index_info_ == nullptr) continue;
+        if(statistics != nullptr) {
+          double selectivity = EstimateSelectivity(match, statistics);
+          if(!worth_probing(IndexProbeCost(candidate, row_count, row_count * selectivity), selectivity)) continue;
+          expected_rows *= selectivity;
+        }
+        RowIdBitmap other;
+        ScanIndex(match, other);
+        bitmap.Intersect(other);
+        matches.push_back(match);
+      }
+    }
+    for(auto term : conjuncts) {
+      if(term->type_ != kNodeConnector || string(term->val_) != "or" || (probed && bitmap.Empty())) continue;
+      vector<IndexMatch> disjunct_matches;
+      if(!MatchDisjuncts(term, index_infos, disjunct_matches)) continue;
+      if(statistics != nullptr) {
+        double selectivity = 0, probe_cost = 0;
+        for(auto &match : disjunct_matches) {
+          double share = EstimateSelectivity(match, statistics);
+          selectivity += share;
+          probe_cost += IndexProbeCost(match.index_info_, row_count, row_count * share);
+        }
+        selectivity = min(1.0, selectivity);
+        if(!worth_probing(probe_cost, selectivity)) continue;
+        expected_rows = probed ? expected_rows * selectivity : row_count * selectivity;
+      }
+      RowIdBitmap other;
+      for(auto &match : disjunct_matches) ScanIndex(match, other);
+      if(probed) {
+        bitmap.Intersect(other);
+      } else {
+        bitmap.Union(other);
+      }
+      probed = true;
+    }
+    if(!probed) {
+      dberr_t status = DB_SUCCESS;
+      for(auto it = table_heap->Begin(); it != table_heap->End(); it++) {
+        bool match = true;
+        for(auto term : conjuncts) {
+          if(!CheckExpression(term, *it, schema, status)) {
+            match = false;
+            break;
+          }
         }
-        return DB_SUCCESS;
+        if(match) rows->push_back(*it);
       }
+      return status;
     }
+    table_heap->GetTuples(bitmap.GetRowIds(), index_rows, nullptr);
+  }
+  // terms no index answered are checked on the rows
+  vector<pSyntaxNode> residual;
+  for(auto term : conjuncts) {
+    if(none_of(matches.begin(), matches.end(), [&](const IndexMatch &m) { return m.Uses(term); }))
+      residual.push_back(term);
   }
   dberr_t status = DB_SUCCESS;
-  for(auto it = table_heap->Begin(); it != table_heap->End(); it++) 
-    if(CheckExpression(ast, *it, table_info, status))  
-      rows->push_back(*it);
+  for(auto &row : index_rows) {
+    bool match = true;
+    for(auto term : residual) {
+      if(!CheckExpression(term, row, schema, status)) {
+        match = false;
+        break;
+      }
+    }
+    if(match) rows->push_back(row);
+  }
   return status;
 }
 
 bool ExecuteEngine::CheckExpression(pSyntaxNode ast, const Row &row, TableInfo *table_info, dberr_t &status) {
+  return CheckExpression(ast, row, table_info->GetSchema(), status);
+}
+
+bool ExecuteEngine::CheckExpression(pSyntaxNode ast, const Row &row, Schema *schema, dberr_t &status) {
   if(ast->type_ == kNodeConditions) {
-    return CheckExpression(ast->child_, row, table_info, status);
+    return CheckExpression(ast->child_, row, schema, status);
   } else if(ast->type_ == kNodeConnector)  {
     auto pos = ast->child_;
     string connector = ast->val_;
     if(connector == "and") {
       while(pos != nullptr) {
-        if(!CheckExpression(pos, row, table_info, status))  return false;
+        if(!CheckExpression(pos, row, schema, status))  return false;
         pos = pos->next_;
       }
       return true;
     } else if(connector == "or") {
       while(pos != nullptr) {
-        if(CheckExpression(pos, row, table_info, status)) return true;
+        if(CheckExpression(pos, row, schema, status)) return true;
         pos = pos->next_;
       }
       return false;
@@ -762,13 +2131,26 @@ bool ExecuteEngine::CheckExpression(pSyntaxNode ast, const Row &row, TableInfo *
   } else if(ast->type_ == kNodeCompareOperator) {
     string column_name = ast->child_->val_;
     uint32_t column_index;
-    if(table_info->GetSchema()->GetColumnIndex(column_name, column_index) == DB_COLUMN_NAME_NOT_EXIST) {
+    if(ResolveColumn(schema, column_name, column_index) != DB_SUCCESS) {
       *message_ += "Error: Column " + column_name + " does not exist!\n";
       return false;
     }
     Field *field = row.GetField(column_index);
     string comparator = ast->val_;
-    Field temp = GetField(field->GetTypeId(), ast->child_->next_->val_); 
+    auto value = ast->child_->next_;
+    Field temp(field->GetTypeId());
+    if(value->type_ == kNodeIdentifier) {
+      // comparison of two columns
+      if(ResolveColumn(schema, value->val_, column_index) != DB_SUCCESS) {
+        *message_ += "Error: Column " + string(value->val_) + " does not exist!\n";
+        return false;
+      }
+      Field other(*row.GetField(column_index));
+      temp = other;
+    } else {
+      Field literal = GetField(field->GetTypeId(), value->val_);
+      temp = literal;
+    }
     if(comparator == "=") return field->CompareEquals(temp);
     else if(comparator == "<") return field->CompareLessThan(temp);
     else if(comparator == "<=") return field->CompareLessThanEquals(temp);
@@ -779,4 +2161,4 @@ bool ExecuteEngine::CheckExpression(pSyntaxNode ast, const Row &row, TableInfo *
   *message_ += "Error: Illegal expression!\n";
   status = DB_FAILED;
   return false;
-}
\ No newline at end of file
+}
@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <queue>
+
+#include "executor/external_sort.h"
+#include "index/generic_key.h"
+
+ExternalSort::ExternalSort(Schema *schema, std::vector<SortKey> keys, size_t limit, size_t memory_budget)
+        : schema_(schema), keys_(std::move(keys)), limit_(limit), memory_budget_(memory_budget) {}
+
+std::string ExternalSort::EncodeKey(const Row &row, const std::vector<SortKey> &keys) {
+  std::string key;
+  for (auto &sort_key : keys) {
+    Field *field = row.GetField(sort_key.column_);
+    size_t ofs = key.size();
+    key.resize(ofs + (field->IsNull() ? 1 : 1 + GenericKey<8>::EncodedSize(*field)));
+    GenericKey<8>::EncodeField(*field, &key[ofs]);
+    // encodings are prefix free, so complementing one reverses its order
+    if (sort_key.descending_) {
+      for (size_t i = ofs; i < key.size(); i++) key[i] = static_cast<char>(~key[i]);
+    }
+  }
+  return key;
+}
+
+size_t ExternalSort::Footprint(const Entry &entry) const {
+  return entry.first.size() + entry.second->GetSerializedSize(schema_) + sizeof(Row) +
+         entry.second->GetFieldCount() * sizeof(Field) + 64;
+}
+
+void ExternalSort::Add(const Row &row) {
+  if (limit_ == 0) return;
+  Entry entry(EncodeKey(row, keys_), nullptr);
+  if (entries_.size() == limit_) {
+    // the heap top is the last of the best limit rows
+    if (!KeyLess(entry, entries_.front())) return;
+    std::pop_heap(entries_.begin(), entries_.end(), KeyLess);
+    memory_used_ -= Footprint(entries_.back());
+    entries_.pop_back();
+  }
+  entry.second.reset(new Row(row));
+  memory_used_ += Footprint(entry);
+  entries_.push_back(std::move(entry));
+  if (limit_ != SIZE_MAX) std::push_heap(entries_.begin(), entries_.end(), KeyLess);
+  if (memory_used_ > memory_budget_) WriteRun();
+}
+
+void ExternalSort::WriteRun() {
+  auto run = SpillFile::Create(schema_);
+  if (run == nullptr) {
+    // no spill space, keep sorting in memory
+    memory_budget_ = SIZE_MAX;
+    return;
+  }
+  std::stable_sort(entries_.begin(), entries_.end(), KeyLess);
+  for (size_t i = 0; i < entries_.size() && i < limit_; i++) {
+    run->Write(*entries_[i].second);
+  }
+  runs_.push_back(std::move(run));
+  entries_.clear();
+  memory_used_ = 0;
+}
+
+void ExternalSort::Finish(const Emitter &emit) {
+  std::stable_sort(entries_.begin(), entries_.end(), KeyLess);
+  if (runs_.empty()) {
+    for (size_t i = 0; i < entries_.size() && i < limit_; i++) emit(*entries_[i].second);
+    entries_.clear();
+    return;
+  }
+  // k-way merge of the runs and the buffer, which is source runs_.size()
+  std::vector<std::unique_ptr<Row>> heads(runs_.size());
+  size_t buffered = 0;
+  using Head = std::pair<std::string, size_t>;
+  std::priority_queue<Head, std::vector<Head>, std::greater<Head>> queue;
+  auto advance = [&](size_t source) {
+    if (source == runs_.size()) {
+      if (buffered < entries_.size()) queue.emplace(entries_[buffered].first, source);
+      return;
+    }
+    if (heads[source] == nullptr) heads[source].reset(new Row(RowId()));
+    if (runs_[source]->Read(*heads[source])) queue.emplace(EncodeKey(*heads[source], keys_), source);
+  };
+  for (auto &run : runs_) run->Rewind();
+  for (size_t source = 0; source <= runs_.size(); source++) advance(source);
+  for (size_t emitted = 0; emitted < limit_ && !queue.empty(); emitted++) {
+    size_t source = queue.top().second;
+    queue.pop();
+    if (source == runs_.size()) {
+      emit(*entries_[buffered++].second);
+    } else {
+      emit(*heads[source]);
+    }
+    advance(source);
+  }
+  entries_.clear();
+  memory_used_ = 0;
+}
@@ -0,0 +1,106 @@
+#include <cstdint>
+
+#include "executor/hash_join.h"
+#include "index/generic_key.h"
+
+HashJoin::HashJoin(Schema *build_schema, std::vector<uint32_t> build_keys, Schema *probe_schema,
+                   std::vector<uint32_t> probe_keys, size_t memory_budget)
+        : build_schema_(build_schema),
+          build_keys_(std::move(build_keys)),
+          probe_schema_(probe_schema),
+          probe_keys_(std::move(probe_keys)),
+          memory_budget_(memory_budget) {}
+
+std::string HashJoin::EncodeKey(const Row &row, const std::vector<uint32_t> &keys) {
+  std::string key;
+  for (auto column : keys) {
+    Field *field = row.GetField(column);
+    if (field->IsNull()) return "";
+    size_t ofs = key.size();
+    key.resize(ofs + 1 + GenericKey<8>::EncodedSize(*field));
+    GenericKey<8>::EncodeField(*field, &key[ofs]);
+  }
+  return key;
+}
+
+void HashJoin::Insert(const std::string &key, const Row &row) {
+  table_.emplace(key, build_rows_.size());
+  build_rows_.emplace_back(row);
+  // rough footprint: serialized fields plus the row, field and table entry headers
+  memory_used_ += row.GetSerializedSize(build_schema_) + key.size() + sizeof(Row) +
+                  row.GetFieldCount() * sizeof(Field) + 64;
+}
+
+void HashJoin::Build(const Row &row) {
+  std::string key = EncodeKey(row, build_keys_);
+  if (key.empty()) return;
+  if (IsSpilled()) {
+    build_partitions_[PartitionOf(key)]->Write(row);
+    return;
+  }
+  Insert(key, row);
+  if (memory_used_ > memory_budget_) Spill();
+}
+
+void HashJoin::Spill() {
+  for (int i = 0; i < HASH_JOIN_PARTITIONS; i++) {
+    auto build_file = SpillFile::Create(build_schema_);
+    auto probe_file = SpillFile::Create(probe_schema_);
+    if (build_file == nullptr || probe_file == nullptr) {
+      // no spill space, keep joining in memory
+      build_partitions_.clear();
+      probe_partitions_.clear();
+      memory_budget_ = SIZE_MAX;
+      return;
+    }
+    build_partitions_.push_back(std::move(build_file));
+    probe_partitions_.push_back(std::move(probe_file));
+  }
+  for (auto &entry : table_) {
+    build_partitions_[PartitionOf(entry.first)]->Write(build_rows_[entry.second]);
+  }
+  table_.clear();
+  build_rows_.clear();
+  memory_used_ = 0;
+}
+
+void HashJoin::Probe(const Row &row, const Emitter &emit) {
+  std::string key = EncodeKey(row, probe_keys_);
+  if (key.empty()) return;
+  if (IsSpilled()) {
+    probe_partitions_[PartitionOf(key)]->Write(row);
+    return;
+  }
+  auto range = table_.equal_range(key);
+  for (auto it = range.first; it != range.second; ++it) {
+    emit(build_rows_[it->second], row);
+  }
+}
+
+void HashJoin::Finish(const Emitter &emit) {
+  for (uint32_t i = 0; i < build_partitions_.size(); i++) {
+    // a partition is assumed to fit in memory, keys are not split further
+    table_.clear();
+    build_rows_.clear();
+    build_partitions_[i]->Rewind();
+    Row build_row{RowId()};
+    while (build_partitions_[i]->Read(build_row)) {
+      Insert(EncodeKey(build_row, build_keys_), build_row);
+    }
+    probe_partitions_[i]->Rewind();
+    Row probe_row{RowId()};
+    while (probe_partitions_[i]->Read(probe_row)) {
+      auto range = table_.equal_range(EncodeKey(probe_row, probe_keys_));
+      for (auto it = range.first; it != range.second; ++it) {
+        emit(build_rows_[it->second], probe_row);
+      }
+    }
+  }
+  table_.clear();
+  build_rows_.clear();
+  memory_used_ = 0;
+}
+
+uint32_t HashJoin::PartitionOf(const std::string &key) const {
+  return std::hash<std::string>()(key) % HASH_JOIN_PARTITIONS;
+}
@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#include "executor/plan_cache.h"
+
+namespace {
+
+bool IsIdentifierChar(char ch) { return isalnum(static_cast<unsigned char>(ch)) || ch == '_'; }
+
+bool IsDigit(char ch) { return isdigit(static_cast<unsigned char>(ch)) != 0; }
+
+/**
+ * Length of the number literal at sql, 0 if there is none. Like the lexer a
+ * number is an optional '-', digits and an optional fraction with digits.
+ */
+size_t NumberLength(const char *sql) {
+  size_t len = sql[0] == '-' ? 1 : 0;
+  size_t digits = 0;
+  while (IsDigit(sql[len])) len++, digits++;
+  if (sql[len] == '.' && IsDigit(sql[len + 1])) {
+    len++;
+    while (IsDigit(sql[len])) len++, digits++;
+  }
+  return digits == 0 ? 0 : len;
+}
+
+/**
+ * Length of the string literal at sql including its quotes, 0 if it is unterminated
+ */
+size_t StringLength(const char *sql) {
+  size_t len = 1;
+  while (sql[len] != '\0' && sql[len] != '"') len += sql[len] == '\\' && sql[len + 1] != '\0' ? 2 : 1;
+  return sql[len] == '"' ? len + 1 : 0;
+}
+
+pSyntaxNode CopyNodes(pSyntaxNode node, std::vector<pSyntaxNode> &literals) {
+  if (node == nullptr) return nullptr;
+  auto copy = static_cast<pSyntaxNode>(malloc(sizeof(struct SyntaxNode)));
+  *copy = *node;
+  copy->val_ = node->val_ == nullptr ? nullptr : strdup(node->val_);
+  if (node->type_ == kNodeNumber || node->type_ == kNodeString || node->type_ == kNodeParameter) {
+    literals.push_back(copy);
+  }
+  copy->child_ = CopyNodes(node->child_, literals);
+  copy->next_ = CopyNodes(node->next_, literals);
+  return copy;
+}
+
+}  // namespace
+
+pSyntaxNode PlanCache::CopyTree(pSyntaxNode node, std::vector<pSyntaxNode> &literals) {
+  size_t begin = literals.size();
+  pSyntaxNode copy = CopyNodes(node, literals);
+  // the lexer creates literal nodes in text order
+  std::sort(literals.begin() + begin, literals.end(),
+            [](pSyntaxNode lhs, pSyntaxNode rhs) { return lhs->id_ < rhs->id_; });
+  return copy;
+}
+
+void PlanCache::FreeTree(pSyntaxNode node) {
+  while (node != nullptr) {
+    pSyntaxNode next = node->next_;
+    FreeTree(node->child_);
+    FreeSyntaxNode(node);
+    node = next;
+  }
+}
+
+PlanCache::~PlanCache() {
+  for (auto &entry : entries_) FreeTree(entry.second.ast_);
+}
+
+void PlanCache::Normalize(const char *sql, Statement &statement) {
+  statement.shape_.clear();
+  statement.literals_.clear();
+  statement.parameter_count_ = 0;
+  bool space = false;
+  for (size_t i = 0; sql[i] != '\0';) {
+    if (isspace(static_cast<unsigned char>(sql[i]))) {
+      space = true;
+      i++;
+      continue;
+    }
+    // blanks only matter between words and between comparison operators
+    char last = statement.shape_.empty() ? ' ' : statement.shape_.back();
+    bool word = IsIdentifierChar(sql[i]) && !IsDigit(sql[i]);
+    if (space && ((word && IsIdentifierChar(last)) || (strchr("<>=", sql[i]) && strchr("<>=", last)))) {
+      statement.shape_ += ' ';
+    }
+    space = false;
+    size_t len;
+    if (word) {
+      for (len = 1; IsIdentifierChar(sql[i + len]); len++) {}
+      statement.shape_.append(sql + i, len);
+    } else if ((len = NumberLength(sql + i)) > 0) {
+      statement.literals_.emplace_back(kNodeNumber, std::string(sql + i, len));
+      statement.shape_ += '?';
+    } else if (sql[i] == '"' && (len = StringLength(sql + i)) > 0) {
+      statement.literals_.emplace_back(kNodeString, std::string(sql + i + 1, len - 2));
+      statement.shape_ += '?';
+    } else {
+      len = 1;
+      statement.parameter_count_ += sql[i] == '?';
+      statement.shape_ += sql[i];
+    }
+    i += len;
+  }
+}
+
+pSyntaxNode PlanCache::Lookup(const Statement &statement) {
+  auto it = entries_.find(statement.shape_);
+  if (it == entries_.end() || statement.parameter_count_ != 0 ||
+      it->second.parameters_.size() != statement.literals_.size()) {
+    return nullptr;
+  }
+  Entry &entry = it->second;
+  // the shape does not tell a number from a string, the cached nodes do
+  for (size_t i = 0; i < entry.parameters_.size(); i++) {
+    if (entry.parameters_[i]->type_ != statement.literals_[i].first) return nullptr;
+  }
+  for (size_t i = 0; i < entry.parameters_.size(); i++) {
+    pSyntaxNode parameter = entry.parameters_[i];
+    const std::string &value = statement.literals_[i].second;
+    if (value == parameter->val_) continue;
+    free(parameter->val_);
+    parameter->val_ = strdup(value.c_str());
+  }
+  lru_.splice(lru_.begin(), lru_, entry.lru_pos_);
+  hits_++;
+  return entry.ast_;
+}
+
+void PlanCache::Insert(const Statement &statement, pSyntaxNode ast) {
+  if (ast == nullptr || capacity_ == 0 || statement.parameter_count_ != 0 || entries_.count(statement.shape_) != 0) {
+    return;
+  }
+  if (ast->type_ != kNodeSelect && ast->type_ != kNodeInsert && ast->type_ != kNodeDelete &&
+      ast->type_ != kNodeUpdate) {
+    return;
+  }
+  Entry entry;
+  entry.ast_ = CopyTree(ast, entry.parameters_);
+  bool match = entry.parameters_.size() == statement.literals_.size();
+  for (size_t i = 0; match && i < entry.parameters_.size(); i++) {
+    match = entry.parameters_[i]->type_ == statement.literals_[i].first &&
+            statement.literals_[i].second == entry.parameters_[i]->val_;
+  }
+  if (!match) {
+    FreeTree(entry.ast_);
+    return;
+  }
+  if (entries_.size() >= capacity_) {
+    auto victim = entries_.find(lru_.back());
+    FreeTree(victim->second.ast_);
+    entries_.erase(victim);
+    lru_.pop_back();
+  }
+  lru_.push_front(statement.shape_);
+  entry.lru_pos_ = lru_.begin();
+  entries_.emplace(statement.shape_, std::move(entry));
+}
@@ -0,0 +1,69 @@
+#include <algorithm>
+#include <cstdio>
+
+#include "executor/execute_engine.h"
+#include "executor/plan_cache.h"
+#include "executor/prepared_statement.h"
+
+void ResultCursor::SetColumns(Schema *schema, const std::vector<uint32_t> &columns) {
+  column_names_.clear();
+  for (auto column : columns) column_names_.push_back(schema->GetColumn(column)->GetName());
+}
+
+void ResultCursor::AddRow(const Row &row, const std::vector<uint32_t> &columns) {
+  std::vector<Field> fields;
+  fields.reserve(columns.size());
+  for (auto column : columns) fields.emplace_back(*row.GetField(column));
+  rows_.emplace_back(fields);
+}
+
+PreparedStatement::PreparedStatement(ExecuteEngine *engine, pSyntaxNode ast) : engine_(engine) {
+  ast_ = PlanCache::CopyTree(ast, parameters_);
+  parameters_.erase(std::remove_if(parameters_.begin(), parameters_.end(),
+                                   [](pSyntaxNode node) { return node->type_ != kNodeParameter; }),
+                    parameters_.end());
+}
+
+PreparedStatement::~PreparedStatement() { PlanCache::FreeTree(ast_); }
+
+dberr_t PreparedStatement::BindValue(uint32_t index, SyntaxNodeType type, const char *value) {
+  if (index >= parameters_.size()) return DB_FAILED;
+  pSyntaxNode parameter = parameters_[index];
+  free(parameter->val_);
+  parameter->type_ = type;
+  parameter->val_ = value == nullptr ? nullptr : strdup(value);
+  return DB_SUCCESS;
+}
+
+dberr_t PreparedStatement::Bind(uint32_t index, int32_t value) {
+  return BindValue(index, kNodeNumber, std::to_string(value).c_str());
+}
+
+dberr_t PreparedStatement::Bind(uint32_t index, float value) {
+  // enough digits to read back the same float
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.9g", value);
+  return BindValue(index, kNodeNumber, buf);
+}
+
+dberr_t PreparedStatement::Bind(uint32_t index, const std::string &value) {
+  return BindValue(index, kNodeString, value.c_str());
+}
+
+dberr_t PreparedStatement::BindNull(uint32_t index) { return BindValue(index, kNodeNull, nullptr); }
+
+std::unique_ptr<ResultCursor> PreparedStatement::Execute() {
+  std::unique_ptr<ResultCursor> cursor(new ResultCursor);
+  for (uint32_t i = 0; i < parameters_.size(); i++) {
+    if (parameters_[i]->type_ == kNodeParameter) {
+      cursor->status_ = DB_FAILED;
+      cursor->message_ = "Error: Parameter " + std::to_string(i) + " is not bound!\n";
+      return cursor;
+    }
+  }
+  ExecuteContext context;
+  context.result_ = cursor.get();
+  cursor->status_ = engine_->Execute(ast_, &context);
+  cursor->message_ = std::move(context.message_);
+  return cursor;
+}
@@ -0,0 +1,36 @@
+#include <vector>
+
+#include "executor/spill_file.h"
+
+std::unique_ptr<SpillFile> SpillFile::Create(Schema *schema) {
+  FILE *file = tmpfile();
+  if (file == nullptr) return nullptr;
+  return std::unique_ptr<SpillFile>(new SpillFile(file, schema));
+}
+
+SpillFile::~SpillFile() {
+  fclose(file_);
+}
+
+void SpillFile::Write(const Row &row) {
+  uint32_t size = row.GetSerializedSize(schema_);
+  std::vector<char> buf(size);
+  row.SerializeTo(buf.data(), schema_);
+  fwrite(&size, sizeof(uint32_t), 1, file_);
+  fwrite(buf.data(), 1, size, file_);
+  row_count_++;
+}
+
+void SpillFile::Rewind() {
+  fflush(file_);
+  rewind(file_);
+}
+
+bool SpillFile::Read(Row &row) {
+  uint32_t size;
+  if (fread(&size, sizeof(uint32_t), 1, file_) != 1) return false;
+  std::vector<char> buf(size);
+  if (fread(buf.data(), 1, size, file_) != size) return false;
+  row.DeserializeFrom(buf.data(), schema_);
+  return true;
+}
@@ -28,6 +28,12 @@ public:
 
   bool DeletePage(page_id_t page_id);
 
+  /**
+   * Copy the content of a page into page_data without pinning it or bringing
+   * it into the pool, for walking pages that are about to be freed
+   */
+  void ReadPage(page_id_t page_id, char *page_data);
+
   bool IsPageFree(page_id_t page_id);
 
   bool CheckAllUnpinned();
@@ -10,6 +10,7 @@
 #include "catalog/table.h"
 #include "common/config.h"
 #include "common/dberr.h"
+#include "storage/page_reclaimer.h"
 #include "transaction/lock_manager.h"
 #include "transaction/log_manager.h"
 #include "transaction/transaction.h"
@@ -51,6 +52,10 @@ public:
     return &index_meta_pages_;
   }
 
+  inline std::map<table_id_t, page_id_t> *GetTableStatisticsPages() {
+    return &table_statistics_pages_;
+  }
+
 private:
   explicit CatalogMeta();
 
@@ -58,6 +63,7 @@ private:
   static constexpr uint32_t CATALOG_METADATA_MAGIC_NUM = 89849;
   std::map<table_id_t, page_id_t> table_meta_pages_;
   std::map<index_id_t, page_id_t> index_meta_pages_;
+  std::map<table_id_t, page_id_t> table_statistics_pages_;
 };
 
 /**
@@ -79,7 +85,8 @@ public:
 
   dberr_t CreateIndex(const std::string &table_name, const std::string &index_name,
                       const std::vector<std::string> &index_keys, Transaction *txn,
-                      IndexInfo *&index_info);
+                      IndexInfo *&index_info, IndexType index_type = kIndexBPlusTree,
+                      const std::vector<std::string> &include_columns = {});
 
   dberr_t GetIndex(const std::string &table_name, const std::string &index_name, IndexInfo *&index_info) const;
 
@@ -87,8 +94,24 @@ public:
 
   dberr_t DropTable(const std::string &table_name);
 
+  /**
+   * Empty a table and its indexes at once, their old pages are freed by the
+   * page reclaimer
+   */
+  dberr_t TruncateTable(const std::string &table_name, Transaction *txn);
+
+  /**
+   * Collect the statistics of a table and persist them in its statistics page
+   */
+  dberr_t AnalyzeTable(const std::string &table_name, Transaction *txn);
+
   dberr_t DropIndex(const std::string &table_name, const std::string &index_name);
 
+  /**
+   * Frees the pages of dropped and truncated tables and indexes
+   */
+  inline PageReclaimer *GetPageReclaimer() { return &reclaimer_; }
+
 private:
   dberr_t FlushCatalogMetaPage() const;
 
@@ -113,6 +136,8 @@ private:
   [[maybe_unused]] std::unordered_map<index_id_t, IndexInfo *> indexes_;
   // memory heap
   MemHeap *heap_;
+  // frees dropped pages in the background, done before the buffer pool goes away
+  PageReclaimer reclaimer_;
 };
 
 #endif //MINISQL_CATALOG_H
@@ -9,6 +9,7 @@
 #include "common/rowid.h"
 #include "index/generic_key.h"
 #include "index/b_plus_tree_index.h"
+#include "index/hash_index.h"
 #include "record/schema.h"
 #include "record/type_id.h"
 
@@ -18,7 +19,8 @@ class IndexMetadata {
 public:
   static IndexMetadata *Create(const index_id_t index_id, const std::string &index_name,
                                const table_id_t table_id, const std::vector<uint32_t> &key_map,
-                               MemHeap *heap);
+                               MemHeap *heap, IndexType index_type = kIndexBPlusTree,
+                               const std::vector<uint32_t> &include_map = {});
 
   uint32_t SerializeTo(char *buf) const;
 
@@ -36,15 +38,22 @@ public:
 
   inline index_id_t GetIndexId() const { return index_id_; }
 
+  inline IndexType GetIndexType() const { return index_type_; }
+
+  inline const std::vector<uint32_t> &GetIncludeMapping() const { return include_map_; }
+
 private:
   IndexMetadata() = delete;
 
   explicit IndexMetadata(const index_id_t index_id, const std::string &index_name,
-                         const table_id_t table_id, const std::vector<uint32_t> &key_map) 
+                         const table_id_t table_id, const std::vector<uint32_t> &key_map,
+                         IndexType index_type, const std::vector<uint32_t> &include_map)
                          :index_id_(index_id),
                           index_name_(index_name),
                           table_id_(table_id),
-                          key_map_(key_map){}
+                          key_map_(key_map),
+                          index_type_(index_type),
+                          include_map_(include_map){}
 
 private:
   static constexpr uint32_t INDEX_METADATA_MAGIC_NUM = 344528;
@@ -52,6 +61,8 @@ private:
   std::string index_name_;
   table_id_t table_id_;
   std::vector<uint32_t> key_map_;  /** The mapping of index key to tuple key */
+  IndexType index_type_;
+  std::vector<uint32_t> include_map_;  /** Columns stored after the keys, see BPlusTreeIndex */
 };
 
 /**
@@ -74,7 +85,9 @@ public:
     // Step3: call CreateIndex to create the index
     meta_data_=meta_data;
     table_info_=table_info;
-    IndexSchema *key_schema=table_info->GetSchema()->ShallowCopySchema(table_info->GetSchema(), meta_data->key_map_, heap_);
+    std::vector<uint32_t> column_map=meta_data->key_map_;
+    column_map.insert(column_map.end(), meta_data->include_map_.begin(), meta_data->include_map_.end());
+    IndexSchema *key_schema=table_info->GetSchema()->ShallowCopySchema(table_info->GetSchema(), column_map, heap_);
     key_schema_=key_schema;
     index_=CreateIndex(buffer_pool_manager);
   }
@@ -83,68 +96,59 @@ public:
 
   inline std::string GetIndexName() { return meta_data_->GetIndexName(); }
 
+  /**
+   * Columns stored in the index entries: the key columns followed by the
+   * include columns
+   */
   inline IndexSchema *GetIndexKeySchema() { return key_schema_; }
 
+  inline uint32_t GetKeyColumnCount() const { return meta_data_->GetIndexColumnCount(); }
+
   inline MemHeap *GetMemHeap() const { return heap_; }
 
   inline TableInfo *GetTableInfo() const { return table_info_; }
 
+  inline IndexType GetIndexType() const { return meta_data_->GetIndexType(); }
+
 private:
   explicit IndexInfo() : meta_data_{nullptr}, index_{nullptr}, table_info_{nullptr},
                          key_schema_{nullptr}, heap_(new SimpleMemHeap()) {}
 
+  /**
+   * The key class only bounds the in-memory key buffer: B+ tree pages store keys
+   * with their zero padding trimmed, so fanout follows the actual key lengths.
+   * Pick the smallest class that holds the longest encoded key (see generic_key.h:
+   * a null flag per column, 4 bytes for int/float, bytes plus terminator for char).
+   */
   Index *CreateIndex(BufferPoolManager *buffer_pool_manager) {
-    uint32_t ofs=sizeof(RowId)+sizeof(size_t);
+    uint32_t ofs=0;
     size_t n=key_schema_->GetColumnCount();
-    ofs+=(n+7)/8;
     for(size_t i=0;i<n;i++){
       TypeId Type=key_schema_->GetColumn(i)->GetType();
-      if(Type==kTypeInt)ofs+=sizeof(int32_t);
-      else if(Type==kTypeFloat)ofs+=sizeof(float_t);
-      else ofs+=sizeof(uint32_t)+key_schema_->GetColumn(i)->GetLength();
-    }
-    void *buf=nullptr;
-    if(ofs<=4){ 
-      buf=heap_->Allocate(sizeof(BPlusTreeIndex<GenericKey<4>, RowId, GenericComparator<4>>));
-      BPlusTreeIndex<GenericKey<4>, RowId, GenericComparator<4>> * B_index=
-        new(buf)BPlusTreeIndex<GenericKey<4>, RowId, GenericComparator<4>>(meta_data_->index_id_,key_schema_,buffer_pool_manager);
-        return B_index;
+      if(Type==kTypeInt)ofs+=1+sizeof(int32_t);
+      else if(Type==kTypeFloat)ofs+=1+sizeof(float_t);
+      else ofs+=2+key_schema_->GetColumn(i)->GetLength();
     }
-    if(ofs<=8){ 
-      buf=heap_->Allocate(sizeof(BPlusTreeIndex<GenericKey<8>, RowId, GenericComparator<8>>));
-      BPlusTreeIndex<GenericKey<8>, RowId, GenericComparator<8>> * B_index=
-        new(buf)BPlusTreeIndex<GenericKey<8>, RowId, GenericComparator<8>>(meta_data_->index_id_,key_schema_,buffer_pool_manager);
-        return B_index;
-    }    
-    if(ofs<=16){ 
-      buf=heap_->Allocate(sizeof(BPlusTreeIndex<GenericKey<16>, RowId, GenericComparator<16>>));
-      BPlusTreeIndex<GenericKey<16>, RowId, GenericComparator<16>> * B_index=
-        new(buf)BPlusTreeIndex<GenericKey<16>, RowId, GenericComparator<16>>(meta_data_->index_id_,key_schema_,buffer_pool_manager);
-        return B_index;
-    }
-    if(ofs<=32){ 
-      buf=heap_->Allocate(sizeof(BPlusTreeIndex<GenericKey<32>, RowId, GenericComparator<32>>));
-      BPlusTreeIndex<GenericKey<32>, RowId, GenericComparator<32>> * B_index=
-        new(buf)BPlusTreeIndex<GenericKey<32>, RowId, GenericComparator<32>>(meta_data_->index_id_,key_schema_,buffer_pool_manager);
-        return B_index;
-    }
-    if(ofs<=64){ 
-      buf=heap_->Allocate(sizeof(BPlusTreeIndex<GenericKey<64>, RowId, GenericComparator<64>>));
-      BPlusTreeIndex<GenericKey<64>, RowId, GenericComparator<64>> * B_index=
-        new(buf)BPlusTreeIndex<GenericKey<64>, RowId, GenericComparator<64>>(meta_data_->index_id_,key_schema_,buffer_pool_manager);
-        return B_index;
-    }
-    if(ofs<=128){
-      buf=heap_->Allocate(sizeof(BPlusTreeIndex<GenericKey<128>, RowId, GenericComparator<128>>));
-      BPlusTreeIndex<GenericKey<128>, RowId, GenericComparator<128>> * B_index=
-        new(buf)BPlusTreeIndex<GenericKey<128>, RowId, GenericComparator<128>>(meta_data_->index_id_,key_schema_,buffer_pool_manager);
-        return B_index;      
-    } else {
-      buf=heap_->Allocate(sizeof(BPlusTreeIndex<GenericKey<256>, RowId, GenericComparator<256>>));
-      BPlusTreeIndex<GenericKey<256>, RowId, GenericComparator<256>> * B_index=
-        new(buf)BPlusTreeIndex<GenericKey<256>, RowId, GenericComparator<256>>(meta_data_->index_id_,key_schema_,buffer_pool_manager);
-        return B_index;      
+    if(ofs<=4)return CreateIndexOfKeySize<4>(buffer_pool_manager);
+    if(ofs<=8)return CreateIndexOfKeySize<8>(buffer_pool_manager);
+    if(ofs<=16)return CreateIndexOfKeySize<16>(buffer_pool_manager);
+    if(ofs<=32)return CreateIndexOfKeySize<32>(buffer_pool_manager);
+    if(ofs<=64)return CreateIndexOfKeySize<64>(buffer_pool_manager);
+    if(ofs<=128)return CreateIndexOfKeySize<128>(buffer_pool_manager);
+    return CreateIndexOfKeySize<256>(buffer_pool_manager);
+  }
+
+  template<size_t KeySize>
+  Index *CreateIndexOfKeySize(BufferPoolManager *buffer_pool_manager) {
+    using KeyType=GenericKey<KeySize>;
+    using KeyComparator=GenericComparator<KeySize>;
+    if(meta_data_->GetIndexType()==kIndexHash){
+      void *buf=heap_->Allocate(sizeof(HashIndex<KeyType, RowId, KeyComparator>));
+      return new(buf)HashIndex<KeyType, RowId, KeyComparator>(meta_data_->index_id_,key_schema_,buffer_pool_manager);
     }
+    void *buf=heap_->Allocate(sizeof(BPlusTreeIndex<KeyType, RowId, KeyComparator>));
+    return new(buf)BPlusTreeIndex<KeyType, RowId, KeyComparator>(meta_data_->index_id_,key_schema_,buffer_pool_manager,
+                                                                 meta_data_->include_map_.size());
   }
 
 private:
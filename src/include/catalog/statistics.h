@@ -0,0 +1,111 @@
+#ifndef MINISQL_STATISTICS_H
+#define MINISQL_STATISTICS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "index/index.h"
+#include "record/field.h"
+#include "record/schema.h"
+#include "storage/table_heap.h"
+
+/**
+ * HyperLogLog sketch estimating the number of distinct values added, within
+ * about 1.04 / sqrt(2^precision) relative error and 2^precision bytes.
+ */
+class HyperLogLog {
+public:
+  explicit HyperLogLog(uint32_t precision = HYPERLOGLOG_PRECISION);
+
+  void Add(const char *data, size_t len);
+
+  uint64_t Estimate() const;
+
+private:
+  static uint64_t Hash(const char *data, size_t len);
+
+  uint32_t precision_;
+  std::vector<uint8_t> registers_;
+};
+
+/**
+ * Statistics of one column. Values are kept in the byte-comparable index key
+ * encoding (see GenericKey) cut to STATISTICS_VALUE_LENGTH bytes, so they
+ * compare with memcmp whatever the column type.
+ */
+struct ColumnStatistics {
+  uint32_t distinct_count_{0};
+  uint32_t null_count_{0};
+  std::string min_;
+  std::string max_;
+  // upper bounds of equi-depth buckets, each holding the same share of the non-null values
+  std::vector<std::string> bounds_;
+};
+
+/**
+ * Table statistics collected by ANALYZE and kept in their own catalog page,
+ * used by the executor to estimate the rows an index probe returns and pick
+ * the cheapest access path.
+ *
+ * Serialized format:
+ *  | MagicNum | RowCount | PageCount | ColumnCount | Column(1) | ... | Column(n) |
+ *  Column format:
+ *  | DistinctCount | NullCount | Min | Max | BoundCount | Bound(1) | ... | Bound(k) |
+ *  values are stored as | Length | Bytes |
+ */
+class TableStatistics {
+public:
+  /**
+   * Scan the whole table, the caller owns the result
+   */
+  static TableStatistics *Collect(TableHeap *table_heap, Schema *schema);
+
+  uint32_t SerializeTo(char *buf) const;
+
+  uint32_t GetSerializedSize() const;
+
+  static uint32_t DeserializeFrom(char *buf, TableStatistics *&statistics);
+
+  /**
+   * Drop every other histogram bound so the statistics fit a page
+   * @return false if there are no bounds left to drop
+   */
+  bool ShrinkHistograms();
+
+  inline uint32_t GetRowCount() const { return row_count_; }
+
+  inline uint32_t GetPageCount() const { return page_count_; }
+
+  inline const ColumnStatistics &GetColumn(uint32_t column_index) const { return columns_[column_index]; }
+
+  /**
+   * Estimated share of the rows whose column equals value
+   */
+  double EstimateEquality(uint32_t column_index, const Field &value) const;
+
+  /**
+   * Estimated share of the rows whose column lies within range, a null bound
+   * leaves that end open
+   */
+  double EstimateRange(uint32_t column_index, const IndexRange &range) const;
+
+  /**
+   * The value encoding statistics compare with
+   */
+  static std::string EncodeValue(const Field &value);
+
+private:
+  TableStatistics() = default;
+
+  // estimated share of the non-null values below value, or up to it when inclusive
+  double ShareBelow(const ColumnStatistics &column, const std::string &value, bool inclusive) const;
+
+  static constexpr uint32_t TABLE_STATISTICS_MAGIC_NUM = 271828;
+  uint32_t row_count_{0};
+  uint32_t page_count_{0};
+  std::vector<ColumnStatistics> columns_;
+};
+
+#endif  // MINISQL_STATISTICS_H
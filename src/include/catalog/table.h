@@ -3,6 +3,7 @@
 
 #include <memory>
 
+#include "catalog/statistics.h"
 #include "glog/logging.h"
 #include "record/schema.h"
 #include "storage/table_heap.h"
@@ -28,6 +29,7 @@ public:
 
   inline Schema *GetSchema() const { return schema_; }
 
+  inline void SetFirstPageId(page_id_t first_page_id) { root_page_id_ = first_page_id; }
 
 private:
   TableMetadata() = delete;
@@ -73,6 +75,15 @@ public:
 
   inline page_id_t GetRootPageId() const { return table_meta_->root_page_id_; }
 
+  inline TableMetadata *GetTableMeta() const { return table_meta_; }
+
+  /**
+   * Statistics of the last ANALYZE, null if the table was never analyzed
+   */
+  inline TableStatistics *GetStatistics() const { return statistics_.get(); }
+
+  inline void SetStatistics(TableStatistics *statistics) { statistics_.reset(statistics); }
+
 private:
   explicit TableInfo() : heap_(new SimpleMemHeap()) {};
 
@@ -80,6 +91,7 @@ private:
   TableMetadata *table_meta_;
   TableHeap *table_heap_;
   MemHeap *heap_; /** store all objects allocated in table_meta and table heap */
+  std::unique_ptr<TableStatistics> statistics_;
 };
 
 #endif //MINISQL_TABLE_H
@@ -16,6 +16,23 @@ static constexpr int INDEX_ROOTS_PAGE_ID = 1;        // logical page id of the i
 static constexpr int PAGE_SIZE = 4096;               // size of a data page in byte
 static constexpr int DEFAULT_BUFFER_POOL_SIZE = 2048;// default size of buffer pool
 
+static constexpr int APPEND_STREAK_SEQUENTIAL = 8;  // appends in a row after which b+ tree inserts count as sequential
+static constexpr int APPEND_SPLIT_PERCENT = 90;     // share of a split page kept on the left for sequential inserts
+static constexpr int BLOOM_FILTER_BITS_PER_KEY = 10; // bloom filter bits per b+ tree index key, 0 disables the filter
+static constexpr int STATISTICS_SAMPLE_SIZE = 10000;  // non-null values per column sampled by analyze for histograms
+static constexpr int STATISTICS_HISTOGRAM_BUCKETS = 16; // equi-depth histogram buckets per column
+static constexpr int STATISTICS_VALUE_LENGTH = 16;   // bytes kept of encoded min, max and histogram bounds
+static constexpr int HYPERLOGLOG_PRECISION = 10;     // log2 of the hyperloglog registers counting distinct values
+static constexpr int HASH_JOIN_MEMORY_BUDGET = 64 << 20; // bytes of build rows a hash join keeps in memory before spilling
+static constexpr int HASH_JOIN_PARTITIONS = 32;      // spill partitions of a grace hash join
+static constexpr int INDEX_JOIN_BATCH_SIZE = 1024;   // outer rows whose keys an index nested-loop join probes together
+static constexpr int HASH_AGGREGATE_MEMORY_BUDGET = 64 << 20; // bytes of groups a hash aggregate keeps in memory before spilling
+static constexpr int HASH_AGGREGATE_PARTITIONS = 32; // spill partitions of a hash aggregate
+static constexpr int SORT_MEMORY_BUDGET = 64 << 20;  // bytes of rows a sort keeps in memory before writing a sorted run
+static constexpr int PLAN_CACHE_CAPACITY = 256;      // syntax trees of distinct statement shapes kept by the plan cache
+static constexpr int CSV_READ_BUFFER_SIZE = 1 << 20;  // bytes a csv reader reads from its file at once
+static constexpr int COPY_BATCH_SIZE = 4096;        // rows copy parses before appending them to the table heap
+
 static constexpr uint32_t FIELD_NULL_LEN = UINT32_MAX;
 static constexpr uint32_t VARCHAR_MAX_LEN = PAGE_SIZE / 2;    // max length of varchar
 
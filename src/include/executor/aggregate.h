@@ -0,0 +1,126 @@
+#ifndef MINISQL_AGGREGATE_H
+#define MINISQL_AGGREGATE_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "executor/spill_file.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+enum AggregateType {
+  kAggregateCount = 0, kAggregateSum, kAggregateAvg, kAggregateMin, kAggregateMax
+};
+
+/**
+ * An aggregate function over an input column, COUNT(*) has no column
+ */
+struct Aggregate {
+  static constexpr uint32_t ALL_ROWS = UINT32_MAX;
+
+  AggregateType type_;
+  uint32_t column_{ALL_ROWS};
+
+  // type of the aggregate value: COUNT gives an int, AVG a float, the others the column type
+  TypeId ResultType(Schema *schema) const;
+};
+
+/**
+ * Running values of the aggregates of one group
+ */
+class GroupAccumulator {
+public:
+  GroupAccumulator(const Row &row, const std::vector<uint32_t> &group_columns, size_t aggregate_count);
+
+  void Add(const Row &row, const std::vector<Aggregate> &aggregates);
+
+  // the group columns followed by the aggregate values
+  Row Result(const std::vector<Aggregate> &aggregates, Schema *schema) const;
+
+  // rough bytes held by the group
+  size_t MemoryUsage() const;
+
+private:
+  struct Value {
+    int64_t count_{0};
+    int64_t int_sum_{0};
+    double float_sum_{0};
+    // min or max so far
+    std::unique_ptr<Field> extreme_;
+  };
+
+  std::vector<Field> group_fields_;
+  std::vector<Value> values_;
+};
+
+/**
+ * Grouped aggregation of rows arriving in any order.
+ *
+ * Groups are kept in a hash table on their encoded group columns. Once the
+ * groups outgrow the memory budget, rows of the groups already in memory are
+ * still aggregated there, while rows starting a new group are written to
+ * HASH_AGGREGATE_PARTITIONS spill files by group hash. Finish aggregates
+ * each partition on its own, a group never spans two partitions.
+ *
+ * Null group columns form a group of their own. Without group columns there
+ * is exactly one group, even for no rows.
+ */
+class HashAggregate {
+public:
+  using Emitter = std::function<void(const Row &row)>;
+
+  HashAggregate(Schema *schema, std::vector<uint32_t> group_columns, std::vector<Aggregate> aggregates,
+                size_t memory_budget = HASH_AGGREGATE_MEMORY_BUDGET);
+
+  void Add(const Row &row);
+
+  // emit a row per group: the group columns followed by the aggregate values
+  void Finish(const Emitter &emit);
+
+  inline bool IsSpilled() const { return !partitions_.empty(); }
+
+  // byte-comparable encoding of the group columns of row
+  static std::string EncodeGroup(const Row &row, const std::vector<uint32_t> &group_columns);
+
+private:
+  void Spill();
+
+  Schema *schema_;
+  std::vector<uint32_t> group_columns_;
+  std::vector<Aggregate> aggregates_;
+  size_t memory_budget_;
+  size_t memory_used_{0};
+  std::vector<GroupAccumulator> groups_;
+  std::unordered_map<std::string, size_t> table_;
+  std::vector<std::unique_ptr<SpillFile>> partitions_;
+};
+
+/**
+ * Grouped aggregation of rows sorted on the group columns, as an index on
+ * them returns them. Only the current group is held, it is emitted as soon
+ * as a row of the next one arrives.
+ */
+class StreamAggregate {
+public:
+  using Emitter = HashAggregate::Emitter;
+
+  StreamAggregate(Schema *schema, std::vector<uint32_t> group_columns, std::vector<Aggregate> aggregates);
+
+  void Add(const Row &row, const Emitter &emit);
+
+  void Finish(const Emitter &emit);
+
+private:
+  Schema *schema_;
+  std::vector<uint32_t> group_columns_;
+  std::vector<Aggregate> aggregates_;
+  std::string current_key_;
+  std::unique_ptr<GroupAccumulator> current_;
+  bool emitted_{false};
+};
+
+#endif  // MINISQL_AGGREGATE_H
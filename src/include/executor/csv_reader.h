@@ -0,0 +1,47 @@
+#ifndef MINISQL_CSV_READER_H
+#define MINISQL_CSV_READER_H
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Streaming reader of comma separated records. The file is read in blocks of
+ * CSV_READ_BUFFER_SIZE bytes and fields are cut out of the buffer without a
+ * copy per character. A field in double quotes may hold commas, line breaks
+ * and quotes written twice; an empty field without quotes is null. Records
+ * end at "\n" or "\r\n".
+ */
+class CsvReader {
+public:
+  // null if the file cannot be opened
+  static std::unique_ptr<CsvReader> Open(const std::string &file_name);
+
+  ~CsvReader();
+
+  /**
+   * Read the next record into fields, nulls[i] telling if fields[i] is null.
+   * Blank lines are skipped.
+   * @return false at the end of the file
+   */
+  bool ReadRecord(std::vector<std::string> &fields, std::vector<bool> &nulls);
+
+  // line the last record read starts on, from 1
+  inline size_t GetLineNumber() const { return record_line_; }
+
+private:
+  explicit CsvReader(FILE *file);
+
+  // make sure buffer_[position_] is valid, false at the end of the file
+  bool Fill();
+
+  FILE *file_;
+  std::vector<char> buffer_;
+  size_t position_{0};
+  size_t size_{0};
+  size_t line_{1};
+  size_t record_line_{0};
+};
+
+#endif  // MINISQL_CSV_READER_H
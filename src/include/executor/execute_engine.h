@@ -2,9 +2,15 @@
 #define MINISQL_EXECUTE_ENGINE_H
 
 #include <cstring>
+#include <functional>
+#include <memory>
 #include <unordered_map>
 #include "common/dberr.h"
 #include "common/instance.h"
+#include "executor/aggregate.h"
+#include "executor/external_sort.h"
+#include "executor/plan_cache.h"
+#include "executor/prepared_statement.h"
 #include "transaction/transaction.h"
 #include "parser/syntax_tree_printer.h"
 #include "utils/tree_file_mgr.h"
@@ -26,6 +32,7 @@ struct ExecuteContext {
   bool flag_quit_{false};
   Transaction *txn_{nullptr};
   string message_{""};
+  ResultCursor *result_{nullptr};  /** receives the selected rows instead of the message if set */
 };
 
 /**
@@ -46,7 +53,25 @@ public:
    */
   dberr_t Execute(pSyntaxNode ast, ExecuteContext *context);
 
+  /**
+   * Parse and execute one statement, statements differing from an earlier one
+   * only in their literals reuse its syntax tree without parsing
+   */
+  dberr_t ExecuteSql(const char *sql, ExecuteContext *context);
+
+  /**
+   * Parse a statement to execute later, its values may be '?' parameters.
+   * Returns nullptr and the parse error in message if it does not parse.
+   */
+  unique_ptr<PreparedStatement> Prepare(const char *sql, string &message);
+
 private:
+  /**
+   * Parse sql and execute visit on its syntax tree, which is nullptr if sql
+   * does not parse. The tree is freed afterwards.
+   */
+  dberr_t ParseSql(const char *sql, const function<dberr_t(pSyntaxNode)> &visit);
+
   dberr_t ExecuteCreateDatabase(pSyntaxNode ast, ExecuteContext *context);
 
   dberr_t ExecuteDropDatabase(pSyntaxNode ast, ExecuteContext *context);
@@ -61,6 +86,8 @@ private:
 
   dberr_t ExecuteDropTable(pSyntaxNode ast, ExecuteContext *context);
 
+  dberr_t ExecuteTruncateTable(pSyntaxNode ast, ExecuteContext *context);
+
   dberr_t ExecuteShowIndexes(pSyntaxNode ast, ExecuteContext *context);
 
   dberr_t ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext *context);
@@ -85,15 +112,93 @@ private:
 
   dberr_t ExecuteQuit(pSyntaxNode ast, ExecuteContext *context);
 
-  dberr_t GetRows(const pSyntaxNode ast, TableInfo* tinfo, vector<IndexInfo*> iinfos, vector<Row>* row);
-  
+  dberr_t ExecuteAnalyze(pSyntaxNode ast, ExecuteContext *context);
+
+  dberr_t ExecuteVacuum(pSyntaxNode ast, ExecuteContext *context);
+
+  dberr_t ExecuteCopy(pSyntaxNode ast, ExecuteContext *context);
+
+  /**
+   * Add the entries of tuples already in the heap to the indexes, keys[i] holding
+   * those of index_infos[i] in row_ids order. Each index takes its entries sorted
+   * in one pass; on a duplicate the entries added so far and the tuples are removed.
+   */
+  dberr_t InsertIndexEntries(TableInfo *table_info, const vector<IndexInfo *> &index_infos,
+                             const vector<vector<Row>> &keys, const vector<RowId> &row_ids, Transaction *txn);
+
+  /**
+   * Collect the rows matching the where conditions. When columns lists the
+   * only table columns the caller reads, an index storing all of them may
+   * answer alone; the other fields of such rows are null.
+   */
+  dberr_t GetRows(const pSyntaxNode ast, TableInfo* tinfo, vector<IndexInfo*> iinfos, vector<Row>* row,
+                  const vector<uint32_t> *columns = nullptr);
+
+  /**
+   * Collect the rows matching every one of the AND-ed terms
+   */
+  dberr_t GetRows(const vector<pSyntaxNode> &conjuncts, TableInfo* tinfo, vector<IndexInfo*> iinfos,
+                  vector<Row>* row, const vector<uint32_t> *columns = nullptr);
+
+  /**
+   * Select over several tables, joined in the order they are listed
+   */
+  dberr_t ExecuteJoinSelect(pSyntaxNode ast, ExecuteContext *context);
+
+  /**
+   * Grouped select over a table answered by an index on the group columns, reading
+   * the index in order. columns are the columns the select reads
+   */
+  dberr_t ExecuteStreamAggregate(pSyntaxNode ast, TableInfo *table_info, IndexInfo *index_info,
+                                 const vector<uint32_t> &columns);
+
+  /**
+   * Append the selected columns of rows, whose columns schema describes, to the message,
+   * grouping and aggregating them first and ordering and limiting them if the select asks
+   * for it. ordered rows already come in the order asked for.
+   */
+  dberr_t OutputRows(pSyntaxNode ast, Schema *schema, vector<Row> &rows, bool ordered = false);
+
+  /**
+   * Sort rows on sort_keys and append the columns of those in the limit to the message
+   */
+  void FinishSelect(vector<Row> &rows, Schema *schema, const vector<uint32_t> &columns,
+                    const vector<SortKey> &sort_keys, size_t count, size_t offset);
+
+  /**
+   * Sort keys of a select, columns of aggregated rows if group_columns are given
+   */
+  dberr_t PlanOrder(pSyntaxNode ast, Schema *schema, const vector<uint32_t> *group_columns,
+                    vector<SortKey> &sort_keys);
+
+  /**
+   * Row count and offset of the limit of a select, count is SIZE_MAX without one
+   */
+  dberr_t GetLimit(pSyntaxNode ast, size_t &count, size_t &offset);
+
+  /**
+   * Group columns and aggregates of a select, and where each selected column is
+   * found in the aggregated rows
+   */
+  dberr_t PlanAggregation(pSyntaxNode ast, Schema *schema, vector<uint32_t> &group_columns,
+                          vector<Aggregate> &aggregates, vector<uint32_t> &columns);
+
+  dberr_t ResolveSelectColumn(Schema *schema, const string &name, uint32_t &column_index);
+
+  void PrintRows(const vector<Row> &rows, const vector<uint32_t> &columns, size_t begin = 0,
+                 size_t end = SIZE_MAX);
+
   bool CheckExpression(pSyntaxNode ast, const Row &row, TableInfo *table_info, dberr_t &status);
 
+  bool CheckExpression(pSyntaxNode ast, const Row &row, Schema *schema, dberr_t &status);
+
  private:
   unordered_map<string, DBStorageEngine *> dbs_;  /** all opened databases */
   string current_db_;  /** current database */
   fstream file_io_;
   string* message_;
+  ResultCursor *result_{nullptr};
+  PlanCache plan_cache_;  /** syntax trees of executed statements */
 };
 
 #endif //MINISQL_EXECUTE_ENGINE_H
\ No newline at end of file
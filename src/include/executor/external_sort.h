@@ -0,0 +1,70 @@
+#ifndef MINISQL_EXTERNAL_SORT_H
+#define MINISQL_EXTERNAL_SORT_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "executor/spill_file.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * Column rows are ordered on, nulls come first in ascending order
+ */
+struct SortKey {
+  uint32_t column_;
+  bool descending_{false};
+};
+
+/**
+ * Sort of rows on sort keys, keeping only the first limit rows.
+ *
+ * Rows are buffered in memory. With a limit the buffer is a bounded heap of
+ * the best limit rows seen so far, so a top-N query holds N rows whatever its
+ * input size. When the buffer outgrows the memory budget it is sorted and
+ * written to a spill file as a run of at most limit rows, and Finish merges
+ * the runs and the buffer k ways. Rows with equal keys keep their input order
+ * unless the bounded heap is used.
+ */
+class ExternalSort {
+public:
+  using Emitter = std::function<void(const Row &row)>;
+
+  ExternalSort(Schema *schema, std::vector<SortKey> keys, size_t limit = SIZE_MAX,
+               size_t memory_budget = SORT_MEMORY_BUDGET);
+
+  void Add(const Row &row);
+
+  // emit the first limit rows in order
+  void Finish(const Emitter &emit);
+
+  inline bool IsSpilled() const { return !runs_.empty(); }
+
+  // byte-comparable encoding of the sort keys of row, descending keys complemented
+  static std::string EncodeKey(const Row &row, const std::vector<SortKey> &keys);
+
+private:
+  using Entry = std::pair<std::string, std::unique_ptr<Row>>;
+
+  static bool KeyLess(const Entry &lhs, const Entry &rhs) { return lhs.first < rhs.first; }
+
+  size_t Footprint(const Entry &entry) const;
+
+  // sort the buffer and move it to a new run
+  void WriteRun();
+
+  Schema *schema_;
+  std::vector<SortKey> keys_;
+  size_t limit_;
+  size_t memory_budget_;
+  size_t memory_used_{0};
+  std::vector<Entry> entries_;
+  std::vector<std::unique_ptr<SpillFile>> runs_;
+};
+
+#endif  // MINISQL_EXTERNAL_SORT_H
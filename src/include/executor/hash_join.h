@@ -0,0 +1,67 @@
+#ifndef MINISQL_HASH_JOIN_H
+#define MINISQL_HASH_JOIN_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "executor/spill_file.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * Inner equi-join of a build and a probe input on key columns.
+ *
+ * Build rows are kept in an in-memory hash table until they exceed the memory
+ * budget. From then on the join runs as a grace hash join: the build rows are
+ * written to HASH_JOIN_PARTITIONS spill files by key hash, probe rows are
+ * spilled the same way, and Finish joins each pair of partitions in memory.
+ * Either way every input row is read once, spilled rows once more.
+ *
+ * Rows with a null key column never match.
+ */
+class HashJoin {
+public:
+  using Emitter = std::function<void(const Row &build_row, const Row &probe_row)>;
+
+  HashJoin(Schema *build_schema, std::vector<uint32_t> build_keys, Schema *probe_schema,
+           std::vector<uint32_t> probe_keys, size_t memory_budget = HASH_JOIN_MEMORY_BUDGET);
+
+  // call for every build row before the first Probe
+  void Build(const Row &row);
+
+  // emit the build rows matching row, or spill it to be joined by Finish
+  void Probe(const Row &row, const Emitter &emit);
+
+  // join the spilled partitions, call after the last Probe
+  void Finish(const Emitter &emit);
+
+  inline bool IsSpilled() const { return !build_partitions_.empty(); }
+
+private:
+  // byte-comparable encoding of the key columns, empty if one is null
+  static std::string EncodeKey(const Row &row, const std::vector<uint32_t> &keys);
+
+  void Insert(const std::string &key, const Row &row);
+
+  // move the in-memory build rows to the spill files
+  void Spill();
+
+  uint32_t PartitionOf(const std::string &key) const;
+
+  Schema *build_schema_;
+  std::vector<uint32_t> build_keys_;
+  Schema *probe_schema_;
+  std::vector<uint32_t> probe_keys_;
+  size_t memory_budget_;
+  size_t memory_used_{0};
+  std::vector<Row> build_rows_;
+  std::unordered_multimap<std::string, size_t> table_;
+  std::vector<std::unique_ptr<SpillFile>> build_partitions_;
+  std::vector<std::unique_ptr<SpillFile>> probe_partitions_;
+};
+
+#endif  // MINISQL_HASH_JOIN_H
@@ -0,0 +1,87 @@
+#ifndef MINISQL_PLAN_CACHE_H
+#define MINISQL_PLAN_CACHE_H
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+
+extern "C" {
+#include "parser/syntax_tree.h"
+}
+
+/**
+ * Cache of syntax trees keyed on the statement text with its literals replaced
+ * by '?', so statements differing only in their literals share one tree.
+ *
+ * A hit binds the literals of the new statement into the number and string
+ * nodes of the cached tree, which skips the lexer and parser altogether. Trees
+ * are only cached when the literal nodes match the literals found in the text
+ * one to one, and the least recently used shape is dropped past the capacity.
+ * Executing a tree must not change it.
+ */
+class PlanCache {
+public:
+  /**
+   * Literals of a statement in text order, number literals keep their text and
+   * string literals drop their quotes like the parser does
+   */
+  struct Statement {
+    std::string shape_;
+    std::vector<std::pair<SyntaxNodeType, std::string>> literals_;
+    uint32_t parameter_count_{0};  // '?' parameters, statements with them are never cached
+  };
+
+  explicit PlanCache(size_t capacity = PLAN_CACHE_CAPACITY) : capacity_(capacity) {}
+
+  ~PlanCache();
+
+  PlanCache(const PlanCache &) = delete;
+
+  PlanCache &operator=(const PlanCache &) = delete;
+
+  /**
+   * Split sql into its shape and literals, tokenizing like the lexer
+   */
+  static void Normalize(const char *sql, Statement &statement);
+
+  /**
+   * Cached tree of the shape of statement with its literals bound, nullptr on a miss
+   */
+  pSyntaxNode Lookup(const Statement &statement);
+
+  /**
+   * Cache a copy of ast, the tree parsed from statement. Only selects, inserts,
+   * deletes and updates are cached.
+   */
+  void Insert(const Statement &statement, pSyntaxNode ast);
+
+  /**
+   * Copy of the tree at node, the number, string and parameter nodes of the copy
+   * are appended to literals in text order
+   */
+  static pSyntaxNode CopyTree(pSyntaxNode node, std::vector<pSyntaxNode> &literals);
+
+  static void FreeTree(pSyntaxNode node);
+
+  inline size_t GetSize() const { return entries_.size(); }
+
+  inline size_t GetHitCount() const { return hits_; }
+
+private:
+  struct Entry {
+    pSyntaxNode ast_;
+    std::vector<pSyntaxNode> parameters_;  // literal nodes of ast in text order
+    std::list<std::string>::iterator lru_pos_;
+  };
+
+  size_t capacity_;
+  size_t hits_{0};
+  std::unordered_map<std::string, Entry> entries_;
+  std::list<std::string> lru_;  // shapes, most recently used first
+};
+
+#endif  // MINISQL_PLAN_CACHE_H
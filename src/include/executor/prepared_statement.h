@@ -0,0 +1,105 @@
+#ifndef MINISQL_PREPARED_STATEMENT_H
+#define MINISQL_PREPARED_STATEMENT_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/dberr.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+extern "C" {
+#include "parser/syntax_tree.h"
+}
+
+class ExecuteEngine;
+
+/**
+ * Result of an executed statement. The selected columns of the rows a select
+ * returns are kept as typed fields, so reading them needs no parsing of the
+ * message text, and Next moves through them one row at a time.
+ */
+class ResultCursor {
+  friend class ExecuteEngine;
+
+  friend class PreparedStatement;
+
+public:
+  /**
+   * Move to the next row, false once past the last one
+   */
+  inline bool Next() { return ++position_ < rows_.size(); }
+
+  /**
+   * Field of column index of the current row
+   */
+  inline const Field &GetField(uint32_t index) const { return *rows_[position_].GetField(index); }
+
+  inline uint32_t GetColumnCount() const { return column_names_.size(); }
+
+  inline const std::string &GetColumnName(uint32_t index) const { return column_names_[index]; }
+
+  inline size_t GetRowCount() const { return rows_.size(); }
+
+  inline dberr_t GetStatus() const { return status_; }
+
+  /**
+   * Errors and notes of the execution, the rows themselves are not in it
+   */
+  inline const std::string &GetMessage() const { return message_; }
+
+private:
+  void SetColumns(Schema *schema, const std::vector<uint32_t> &columns);
+
+  void AddRow(const Row &row, const std::vector<uint32_t> &columns);
+
+  std::vector<std::string> column_names_;
+  std::vector<Row> rows_;
+  size_t position_{SIZE_MAX};  // before the first row, Next wraps it to 0
+  dberr_t status_{DB_SUCCESS};
+  std::string message_;
+};
+
+/**
+ * Statement parsed once and executed any number of times. Its values may be
+ * '?' parameters, numbered from 0 in text order, that are bound before every
+ * execution and keep their value until bound again.
+ */
+class PreparedStatement {
+  friend class ExecuteEngine;
+
+public:
+  ~PreparedStatement();
+
+  PreparedStatement(const PreparedStatement &) = delete;
+
+  PreparedStatement &operator=(const PreparedStatement &) = delete;
+
+  dberr_t Bind(uint32_t index, int32_t value);
+
+  dberr_t Bind(uint32_t index, float value);
+
+  dberr_t Bind(uint32_t index, const std::string &value);
+
+  dberr_t BindNull(uint32_t index);
+
+  inline uint32_t GetParameterCount() const { return parameters_.size(); }
+
+  /**
+   * Execute the statement with the bound parameters, failing if one is unbound
+   */
+  std::unique_ptr<ResultCursor> Execute();
+
+private:
+  PreparedStatement(ExecuteEngine *engine, pSyntaxNode ast);
+
+  dberr_t BindValue(uint32_t index, SyntaxNodeType type, const char *value);
+
+  ExecuteEngine *engine_;
+  pSyntaxNode ast_;
+  std::vector<pSyntaxNode> parameters_;  // parameter nodes of ast_ in text order
+};
+
+#endif  // MINISQL_PREPARED_STATEMENT_H
@@ -0,0 +1,40 @@
+#ifndef MINISQL_SPILL_FILE_H
+#define MINISQL_SPILL_FILE_H
+
+#include <cstdio>
+#include <memory>
+
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * Temporary file of rows written by an operator whose input outgrows its
+ * memory budget, read back in the order written. Rows are stored as
+ * [size (4)][Row::SerializeTo bytes], the file is removed when closed.
+ */
+class SpillFile {
+public:
+  // null if no temporary file can be created
+  static std::unique_ptr<SpillFile> Create(Schema *schema);
+
+  ~SpillFile();
+
+  void Write(const Row &row);
+
+  // start reading from the first row
+  void Rewind();
+
+  // false after the last row
+  bool Read(Row &row);
+
+  inline size_t GetRowCount() const { return row_count_; }
+
+private:
+  SpillFile(FILE *file, Schema *schema) : file_(file), schema_(schema) {}
+
+  FILE *file_;
+  Schema *schema_;
+  size_t row_count_{0};
+};
+
+#endif  // MINISQL_SPILL_FILE_H
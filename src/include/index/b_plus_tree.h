@@ -8,6 +8,7 @@
 #include "page/b_plus_tree_internal_page.h"
 #include "page/b_plus_tree_leaf_page.h"
 #include "page/b_plus_tree_page.h"
+#include "storage/page_reclaimer.h"
 #include "transaction/transaction.h"
 #include "index/index_iterator.h"
 
@@ -39,8 +40,30 @@ public:
   // Insert a key-value pair into this B+ tree.
   bool Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
-  // Remove a key and its value from this B+ tree.
-  void Remove(const KeyType &key, Transaction *transaction = nullptr);
+  // Build an empty tree bottom-up from items sorted by distinct keys, false if the tree is not empty
+  bool BulkLoad(const std::vector<MappingType> &items);
+
+  // Insert key with a placeholder value unless it is in the tree, leaf_page_id
+  // receives the leaf it went to and freed_pages the count of pages freed so far
+  bool Reserve(const KeyType &key, page_id_t &leaf_page_id, uint64_t &freed_pages);
+
+  // Set the value of a key taken by Reserve in leaf_page_id
+  void Fill(const KeyType &key, const ValueType &value, page_id_t leaf_page_id, uint64_t freed_pages);
+
+  // Insert items sorted by distinct keys with one descent per leaf they land in,
+  // returns how many were inserted before the first key already in the tree
+  size_t InsertSorted(const std::vector<MappingType> &items);
+
+  // Remove a key and its value from this B+ tree, returns whether it was there
+  bool Remove(const KeyType &key, Transaction *transaction = nullptr);
+
+  // Remove sorted distinct keys with one descent per leaf they are in, returns
+  // how many were in the tree
+  size_t RemoveSorted(const std::vector<KeyType> &keys);
+
+  // Set the values of items sorted by distinct keys with one descent per leaf,
+  // returns how many keys were in the tree
+  size_t UpdateSorted(const std::vector<MappingType> &items);
 
   // return the value associated with a given key
   bool GetValue(const KeyType &key, std::vector<ValueType> &result, Transaction *transaction = nullptr);
@@ -49,6 +72,9 @@ public:
 
   INDEXITERATOR_TYPE Begin(const KeyType &key);
 
+  // iterator at the first key not less than the given key
+  INDEXITERATOR_TYPE LowerBound(const KeyType &key);
+
   INDEXITERATOR_TYPE End();
 
   // expose for test purpose
@@ -60,6 +86,12 @@ public:
   // destroy the b plus tree
   void Destroy();
 
+  // empty the tree at once and leave its old pages to reclaimer
+  void Release(PageReclaimer *reclaimer);
+
+  // free the pages of a tree no longer in use, reading only its internal pages
+  static void FreePages(BufferPoolManager *buffer_pool_manager, page_id_t root_page_id);
+
   void PrintTree(std::ofstream &out) {
     if (IsEmpty()) {
       return;
@@ -72,28 +104,46 @@ public:
   }
 
 private:
-  void StartNewTree(const KeyType &key, const ValueType &value);
+  /*
+   * A page pinned on the way down from the root, together with the index of
+   * the child taken in it (unused for the leaf). The whole path stays pinned
+   * until the operation finishes, which replaces parent pointers.
+   */
+  struct PathEntry {
+    BPlusTreePage *page_;
+    int index_;
+  };
 
-  bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+  void FindPath(const KeyType &key, std::vector<PathEntry> &path);
 
-  void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                        Transaction *transaction = nullptr);
+  void ReleasePath(std::vector<PathEntry> &path, bool is_dirty);
+
+  bool LeafBound(const std::vector<PathEntry> &path, KeyType &bound) const;
+
+  void RebalancePath(std::vector<PathEntry> &path);
+
+  bool InsertInto(const KeyType &key, const ValueType &value, page_id_t &leaf_page_id);
+
+  void StartNewTree(const KeyType &key, const ValueType &value);
+
+  bool AppendToRightmostLeaf(const KeyType &key, const ValueType &value);
 
   template<typename N>
-  N *Split(N *node);
+  N *Split(N *node, int left_percent = 50);
 
   template<typename N>
-  bool CoalesceOrRedistribute(N *node, Transaction *transaction = nullptr);
+  bool CoalesceOrRedistribute(N *node, InternalPage *parent, int index, Transaction *transaction = nullptr);
 
   template<typename N>
-  bool Coalesce(N **neighbor_node, N **node, BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent,
-                int index, Transaction *transaction = nullptr);
+  bool Coalesce(N **neighbor_node, N **node, InternalPage **parent, int index, Transaction *transaction = nullptr);
 
   template<typename N>
-  void Redistribute(N *neighbor_node, N *node, int index);
+  void Redistribute(N *neighbor_node, N *node, InternalPage *parent, int index);
 
   bool AdjustRoot(BPlusTreePage *node);
 
+  KeyType Separator(const KeyType &left_last, const KeyType &right_first) const;
+
   void UpdateRootPageId(int flag);
 
   /* Debug Routines for FREE!! */
@@ -101,12 +151,6 @@ private:
 
   void ToString(BPlusTreePage *page, BufferPoolManager *bpm) const;
 
-  KeyType FirstKey(BPlusTreePage *p);
-
-  BPlusTreePage *InsertDown(BPlusTreePage *cur_tree_page,const KeyType &key, const ValueType &value, KeyType &new_key, bool &found);
-
-  KeyType RemoveDown(BPlusTreePage *cur_tree_page, const KeyType &key);
-
   void DestroyDown(BPlusTreePage *cur_tree_page);
 
   // member variable
@@ -116,6 +160,12 @@ private:
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  // rightmost leaf, kept to append increasing keys without a descent
+  page_id_t rightmost_leaf_id_{INVALID_PAGE_ID};
+  // inserts in a row that went past the largest key of the tree
+  int append_streak_{0};
+  // bumped whenever the tree gives up pages, a leaf kept by Reserve is only trusted while it stays the same
+  uint64_t freed_pages_{0};
 };
 
 #endif  // MINISQL_B_PLUS_TREE_H
@@ -2,23 +2,60 @@
 #define MINISQL_B_PLUS_TREE_INDEX_H
 
 #include "index/b_plus_tree.h"
+#include "index/bloom_filter.h"
 #include "index/index.h"
 
 #define BPLUSTREE_INDEX_TYPE BPlusTreeIndex<KeyType, ValueType, KeyComparator>
 
+/**
+ * Unique index on the leading key columns of the key schema. The remaining
+ * include columns are only stored: they are encoded after the key columns, so
+ * a key is found by the byte prefix its key columns encode to.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
 public:
-  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, BufferPoolManager *buffer_pool_manager);
+  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, BufferPoolManager *buffer_pool_manager,
+                 uint32_t include_column_count = 0);
 
   dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
 
   dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) override;
 
+  // sorts the entries and checks their uniqueness on the sorted keys, then
+  // builds an empty tree bottom-up or inserts into a filled one in key order,
+  // descending once per leaf
+  dberr_t InsertEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids, Transaction *txn) override;
+
+  // removes the sorted keys in one left-to-right pass over the leaves
+  dberr_t RemoveEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids, Transaction *txn) override;
+
+  // sets the new row ids in the leaves in one left-to-right pass, the tree
+  // keeps its shape
+  dberr_t RepointEntries(const std::vector<Row> &keys, const std::vector<RowId> &old_row_ids,
+                         const std::vector<RowId> &row_ids, Transaction *txn) override;
+
+  // the key goes into the tree with a placeholder row id, completing it only
+  // sets the row id in the leaf the key went to
+  dberr_t ReserveEntry(const Row &key, IndexReservation &reservation, Transaction *txn) override;
+
+  dberr_t CompleteEntry(const Row &key, RowId row_id, const IndexReservation &reservation, Transaction *txn) override;
+
+  void CancelEntry(const Row &key, const IndexReservation &reservation, Transaction *txn) override;
+
   dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn) override;
 
   dberr_t Destroy() override;
 
+  dberr_t Release(PageReclaimer *reclaimer) override;
+
+  dberr_t ScanRange(const Row &key, const IndexRange &range, std::vector<RowId> &result, Transaction *txn) override;
+
+  dberr_t ScanEntries(const Row &key, const IndexRange &range, std::vector<Row> &result, Transaction *txn) override;
+
+  // probes the keys in key order with one iterator, nearby keys share the leaf
+  dberr_t ScanKeys(const std::vector<Row> &keys, std::vector<std::vector<RowId>> &results, Transaction *txn) override;
+
   INDEXITERATOR_TYPE GetBeginIterator();
 
   INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
@@ -26,10 +63,29 @@ public:
   INDEXITERATOR_TYPE GetEndIterator();
 
 protected:
+  // size the filter for the keys in the tree and add them all
+  void RebuildFilter();
+
+  // entries whose key starts with the first column_count columns of key,
+  // with the next column in range
+  void ScanPrefix(const Row &key, uint32_t column_count, const IndexRange &range, std::vector<MappingType> &result);
+
+  // insert the entry unless its key columns are taken, only reserving the key
+  // when a reservation is given
+  dberr_t InsertKey(const Row &key, RowId row_id, IndexReservation *reservation);
+
+  // whether the filter may hold the key columns of index_key
+  bool FilterMayContain(const KeyType &index_key);
+
+  // number of leading key schema columns the index is unique on
+  uint32_t key_column_count_;
+
   // comparator for key
   KeyComparator comparator_;
   // container
   BPLUSTREE_TYPE container_;
+  // skips the tree descent for most absent keys
+  BloomFilter filter_;
 };
 
 #endif //MINISQL_B_PLUS_TREE_INDEX_H
@@ -0,0 +1,49 @@
+#ifndef MINISQL_BLOOM_FILTER_H
+#define MINISQL_BLOOM_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+
+/**
+ * In-memory Bloom filter over index key bytes, used to answer most lookups of
+ * absent keys without descending the index.
+ *
+ * A plain bit array cannot forget a key, so removals are only counted: the
+ * owner rebuilds the filter from the index once NeedsRebuild() reports that
+ * the filter is either over capacity or holds too many removed keys.
+ */
+class BloomFilter {
+public:
+  explicit BloomFilter(uint32_t bits_per_key = BLOOM_FILTER_BITS_PER_KEY);
+
+  bool IsEnabled() const { return bits_per_key_ > 0; }
+
+  // drop every key and size the filter for expected_keys keys
+  void Reset(size_t expected_keys);
+
+  void Add(const char *data, size_t len);
+
+  void Remove() { removed_keys_++; }
+
+  // false means the key was never added
+  bool MayContain(const char *data, size_t len) const;
+
+  bool NeedsRebuild() const { return keys_ > capacity_ || (removed_keys_ > MIN_CAPACITY && 2 * removed_keys_ > keys_); }
+
+private:
+  static uint64_t Hash(const char *data, size_t len);
+
+  static constexpr size_t MIN_CAPACITY = 1024;
+
+  uint32_t bits_per_key_;
+  uint32_t num_probes_;
+  size_t capacity_{0};
+  size_t keys_{0};
+  size_t removed_keys_{0};
+  std::vector<uint64_t> bits_;
+};
+
+#endif  // MINISQL_BLOOM_FILTER_H
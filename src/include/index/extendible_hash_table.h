@@ -0,0 +1,87 @@
+#ifndef MINISQL_EXTENDIBLE_HASH_TABLE_H
+#define MINISQL_EXTENDIBLE_HASH_TABLE_H
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "page/hash_table_bucket_page.h"
+#include "page/hash_table_directory_page.h"
+#include "storage/page_reclaimer.h"
+#include "transaction/transaction.h"
+
+#define HASH_TABLE_TYPE ExtendibleHashTable<KeyType, ValueType, KeyComparator>
+
+/**
+ * Disk-based extendible hash table for unique keys.
+ *
+ * A point lookup reads the directory page and one bucket page, independent of
+ * the number of keys. A full bucket is split in two by one more hash bit,
+ * doubling the directory when the bucket already uses all directory bits; past
+ * the largest directory a full bucket chains overflow pages instead. An
+ * emptied bucket is merged back into its split image and the directory is
+ * halved when possible. The directory page id is kept in the index roots page
+ * under the index id, like the root of a B+ tree.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class ExtendibleHashTable {
+  using BucketPage = HashTableBucketPage<KeyType, ValueType, KeyComparator>;
+
+public:
+  explicit ExtendibleHashTable(index_id_t index_id, BufferPoolManager *buffer_pool_manager,
+                               const KeyComparator &comparator);
+
+  bool IsEmpty() const;
+
+  // Insert a key-value pair, false if the key exists
+  bool Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // Remove a key and its value, false if the key does not exist
+  bool Remove(const KeyType &key, Transaction *transaction = nullptr);
+
+  // return the value associated with a given key
+  bool GetValue(const KeyType &key, std::vector<ValueType> &result, Transaction *transaction = nullptr);
+
+  // set the value of a key in its bucket, false if the key is absent
+  bool Update(const KeyType &key, const ValueType &value);
+
+  uint32_t GetGlobalDepth();
+
+  // used to check whether all pages are unpinned
+  bool Check();
+
+  // destroy the hash table
+  void Destroy();
+
+  // empty the table at once and leave its old pages to reclaimer
+  void Release(PageReclaimer *reclaimer);
+
+  // free the directory and bucket pages of a table no longer in use
+  static void FreePages(BufferPoolManager *buffer_pool_manager, page_id_t directory_page_id);
+
+  static uint32_t Hash(const KeyType &key);
+
+private:
+  void StartNewTable();
+
+  HashTableDirectoryPage *FetchDirectoryPage();
+
+  BucketPage *FetchBucketPage(page_id_t bucket_page_id);
+
+  void InsertIntoChain(page_id_t room_page_id, page_id_t last_page_id, const KeyType &key, uint32_t hash,
+                       const ValueType &value);
+
+  void Merge(HashTableDirectoryPage *directory, uint32_t bucket_idx);
+
+  // free a bucket page and its overflow pages
+  static void FreeBucket(BufferPoolManager *buffer_pool_manager, page_id_t bucket_page_id);
+
+  void UpdateDirectoryPageId(int flag);
+
+  // member variable
+  index_id_t index_id_;
+  page_id_t directory_page_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+};
+
+#endif  // MINISQL_EXTENDIBLE_HASH_TABLE_H
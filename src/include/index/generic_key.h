@@ -1,27 +1,96 @@
 #ifndef MINISQL_GENERIC_KEY_H
 #define MINISQL_GENERIC_KEY_H
 
+#include <algorithm>
 #include <cstring>
+#include <type_traits>
 
 #include "record/row.h"
 #include "record/field.h"
 
+/**
+ * Index keys are encoded so that memcmp on the key bytes gives the key order:
+ * each column starts with a null flag (0 null, 1 not null, so nulls sort first)
+ * followed by
+ *   int   : 4 bytes big-endian with the sign bit flipped
+ *   float : 4 bytes big-endian IEEE bits, all bits flipped for negatives and
+ *           only the sign bit flipped otherwise
+ *   char  : the raw bytes terminated by a single 0 (char values come from
+ *           C strings and never contain 0)
+ * The rest of the buffer is zero-filled.
+ */
 template<size_t KeySize>
 class GenericKey {
 public:
-  inline void SerializeFromKey(const Row &key, Schema *schema) {
-    // initialize to 0
-    uint32_t size = key.GetSerializedSize(schema);
-    ASSERT(key.GetFieldCount() == schema->GetColumnCount(), "field nums not match.");
-    if(size > KeySize) printf("Index key size exceed max key size.");
+  inline uint32_t SerializeFromKey(const Row &key, Schema *schema) {
+    return SerializeFromKey(key, schema, key.GetFieldCount());
+  }
+
+  /**
+   * Encode the first column_count fields of key, which may be fewer than the
+   * schema columns. Encoded columns are prefix free, so the result is a byte
+   * prefix of every key agreeing on those columns.
+   * @return: bytes written
+   */
+  inline uint32_t SerializeFromKey(const Row &key, Schema *schema, uint32_t column_count) {
+    ASSERT(column_count <= key.GetFieldCount() && column_count <= schema->GetColumnCount(), "field nums not match.");
     memset(data, 0, KeySize);
-    key.SerializeTo(data, schema);
+    uint32_t ofs = 0;
+    for (uint32_t i = 0; i < column_count; i++) {
+      Field *field = key.GetField(i);
+      uint32_t size = field->IsNull() ? 1 : 1 + EncodedSize(*field);
+      if (ofs + size > KeySize) {
+        printf("Index key size exceed max key size.");
+        return ofs;
+      }
+      ofs += EncodeField(*field, data + ofs);
+    }
+    return ofs;
+  }
+
+  /**
+   * Bytes taken by the first column_count columns of the encoded key
+   */
+  inline uint32_t PrefixLength(Schema *schema, uint32_t column_count) const {
+    uint32_t ofs = 0;
+    for (uint32_t i = 0; i < column_count && ofs < KeySize; i++) {
+      if (data[ofs++] == 0) continue;
+      if (schema->GetColumn(i)->GetType() == TypeId::kTypeChar) {
+        ofs += strnlen(data + ofs, KeySize - ofs) + 1;
+      } else {
+        ofs += sizeof(uint32_t);
+      }
+    }
+    return std::min<uint32_t>(ofs, KeySize);
   }
 
   inline void DeserializeToKey(Row &key, Schema *schema) const {
-    uint32_t ofs = key.DeserializeFrom(const_cast<char *>(data), schema);
-    if(ofs > KeySize) printf("Index key size exceed max key size.");
-    return;
+    auto &fields = key.GetFields();
+    fields.clear();
+    uint32_t ofs = 0;
+    for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+      TypeId type = schema->GetColumn(i)->GetType();
+      if (data[ofs++] == 0) {
+        fields.push_back(ALLOC_P(key.GetHeap(), Field)(type));
+        continue;
+      }
+      if (type == TypeId::kTypeChar) {
+        uint32_t len = strnlen(data + ofs, KeySize - ofs);
+        fields.push_back(ALLOC_P(key.GetHeap(), Field)(type, const_cast<char *>(data + ofs), len, true));
+        ofs += len + 1;
+        continue;
+      }
+      uint32_t bits = ReadBigEndian(data + ofs);
+      ofs += sizeof(uint32_t);
+      if (type == TypeId::kTypeInt) {
+        fields.push_back(ALLOC_P(key.GetHeap(), Field)(type, static_cast<int32_t>(bits ^ 0x80000000u)));
+      } else {
+        bits = (bits & 0x80000000u) ? (bits ^ 0x80000000u) : ~bits;
+        float value;
+        memcpy(&value, &bits, sizeof(float));
+        fields.push_back(ALLOC_P(key.GetHeap(), Field)(type, value));
+      }
+    }
   }
 
   // compare
@@ -42,8 +111,60 @@ public:
     return os;
   }
 
+  /**
+   * Bytes of the encoded value (without the null flag) of a non-null field
+   */
+  static inline uint32_t EncodedSize(const Field &field) {
+    return field.GetTypeId() == TypeId::kTypeChar ? CharLength(field) + 1 : sizeof(uint32_t);
+  }
+
+  /**
+   * Length of a char value up to its first 0, fields built from C strings may
+   * count the terminator
+   */
+  static inline uint32_t CharLength(const Field &field) {
+    return strnlen(field.GetData(), field.GetLength());
+  }
+
+  /**
+   * Encode field into buf, return bytes written
+   */
+  static inline uint32_t EncodeField(const Field &field, char *buf) {
+    if (field.IsNull()) {
+      buf[0] = 0;
+      return 1;
+    }
+    buf[0] = 1;
+    if (field.GetTypeId() == TypeId::kTypeChar) {
+      uint32_t len = CharLength(field);
+      memcpy(buf + 1, field.GetData(), len);
+      buf[1 + len] = 0;
+      return len + 2;
+    }
+    uint32_t bits;
+    if (field.GetTypeId() == TypeId::kTypeInt) {
+      bits = static_cast<uint32_t>(field.value_.integer_) ^ 0x80000000u;
+    } else {
+      memcpy(&bits, &field.value_.float_, sizeof(float));
+      bits = (bits & 0x80000000u) ? ~bits : (bits ^ 0x80000000u);
+    }
+    WriteBigEndian(buf + 1, bits);
+    return 1 + sizeof(uint32_t);
+  }
+
   // actual location of data, extends past the end.
   char data[KeySize];
+
+private:
+  static inline void WriteBigEndian(char *buf, uint32_t v) {
+    for (int i = 3; i >= 0; i--, v >>= 8) buf[i] = static_cast<char>(v & 0xff);
+  }
+
+  static inline uint32_t ReadBigEndian(const char *buf) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v = v << 8 | static_cast<unsigned char>(buf[i]);
+    return v;
+  }
 };
 
 /**
@@ -54,24 +175,7 @@ class GenericComparator {
 public:
   inline int operator()(const GenericKey<KeySize> &lhs,
                         const GenericKey<KeySize> &rhs) const {
-    int column_count = key_schema_->GetColumnCount();
-    Row lhs_key(INVALID_ROWID);
-    Row rhs_key(INVALID_ROWID);
-    lhs.DeserializeToKey(lhs_key, key_schema_);
-    rhs.DeserializeToKey(rhs_key, key_schema_);
-
-    for (int i = 0; i < column_count; i++) {
-      Field *lhs_value = lhs_key.GetField(i);
-      Field *rhs_value = rhs_key.GetField(i);
-
-      if (lhs_value->CompareLessThan(*rhs_value) == CmpBool::kTrue)
-        return -1;
-
-      if (lhs_value->CompareGreaterThan(*rhs_value) == CmpBool::kTrue)
-        return 1;
-    }
-    // equals
-    return 0;
+    return memcmp(lhs.data, rhs.data, KeySize);
   }
 
   GenericComparator(const GenericComparator &other) {
@@ -85,4 +189,14 @@ private:
   Schema *key_schema_;
 };
 
+/**
+ * Whether KeyComparator orders keys exactly like memcmp on their bytes, which
+ * lets the tree build truncated separators.
+ */
+template<typename KeyComparator>
+struct IsByteComparable : std::false_type {};
+
+template<size_t KeySize>
+struct IsByteComparable<GenericComparator<KeySize>> : std::true_type {};
+
 #endif  // MINISQL_GENERIC_KEY_H
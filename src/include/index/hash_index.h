@@ -0,0 +1,39 @@
+#ifndef MINISQL_HASH_INDEX_H
+#define MINISQL_HASH_INDEX_H
+
+#include "index/extendible_hash_table.h"
+#include "index/index.h"
+
+#define HASH_INDEX_TYPE HashIndex<KeyType, ValueType, KeyComparator>
+
+/**
+ * Unique index answering equality lookups with an extendible hash table.
+ * It keeps no key order, so it cannot serve range scans.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class HashIndex : public Index {
+public:
+  HashIndex(index_id_t index_id, IndexSchema *key_schema, BufferPoolManager *buffer_pool_manager);
+
+  dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  // rewrites the row ids in their buckets, no bucket splits or merges
+  dberr_t RepointEntries(const std::vector<Row> &keys, const std::vector<RowId> &old_row_ids,
+                         const std::vector<RowId> &row_ids, Transaction *txn) override;
+
+  dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn) override;
+
+  dberr_t Destroy() override;
+
+  dberr_t Release(PageReclaimer *reclaimer) override;
+
+protected:
+  // comparator for key
+  KeyComparator comparator_;
+  // container
+  HASH_TABLE_TYPE container_;
+};
+
+#endif  // MINISQL_HASH_INDEX_H
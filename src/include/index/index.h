@@ -1,12 +1,43 @@
 #ifndef MINISQL_INDEX_H
 #define MINISQL_INDEX_H
 
+#include <cstdint>
 #include <memory>
 
 #include "common/dberr.h"
 #include "record/row.h"
+#include "storage/page_reclaimer.h"
 #include "transaction/transaction.h"
 
+/**
+ * Access method of an index, chosen with CREATE INDEX ... USING
+ */
+enum IndexType {
+  kIndexBPlusTree = 0, kIndexHash
+};
+
+/**
+ * Bounds on the index column that follows an equality prefix, a null bound
+ * is open. A scan stops after limit_ entries.
+ */
+struct IndexRange {
+  const Field *low_{nullptr};
+  bool low_inclusive_{true};
+  const Field *high_{nullptr};
+  bool high_inclusive_{true};
+  size_t limit_{SIZE_MAX};
+};
+
+/**
+ * Key claimed by Index::ReserveEntry for a row not in the heap yet, with the
+ * leaf it went to when the index can complete it there, and how many pages the
+ * index had freed then to tell if that leaf may be gone
+ */
+struct IndexReservation {
+  page_id_t leaf_page_id_{INVALID_PAGE_ID};
+  uint64_t freed_pages_{0};
+};
+
 class Index {
 public:
   explicit Index(index_id_t index_id, IndexSchema *key_schema)
@@ -18,10 +49,103 @@ public:
 
   virtual dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) = 0;
 
+  /**
+   * Insert the entries (keys[i], row_ids[i]) all or none: if one of them fails,
+   * those inserted before are removed again and its status is returned,
+   * DB_KEY_ALREADY_EXIST for a key taken
+   */
+  virtual dberr_t InsertEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids, Transaction *txn) {
+    for (size_t i = 0; i < keys.size(); i++) {
+      dberr_t status = InsertEntry(keys[i], row_ids[i], txn);
+      if (status == DB_SUCCESS) continue;
+      while (i-- > 0) RemoveEntry(keys[i], row_ids[i], txn);
+      return status;
+    }
+    return DB_SUCCESS;
+  }
+
+  /**
+   * Remove the entries (keys[i], row_ids[i]), keys not in the index are skipped
+   */
+  virtual dberr_t RemoveEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids, Transaction *txn) {
+    for (size_t i = 0; i < keys.size(); i++) RemoveEntry(keys[i], row_ids[i], txn);
+    return DB_SUCCESS;
+  }
+
+  /**
+   * Point the entries of keys from old_row_ids to row_ids, for rows that moved
+   * unchanged. By default the entries are removed and inserted again, and the
+   * old ones are put back if the insert fails, so the index is left either
+   * way as a whole.
+   */
+  virtual dberr_t RepointEntries(const std::vector<Row> &keys, const std::vector<RowId> &old_row_ids,
+                                 const std::vector<RowId> &row_ids, Transaction *txn) {
+    RemoveEntries(keys, old_row_ids, txn);
+    if (InsertEntries(keys, row_ids, txn) == DB_SUCCESS) return DB_SUCCESS;
+    InsertEntries(keys, old_row_ids, txn);
+    return DB_FAILED;
+  }
+
+  /**
+   * Claim key for a row about to be inserted, DB_KEY_ALREADY_EXIST if the key
+   * is taken.
+   * Once the row has its id CompleteEntry adds the entry, and CancelEntry
+   * gives the key up if the row is not inserted after all. Indexes able to
+   * insert a placeholder find the key once; by default the key is only
+   * checked here and inserted on completion.
+   */
+  virtual dberr_t ReserveEntry(const Row &key, IndexReservation &reservation, Transaction *txn) {
+    std::vector<RowId> result;
+    return ScanKey(key, result, txn) == DB_KEY_NOT_FOUND ? DB_SUCCESS : DB_KEY_ALREADY_EXIST;
+  }
+
+  virtual dberr_t CompleteEntry(const Row &key, RowId row_id, const IndexReservation &reservation, Transaction *txn) {
+    return InsertEntry(key, row_id, txn);
+  }
+
+  virtual void CancelEntry(const Row &key, const IndexReservation &reservation, Transaction *txn) {}
+
   virtual dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn) = 0;
 
+  /**
+   * ScanKey for each of keys, results[i] receives the row ids matching keys[i]
+   */
+  virtual dberr_t ScanKeys(const std::vector<Row> &keys, std::vector<std::vector<RowId>> &results, Transaction *txn) {
+    results.assign(keys.size(), {});
+    for (size_t i = 0; i < keys.size(); i++) {
+      ScanKey(keys[i], results[i], txn);
+    }
+    return DB_SUCCESS;
+  }
+
   virtual dberr_t Destroy() = 0;
 
+  /**
+   * Empty the index at once and leave freeing its old pages to reclaimer, for
+   * TRUNCATE and DROP. Indexes that cannot hand their pages over free them
+   * right away with Destroy.
+   */
+  virtual dberr_t Release(PageReclaimer *reclaimer) {
+    return Destroy();
+  }
+
+  /**
+   * Row ids of the entries whose leading key columns equal the fields of key
+   * and whose next key column lies in range, in key order.
+   */
+  virtual dberr_t ScanRange(const Row &key, const IndexRange &range, std::vector<RowId> &result, Transaction *txn) {
+    return DB_FAILED;
+  }
+
+  /**
+   * Like ScanRange, but decode the stored columns of the entries into rows
+   * carrying the row ids, so a query reading only those columns skips the
+   * table heap.
+   */
+  virtual dberr_t ScanEntries(const Row &key, const IndexRange &range, std::vector<Row> &result, Transaction *txn) {
+    return DB_FAILED;
+  }
+
 protected:
   index_id_t index_id_;
   IndexSchema *key_schema_;
@@ -15,8 +15,13 @@ public:
   // you may define your own constructor based on your member variables
   explicit IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *leaf, int index);
 
+  IndexIterator(IndexIterator &&other) noexcept;
+
   ~IndexIterator();
 
+  // the leaf pinned by this iterator is released, other's is taken over
+  IndexIterator &operator=(IndexIterator &&other) noexcept;
+
   /** Return the key/value pair this iterator is currently pointing at. */
   const MappingType &operator*();
 
@@ -29,11 +34,21 @@ public:
   /** Return whether two iterators are not equal. */
   bool operator!=(const IndexIterator &itr) const;
 
+  /**
+   * Move to the first key not less than key if it is on the current leaf,
+   * keys sought must not decrease. A lookup close to the last one is answered
+   * without descending the tree again.
+   * @return false if key is past the current leaf, the iterator is unchanged
+   */
+  bool Seek(const KeyType &key);
+
 private:
   // add your own private member variables here
   BPlusTree<KeyType, ValueType, KeyComparator> *tree_;
   BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *leaf_;
   int index_;
+  // keys are stored trimmed in the leaf, current pair is materialized here
+  MappingType item_;
 };
 
 
@@ -5,37 +5,70 @@
 #include "page/b_plus_tree_page.h"
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 24
-#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)) - 1)
+#define INTERNAL_PAGE_HEADER_SIZE 32
+#define INTERNAL_PAGE_ENTRY_SIZE (sizeof(uint32_t) + sizeof(BPlusTreeKeySlot) + sizeof(page_id_t))
+#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / INTERNAL_PAGE_ENTRY_SIZE - 1)
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
  * K(i) <= K < K(i+1).
  * NOTE: since the number of keys does not equal to number of child pointers,
  * the first key always remains invalid. That is to say, any search/lookup
- * should ignore the first key.
+ * should ignore the first key. The invalid first key is stored with zero length
+ * except right after MoveHalfTo/MoveFirstToEndOf, where it carries the key to
+ * be pushed into the parent until the tree clears it.
  *
- * Internal page format (keys are stored in increasing order):
- *  --------------------------------------------------------------------------
- * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
- *  --------------------------------------------------------------------------
+ * Internal page format (structure of arrays: the three arrays are packed one
+ * after another and shifted as the page grows, key bytes grow backward from
+ * the end of the page):
+ *  -------------------------------------------------------------------------------
+ * | HEADER | HEAD(0..n) | KEY_SLOT(0..n) | PAGE_ID(0..n) | FREE | KEY(n) ... KEY(0) |
+ *  -------------------------------------------------------------------------------
+ *  Head: first 4 bytes of the key as an order preserving unsigned integer
+ *  Key slot format: | KeyOffset (2) | KeyLength (2) |
+ *
+ *  Header format (size in byte, 32 bytes in total, padded so that the heads
+ *  start 16-byte aligned):
+ *  ---------------------------------------------------------------------
+ * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
+ *  ---------------------------------------------------------------------
+ *  ----------------------------------------------
+ * | PageId (4) | KeyHeapBegin (4) | Padding (8) |
+ *  ----------------------------------------------
+ *
+ * Lookup only touches the contiguous heads: a binary search narrows them down
+ * to a few cache lines that are scanned with SIMD compares, and full keys are
+ * compared only among entries whose heads tie with the search key.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
+  using KeySlot = BPlusTreeKeySlot;
+
 public:
   // must call initialize method after "create" a new node
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
+  void Init(page_id_t page_id, int max_size = INTERNAL_PAGE_SIZE);
 
   KeyType KeyAt(int index) const;
 
   void SetKeyAt(int index, const KeyType &key);
 
+  bool CanSetKeyAt(int index, const KeyType &key) const;
+
   int ValueIndex(const ValueType &value) const;
 
   ValueType ValueAt(int index) const;
 
   ValueType Lookup(const KeyType &key, const KeyComparator &comparator) const;
 
+  int LookupIndex(const KeyType &key, const KeyComparator &comparator) const;
+
+  // space accounting
+  bool HasRoomFor(const KeyType &key) const;
+
+  bool IsUnderflow() const;
+
+  bool CanMergeWith(const BPlusTreeInternalPage *sibling, const KeyType &middle_key) const;
+
   void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
 
   int InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
@@ -45,26 +78,51 @@ public:
   ValueType RemoveAndReturnOnlyChild();
 
   // Split and Merge utility methods
-  void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key, BufferPoolManager *buffer_pool_manager);
+  void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
 
-  void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
+  void MoveHalfTo(BPlusTreeInternalPage *recipient, int left_percent = 50);
 
-  void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                        BufferPoolManager *buffer_pool_manager);
+  void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
 
-  void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                         BufferPoolManager *buffer_pool_manager);
+  void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
 
-  MappingType *GetData() {return array_;}
-  
 private:
-  void CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
+  void CopyNFrom(const BPlusTreeInternalPage *src, int begin, int end);
+
+  void CopyLastFrom(const std::pair<KeyType, ValueType> &pair);
+
+  void CopyFirstFrom(const std::pair<KeyType, ValueType> &pair);
+
+  void InsertAt(int index, const KeyType &key, const ValueType &value);
+
+  void OpenEntry(int index);
+
+  void CloseEntry(int index);
+
+  void RemoveKeyBytes(int index);
+
+  void Truncate(int size);
+
+  const char *PageBase() const { return reinterpret_cast<const char *>(this); }
+
+  char *PageBase() { return reinterpret_cast<char *>(this); }
+
+  const KeySlot *KeySlots() const { return reinterpret_cast<const KeySlot *>(heads_ + GetSize()); }
+
+  KeySlot *KeySlots() { return reinterpret_cast<KeySlot *>(heads_ + GetSize()); }
+
+  const ValueType *Children() const { return reinterpret_cast<const ValueType *>(KeySlots() + GetSize()); }
+
+  ValueType *Children() { return reinterpret_cast<ValueType *>(KeySlots() + GetSize()); }
+
+  uint32_t EntryBytes(int index) const { return INTERNAL_PAGE_ENTRY_SIZE + KeySlots()[index].key_length_; }
 
-  void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
+  uint32_t UsedBytes() const;
 
-  void CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
+  uint32_t FreeBytes() const;
 
-  MappingType array_[0];
+  uint32_t key_heap_begin_;
+  alignas(16) uint32_t heads_[0];
 };
 
 #endif  // MINISQL_B_PLUS_TREE_INTERNAL_PAGE_H
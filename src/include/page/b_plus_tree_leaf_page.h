@@ -8,18 +8,28 @@
  * see include/common/rid.h for detailed implementation) together within leaf
  * page. Only support unique key.
 
- * Leaf page format (keys are stored in order):
- *  ----------------------------------------------------------------------
- * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
- *  ----------------------------------------------------------------------
+ * Leaf page format (slots are stored in key order, key bytes grow backward
+ * from the end of the page):
+ *  -------------------------------------------------------------------------------
+ * | HEADER | SLOT(1) | SLOT(2) | ... | SLOT(n) | FREE | SUFFIX(n) ... | PREFIX |
+ *  -------------------------------------------------------------------------------
+ *  Slot format: | KeyOffset (2) | KeyLength (2) | RID |
  *
- *  Header format (size in byte, 24 bytes in total):
+ *  Header format (size in byte, 32 bytes in total):
  *  ---------------------------------------------------------------------
- * | PageType (4) | CurrentSize (4) | MaxSize (4) | ParentPageId (4) |
+ * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  ------------------------------
- * | PageId (4) | NextPageId (4)
- *  ------------------------------
+ *  -----------------------------------------------------------------------------
+ * | PageId (4) | NextPageId (4) | KeyHeapBegin (4) | PrefixOffset (2) | PrefixLength (2) |
+ *  -----------------------------------------------------------------------------
+ *
+ * Prefix compression: the bytes all keys of the page share are stored once as
+ * the page prefix, and each slot only points to the rest of its key. The
+ * prefix is recomputed whenever the page is rebuilt (split, merge), and
+ * shrunk when an inserted key does not share it.
+ *
+ * A page is full when it either holds MaxSize entries or has no room left for
+ * the slot and the key bytes of a new entry.
  */
 #include <utility>
 #include <vector>
@@ -27,15 +37,17 @@
 #include "page/b_plus_tree_page.h"
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
-#define LEAF_PAGE_SIZE (((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType)) - 1)
+#define LEAF_PAGE_HEADER_SIZE 32
+#define LEAF_PAGE_SIZE (((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(BPlusTreeSlot<ValueType>)) - 1)
 
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
+  using Slot = BPlusTreeSlot<ValueType>;
+
 public:
   // After creating a new leaf page from buffer pool, must call initialize
   // method to set default values
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE);
+  void Init(page_id_t page_id, int max_size = LEAF_PAGE_SIZE);
 
   // helper methods
   page_id_t GetNextPageId() const;
@@ -44,9 +56,20 @@ public:
 
   KeyType KeyAt(int index) const;
 
+  ValueType ValueAt(int index) const;
+
+  void SetValueAt(int index, const ValueType &value);
+
   int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
 
-  const MappingType &GetItem(int index);
+  MappingType GetItem(int index) const;
+
+  // space accounting
+  bool HasRoomFor(const KeyType &key) const;
+
+  bool IsUnderflow() const;
+
+  bool CanMergeWith(const BPlusTreeLeafPage *sibling) const;
 
   // insert and delete methods
   int Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
@@ -55,8 +78,10 @@ public:
 
   int RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator);
 
+  int RemoveRecords(const KeyType *keys, int count, const KeyComparator &comparator);
+
   // Split and Merge utility methods
-  void MoveHalfTo(BPlusTreeLeafPage *recipient);
+  void MoveHalfTo(BPlusTreeLeafPage *recipient, int left_percent = 50);
 
   void MoveAllTo(BPlusTreeLeafPage *recipient);
 
@@ -64,19 +89,40 @@ public:
 
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
 
-  MappingType *GetData() {return array_;}
-  
-  void Arrange(BPlusTreeLeafPage *recipient);
-
 private:
-  void CopyNFrom(MappingType *items, int size);
+  void CopyNFrom(const std::vector<MappingType> &items);
 
   void CopyLastFrom(const MappingType &item);
 
   void CopyFirstFrom(const MappingType &item);
 
+  std::vector<MappingType> GetItems(int begin, int end) const;
+
+  void Rebuild(const std::vector<MappingType> &items);
+
+  void InsertAt(int index, const KeyType &key, const ValueType &value);
+
+  void RemoveAt(int index);
+
+  uint16_t CommonPrefixLength(const KeyType &key) const;
+
+  uint16_t SuffixLength(const KeyType &key, uint16_t prefix_length) const;
+
+  const char *PageBase() const { return reinterpret_cast<const char *>(this); }
+
+  char *PageBase() { return reinterpret_cast<char *>(this); }
+
+  uint32_t EntryBytes(int index) const { return sizeof(Slot) + array_[index].key_length_; }
+
+  uint32_t UsedBytes() const;
+
+  uint32_t FreeBytes() const;
+
   page_id_t next_page_id_;
-  MappingType array_[0];
+  uint32_t key_heap_begin_;
+  uint16_t prefix_offset_;
+  uint16_t prefix_length_;
+  Slot array_[0];
 };
 
 #endif  // MINISQL_B_PLUS_TREE_LEAF_PAGE_H
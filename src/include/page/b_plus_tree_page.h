@@ -16,25 +16,60 @@ enum class IndexPageType {
   INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE
 };
 
+/**
+ * Slot directory entry shared by leaf and internal pages.
+ *
+ * B+ tree pages are slotted: the slot directory grows forward right after the
+ * page header while key bytes are packed into a heap growing backward from the
+ * end of the page. A key is stored with its trailing zero padding trimmed, so
+ * a GenericKey<N> only occupies as many bytes as its serialized row needs and
+ * fanout depends on actual key lengths instead of the padded key class size.
+ */
+template<typename ValueType>
+struct BPlusTreeSlot {
+  uint16_t key_offset_;
+  uint16_t key_length_;
+  ValueType value_;
+};
+
+/**
+ * Key part of a slot, for pages that keep the values in a separate array.
+ */
+struct BPlusTreeKeySlot {
+  uint16_t key_offset_;
+  uint16_t key_length_;
+};
+
+/**
+ * Number of bytes a key occupies inside the key heap (trailing zeros trimmed).
+ */
+template<typename KeyType>
+inline uint16_t StoredKeyLength(const KeyType &key) {
+  auto bytes = reinterpret_cast<const char *>(&key);
+  uint16_t len = sizeof(KeyType);
+  while (len > 0 && bytes[len - 1] == 0) len--;
+  return len;
+}
+
 /**
  * Both internal and leaf page are inherited from this page.
  *
  * It actually serves as a header part for each B+ tree page and
  * contains information shared by both leaf page and internal page.
  *
- * Header format (size in byte, 24 bytes in total):
- * ----------------------------------------------------------------------------
- * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
+ * Header format (size in byte, 20 bytes in total):
  * ----------------------------------------------------------------------------
- * | ParentPageId (4) | PageId(4) |
+ * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) | PageId(4) |
  * ----------------------------------------------------------------------------
+ *
+ * Pages keep no parent pointer: the tree remembers the pages it passed on the
+ * way down, so moving children between internal pages never has to fetch
+ * them.
  */
 class BPlusTreePage {
 public:
   bool IsLeafPage() const;
 
-  bool IsRootPage() const;
-
   void SetPageType(IndexPageType page_type);
 
   int GetSize() const;
@@ -49,10 +84,6 @@ public:
 
   int GetMinSize() const;
 
-  page_id_t GetParentPageId() const;
-
-  void SetParentPageId(page_id_t parent_page_id);
-
   page_id_t GetPageId() const;
 
   void SetPageId(page_id_t page_id);
@@ -65,7 +96,6 @@ private:
   [[maybe_unused]] lsn_t lsn_;
   [[maybe_unused]] int size_;
   [[maybe_unused]] int max_size_;
-  [[maybe_unused]] page_id_t parent_page_id_;
   [[maybe_unused]] page_id_t page_id_;
 };
 
@@ -0,0 +1,96 @@
+#ifndef MINISQL_HASH_TABLE_BUCKET_PAGE_H
+#define MINISQL_HASH_TABLE_BUCKET_PAGE_H
+
+/**
+ * hash_table_bucket_page.h
+ *
+ * Bucket page of an extendible hash index. Entries are unordered; each slot
+ * caches the full hash of its key so lookups only compare keys whose hash
+ * matches, and bucket splits never rehash. A bucket that can no longer split
+ * continues in overflow pages of the same format linked by NextPageId.
+ *
+ * Bucket page format (key bytes grow backward from the end of the page, with
+ * trailing zeros trimmed like in B+ tree pages):
+ *  ------------------------------------------------------------------
+ * | HEADER | SLOT(1) | SLOT(2) | ... | SLOT(n) | FREE | KEY(n) ... KEY(1) |
+ *  ------------------------------------------------------------------
+ *  Slot format: | Hash (4) | KeyOffset (2) | KeyLength (2) | RID |
+ *
+ *  Header format (size in byte, 12 bytes in total):
+ *  ------------------------------------------------------
+ * | CurrentSize (4) | KeyHeapBegin (4) | NextPageId (4) |
+ *  ------------------------------------------------------
+ */
+#include "page/b_plus_tree_page.h"
+
+#define HASH_TABLE_BUCKET_TYPE HashTableBucketPage<KeyType, ValueType, KeyComparator>
+#define HASH_BUCKET_PAGE_HEADER_SIZE 12
+
+template<typename ValueType>
+struct HashBucketSlot {
+  uint32_t hash_;
+  uint16_t key_offset_;
+  uint16_t key_length_;
+  ValueType value_;
+};
+
+INDEX_TEMPLATE_ARGUMENTS
+class HashTableBucketPage {
+  using Slot = HashBucketSlot<ValueType>;
+
+public:
+  // After creating a new bucket page from buffer pool, must call initialize
+  // method to set default values
+  void Init();
+
+  int GetSize() const { return size_; }
+
+  bool IsEmpty() const { return size_ == 0; }
+
+  // next overflow page of the bucket, INVALID_PAGE_ID at the end of the chain
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  KeyType KeyAt(int index) const;
+
+  ValueType ValueAt(int index) const { return array_[index].value_; }
+
+  void SetValueAt(int index, const ValueType &value) { array_[index].value_ = value; }
+
+  uint32_t HashAt(int index) const { return array_[index].hash_; }
+
+  // index of the entry with the given key, -1 if absent
+  int KeyIndex(const KeyType &key, uint32_t hash, const KeyComparator &comparator) const;
+
+  bool Lookup(const KeyType &key, uint32_t hash, ValueType &value, const KeyComparator &comparator) const;
+
+  bool HasRoomFor(const KeyType &key) const;
+
+  // append an entry, the caller has checked it is absent and fits
+  void Insert(const KeyType &key, uint32_t hash, const ValueType &value);
+
+  bool Remove(const KeyType &key, uint32_t hash, const KeyComparator &comparator);
+
+  // move the entries whose hash has hash_bit set into the empty recipient
+  void SplitTo(HashTableBucketPage *recipient, uint32_t hash_bit);
+
+  // take over the entries and the chain link of another page
+  void CopyFrom(const HashTableBucketPage *other) { memcpy(PageBase(), other->PageBase(), PAGE_SIZE); }
+
+private:
+  void RemoveAt(int index);
+
+  const char *PageBase() const { return reinterpret_cast<const char *>(this); }
+
+  char *PageBase() { return reinterpret_cast<char *>(this); }
+
+  uint32_t FreeBytes() const { return key_heap_begin_ - HASH_BUCKET_PAGE_HEADER_SIZE - size_ * sizeof(Slot); }
+
+  uint32_t size_;
+  uint32_t key_heap_begin_;
+  page_id_t next_page_id_;
+  Slot array_[0];
+};
+
+#endif  // MINISQL_HASH_TABLE_BUCKET_PAGE_H
@@ -0,0 +1,71 @@
+#ifndef MINISQL_HASH_TABLE_DIRECTORY_PAGE_H
+#define MINISQL_HASH_TABLE_DIRECTORY_PAGE_H
+
+#include <cstdint>
+
+#include "common/config.h"
+
+#define HASH_DIRECTORY_MAX_DEPTH 9
+#define HASH_DIRECTORY_ARRAY_SIZE (1 << HASH_DIRECTORY_MAX_DEPTH)
+
+/**
+ * Directory page of an extendible hash index.
+ *
+ * The lowest GlobalDepth bits of a key hash select a directory slot, and each
+ * slot points to a bucket page. A bucket with local depth d is shared by the
+ * 2^(GlobalDepth - d) slots agreeing on the lowest d hash bits.
+ *
+ * Directory page format (size in byte):
+ *  --------------------------------------------------------------------------
+ * | PageId (4) | LSN (4) | GlobalDepth (4) | LocalDepths (512) | BucketPageIds (2048) |
+ *  --------------------------------------------------------------------------
+ */
+class HashTableDirectoryPage {
+public:
+  void Init(page_id_t page_id);
+
+  page_id_t GetPageId() const { return page_id_; }
+
+  uint32_t GetGlobalDepth() const { return global_depth_; }
+
+  uint32_t GetGlobalDepthMask() const { return (1u << global_depth_) - 1; }
+
+  // number of directory slots in use
+  uint32_t Size() const { return 1u << global_depth_; }
+
+  page_id_t GetBucketPageId(uint32_t bucket_idx) const { return bucket_page_ids_[bucket_idx]; }
+
+  void SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id) { bucket_page_ids_[bucket_idx] = bucket_page_id; }
+
+  uint32_t GetLocalDepth(uint32_t bucket_idx) const { return local_depths_[bucket_idx]; }
+
+  void SetLocalDepth(uint32_t bucket_idx, uint32_t local_depth) {
+    local_depths_[bucket_idx] = static_cast<uint8_t>(local_depth);
+  }
+
+  // slot of the bucket a bucket with local depth > 0 was split from (or into)
+  uint32_t GetSplitImageIndex(uint32_t bucket_idx) const {
+    return bucket_idx ^ (1u << (local_depths_[bucket_idx] - 1));
+  }
+
+  bool CanGrow() const { return global_depth_ < HASH_DIRECTORY_MAX_DEPTH; }
+
+  // the directory can halve when no bucket uses the highest global bit
+  bool CanShrink() const;
+
+  // double the directory, the new upper half mirrors the lower half
+  void IncrGlobalDepth();
+
+  void DecrGlobalDepth();
+
+private:
+  page_id_t page_id_;
+  lsn_t lsn_;
+  uint32_t global_depth_;
+  uint8_t local_depths_[HASH_DIRECTORY_ARRAY_SIZE];
+  page_id_t bucket_page_ids_[HASH_DIRECTORY_ARRAY_SIZE];
+};
+
+static_assert(sizeof(HashTableDirectoryPage) <= PAGE_SIZE, "hash directory does not fit in a page");
+
+#endif  // MINISQL_HASH_TABLE_DIRECTORY_PAGE_H
@@ -15,6 +15,14 @@
  *  ----------------------------------------------------------------
  *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
  *  ----------------------------------------------------------------
+ *
+ *  The top bits of a tuple size are flags: deleted, forward (the slot holds
+ *  the 8-byte RowId a grown tuple was moved to, so its RowId stays valid) and
+ *  moved (the tuple is such a moved version, reached through its forward slot
+ *  only and skipped by scans).
+ *
+ *  Deleting a tuple leaves a hole in the tuple area. The holes of a page are
+ *  squeezed out at once when an insert or a grown tuple needs their room.
  **/
 
 #include <string>
@@ -57,6 +65,37 @@ public:
 
   bool GetTuple(Row *row, Schema *schema, Transaction *txn, LockManager *lock_manager);
 
+  /**
+   * Whether the slot of rid is a forward slot, deleted or not, and where it points to
+   */
+  bool GetForward(const RowId &rid, RowId *target);
+
+  /**
+   * Turn the tuple of rid into a forward slot pointing to target. Always fits
+   * in a tuple's place, false only if rid is not a live tuple.
+   */
+  bool SetForward(const RowId &rid, const RowId &target);
+
+  /**
+   * Store row in the forward slot of rid again, false if the page lacks room
+   */
+  bool RestoreTuple(const RowId &rid, const Row &row, Schema *schema);
+
+  /**
+   * Flag the tuple of rid as the moved version of a forward slot
+   */
+  void MarkMoved(const RowId &rid);
+
+  /**
+   * Make the moved version of rid an ordinary tuple again, once its forward slot is gone
+   */
+  void UnmarkMoved(const RowId &rid);
+
+  /**
+   * Whether no slot is in use, deleted tuples not applied yet included
+   */
+  bool IsEmpty() { return GetTupleCount() == 0; }
+
   bool GetFirstTupleRid(RowId *first_rid);
 
   bool GetNextTupleRid(const RowId &cur_rid, RowId *next_rid);
@@ -92,8 +131,37 @@ private:
     memcpy(GetData() + OFFSET_TUPLE_SIZE + SIZE_TUPLE * slot_num, &size, sizeof(uint32_t));
   }
 
+  /**
+   * Give the tuple of slot_num size bytes at its end of the tuple area, moving
+   * the tuples stored before it; false if the page lacks room
+   */
+  bool ResizeTuple(uint32_t slot_num, uint32_t size);
+
+  /**
+   * Make size bytes of free space contiguous, defragmenting the page if only
+   * its holes have that room; false if the page lacks room
+   */
+  bool MakeRoom(uint32_t size);
+
+  // bytes of the tuple area left as holes by deleted tuples
+  uint32_t GetFragmentedSpace();
+
+  /**
+   * Pack the tuples at the end of the page, slots keep their numbers
+   */
+  void Defragment();
+
   static bool IsDeleted(uint32_t tuple_size) { return static_cast<bool>(tuple_size & DELETE_MASK) || tuple_size == 0; }
 
+  static bool IsForward(uint32_t tuple_size) { return static_cast<bool>(tuple_size & FORWARD_MASK); }
+
+  static bool IsMoved(uint32_t tuple_size) { return static_cast<bool>(tuple_size & MOVED_MASK); }
+
+  // bytes of a tuple, without its flags
+  static uint32_t TupleBytes(uint32_t tuple_size) {
+    return static_cast<uint32_t>(tuple_size & ~(DELETE_MASK | FORWARD_MASK | MOVED_MASK));
+  }
+
   static uint32_t SetDeletedFlag(uint32_t tuple_size) { return static_cast<uint32_t>(tuple_size | DELETE_MASK); }
 
   static uint32_t UnsetDeletedFlag(uint32_t tuple_size) { return static_cast<uint32_t>(tuple_size & (~DELETE_MASK)); }
@@ -101,6 +169,9 @@ private:
 private:
   static_assert(sizeof(page_id_t) == 4);
   static constexpr uint64_t DELETE_MASK = (1U << (8 * sizeof(uint32_t) - 1));
+  static constexpr uint64_t FORWARD_MASK = (1U << (8 * sizeof(uint32_t) - 2));
+  static constexpr uint64_t MOVED_MASK = (1U << (8 * sizeof(uint32_t) - 3));
+  static constexpr uint32_t SIZE_FORWARD = sizeof(int64_t);
   static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
   static constexpr size_t SIZE_TUPLE = 8;
   static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
@@ -1,10 +1,21 @@
 %{
   #include <stdio.h>
+  #include <stdlib.h>
+  #include <string.h>
   #include "parser/parser.h"
 
   extern char *yytext;
   extern int yylex(void);
   int yyerror(char* error);
+
+  /* table.column as a single identifier node */
+  static pSyntaxNode QualifiedName(pSyntaxNode table, pSyntaxNode column) {
+    char *name = (char *) malloc(strlen(table->val_) + strlen(column->val_) + 2);
+    sprintf(name, "%s.%s", table->val_, column->val_);
+    pSyntaxNode node = CreateSyntaxNode(kNodeIdentifier, name);
+    free(name);
+    return node;
+  }
 %}
 
 %union {
@@ -12,22 +23,26 @@
 }
 
 %token <syntax_node> CREATE DROP SELECT INSERT DELETE UPDATE
-%token <syntax_node> TRXBEGIN TRXCOMMIT TRXROLLBACK QUIT EXECFILE SHOW USE USING
+%token <syntax_node> TRXBEGIN TRXCOMMIT TRXROLLBACK QUIT EXECFILE SHOW USE USING INCLUDE ANALYZE JOIN GROUP BY
+%token <syntax_node> ORDER ASC DESC LIMIT OFFSET COPY TRUNCATE VACUUM
 %token <syntax_node> DATABASE DATABASES TABLE TABLES INDEX INDEXES
 %token <syntax_node> ON FROM WHERE INTO SET VALUES PRIMARY KEY UNIQUE
 %token <syntax_node> CHAR INT FLOAT AND OR NOT IS FLAGNULL
-%token <syntax_node> IDENTIFIER STRING NUMBER EQ NE LE GE
+%token <syntax_node> IDENTIFIER STRING NUMBER PARAMETER EQ NE LE GE
 
 %type <syntax_node> start sql
 %type <syntax_node> sql_create_database sql_drop_database sql_show_databases sql_use_database
-%type <syntax_node> sql_show_tables sql_create_table sql_drop_table
+%type <syntax_node> sql_show_tables sql_create_table sql_drop_table sql_truncate_table
 %type <syntax_node> column_definition_list column_definition column_type column_list
-%type <syntax_node> sql_create_index sql_drop_index sql_show_indexes
+%type <syntax_node> sql_create_index sql_drop_index sql_show_indexes index_type include_columns
 %type <syntax_node> sql_trx_begin sql_trx_commit sql_trx_rollback
-%type <syntax_node> sql_select select_columns column_values column_value operator
+%type <syntax_node> sql_select select_columns select_column_list select_column column_ref column_ref_list table_list
+%type <syntax_node> select_source select_where select_group select_order order_key_list order_key select_limit
+%type <syntax_node> column_values column_value operator
 %type <syntax_node> connector where_conditions where_condition
 %type <syntax_node> sql_insert sql_delete sql_update update_values update_value
-%type <syntax_node> sql_quit sql_exec_file
+%type <syntax_node> value_tuples value_tuple
+%type <syntax_node> sql_quit sql_exec_file sql_analyze sql_vacuum sql_copy
 
 %%
 
@@ -46,6 +61,7 @@ sql:
   | sql_show_tables { $$ = $1; }
   | sql_create_table { $$ = $1; }
   | sql_drop_table { $$ = $1; }
+  | sql_truncate_table { $$ = $1; }
   | sql_create_index { $$ = $1; }
   | sql_drop_index { $$ = $1; }
   | sql_show_indexes { $$ = $1; }
@@ -58,6 +74,9 @@ sql:
   | sql_trx_rollback { $$ = $1; }
   | sql_quit { $$ = $1; }
   | sql_exec_file { $$ = $1; }
+  | sql_analyze { $$ = $1; }
+  | sql_vacuum { $$ = $1; }
+  | sql_copy { $$ = $1; }
   ;
 
 sql_create_database:
@@ -160,25 +179,47 @@ sql_drop_table:
   }
   ;
 
+sql_truncate_table:
+  TRUNCATE TABLE IDENTIFIER {
+    $$ = CreateSyntaxNode(kNodeTruncateTable, NULL);
+    SyntaxNodeAddChildren($$, $3);
+  }
+  ;
+
 sql_create_index:
-  CREATE INDEX IDENTIFIER ON IDENTIFIER '(' column_list ')' {
+  CREATE INDEX IDENTIFIER ON IDENTIFIER '(' column_list ')' index_type include_columns {
     $$ = CreateSyntaxNode(kNodeCreateIndex, NULL);
     SyntaxNodeAddChildren($$, $3);
     SyntaxNodeAddChildren($$, $5);
     pSyntaxNode index_keys_node = CreateSyntaxNode(kNodeColumnList, "index keys");
     SyntaxNodeAddChildren(index_keys_node, $7);
     SyntaxNodeAddChildren($$, index_keys_node);
+    if ($9 != NULL) {
+      SyntaxNodeAddChildren($$, $9);
+    }
+    if ($10 != NULL) {
+      SyntaxNodeAddChildren($$, $10);
+    }
   }
-  | CREATE INDEX IDENTIFIER ON IDENTIFIER '(' column_list ')' USING IDENTIFIER {
-      $$ = CreateSyntaxNode(kNodeCreateIndex, NULL);
-      SyntaxNodeAddChildren($$, $3);
-      SyntaxNodeAddChildren($$, $5);
-      pSyntaxNode index_keys_node = CreateSyntaxNode(kNodeColumnList, "index keys");
-      SyntaxNodeAddChildren(index_keys_node, $7);
-      SyntaxNodeAddChildren($$, index_keys_node);
-      pSyntaxNode index_type_node = CreateSyntaxNode(kNodeIndexType, "index type");
-      SyntaxNodeAddChildren(index_type_node, $10);
-      SyntaxNodeAddChildren($$, index_type_node);
+  ;
+
+index_type:
+  /* empty */ {
+    $$ = NULL;
+  }
+  | USING IDENTIFIER {
+    $$ = CreateSyntaxNode(kNodeIndexType, "index type");
+    SyntaxNodeAddChildren($$, $2);
+  }
+  ;
+
+include_columns:
+  /* empty */ {
+    $$ = NULL;
+  }
+  | INCLUDE '(' column_list ')' {
+    $$ = CreateSyntaxNode(kNodeIncludeColumns, "include columns");
+    SyntaxNodeAddChildren($$, $3);
   }
   ;
 
@@ -196,17 +237,119 @@ sql_show_indexes:
   ;
 
 sql_select:
-  SELECT select_columns FROM IDENTIFIER {
+  SELECT select_columns FROM select_source select_where select_group select_order select_limit {
     $$ = CreateSyntaxNode(kNodeSelect, NULL);
     SyntaxNodeAddChildren($$, $2);
     SyntaxNodeAddChildren($$, $4);
+    SyntaxNodeAddChildren($$, $5);
+    SyntaxNodeAddChildren($$, $6);
+    SyntaxNodeAddChildren($$, $7);
+    SyntaxNodeAddChildren($$, $8);
   }
-  | SELECT select_columns FROM IDENTIFIER WHERE where_conditions {
-    $$ = CreateSyntaxNode(kNodeSelect, NULL);
+  ;
+
+select_source:
+  IDENTIFIER {
+    $$ = $1;
+  }
+  | table_list {
+    $$ = $1;
+  }
+  ;
+
+select_where:
+  /* empty */ {
+    $$ = NULL;
+  }
+  | WHERE where_conditions {
+    $$ = CreateSyntaxNode(kNodeConditions, NULL);
+    SyntaxNodeAddChildren($$, $2);
+  }
+  ;
+
+select_group:
+  /* empty */ {
+    $$ = NULL;
+  }
+  | GROUP BY column_ref_list {
+    $$ = CreateSyntaxNode(kNodeGroupBy, NULL);
+    SyntaxNodeAddChildren($$, $3);
+  }
+  ;
+
+select_order:
+  /* empty */ {
+    $$ = NULL;
+  }
+  | ORDER BY order_key_list {
+    $$ = CreateSyntaxNode(kNodeOrderBy, NULL);
+    SyntaxNodeAddChildren($$, $3);
+  }
+  ;
+
+order_key_list:
+  order_key ',' order_key_list {
+    $$ = $1;
+    SyntaxNodeAddSibling($$, $3);
+  }
+  | order_key {
+    $$ = $1;
+  }
+  ;
+
+order_key:
+  column_ref {
+    $$ = CreateSyntaxNode(kNodeOrderKey, "asc");
+    SyntaxNodeAddChildren($$, $1);
+  }
+  | column_ref ASC {
+    $$ = CreateSyntaxNode(kNodeOrderKey, "asc");
+    SyntaxNodeAddChildren($$, $1);
+  }
+  | column_ref DESC {
+    $$ = CreateSyntaxNode(kNodeOrderKey, "desc");
+    SyntaxNodeAddChildren($$, $1);
+  }
+  ;
+
+select_limit:
+  /* empty */ {
+    $$ = NULL;
+  }
+  | LIMIT NUMBER {
+    $$ = CreateSyntaxNode(kNodeLimit, NULL);
+    SyntaxNodeAddChildren($$, $2);
+  }
+  | LIMIT NUMBER OFFSET NUMBER {
+    $$ = CreateSyntaxNode(kNodeLimit, NULL);
     SyntaxNodeAddChildren($$, $2);
     SyntaxNodeAddChildren($$, $4);
+  }
+  ;
+
+table_list:
+  IDENTIFIER ',' IDENTIFIER {
+    $$ = CreateSyntaxNode(kNodeTableList, "tables");
+    SyntaxNodeAddChildren($$, $1);
+    SyntaxNodeAddChildren($$, $3);
+  }
+  | IDENTIFIER JOIN IDENTIFIER ON where_conditions {
+    $$ = CreateSyntaxNode(kNodeTableList, "tables");
+    SyntaxNodeAddChildren($$, $1);
+    SyntaxNodeAddChildren($$, $3);
     pSyntaxNode condition_node = CreateSyntaxNode(kNodeConditions, NULL);
-    SyntaxNodeAddChildren(condition_node, $6);
+    SyntaxNodeAddChildren(condition_node, $5);
+    SyntaxNodeAddChildren($$, condition_node);
+  }
+  | table_list ',' IDENTIFIER {
+    $$ = $1;
+    SyntaxNodeAddChildren($$, $3);
+  }
+  | table_list JOIN IDENTIFIER ON where_conditions {
+    $$ = $1;
+    SyntaxNodeAddChildren($$, $3);
+    pSyntaxNode condition_node = CreateSyntaxNode(kNodeConditions, NULL);
+    SyntaxNodeAddChildren(condition_node, $5);
     SyntaxNodeAddChildren($$, condition_node);
   }
   ;
@@ -215,12 +358,55 @@ select_columns:
   '*' {
     $$ = CreateSyntaxNode(kNodeAllColumns, NULL);
   }
-  | column_list {
+  | select_column_list {
     $$ = CreateSyntaxNode(kNodeColumnList, "select columns");
     SyntaxNodeAddChildren($$, $1);
   }
   ;
 
+select_column_list:
+  select_column ',' select_column_list {
+    $$ = $1;
+    SyntaxNodeAddSibling($$, $3);
+  }
+  | select_column {
+    $$ = $1;
+  }
+  ;
+
+select_column:
+  column_ref {
+    $$ = $1;
+  }
+  | IDENTIFIER '(' column_ref ')' {
+    $$ = CreateSyntaxNode(kNodeAggregate, $1->val_);
+    SyntaxNodeAddChildren($$, $3);
+  }
+  | IDENTIFIER '(' '*' ')' {
+    $$ = CreateSyntaxNode(kNodeAggregate, $1->val_);
+    SyntaxNodeAddChildren($$, CreateSyntaxNode(kNodeAllColumns, NULL));
+  }
+  ;
+
+column_ref_list:
+  column_ref ',' column_ref_list {
+    $$ = $1;
+    SyntaxNodeAddSibling($$, $3);
+  }
+  | column_ref {
+    $$ = $1;
+  }
+  ;
+
+column_ref:
+  IDENTIFIER {
+    $$ = $1;
+  }
+  | IDENTIFIER '.' IDENTIFIER {
+    $$ = QualifiedName($1, $3);
+  }
+  ;
+
 where_conditions:
   where_conditions connector where_condition  {
     $$ = $2;
@@ -242,7 +428,12 @@ connector:
   ;
 
 where_condition:
-  IDENTIFIER operator column_value {
+  column_ref operator column_value {
+    $$ = $2;
+    SyntaxNodeAddChildren($$, $1);
+    SyntaxNodeAddChildren($$, $3);
+  }
+  | column_ref operator column_ref {
     $$ = $2;
     SyntaxNodeAddChildren($$, $1);
     SyntaxNodeAddChildren($$, $3);
@@ -259,6 +450,9 @@ column_value:
   | FLAGNULL {
     $$ = CreateSyntaxNode(kNodeNull, NULL);
   }
+  | PARAMETER {
+    $$ = $1;
+  }
   ;
 
 operator:
@@ -289,12 +483,37 @@ operator:
   ;
 
 sql_insert:
-  INSERT INTO IDENTIFIER VALUES '(' column_values ')' {
+  INSERT INTO IDENTIFIER VALUES value_tuples {
     $$ = CreateSyntaxNode(kNodeInsert, NULL);
     SyntaxNodeAddChildren($$, $3);
-    pSyntaxNode col_val_node = CreateSyntaxNode(kNodeColumnValues, NULL);
-    SyntaxNodeAddChildren(col_val_node, $6);
-    SyntaxNodeAddChildren($$, col_val_node);
+    /* value_tuples come newest first, restore the statement order */
+    pSyntaxNode tuples = NULL;
+    while ($5 != NULL) {
+      pSyntaxNode next = $5->next_;
+      $5->next_ = tuples;
+      tuples = $5;
+      $5 = next;
+    }
+    SyntaxNodeAddChildren($$, tuples);
+  }
+  ;
+
+/* left recursive and prepending, so long VALUES lists neither grow the parser
+ * stack nor walk the list per tuple */
+value_tuples:
+  value_tuples ',' value_tuple {
+    $$ = $3;
+    $$->next_ = $1;
+  }
+  | value_tuple {
+    $$ = $1;
+  }
+  ;
+
+value_tuple:
+  '(' column_values ')' {
+    $$ = CreateSyntaxNode(kNodeColumnValues, NULL);
+    SyntaxNodeAddChildren($$, $2);
   }
   ;
 
@@ -393,6 +612,34 @@ sql_exec_file:
   }
   ;
 
+sql_analyze:
+  ANALYZE IDENTIFIER {
+    $$ = CreateSyntaxNode(kNodeAnalyze, NULL);
+    SyntaxNodeAddChildren($$, $2);
+  }
+  | ANALYZE {
+    $$ = CreateSyntaxNode(kNodeAnalyze, NULL);
+  }
+  ;
+
+sql_vacuum:
+  VACUUM IDENTIFIER {
+    $$ = CreateSyntaxNode(kNodeVacuum, NULL);
+    SyntaxNodeAddChildren($$, $2);
+  }
+  | VACUUM {
+    $$ = CreateSyntaxNode(kNodeVacuum, NULL);
+  }
+  ;
+
+sql_copy:
+  COPY IDENTIFIER FROM STRING {
+    $$ = CreateSyntaxNode(kNodeCopy, NULL);
+    SyntaxNodeAddChildren($$, $2);
+    SyntaxNodeAddChildren($$, $4);
+  }
+  ;
+
 %%
 int yyerror(char* error) {
 	MinisqlParserSetError(error);
@@ -15,6 +15,7 @@ typedef enum {
   kNodeNumber,  /** numeric value type, eg: int, float */
   kNodeString, /** string value type, eg: char */
   kNodeNull,  /** null value type */
+  kNodeParameter,  /** '?' value bound later by a prepared statement */
   kNodeCreateDB, /** create database command */
   kNodeDropDB, /** drop database command */
   kNodeShowDB, /** show databases command */
@@ -28,6 +29,12 @@ typedef enum {
   kNodeUpdate,  /** update command */
   kNodeSelect,  /** select command */
   kNodeConditions,  /** where conditions */
+  kNodeTableList,  /** tables joined by a select, contains table identifiers and join conditions */
+  kNodeGroupBy,  /** group by clause of a select, contains the grouping columns */
+  kNodeAggregate,  /** aggregate function of a selected column, eg: count, sum */
+  kNodeOrderBy,  /** order by clause of a select, contains the order keys */
+  kNodeOrderKey,  /** column a select is ordered on, 'asc' or 'desc' */
+  kNodeLimit,  /** limit clause of a select, contains the row count and the optional offset */
   kNodeConnector, /** operators 'AND' and 'OR' */
   kNodeCompareOperator, /** operators '=', '<>', '<=', '>=', '<', '>', is, not */
   kNodeColumnType,  /** column types: int, char, float */
@@ -41,9 +48,14 @@ typedef enum {
   kNodeCreateIndex, /** create index command */
   kNodeDropIndex, /** drop index command */
   kNodeIndexType, /** type of index */
+  kNodeIncludeColumns, /** non-key columns stored in index entries */
   kNodeTrxBegin, /** begin transaction command */
   kNodeTrxCommit, /** commit transaction command */
-  kNodeTrxRollback /** rollback transaction command */
+  kNodeTrxRollback, /** rollback transaction command */
+  kNodeAnalyze, /** analyze command */
+  kNodeCopy, /** copy command, loads a table from a csv file */
+  kNodeTruncateTable, /** truncate table command */
+  kNodeVacuum /** vacuum command, merges sparse table pages */
 } SyntaxNodeType;
 
 /**
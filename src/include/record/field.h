@@ -140,7 +140,9 @@ public:
     std::swap(first.manage_data_, second.manage_data_);
   }
   std :: string GetString() const{
-    if(type_id_ == kTypeInt) {
+    if(is_null_) {
+        return "null";
+    } else if(type_id_ == kTypeInt) {
         return std :: to_string(value_.integer_);
     } else if(type_id_ == kTypeFloat) {
         return std :: to_string(value_.float_);
@@ -86,6 +86,8 @@ public:
 
   inline std::vector<Field *> &GetFields() { return fields_; }
 
+  inline MemHeap *GetHeap() const { return heap_; }
+
   inline Field *GetField(uint32_t idx) const {
     ASSERT(idx < fields_.size(), "Failed to access field");
     return fields_[idx];
@@ -0,0 +1,46 @@
+#ifndef MINISQL_PAGE_RECLAIMER_H
+#define MINISQL_PAGE_RECLAIMER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * Runs the freeing of dropped or truncated storage in a background thread,
+ * so that DROP and TRUNCATE return as soon as the catalog forgets the pages.
+ *
+ * A job only gets page ids nobody else can reach any more (see
+ * TableHeap::FreePages and BPlusTree::FreePages). Jobs run one at a time in
+ * submission order, and the destructor finishes the queued ones before the
+ * buffer pool they use goes away.
+ */
+class PageReclaimer {
+public:
+  PageReclaimer() = default;
+
+  ~PageReclaimer();
+
+  /**
+   * Queue a job, the worker thread starts with the first one
+   */
+  void Submit(std::function<void()> job);
+
+  /**
+   * Block until every queued job has run
+   */
+  void Wait();
+
+private:
+  void Run();
+
+  std::thread worker_;
+  std::mutex latch_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> jobs_;
+  bool busy_{false};
+  bool stop_{false};
+};
+
+#endif  // MINISQL_PAGE_RECLAIMER_H
@@ -0,0 +1,41 @@
+#ifndef MINISQL_ROW_ID_BITMAP_H
+#define MINISQL_ROW_ID_BITMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "common/rowid.h"
+
+/**
+ * Set of row ids kept as one slot bitmap per table page, ordered by page id.
+ *
+ * Index probes collect their row ids here so that the heap is read in page
+ * order with each page fetched once, and results of several probes are
+ * combined with Intersect (AND) and Union (OR) before touching the heap.
+ */
+class RowIdBitmap {
+public:
+  void Add(const RowId &rid);
+
+  bool Contains(const RowId &rid) const;
+
+  // keep only row ids also in other
+  void Intersect(const RowIdBitmap &other);
+
+  // add every row id of other
+  void Union(const RowIdBitmap &other);
+
+  size_t Size() const;
+
+  bool Empty() const { return pages_.empty(); }
+
+  // row ids sorted by page id, then slot
+  std::vector<RowId> GetRowIds() const;
+
+private:
+  std::map<page_id_t, std::vector<uint64_t>> pages_;
+};
+
+#endif  // MINISQL_ROW_ID_BITMAP_H
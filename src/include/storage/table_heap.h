@@ -1,6 +1,8 @@
 #ifndef MINISQL_TABLE_HEAP_H
 #define MINISQL_TABLE_HEAP_H
 
+#include <unordered_map>
+
 #include "buffer/buffer_pool_manager.h"
 #include "page/table_page.h"
 #include "storage/table_iterator.h"
@@ -33,6 +35,15 @@ public:
    */
   bool InsertTuple(Row &row, Transaction *txn);
 
+  /**
+   * Append rows to the table, filling the last page and then new pages in
+   * order with one fetch of each page. Nothing is inserted if a row is too large.
+   * @param[in/out] rows Tuples to insert, each gets the rid it is inserted at
+   * @param[in] txn The transaction performing the insert
+   * @return true iff the rows are inserted
+   */
+  bool InsertTuples(std::vector<Row> &rows, Transaction *txn);
+
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param[in] rid Resource id of the tuple of delete
@@ -42,8 +53,10 @@ public:
   bool MarkDelete(const RowId &rid, Transaction *txn);
 
   /**
-   * if the new tuple is too large to fit in the old page, return false (will delete and insert)
-   * @param[in] row Tuple of new row
+   * Update the tuple in its page when the page has room for the new version,
+   * otherwise move the new version to another page and leave a forward slot
+   * at rid, so the tuple keeps its rid either way
+   * @param[in,out] row Tuple of new row, receives rid
    * @param[in] rid Rid of the old tuple
    * @param[in] txn Transaction performing the update
    * @return true is update is successful.
@@ -57,6 +70,16 @@ public:
    */
   void ApplyDelete(const RowId &rid, Transaction *txn);
 
+  /**
+   * Delete the tuples of rids right away. Row ids are sorted by page, so each
+   * page is pinned once for all of its tuples.
+   * @param rids Rids of the tuples to delete
+   * @param txn Transaction performing the delete.
+   * @param[out] deleted Rids of the tuples deleted, when not null
+   * @return true iff every tuple existed
+   */
+  bool DeleteTuples(std::vector<RowId> rids, Transaction *txn, std::vector<RowId> *deleted = nullptr);
+
   /**
    * Called on abort to rollback a delete.
    * @param[in] rid Rid of the deleted tuple.
@@ -72,11 +95,46 @@ public:
    */
   bool GetTuple(Row *row, Transaction *txn);
 
+  /**
+   * Read the tuples of row_ids in the given order, fetching each page once for
+   * a run of row ids on it. Pass row ids sorted by page (see RowIdBitmap) so
+   * every page is read only once. Missing tuples are skipped.
+   * @param[in] row_ids Row ids of the tuples
+   * @param[out] rows Tuples read
+   * @param[in] txn transaction performing the read
+   */
+  void GetTuples(const std::vector<RowId> &row_ids, std::vector<Row> &rows, Transaction *txn);
+
+  /**
+   * Fold forward slots into their moved versions, then move the tuples of
+   * later pages into the free space of earlier ones along the page chain and
+   * free the pages left empty. Tuples that change their rid are reported so
+   * the indexes can follow.
+   * @param[out] rows Moved tuples, carrying their new rids
+   * @param[out] old_row_ids Rids the tuples of rows had before
+   * @param[in] txn Transaction performing the vacuum
+   * @return number of pages freed
+   */
+  uint32_t Vacuum(std::vector<Row> &rows, std::vector<RowId> &old_row_ids, Transaction *txn);
+
   /**
    * Free table heap and release storage in disk file
    */
   void FreeHeap();
 
+  /**
+   * Empty the heap at once: it starts over on a new first page, and the old
+   * pages are left for the caller to free with FreePages
+   * @return the first of the old pages
+   */
+  page_id_t Truncate(Transaction *txn);
+
+  /**
+   * Free the pages of a heap no longer in use, following the page links from
+   * first_page_id. Pages are read without entering the buffer pool.
+   */
+  static void FreePages(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id);
+
   /**
    * @return the begin iterator of this table
    */
@@ -117,6 +175,32 @@ private:
             log_manager_(log_manager),
             lock_manager_(lock_manager) {}
 
+  /**
+   * Fetch the last page of the heap. A heap loaded from disk only knows its
+   * first page, so the page links are followed to the tail on the first append.
+   */
+  TablePage *FetchLastPage();
+
+  /**
+   * Read the tuple at row's RowId from page, following a forward slot to the
+   * moved version. row keeps the RowId it was read with.
+   */
+  bool ReadTuple(TablePage *page, Row *row, Transaction *txn);
+
+  /**
+   * Insert row as the moved version of a tuple whose slot forwards to it,
+   * row gets the RowId of the new place.
+   */
+  void Relocate(Row &row, Transaction *txn);
+
+  /**
+   * Turn every forward slot back into a tuple: the moved version returns to
+   * the slot if its page has room, otherwise it takes over as the tuple and
+   * the slot goes away. Rids changed are recorded in moved.
+   */
+  void FoldForwards(std::vector<Row> &rows, std::vector<RowId> &old_row_ids,
+                    std::unordered_map<int64_t, size_t> &moved, Transaction *txn);
+
 private:
   BufferPoolManager *buffer_pool_manager_;
   page_id_t first_page_id_;
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <string>
 #include "glog/logging.h"
 #include "index/b_plus_tree.h"
@@ -37,14 +38,60 @@ void BPLUSTREE_TYPE::Destroy() {
   buffer_pool_manager_->UnpinPage(root_page_id_, true);
   buffer_pool_manager_->DeletePage(root_page_id_);
   root_page_id_ = INVALID_PAGE_ID;
+  rightmost_leaf_id_ = INVALID_PAGE_ID;
+  freed_pages_++;
   UpdateRootPageId(-1);
 }
+/*
+ * Unlike Destroy, the pages are not touched here: the tree forgets its root and
+ * a job of reclaimer frees the old pages later.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Release(PageReclaimer *reclaimer) {
+  if(IsEmpty()) return ;
+  page_id_t root_page_id = root_page_id_;
+  BufferPoolManager *buffer_pool_manager = buffer_pool_manager_;
+  root_page_id_ = INVALID_PAGE_ID;
+  rightmost_leaf_id_ = INVALID_PAGE_ID;
+  freed_pages_++;
+  UpdateRootPageId(-1);
+  reclaimer->Submit([buffer_pool_manager, root_page_id] { FreePages(buffer_pool_manager, root_page_id); });
+}
+
+/*
+ * Free the tree level by level. The first page of a level tells whether the
+ * level holds leaves; leaves are freed without being read, so only the
+ * internal pages, a small part of the tree, are read.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::FreePages(BufferPoolManager *buffer_pool_manager, page_id_t root_page_id) {
+  Page page;
+  std::vector<page_id_t> level{root_page_id}, next_level;
+  bool leaves = false;
+  while(!level.empty()) {
+    for(auto page_id : level) {
+      if(!leaves) {
+        buffer_pool_manager->ReadPage(page_id, page.GetData());
+        auto tree_page = reinterpret_cast<BPlusTreePage *>(page.GetData());
+        leaves = tree_page->IsLeafPage();
+        if(!leaves) {
+          auto internal_page = reinterpret_cast<InternalPage *>(tree_page);
+          for(int i = 0; i < internal_page->GetSize(); ++i) next_level.push_back(internal_page->ValueAt(i));
+        }
+      }
+      buffer_pool_manager->DeletePage(page_id);
+    }
+    level.swap(next_level);
+    next_level.clear();
+  }
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::DestroyDown(BPlusTreePage *cur_tree_page) {
   if(cur_tree_page->IsLeafPage()) return ;
   auto internal_page = reinterpret_cast<InternalPage *>(cur_tree_page);
   for(int i = 0; i < internal_page->GetSize(); ++i) {
-    auto nxt_page_id = internal_page->GetData()[i].second;
+    auto nxt_page_id = internal_page->ValueAt(i);
     auto nxt_tree_page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(nxt_page_id)->GetData());
     DestroyDown(nxt_tree_page);
     buffer_pool_manager_->UnpinPage(nxt_page_id, true);
@@ -71,132 +118,207 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> &result
   return find;
 }
 
+/*
+ * Fetch the pages from the root down to the leaf that should hold key, keeping
+ * each of them pinned in path along with the index of the child taken.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::FindPath(const KeyType &key, std::vector<PathEntry> &path) {
+  page_id_t page_id = root_page_id_;
+  while(true) {
+    auto tree_page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    if(tree_page->IsLeafPage()) {
+      path.push_back({tree_page, 0});
+      return ;
+    }
+    auto internal_page = reinterpret_cast<InternalPage *>(tree_page);
+    int index = internal_page->LookupIndex(key, comparator_);
+    path.push_back({tree_page, index});
+    page_id = internal_page->ValueAt(index);
+  }
+}
+
+/*
+ * Unpin every page left in path.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleasePath(std::vector<PathEntry> &path, bool is_dirty) {
+  for(auto &entry : path) buffer_pool_manager_->UnpinPage(entry.page_->GetPageId(), is_dirty);
+  path.clear();
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 /*
  * Insert constant key & value pair into b+ tree
  * if current tree is empty, start new tree, update root page id and insert
- * entry, otherwise insert into leaf page.
+ * entry, otherwise insert into leaf page. Splits propagate up the pinned path,
+ * so a split only touches the pages on the path and the new siblings.
+ * Keys beyond the largest key are appended to the cached rightmost leaf
+ * directly, and once such appends come in a row the pages on the right edge
+ * split unevenly so that the left pages stay nearly full.
  * @return: since we only support unique key, if user try to insert duplicate
  * keys return false, otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  page_id_t leaf_page_id;
+  return InsertInto(key, value, leaf_page_id);
+}
+
+/*
+ * Insert a key unless it is in the tree, holding its place with a default value
+ * until Fill sets the real one. leaf_page_id receives the leaf the key went to,
+ * so that Fill needs no descent, and freed_pages how many pages the tree had
+ * freed by then.
+ * @return: false if the key is in the tree
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::Reserve(const KeyType &key, page_id_t &leaf_page_id, uint64_t &freed_pages) {
+  freed_pages = freed_pages_;
+  return InsertInto(key, ValueType{}, leaf_page_id);
+}
+
+/*
+ * Set the value of a key taken by Reserve. The key is looked up in the leaf
+ * it was reserved in, and searched from the root if a split moved it. Once the
+ * tree has freed a page since the reservation, that leaf may be gone and its
+ * page reused or left with stale pairs, so the search starts at the root.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Fill(const KeyType &key, const ValueType &value, page_id_t leaf_page_id, uint64_t freed_pages) {
+  bool live = leaf_page_id != INVALID_PAGE_ID && freed_pages == freed_pages_;
+  Page *p = live ? buffer_pool_manager_->FetchPage(leaf_page_id) : FindLeafPage(key);
+  for(int attempt = live ? 0 : 1; p != nullptr && attempt < 2; attempt++) {
+    auto leaf_page = reinterpret_cast<LeafPage *>(p->GetData());
+    if(leaf_page->IsLeafPage()) {
+      int index = leaf_page->KeyIndex(key, comparator_);
+      if(index < leaf_page->GetSize() && comparator_(leaf_page->KeyAt(index), key) == 0) {
+        leaf_page->SetValueAt(index, value);
+        buffer_pool_manager_->UnpinPage(p->GetPageId(), true);
+        return;
+      }
+    }
+    buffer_pool_manager_->UnpinPage(p->GetPageId(), false);
+    p = attempt == 0 ? FindLeafPage(key) : nullptr;
+  }
+}
+
+/*
+ * Insert with leaf_page_id receiving the leaf that takes the key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::InsertInto(const KeyType &key, const ValueType &value, page_id_t &leaf_page_id) {
   if(IsEmpty()){
     StartNewTree(key, value);
+    leaf_page_id = root_page_id_;
+    return true;
+  }
+  if(AppendToRightmostLeaf(key, value)) {
+    leaf_page_id = rightmost_leaf_id_;
+    return true;
+  }
+  std::vector<PathEntry> path;
+  FindPath(key, path);
+  auto leaf_page = reinterpret_cast<LeafPage *>(path.back().page_);
+  ValueType temp;
+  if(leaf_page->Lookup(key, temp, comparator_)) {
+    ReleasePath(path, false);
+    return false;
+  }
+  if(leaf_page->HasRoomFor(key)) {
+    leaf_page->Insert(key, value, comparator_);
+    leaf_page_id = leaf_page->GetPageId();
+    if(leaf_page->GetNextPageId() == INVALID_PAGE_ID) rightmost_leaf_id_ = leaf_page->GetPageId();
+    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
+    path.pop_back();
+    ReleasePath(path, false);
     return true;
   }
-  auto root_page = buffer_pool_manager_->FetchPage(root_page_id_);
-  auto root_tree_page = reinterpret_cast<BPlusTreePage *>(root_page->GetData());
-  bool exist = false;
-  KeyType new_key;
-  auto new_page = InsertDown(root_tree_page, key, value, new_key, exist);
-  if(exist || new_page == nullptr) {
-    buffer_pool_manager_->UnpinPage(root_page_id_, true);
-    return !exist;
+  bool sequential = append_streak_ >= APPEND_STREAK_SEQUENTIAL && leaf_page->GetNextPageId() == INVALID_PAGE_ID &&
+                    comparator_(key, leaf_page->KeyAt(leaf_page->GetSize() - 1)) > 0;
+  auto ext_leaf_page = Split(leaf_page, sequential ? APPEND_SPLIT_PERCENT : 50);
+  if(ext_leaf_page->GetNextPageId() == INVALID_PAGE_ID) rightmost_leaf_id_ = ext_leaf_page->GetPageId();
+  bool left = comparator_(key, ext_leaf_page->KeyAt(0)) < 0;
+  (left ? leaf_page : ext_leaf_page)->Insert(key, value, comparator_);
+  leaf_page_id = (left ? leaf_page : ext_leaf_page)->GetPageId();
+  KeyType split_key = Separator(leaf_page->KeyAt(leaf_page->GetSize() - 1), ext_leaf_page->KeyAt(0));
+  page_id_t child_page_id = leaf_page->GetPageId();
+  page_id_t new_page_id = ext_leaf_page->GetPageId();
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+  buffer_pool_manager_->UnpinPage(child_page_id, true);
+  path.pop_back();
+
+  while(!path.empty()) {
+    auto cur_internal_page = reinterpret_cast<InternalPage *>(path.back().page_);
+    int child_index = path.back().index_;
+    path.pop_back();
+    if(cur_internal_page->HasRoomFor(split_key)) {
+      cur_internal_page->InsertNodeAfter(child_page_id, split_key, new_page_id);
+      buffer_pool_manager_->UnpinPage(cur_internal_page->GetPageId(), true);
+      ReleasePath(path, false);
+      return true;
+    }
+    sequential = sequential && child_index == cur_internal_page->GetSize() - 1;
+    auto ext_internal_page = Split(cur_internal_page, sequential ? APPEND_SPLIT_PERCENT : 50);
+    KeyType new_key = split_key;
+    split_key = ext_internal_page->KeyAt(0);
+    ext_internal_page->SetKeyAt(0, KeyType{});
+    if(child_index < cur_internal_page->GetSize()) {
+      cur_internal_page->InsertNodeAfter(child_page_id, new_key, new_page_id);
+    } else {
+      ext_internal_page->InsertNodeAfter(child_page_id, new_key, new_page_id);
+    }
+    // with tiny max sizes the new page may end up with a single child
+    if(ext_internal_page->GetSize() < 2) {
+      KeyType moved_key = cur_internal_page->KeyAt(cur_internal_page->GetSize() - 1);
+      cur_internal_page->MoveLastToFrontOf(ext_internal_page, split_key);
+      split_key = moved_key;
+    }
+    child_page_id = cur_internal_page->GetPageId();
+    new_page_id = ext_internal_page->GetPageId();
+    buffer_pool_manager_->UnpinPage(new_page_id, true);
+    buffer_pool_manager_->UnpinPage(child_page_id, true);
   }
+
+  // the root was split
   page_id_t new_root_page_id;
-  auto new_root = reinterpret_cast<InternalPage *>(buffer_pool_manager_->NewPage(new_root_page_id)->GetData());
-  new_root->Init(new_root_page_id, INVALID_PAGE_ID, internal_max_size_);
-  new_root->SetSize(2);
-  new_root->GetData()[0] = make_pair(FirstKey(root_tree_page), root_tree_page->GetPageId());
-  new_root->GetData()[1] = make_pair(FirstKey(new_page), new_page->GetPageId());
-  root_tree_page->SetParentPageId(new_root_page_id);
-  new_page->SetParentPageId(new_root_page_id);
+  Page *p = buffer_pool_manager_->NewPage(new_root_page_id);
+  if(p == nullptr) throw std::bad_alloc();
+  auto new_root = reinterpret_cast<InternalPage *>(p->GetData());
+  new_root->Init(new_root_page_id, internal_max_size_);
+  new_root->PopulateNewRoot(child_page_id, split_key, new_page_id);
   buffer_pool_manager_->UnpinPage(new_root_page_id, true);
-  buffer_pool_manager_->UnpinPage(new_page->GetPageId(), true);
-  buffer_pool_manager_->UnpinPage(root_page_id_, true);
   root_page_id_ = new_root_page_id;
   UpdateRootPageId(0);
   return true;
 }
 
+/*
+ * Fast path of Insert for a key greater than every key in the tree: such a key
+ * belongs to the rightmost leaf, which is appended to without a descent.
+ * @return: false if the key is not the largest one or the leaf is full, in
+ * which case the caller does a regular insert.
+ */
 INDEX_TEMPLATE_ARGUMENTS
-KeyType BPLUSTREE_TYPE::FirstKey(BPlusTreePage *p) {
-  if(p->IsLeafPage()) return reinterpret_cast<LeafPage *>(p)->GetData()[0].first;
-  else return reinterpret_cast<InternalPage *>(p)->GetData()[0].first;
-}
-INDEX_TEMPLATE_ARGUMENTS
-BPlusTreePage *BPLUSTREE_TYPE::InsertDown(BPlusTreePage *cur_tree_page,const KeyType &key, const ValueType &value, KeyType &min_key, bool &exist){
-  if(cur_tree_page->IsLeafPage()){
-    auto cur_leaf_page = reinterpret_cast<LeafPage *>(cur_tree_page);
-    ValueType temp;
-    auto cur_data = cur_leaf_page->GetData();
-    if(cur_leaf_page->Lookup(key, temp, comparator_)) {
-      return min_key = cur_data[0].first, exist = true, nullptr;
-    }
-    int pos = cur_leaf_page->KeyIndex(key, comparator_);
-    if(cur_leaf_page->GetSize() < cur_leaf_page->GetMaxSize()) {
-      cur_leaf_page->Insert(key, value, comparator_);
-      return min_key = cur_data[0].first, nullptr;
-    }
-    page_id_t ext_page_id;
-    auto ext_leaf_page = reinterpret_cast<LeafPage *>(buffer_pool_manager_->NewPage(ext_page_id)->GetData());
-    ext_leaf_page->Init(ext_page_id, cur_leaf_page->GetParentPageId(), leaf_max_size_);
-    ext_leaf_page->SetSize(leaf_max_size_ + 1 - (leaf_max_size_ / 2));
-    ext_leaf_page->SetNextPageId(cur_leaf_page->GetNextPageId());
-    cur_leaf_page->SetSize(leaf_max_size_ / 2);
-    cur_leaf_page->SetNextPageId(ext_page_id);
-    auto ext_data = ext_leaf_page->GetData();
-    for(int i = leaf_max_size_; i >= 0 ;i --){
-      pair<KeyType, ValueType> cur_pair;
-      if(i < pos) cur_pair = cur_data[i];
-      else if(i == pos) cur_pair = make_pair(key, value);
-      else cur_pair = cur_data[i - 1];
-      if(i < internal_max_size_ / 2) cur_data[i] = cur_pair;
-      else ext_data[i - internal_max_size_ / 2] = cur_pair;
-    }
-    return min_key = cur_data[0].first, ext_leaf_page;
+bool BPLUSTREE_TYPE::AppendToRightmostLeaf(const KeyType &key, const ValueType &value) {
+  if(rightmost_leaf_id_ == INVALID_PAGE_ID) return false;
+  auto leaf_page = reinterpret_cast<LeafPage *>(buffer_pool_manager_->FetchPage(rightmost_leaf_id_)->GetData());
+  assert(leaf_page->IsLeafPage() && leaf_page->GetNextPageId() == INVALID_PAGE_ID);
+  if(leaf_page->GetSize() == 0 || comparator_(key, leaf_page->KeyAt(leaf_page->GetSize() - 1)) <= 0) {
+    append_streak_ = 0;
+    buffer_pool_manager_->UnpinPage(rightmost_leaf_id_, false);
+    return false;
   }
-  page_id_t tar_page_id;
-  auto cur_internal_page = reinterpret_cast<InternalPage * >(cur_tree_page);
-  auto cur_data = cur_internal_page->GetData();
-  tar_page_id = cur_internal_page->Lookup(key, comparator_);
-  int tar_page_index = cur_internal_page->ValueIndex(tar_page_id);
-
-  auto tar_page = buffer_pool_manager_->FetchPage(tar_page_id);
-  
-  auto tar_tree_page = reinterpret_cast<BPlusTreePage *>(tar_page->GetData());
-
-
-  auto new_page = InsertDown(tar_tree_page, key, value, min_key, exist);
-
-  cur_data[tar_page_index].first = min_key;
-
-  if(new_page == nullptr) {
-      buffer_pool_manager_->UnpinPage(tar_page_id, true);
-      return min_key = cur_data[0].first, nullptr;
-  }
-  page_id_t new_page_id = new_page->GetPageId();
-  
-  KeyType new_key = FirstKey(new_page);
-  
-  if(cur_internal_page->GetSize() < internal_max_size_) {
-    cur_internal_page->InsertNodeAfter(tar_page_id, new_key, new_page_id);
-    buffer_pool_manager_->UnpinPage(new_page_id, true);
-    buffer_pool_manager_->UnpinPage(tar_page_id, true);
-    return min_key = cur_data[0].first, nullptr;
-  }
-  
-  page_id_t ext_page_id;
-  
-  auto ext_internal_page = reinterpret_cast<InternalPage *>(buffer_pool_manager_->NewPage(ext_page_id)->GetData());
-  auto ext_data = ext_internal_page->GetData();
-  ext_internal_page->Init(ext_page_id, cur_internal_page->GetParentPageId(), internal_max_size_);
-  ext_internal_page->SetSize(internal_max_size_ + 1 - (internal_max_size_ / 2));
-  cur_internal_page->SetSize(internal_max_size_ / 2);
-  for(int i = internal_max_size_; i >= 0 ;i --){
-    pair<KeyType, page_id_t> cur_pair;
-    if(i <= tar_page_index) cur_pair = cur_data[i];
-    else if(i == tar_page_index + 1) cur_pair = make_pair(new_key, new_page_id);
-    else cur_pair = cur_data[i - 1];
-    if(i < internal_max_size_ / 2) cur_data[i] = cur_pair;
-    else ext_data[i - internal_max_size_/2] = cur_pair;
+  append_streak_++;
+  if(!leaf_page->HasRoomFor(key)) {
+    buffer_pool_manager_->UnpinPage(rightmost_leaf_id_, false);
+    return false;
   }
-  buffer_pool_manager_->UnpinPage(new_page_id, true);
-  buffer_pool_manager_->UnpinPage(tar_page_id, true);
-  return min_key = cur_data[0].first, ext_internal_page;
+  leaf_page->Insert(key, value, comparator_);
+  buffer_pool_manager_->UnpinPage(rightmost_leaf_id_, true);
+  return true;
 }
 
 /*
@@ -210,24 +332,127 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
   page_id_t root_page_id;
   Page *p = buffer_pool_manager_->NewPage(root_page_id);
   LeafPage * leaf_page = reinterpret_cast<LeafPage *>(p->GetData());
-  leaf_page->Init(root_page_id, INVALID_PAGE_ID, leaf_max_size_);
+  leaf_page->Init(root_page_id, leaf_max_size_);
   leaf_page->Insert(key, value, comparator_);
   root_page_id_ = root_page_id;
+  rightmost_leaf_id_ = root_page_id;
   UpdateRootPageId(1);
   buffer_pool_manager_->UnpinPage(root_page_id, true);
 }
 
 /*
- * Insert constant key & value pair into leaf page
- * User needs to first find the right leaf page as insertion target, then look
- * through leaf page to see whether insert key exist or not. If exist, return
- * immediately, otherwise insert entry. Remember to deal with split if necessary.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * Build the tree level by level from the leaves up. Leaves are filled in key
+ * order until the next key does not fit, and every level is the list of its
+ * pages with the separator in front of each, which the next level up is
+ * built from the same way. No descent or split happens, and all pages but the
+ * last one of a level are full.
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) {
-  return false;
+bool BPLUSTREE_TYPE::BulkLoad(const std::vector<MappingType> &items) {
+  if(!IsEmpty()) return false;
+  if(items.empty()) return true;
+  // separator in front of every page of a level (unused for the first) and its id
+  std::vector<std::pair<KeyType, page_id_t>> level;
+  LeafPage *leaf_page = nullptr;
+  for(auto &item : items) {
+    if(leaf_page == nullptr || !leaf_page->HasRoomFor(item.first)) {
+      page_id_t page_id;
+      Page *p = buffer_pool_manager_->NewPage(page_id);
+      if(p == nullptr) throw std::bad_alloc();
+      KeyType separator{};
+      if(leaf_page != nullptr) {
+        separator = Separator(leaf_page->KeyAt(leaf_page->GetSize() - 1), item.first);
+        leaf_page->SetNextPageId(page_id);
+        buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
+      }
+      leaf_page = reinterpret_cast<LeafPage *>(p->GetData());
+      leaf_page->Init(page_id, leaf_max_size_);
+      level.emplace_back(separator, page_id);
+    }
+    leaf_page->Insert(item.first, item.second, comparator_);
+  }
+  rightmost_leaf_id_ = leaf_page->GetPageId();
+  buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
+
+  while(level.size() > 1) {
+    std::vector<std::pair<KeyType, page_id_t>> parents;
+    InternalPage *page = nullptr;
+    for(size_t i = 0; i < level.size(); i++) {
+      if(page != nullptr && page->HasRoomFor(level[i].first)) {
+        page->InsertNodeAfter(page->ValueAt(page->GetSize() - 1), level[i].first, level[i].second);
+        continue;
+      }
+      KeyType separator = level[i].first;
+      page_id_t first_child = level[i].second;
+      // a page needs two children, the last one borrows one from its left neighbour
+      bool last = i + 1 == level.size();
+      if(last) {
+        assert(page->GetSize() > 2);
+        separator = page->KeyAt(page->GetSize() - 1);
+        first_child = page->ValueAt(page->GetSize() - 1);
+        page->Remove(page->GetSize() - 1);
+      }
+      if(page != nullptr) buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+      page_id_t page_id;
+      Page *p = buffer_pool_manager_->NewPage(page_id);
+      if(p == nullptr) throw std::bad_alloc();
+      page = reinterpret_cast<InternalPage *>(p->GetData());
+      page->Init(page_id, internal_max_size_);
+      if(!last) i++;
+      page->PopulateNewRoot(first_child, level[i].first, level[i].second);
+      parents.emplace_back(separator, page_id);
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    level.swap(parents);
+  }
+  root_page_id_ = level[0].second;
+  UpdateRootPageId(1);
+  return true;
+}
+
+/*
+ * Insert a run of sorted keys: after a descent the leaf takes every following
+ * key below the separator bounding it on the right while it has room, so keys
+ * sharing a leaf cost a single descent. A key meeting a full leaf goes through
+ * Insert and splits it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+size_t BPLUSTREE_TYPE::InsertSorted(const std::vector<MappingType> &items) {
+  size_t i = 0;
+  while(i < items.size()) {
+    if(IsEmpty()) {
+      StartNewTree(items[i].first, items[i].second);
+      i++;
+      continue;
+    }
+    std::vector<PathEntry> path;
+    FindPath(items[i].first, path);
+    KeyType bound;
+    bool bounded = LeafBound(path, bound);
+    auto leaf_page = reinterpret_cast<LeafPage *>(path.back().page_);
+    bool dirty = false, full = false;
+    ValueType temp;
+    for(; i < items.size() && (!bounded || comparator_(items[i].first, bound) < 0); i++) {
+      if(leaf_page->Lookup(items[i].first, temp, comparator_)) break;
+      if(!leaf_page->HasRoomFor(items[i].first)) {
+        full = true;
+        break;
+      }
+      leaf_page->Insert(items[i].first, items[i].second, comparator_);
+      dirty = true;
+    }
+    bool conflict = !full && i < items.size() && (!bounded || comparator_(items[i].first, bound) < 0);
+    if(dirty && leaf_page->GetNextPageId() == INVALID_PAGE_ID) rightmost_leaf_id_ = leaf_page->GetPageId();
+    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), dirty);
+    path.pop_back();
+    ReleasePath(path, false);
+    if(conflict) return i;
+    if(full) {
+      if(!Insert(items[i].first, items[i].second)) return i;
+      i++;
+    }
+  }
+  return i;
 }
 
 /*
@@ -236,25 +461,18 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then move half
  * of key & value pairs from input page to newly created page
+ * NOTE: the returned page is pinned, caller should unpin it after use.
  */
 INDEX_TEMPLATE_ARGUMENTS
 template<typename N>
-N *BPLUSTREE_TYPE::Split(N *node) {
-  return nullptr;
-}
-
-/*
- * Insert key & value pair into internal page after split
- * @param   old_node      input page from split() method
- * @param   key
- * @param   new_node      returned page from split() method
- * User needs to first find the parent page of old_node, parent node must be
- * adjusted to take info of new_node into account. Remember to deal with split
- * recursively if necessary.
- */
-INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                                      Transaction *transaction) {
+N *BPLUSTREE_TYPE::Split(N *node, int left_percent) {
+  page_id_t new_page_id;
+  Page *p = buffer_pool_manager_->NewPage(new_page_id);
+  if(p == nullptr) throw std::bad_alloc();
+  N *new_node = reinterpret_cast<N *>(p->GetData());
+  new_node->Init(new_page_id, node->GetMaxSize());
+  node->MoveHalfTo(new_node, left_percent);
+  return new_node;
 }
 
 /*****************************************************************************
@@ -265,210 +483,272 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
  * If current tree is empty, return immediately.
  * If not, User needs to first find the right leaf page as deletion target, then
  * delete entry from leaf page. Remember to deal with redistribute or merge if
- * necessary.
+ * necessary. Underflowed pages are fixed bottom up along the pinned path.
+ * @return: false if the key was not in the tree
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
-  if(IsEmpty()) return ;
-  auto root_tree_page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(root_page_id_)->GetData());
-  RemoveDown(root_tree_page, key);
-  if(!root_tree_page->IsLeafPage() && root_tree_page->GetSize() == 1) {
-    auto p = reinterpret_cast<InternalPage *>(root_tree_page);
-    auto new_root_page_id = p->GetData()[0].second;
-    buffer_pool_manager_->UnpinPage(root_page_id_, true);
-    buffer_pool_manager_->DeletePage(root_page_id_);
-    root_page_id_ = new_root_page_id;
-    root_tree_page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(root_page_id_)->GetData());
-    root_tree_page->SetParentPageId(INVALID_PAGE_ID);
-    buffer_pool_manager_->UnpinPage(root_page_id_,true);
-    UpdateRootPageId(0);
-  } else if(root_tree_page->IsLeafPage() && root_tree_page->GetSize() == 0) {
-    buffer_pool_manager_->UnpinPage(root_page_id_, true);
-    buffer_pool_manager_->DeletePage(root_page_id_);
-    root_page_id_ = INVALID_PAGE_ID;
-    UpdateRootPageId(-1);
-  } else {
-    buffer_pool_manager_->UnpinPage(root_page_id_,true);
+bool BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  if(IsEmpty()) return false;
+  std::vector<PathEntry> path;
+  FindPath(key, path);
+  auto leaf_page = reinterpret_cast<LeafPage *>(path.back().page_);
+  int old_size = leaf_page->GetSize();
+  if(leaf_page->RemoveAndDeleteRecord(key, comparator_) == old_size) {
+    ReleasePath(path, false);
+    return false;
   }
+  RebalancePath(path);
+  return true;
 }
 
+/*
+ * Remove sorted distinct keys in one left-to-right pass: after a descent every
+ * following key below the separator bounding the leaf on the right is removed
+ * from it at once, and the leaf is rebalanced once, so keys sharing a leaf
+ * cost a single descent. Keys not in the tree are skipped.
+ * @return: number of keys removed
+ */
 INDEX_TEMPLATE_ARGUMENTS
-KeyType BPLUSTREE_TYPE::RemoveDown(BPlusTreePage *cur_tree_page, const KeyType &key) {
-  if(cur_tree_page->IsLeafPage()) {
-    auto cur_leaf_page = reinterpret_cast<LeafPage *>(cur_tree_page);
-    auto cur_data = cur_leaf_page->GetData();
-    int cur_size = cur_leaf_page->GetSize();
-    ValueType temp;
-    if(cur_leaf_page->Lookup(key, temp, comparator_)) {
-      int tar_row_index = cur_leaf_page->KeyIndex(key, comparator_);
-      for(int i = tar_row_index; i < cur_size - 1; ++i) 
-        cur_data[i] = cur_data[i + 1];
-      cur_leaf_page->IncreaseSize(-1);
+size_t BPLUSTREE_TYPE::RemoveSorted(const std::vector<KeyType> &keys) {
+  size_t i = 0, removed = 0;
+  while(i < keys.size() && !IsEmpty()) {
+    std::vector<PathEntry> path;
+    FindPath(keys[i], path);
+    KeyType bound;
+    bool bounded = LeafBound(path, bound);
+    size_t end = i;
+    while(end < keys.size() && (!bounded || comparator_(keys[end], bound) < 0)) end++;
+    auto leaf_page = reinterpret_cast<LeafPage *>(path.back().page_);
+    int count = leaf_page->RemoveRecords(keys.data() + i, static_cast<int>(end - i), comparator_);
+    i = end;
+    if(count == 0) {
+      ReleasePath(path, false);
+      continue;
     }
-    return cur_data[0].first;
-  }
-  page_id_t tar_page_id;
-  auto cur_internal_page = reinterpret_cast<InternalPage *>(cur_tree_page);
-  auto cur_data = cur_internal_page->GetData();
-  tar_page_id = cur_internal_page->Lookup(key, comparator_);
-  int tar_page_index = cur_internal_page->ValueIndex(tar_page_id);
-  auto tar_page = buffer_pool_manager_->FetchPage(tar_page_id);
-  auto tar_tree_page = reinterpret_cast<BPlusTreePage *>(tar_page->GetData());
-
-  cur_data[tar_page_index].first = RemoveDown(tar_tree_page, key);
-
-  auto remain_size = tar_tree_page->GetMaxSize() - tar_tree_page->GetSize();
-  buffer_pool_manager_->UnpinPage(tar_page_id, true);
-  if(tar_tree_page->GetSize() >= tar_tree_page->GetMinSize()) return cur_data[0].first;
-
-  int left_index = -1;
-  if(tar_page_index > 0) {
-    auto sib_page = buffer_pool_manager_->FetchPage(cur_internal_page->GetData()[tar_page_index - 1].second);
-    auto sib_tree_page = reinterpret_cast<BPlusTreePage *>(sib_page->GetData());
-    if(sib_tree_page->GetSize() <= remain_size) left_index = tar_page_index - 1;
-    buffer_pool_manager_->UnpinPage(sib_page->GetPageId(),false);
-  }
-  if(left_index == -1 && tar_page_index < cur_internal_page->GetSize() - 1) {
-    auto sib_page = buffer_pool_manager_->FetchPage(cur_internal_page->GetData()[tar_page_index + 1].second);
-    auto sib_tree_page = reinterpret_cast<BPlusTreePage *>(sib_page->GetData());
-    if(sib_tree_page->GetSize() <= remain_size) left_index = tar_page_index;
-    buffer_pool_manager_->UnpinPage(sib_page->GetPageId(),false);
-  }
-  if(left_index != -1) {
-    auto left_page = buffer_pool_manager_->FetchPage(cur_internal_page->GetData()[left_index].second);
-    auto left_tree_page = reinterpret_cast<BPlusTreePage *>(left_page->GetData());
-    auto right_page = buffer_pool_manager_->FetchPage(cur_internal_page->GetData()[left_index + 1].second);
-    auto right_tree_page = reinterpret_cast<BPlusTreePage *>(right_page->GetData());
-    char *src, *dest;
-    size_t size;
-    if(left_tree_page->IsLeafPage()){
-      auto left_leaf = reinterpret_cast<LeafPage *>(left_tree_page);
-      auto right_leaf = reinterpret_cast<LeafPage *>(right_tree_page);
-      src = reinterpret_cast<char *>(right_leaf->GetData() );
-      dest = reinterpret_cast<char *>(left_leaf->GetData() + left_leaf->GetSize());
-      size = sizeof(pair<KeyType, ValueType>) * right_leaf->GetSize();
-      left_leaf->SetNextPageId(right_leaf->GetNextPageId());
-      left_leaf->IncreaseSize(right_leaf->GetSize());
-    } else {
-      auto left_leaf = reinterpret_cast<InternalPage *>(left_tree_page);
-      auto right_leaf = reinterpret_cast<InternalPage *>(right_tree_page);
-      src = reinterpret_cast<char *>(right_leaf->GetData() );
-      dest = reinterpret_cast<char *>(left_leaf->GetData() + left_leaf->GetSize());
-      size = sizeof(pair<KeyType, page_id_t>) * right_leaf->GetSize();
-      left_leaf->IncreaseSize(right_leaf->GetSize());
+    removed += count;
+    RebalancePath(path);
+  }
+  return removed;
+}
+
+/*
+ * Set the values of keys in the tree, items sorted by distinct keys. As in
+ * RemoveSorted the items below the bound of a leaf are handled in one descent.
+ * Only values change, so no page splits, merges or gets freed. Keys not in the
+ * tree are skipped.
+ * @return: number of keys updated
+ */
+INDEX_TEMPLATE_ARGUMENTS
+size_t BPLUSTREE_TYPE::UpdateSorted(const std::vector<MappingType> &items) {
+  size_t i = 0, updated = 0;
+  while(i < items.size() && !IsEmpty()) {
+    std::vector<PathEntry> path;
+    FindPath(items[i].first, path);
+    KeyType bound;
+    bool bounded = LeafBound(path, bound);
+    auto leaf_page = reinterpret_cast<LeafPage *>(path.back().page_);
+    size_t begin = updated;
+    for(; i < items.size() && (!bounded || comparator_(items[i].first, bound) < 0); i++) {
+      int index = leaf_page->KeyIndex(items[i].first, comparator_);
+      if(index < leaf_page->GetSize() && comparator_(leaf_page->KeyAt(index), items[i].first) == 0) {
+        leaf_page->SetValueAt(index, items[i].second);
+        updated++;
+      }
     }
-    memcpy(dest, src, size);
-    buffer_pool_manager_->UnpinPage(left_page->GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(right_page->GetPageId(), true);
-    buffer_pool_manager_->DeletePage(right_page->GetPageId());
-
-    for(int i = left_index + 1;i < cur_internal_page->GetSize() - 1;i++) 
-        cur_data[i] = cur_data[i + 1];
-    cur_internal_page->IncreaseSize(-1);
-    return cur_data[0].first;
-  }
-  if(tar_page_index > 0) {
-    auto left_page = buffer_pool_manager_->FetchPage(cur_internal_page->GetData()[tar_page_index - 1].second);
-    auto left_tree_page = reinterpret_cast<BPlusTreePage *>(left_page->GetData());
-    auto right_page = buffer_pool_manager_->FetchPage(cur_internal_page->GetData()[tar_page_index].second);
-    auto right_tree_page = reinterpret_cast<BPlusTreePage *>(right_page->GetData());
-    if(left_tree_page->IsLeafPage()) {
-      auto left_leaf = reinterpret_cast<LeafPage *>(left_tree_page);
-      auto right_leaf = reinterpret_cast<LeafPage *>(right_tree_page);
-      for(int i = right_leaf->GetSize(); i > 0; --i) right_leaf->GetData()[i] = right_leaf->GetData()[i - 1];
-      right_leaf->IncreaseSize(1);
-      right_leaf->GetData()[0] = left_leaf->GetData()[left_leaf->GetSize() - 1];
-      left_leaf->IncreaseSize(-1);
-      cur_data[tar_page_index].first = right_leaf->GetData()[0].first;
-    } else {
-      auto left_leaf = reinterpret_cast<InternalPage *>(left_tree_page);
-      auto right_leaf = reinterpret_cast<InternalPage *>(right_tree_page);
-      for(int i = right_leaf->GetSize(); i > 0; --i) right_leaf->GetData()[i] = right_leaf->GetData()[i - 1];
-      right_leaf->IncreaseSize(1);
-      right_leaf->GetData()[0] = left_leaf->GetData()[left_leaf->GetSize() - 1];
-      left_leaf->IncreaseSize(-1);
-      cur_data[tar_page_index].first = right_leaf->GetData()[0].first;
+    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), updated != begin);
+    path.pop_back();
+    ReleasePath(path, false);
+  }
+  return updated;
+}
+
+/*
+ * The leaf at the end of path holds keys below the separator of the next child
+ * of the lowest ancestor having one.
+ * @return: false if the leaf is the rightmost one and has no bound
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::LeafBound(const std::vector<PathEntry> &path, KeyType &bound) const {
+  for(size_t level = path.size() - 1; level-- > 0;) {
+    auto internal_page = reinterpret_cast<InternalPage *>(path[level].page_);
+    if(path[level].index_ + 1 < internal_page->GetSize()) {
+      bound = internal_page->KeyAt(path[level].index_ + 1);
+      return true;
     }
-    buffer_pool_manager_->UnpinPage(left_page->GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(right_page->GetPageId(), true);
-  } else {
-    auto left_page = buffer_pool_manager_->FetchPage(cur_internal_page->GetData()[tar_page_index].second);
-    auto left_tree_page = reinterpret_cast<BPlusTreePage *>(left_page->GetData());
-    auto right_page = buffer_pool_manager_->FetchPage(cur_internal_page->GetData()[tar_page_index + 1].second);
-    auto right_tree_page = reinterpret_cast<BPlusTreePage *>(right_page->GetData());
-    if(left_tree_page->IsLeafPage()) {
-      auto left_leaf = reinterpret_cast<LeafPage *>(left_tree_page);
-      auto right_leaf = reinterpret_cast<LeafPage *>(right_tree_page);
-      left_leaf->IncreaseSize(1);
-      left_leaf->GetData()[left_leaf->GetSize() - 1] = right_leaf->GetData()[0];
-      right_leaf->IncreaseSize(-1);
-      for(int i = 0; i < right_leaf->GetSize(); ++i) right_leaf->GetData()[i] = right_leaf->GetData()[i + 1];
-      cur_data[tar_page_index + 1].first = right_leaf->GetData()[0].first;
+  }
+  return false;
+}
+
+/*
+ * Fix underflowed pages bottom up along a path whose leaf lost keys, then
+ * adjust the root. Unpins every page of path.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RebalancePath(std::vector<PathEntry> &path) {
+  for(size_t level = path.size() - 1; level > 0; --level) {
+    auto node = path[level].page_;
+    auto parent = reinterpret_cast<InternalPage *>(path[level - 1].page_);
+    int index = path[level - 1].index_;
+    if(node->IsLeafPage()) {
+      CoalesceOrRedistribute(reinterpret_cast<LeafPage *>(node), parent, index);
     } else {
-      auto left_leaf = reinterpret_cast<InternalPage *>(left_tree_page);
-      auto right_leaf = reinterpret_cast<InternalPage *>(right_tree_page);
-      left_leaf->IncreaseSize(1);
-      left_leaf->GetData()[left_leaf->GetSize() - 1] = right_leaf->GetData()[0];
-      right_leaf->IncreaseSize(-1);
-      for(int i = 0; i < right_leaf->GetSize(); ++i) right_leaf->GetData()[i] = right_leaf->GetData()[i + 1];
-      cur_data[tar_page_index + 1].first = right_leaf->GetData()[0].first;
+      CoalesceOrRedistribute(reinterpret_cast<InternalPage *>(node), parent, index);
     }
-    buffer_pool_manager_->UnpinPage(left_page->GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(right_page->GetPageId(), true);
   }
-  return cur_data[0].first;
+  auto root_tree_page = path[0].page_;
+  page_id_t old_root_page_id = root_tree_page->GetPageId();
+  bool root_deleted = AdjustRoot(root_tree_page);
+  buffer_pool_manager_->UnpinPage(old_root_page_id, true);
+  if(root_deleted) {
+    buffer_pool_manager_->DeletePage(old_root_page_id);
+    freed_pages_++;
+  }
+  path.clear();
 }
 
 /*
  * User needs to first find the sibling of input page. If sibling's size + input
  * page's size > page's max size, then redistribute. Otherwise, merge.
  * Using template N to represent either internal page or leaf page.
+ * NOTE: node is pinned by the caller and gets unpinned here.
  * @return: true means target leaf page should be deleted, false means no
  * deletion happens
  */
 INDEX_TEMPLATE_ARGUMENTS
 template<typename N>
-bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
+bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, InternalPage *parent, int index, Transaction *transaction) {
+  if(!node->IsUnderflow() || parent->GetSize() < 2) {
+    buffer_pool_manager_->UnpinPage(node->GetPageId(), true);
+    return false;
+  }
+  int sibling_index = index > 0 ? index - 1 : index + 1;
+  page_id_t sibling_page_id = parent->ValueAt(sibling_index);
+  auto sibling = reinterpret_cast<N *>(buffer_pool_manager_->FetchPage(sibling_page_id)->GetData());
+  N *left = index > 0 ? sibling : node;
+  N *right = index > 0 ? node : sibling;
+  int right_index = index > 0 ? index : index + 1;
+  bool can_merge;
+  if constexpr (std::is_same<N, LeafPage>::value) {
+    can_merge = left->CanMergeWith(right);
+  } else {
+    can_merge = left->CanMergeWith(right, parent->KeyAt(right_index));
+  }
+  if(can_merge) {
+    return Coalesce(&left, &right, &parent, right_index, transaction);
+  }
+  Redistribute(sibling, node, parent, index);
+  buffer_pool_manager_->UnpinPage(sibling_page_id, true);
+  buffer_pool_manager_->UnpinPage(node->GetPageId(), true);
   return false;
 }
 
 /*
  * Move all the key & value pairs from one page to its sibling page, and notify
  * buffer pool manager to delete this page. Parent page must be adjusted to
- * take info of deletion into account. Remember to deal with coalesce or
- * redistribute recursively if necessary.
+ * take info of deletion into account. Underflow of parent is handled by its
+ * own parent once the recursion returns.
  * Using template N to represent either internal page or leaf page.
- * @param   neighbor_node      sibling page of input "node"
- * @param   node               input from method coalesceOrRedistribute()
- * @param   parent             parent page of input "node"
+ * @param   neighbor_node      left page, receives all the pairs
+ * @param   node               right page, deleted afterwards
+ * @param   parent             parent page of both
+ * @param   index              index of node in parent
  * @return  true means parent node should be deleted, false means no deletion happened
  */
 INDEX_TEMPLATE_ARGUMENTS
 template<typename N>
-bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
-                              BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent, int index,
+bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node, InternalPage **parent, int index,
                               Transaction *transaction) {
-  return false;
+  page_id_t node_page_id = (*node)->GetPageId();
+  if constexpr (std::is_same<N, LeafPage>::value) {
+    (*node)->MoveAllTo(*neighbor_node);
+  } else {
+    (*node)->MoveAllTo(*neighbor_node, (*parent)->KeyAt(index));
+  }
+  (*parent)->Remove(index);
+  buffer_pool_manager_->UnpinPage((*neighbor_node)->GetPageId(), true);
+  buffer_pool_manager_->UnpinPage(node_page_id, true);
+  buffer_pool_manager_->DeletePage(node_page_id);
+  freed_pages_++;
+  if(node_page_id == rightmost_leaf_id_) rightmost_leaf_id_ = (*neighbor_node)->GetPageId();
+  return (*parent)->GetSize() == 0;
 }
 
 /*
  * Redistribute key & value pairs from one page to its sibling page. If index ==
  * 0, move sibling page's first key & value pair into end of input "node",
  * otherwise move sibling page's last key & value pair into head of input
- * "node".
+ * "node". Pairs are moved one by one until node no longer underflows, and the
+ * separator in parent follows along. Since keys vary in length, a move is
+ * skipped when the new separator would not fit into parent; node is then
+ * simply left underflowed.
  * Using template N to represent either internal page or leaf page.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
  */
 INDEX_TEMPLATE_ARGUMENTS
 template<typename N>
-void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
+void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, InternalPage *parent, int index) {
+  int right_index = index > 0 ? index : index + 1;
+  int min_donor_size = node->IsLeafPage() ? 1 : 2;
+  while(node->IsUnderflow() && !neighbor_node->IsUnderflow() && neighbor_node->GetSize() > min_donor_size) {
+    if constexpr (std::is_same<N, LeafPage>::value) {
+      if(index == 0) {
+        KeyType moved_key = neighbor_node->KeyAt(0);
+        KeyType separator = Separator(moved_key, neighbor_node->KeyAt(1));
+        if(!node->HasRoomFor(moved_key) || !parent->CanSetKeyAt(right_index, separator)) break;
+        neighbor_node->MoveFirstToEndOf(node);
+        parent->SetKeyAt(right_index, separator);
+      } else {
+        KeyType moved_key = neighbor_node->KeyAt(neighbor_node->GetSize() - 1);
+        KeyType separator = Separator(neighbor_node->KeyAt(neighbor_node->GetSize() - 2), moved_key);
+        if(!node->HasRoomFor(moved_key) || !parent->CanSetKeyAt(right_index, separator)) break;
+        neighbor_node->MoveLastToFrontOf(node);
+        parent->SetKeyAt(right_index, separator);
+      }
+    } else {
+      KeyType middle_key = parent->KeyAt(right_index);
+      if(!node->HasRoomFor(middle_key)) break;
+      if(index == 0) {
+        if(!parent->CanSetKeyAt(right_index, neighbor_node->KeyAt(1))) break;
+        neighbor_node->MoveFirstToEndOf(node, middle_key);
+        parent->SetKeyAt(right_index, neighbor_node->KeyAt(0));
+        neighbor_node->SetKeyAt(0, KeyType{});
+      } else {
+        KeyType moved_key = neighbor_node->KeyAt(neighbor_node->GetSize() - 1);
+        if(!parent->CanSetKeyAt(right_index, moved_key)) break;
+        neighbor_node->MoveLastToFrontOf(node, middle_key);
+        parent->SetKeyAt(right_index, moved_key);
+      }
+    }
+  }
+}
+
+/*
+ * Shortest separator between two adjacent leaves: for byte comparable keys
+ * the prefix of right_first up to the first byte differing from left_last, so
+ * that left_last < separator <= right_first. Shorter separators keep more keys
+ * in internal pages. Other comparators get right_first itself.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+KeyType BPLUSTREE_TYPE::Separator(const KeyType &left_last, const KeyType &right_first) const {
+  if constexpr (!IsByteComparable<KeyComparator>::value) {
+    return right_first;
+  } else {
+    KeyType separator;
+    auto left = reinterpret_cast<const char *>(&left_last);
+    auto right = reinterpret_cast<const char *>(&right_first);
+    size_t len = 0;
+    while(len < sizeof(KeyType) && left[len] == right[len]) len++;
+    memset(reinterpret_cast<char *>(&separator), 0, sizeof(KeyType));
+    memcpy(reinterpret_cast<char *>(&separator), right, std::min(len + 1, sizeof(KeyType)));
+    return separator;
+  }
 }
 
 /*
  * Update root page if necessary
  * NOTE: size of root page can be less than min size and this method is only
- * called within coalesceOrRedistribute() method
+ * called within Remove() method
  * case 1: when you delete the last element in root page, but root page still
  * has one last child
  * case 2: when you delete the last element in whole b+ tree
@@ -477,6 +757,17 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
+  if(!old_root_node->IsLeafPage() && old_root_node->GetSize() == 1) {
+    root_page_id_ = reinterpret_cast<InternalPage *>(old_root_node)->RemoveAndReturnOnlyChild();
+    UpdateRootPageId(0);
+    return true;
+  }
+  if(old_root_node->IsLeafPage() && old_root_node->GetSize() == 0) {
+    root_page_id_ = INVALID_PAGE_ID;
+    rightmost_leaf_id_ = INVALID_PAGE_ID;
+    UpdateRootPageId(-1);
+    return true;
+  }
   return false;
 }
 
@@ -494,7 +785,7 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
   page_id_t now = root_page_id_;
   Page *p = buffer_pool_manager_->FetchPage(now);
   while(!reinterpret_cast<BPlusTreePage *>(p->GetData())->IsLeafPage()) {
-    page_id_t nxt = reinterpret_cast<InternalPage *>(p->GetData())->GetData()[0].second;
+    page_id_t nxt = reinterpret_cast<InternalPage *>(p->GetData())->ValueAt(0);
     buffer_pool_manager_->UnpinPage(now, false);
     now = nxt;
     p = buffer_pool_manager_->FetchPage(now);
@@ -521,6 +812,29 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
   return INDEXITERATOR_TYPE(this, leaf, index);
 }
 
+/*
+ * Input parameter is a key that need not be in the tree, find the leaf page
+ * that contains the first key not less than it and construct an index
+ * iterator there
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::LowerBound(const KeyType &key) {
+  auto p = FindLeafPage(key);
+  if(p == nullptr) return End();
+  auto leaf = reinterpret_cast<LeafPage *>(p->GetData());
+  int index = leaf->KeyIndex(key, comparator_);
+  // every key of the leaf is smaller, the answer starts the next non-empty leaf
+  while(index >= leaf->GetSize()) {
+    page_id_t next = leaf->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+    if(next == INVALID_PAGE_ID) return End();
+    leaf = reinterpret_cast<LeafPage *>(buffer_pool_manager_->FetchPage(next)->GetData());
+    index = 0;
+  }
+  return INDEXITERATOR_TYPE(this, leaf, index);
+}
+
 /*
  * Input parameter is void, construct an index iterator representing the end
  * of the key/value pair in the leaf node
@@ -586,8 +900,7 @@ void BPLUSTREE_TYPE::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::o
     // Print data of the node
     out << "label=<<TABLE BORDER=\"0\" CELLBORDER=\"1\" CELLSPACING=\"0\" CELLPADDING=\"4\">\n";
     // Print data
-    out << "<TR><TD COLSPAN=\"" << leaf->GetSize() << "\">P=" << leaf->GetPageId()
-        << ",Parent=" << leaf->GetParentPageId() << "</TD></TR>\n";
+    out << "<TR><TD COLSPAN=\"" << leaf->GetSize() << "\">P=" << leaf->GetPageId() << "</TD></TR>\n";
     out << "<TR><TD COLSPAN=\"" << leaf->GetSize() << "\">"
         << "max_size=" << leaf->GetMaxSize() << ",min_size=" << leaf->GetMinSize() << ",size=" << leaf->GetSize()
         << "</TD></TR>\n";
@@ -604,12 +917,6 @@ void BPLUSTREE_TYPE::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::o
       out << "{rank=same " << leaf_prefix << leaf->GetPageId() << " " << leaf_prefix << leaf->GetNextPageId()
           << "};\n";
     }
-
-    // Print parent links if there is a parent
-    if (leaf->GetParentPageId() != INVALID_PAGE_ID) {
-      out << internal_prefix << leaf->GetParentPageId() << ":p" << leaf->GetPageId() << " -> " << leaf_prefix
-          << leaf->GetPageId() << ";\n";
-    }
   } else {
     auto *inner = reinterpret_cast<InternalPage *>(page);
     // Print node name
@@ -619,8 +926,7 @@ void BPLUSTREE_TYPE::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::o
     // Print data of the node
     out << "label=<<TABLE BORDER=\"0\" CELLBORDER=\"1\" CELLSPACING=\"0\" CELLPADDING=\"4\">\n";
     // Print data
-    out << "<TR><TD COLSPAN=\"" << inner->GetSize() << "\">P=" << inner->GetPageId()
-        << ",Parent=" << inner->GetParentPageId() << "</TD></TR>\n";
+    out << "<TR><TD COLSPAN=\"" << inner->GetSize() << "\">P=" << inner->GetPageId() << "</TD></TR>\n";
     out << "<TR><TD COLSPAN=\"" << inner->GetSize() << "\">"
         << "max_size=" << inner->GetMaxSize() << ",min_size=" << inner->GetMinSize() << ",size=" << inner->GetSize()
         << "</TD></TR>\n";
@@ -637,16 +943,12 @@ void BPLUSTREE_TYPE::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::o
     out << "</TR>";
     // Print table end
     out << "</TABLE>>];\n";
-    // Print Parent link
-    if (inner->GetParentPageId() != INVALID_PAGE_ID) {
-      out << internal_prefix << inner->GetParentPageId() << ":p" << inner->GetPageId() << " -> "
-          << internal_prefix
-          << inner->GetPageId() << ";\n";
-    }
-    // Print leaves
+    // Print leaves and the links to them
     for (int i = 0; i < inner->GetSize(); i++) {
       auto child_page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(inner->ValueAt(i))->GetData());
       ToGraph(child_page, bpm, out);
+      out << internal_prefix << inner->GetPageId() << ":p" << child_page->GetPageId() << " -> "
+          << (child_page->IsLeafPage() ? leaf_prefix : internal_prefix) << child_page->GetPageId() << ";\n";
       if (i > 0) {
         auto sibling_page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(inner->ValueAt(i - 1))->GetData());
         if (!sibling_page->IsLeafPage() && !child_page->IsLeafPage()) {
@@ -667,8 +969,7 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const {
   if (page->IsLeafPage()) {
     auto *leaf = reinterpret_cast<LeafPage *>(page);
-    std::cout << "Leaf Page: " << leaf->GetPageId() << " parent: " << leaf->GetParentPageId()
-              << " next: " << leaf->GetNextPageId() << std::endl;
+    std::cout << "Leaf Page: " << leaf->GetPageId() << " next: " << leaf->GetNextPageId() << std::endl;
     for (int i = 0; i < leaf->GetSize(); i++) {
       std::cout << leaf->KeyAt(i) << ",";
     }
@@ -676,8 +977,7 @@ void BPLUSTREE_TYPE::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const
     std::cout << std::endl;
   } else {
     auto *internal = reinterpret_cast<InternalPage *>(page);
-    std::cout << "Internal Page: " << internal->GetPageId() << " parent: " << internal->GetParentPageId()
-              << std::endl;
+    std::cout << "Internal Page: " << internal->GetPageId() << std::endl;
     for (int i = 0; i < internal->GetSize(); i++) {
       std::cout << internal->KeyAt(i) << ": " << internal->ValueAt(i) << ",";
     }
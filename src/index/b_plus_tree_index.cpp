@@ -1,51 +1,332 @@
+#include <algorithm>
+
 #include "index/b_plus_tree_index.h"
 #include "index/generic_key.h"
 
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema,
-                                     BufferPoolManager *buffer_pool_manager)
+                                     BufferPoolManager *buffer_pool_manager, uint32_t include_column_count)
         : Index(index_id, key_schema),
+          key_column_count_(key_schema->GetColumnCount() - include_column_count),
           comparator_(key_schema_),
           container_(index_id, buffer_pool_manager, comparator_) {
+  RebuildFilter();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::RebuildFilter() {
+  if (!filter_.IsEnabled()) return;
+  std::vector<KeyType> keys;
+  for (auto iter = container_.Begin(); iter != container_.End(); ++iter) {
+    keys.push_back((*iter).first);
+  }
+  filter_.Reset(2 * keys.size());
+  for (auto &key : keys) {
+    filter_.Add(reinterpret_cast<const char *>(&key), key.PrefixLength(key_schema_, key_column_count_));
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_INDEX_TYPE::FilterMayContain(const KeyType &index_key) {
+  return filter_.MayContain(reinterpret_cast<const char *>(&index_key),
+                            index_key.PrefixLength(key_schema_, key_column_count_));
+}
 
+/*
+ * Column encodings are prefix free and order preserving, so the range column
+ * of an entry is compared with a bound by comparing the bytes after the prefix
+ * with the encoded bound.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanPrefix(const Row &key, uint32_t column_count, const IndexRange &range,
+                                      std::vector<MappingType> &result) {
+  KeyType prefix;
+  uint32_t prefix_length = prefix.SerializeFromKey(key, key_schema_, column_count);
+  if (column_count == key_column_count_ && !FilterMayContain(prefix)) return;
+  std::vector<char> low, high;
+  if (range.low_ != nullptr) {
+    low.resize(1 + KeyType::EncodedSize(*range.low_));
+    KeyType::EncodeField(*range.low_, low.data());
+  }
+  if (range.high_ != nullptr) {
+    high.resize(1 + KeyType::EncodedSize(*range.high_));
+    KeyType::EncodeField(*range.high_, high.data());
+  }
+  KeyType start = prefix;
+  if (range.low_ != nullptr || range.high_ != nullptr) {
+    ASSERT(column_count < key_column_count_, "Range on a column out of the key.");
+    auto start_bytes = reinterpret_cast<char *>(&start);
+    if (low.empty()) {
+      // nulls sort first and never satisfy a comparison
+      if (prefix_length < sizeof(KeyType)) start_bytes[prefix_length] = 1;
+    } else {
+      memcpy(start_bytes + prefix_length, low.data(), std::min<size_t>(low.size(), sizeof(KeyType) - prefix_length));
+    }
+  }
+  size_t found = 0;
+  for (auto iter = container_.LowerBound(start); iter != container_.End() && found < range.limit_; ++iter) {
+    auto bytes = reinterpret_cast<const char *>(&(*iter).first);
+    if (memcmp(bytes, &prefix, prefix_length) != 0) break;
+    size_t rest = sizeof(KeyType) - prefix_length;
+    if (!low.empty() && !range.low_inclusive_ && low.size() <= rest &&
+        memcmp(bytes + prefix_length, low.data(), low.size()) == 0) {
+      continue;
+    }
+    if (!high.empty()) {
+      int cmp = memcmp(bytes + prefix_length, high.data(), std::min(high.size(), rest));
+      if (cmp > 0 || (cmp == 0 && !range.high_inclusive_ && high.size() <= rest)) break;
+    }
+    result.push_back(*iter);
+    found++;
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 dberr_t BPLUSTREE_INDEX_TYPE::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
   ASSERT(row_id.Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
+  return InsertKey(key, row_id, nullptr);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t BPLUSTREE_INDEX_TYPE::InsertKey(const Row &key, RowId row_id, IndexReservation *reservation) {
   KeyType index_key;
   index_key.SerializeFromKey(key, key_schema_);
 
-  bool status = container_.Insert(index_key, row_id, txn);
+  // unique on the key columns, whatever the include columns hold
+  if (key_column_count_ < key_schema_->GetColumnCount()) {
+    std::vector<MappingType> matches;
+    ScanPrefix(key, key_column_count_, IndexRange(), matches);
+    if (!matches.empty()) {
+      return DB_KEY_ALREADY_EXIST;
+    }
+  }
+
+  bool status = reservation == nullptr ? container_.Insert(index_key, row_id)
+                                       : container_.Reserve(index_key, reservation->leaf_page_id_,
+                                                            reservation->freed_pages_);
 
   if (!status) {
-    return DB_FAILED;
+    return DB_KEY_ALREADY_EXIST;
+  }
+  filter_.Add(reinterpret_cast<const char *>(&index_key), index_key.PrefixLength(key_schema_, key_column_count_));
+  if (filter_.NeedsRebuild()) {
+    RebuildFilter();
   }
   return DB_SUCCESS;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-dberr_t BPLUSTREE_INDEX_TYPE::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
+dberr_t BPLUSTREE_INDEX_TYPE::ReserveEntry(const Row &key, IndexReservation &reservation, Transaction *txn) {
+  return InsertKey(key, INVALID_ROWID, &reservation);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t BPLUSTREE_INDEX_TYPE::CompleteEntry(const Row &key, RowId row_id, const IndexReservation &reservation,
+                                            Transaction *txn) {
+  ASSERT(row_id.Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
   KeyType index_key;
   index_key.SerializeFromKey(key, key_schema_);
+  container_.Fill(index_key, row_id, reservation.leaf_page_id_, reservation.freed_pages_);
+  return DB_SUCCESS;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::CancelEntry(const Row &key, const IndexReservation &reservation, Transaction *txn) {
+  RemoveEntry(key, INVALID_ROWID, txn);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t BPLUSTREE_INDEX_TYPE::InsertEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids,
+                                            Transaction *txn) {
+  std::vector<MappingType> items(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    items[i].first.SerializeFromKey(keys[i], key_schema_);
+    items[i].second = row_ids[i];
+  }
+  std::sort(items.begin(), items.end(), [&](const MappingType &lhs, const MappingType &rhs) {
+    return comparator_(lhs.first, rhs.first) < 0;
+  });
+  // equal key columns end up next to each other
+  for (size_t i = 1; i < items.size(); i++) {
+    uint32_t length = items[i].first.PrefixLength(key_schema_, key_column_count_);
+    if (length == items[i - 1].first.PrefixLength(key_schema_, key_column_count_) &&
+        memcmp(&items[i].first, &items[i - 1].first, length) == 0) {
+      return DB_KEY_ALREADY_EXIST;
+    }
+  }
+  if (container_.IsEmpty()) {
+    container_.BulkLoad(items);
+    RebuildFilter();
+    return DB_SUCCESS;
+  }
+  std::vector<std::vector<RowId>> matches;
+  ScanKeys(keys, matches, txn);
+  for (auto &match : matches) {
+    if (!match.empty()) return DB_KEY_ALREADY_EXIST;
+  }
+  size_t inserted = container_.InsertSorted(items);
+  if (inserted < items.size()) {
+    for (size_t i = 0; i < inserted; i++) container_.Remove(items[i].first, txn);
+    return DB_FAILED;
+  }
+  for (auto &item : items) {
+    filter_.Add(reinterpret_cast<const char *>(&item.first), item.first.PrefixLength(key_schema_, key_column_count_));
+  }
+  if (filter_.NeedsRebuild()) {
+    RebuildFilter();
+  }
+  return DB_SUCCESS;
+}
 
-  container_.Remove(index_key, txn);
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t BPLUSTREE_INDEX_TYPE::RemoveEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids,
+                                            Transaction *txn) {
+  std::vector<KeyType> index_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    index_keys[i].SerializeFromKey(keys[i], key_schema_);
+  }
+  std::sort(index_keys.begin(), index_keys.end(), [&](const KeyType &lhs, const KeyType &rhs) {
+    return comparator_(lhs, rhs) < 0;
+  });
+  size_t removed = container_.RemoveSorted(index_keys);
+  for (size_t i = 0; i < removed; i++) filter_.Remove();
+  if (filter_.NeedsRebuild()) {
+    RebuildFilter();
+  }
   return DB_SUCCESS;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-dberr_t BPLUSTREE_INDEX_TYPE::ScanKey(const Row &key, vector<RowId> &result, Transaction *txn) {
+dberr_t BPLUSTREE_INDEX_TYPE::RepointEntries(const std::vector<Row> &keys, const std::vector<RowId> &old_row_ids,
+                                             const std::vector<RowId> &row_ids, Transaction *txn) {
+  std::vector<MappingType> items(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    items[i].first.SerializeFromKey(keys[i], key_schema_);
+    items[i].second = row_ids[i];
+  }
+  std::sort(items.begin(), items.end(), [&](const MappingType &lhs, const MappingType &rhs) {
+    return comparator_(lhs.first, rhs.first) < 0;
+  });
+  return container_.UpdateSorted(items) == items.size() ? DB_SUCCESS : DB_KEY_NOT_FOUND;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t BPLUSTREE_INDEX_TYPE::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
   KeyType index_key;
   index_key.SerializeFromKey(key, key_schema_);
-  if (container_.GetValue(index_key, result, txn)) {
+
+  // only keys that were in the tree count towards a rebuild
+  if (!container_.Remove(index_key, txn)) {
     return DB_SUCCESS;
   }
-  return DB_KEY_NOT_FOUND;
+  filter_.Remove();
+  if (filter_.NeedsRebuild()) {
+    RebuildFilter();
+  }
+  return DB_SUCCESS;
+}
+
+/*
+ * Match key on its key columns; include columns it carries are ignored
+ */
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t BPLUSTREE_INDEX_TYPE::ScanKey(const Row &key, vector<RowId> &result, Transaction *txn) {
+  uint32_t column_count = std::min<uint32_t>(key.GetFieldCount(), key_column_count_);
+  if (column_count == key_schema_->GetColumnCount()) {
+    KeyType index_key;
+    index_key.SerializeFromKey(key, key_schema_);
+    if (!FilterMayContain(index_key)) {
+      return DB_KEY_NOT_FOUND;
+    }
+    if (container_.GetValue(index_key, result, txn)) {
+      return DB_SUCCESS;
+    }
+    return DB_KEY_NOT_FOUND;
+  }
+  return ScanRange(key, IndexRange(), result, txn);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t BPLUSTREE_INDEX_TYPE::ScanRange(const Row &key, const IndexRange &range, vector<RowId> &result,
+                                        Transaction *txn) {
+  std::vector<MappingType> matches;
+  ScanPrefix(key, std::min<uint32_t>(key.GetFieldCount(), key_column_count_), range, matches);
+  for (auto &match : matches) {
+    result.push_back(match.second);
+  }
+  return matches.empty() ? DB_KEY_NOT_FOUND : DB_SUCCESS;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t BPLUSTREE_INDEX_TYPE::ScanEntries(const Row &key, const IndexRange &range, std::vector<Row> &result,
+                                          Transaction *txn) {
+  std::vector<MappingType> matches;
+  ScanPrefix(key, std::min<uint32_t>(key.GetFieldCount(), key_column_count_), range, matches);
+  for (auto &match : matches) {
+    Row row(match.second);
+    match.first.DeserializeToKey(row, key_schema_);
+    result.push_back(row);
+  }
+  return matches.empty() ? DB_KEY_NOT_FOUND : DB_SUCCESS;
+}
+
+/*
+ * Each probe after the first either finds its key on the leaf the iterator
+ * holds or descends from the root, so keys falling on the same leaf pin it
+ * once and the tree path is read from the buffer pool while still hot.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t BPLUSTREE_INDEX_TYPE::ScanKeys(const std::vector<Row> &keys, std::vector<std::vector<RowId>> &results,
+                                       Transaction *txn) {
+  results.assign(keys.size(), {});
+  struct Probe {
+    KeyType prefix_;
+    uint32_t length_;
+    size_t position_;
+  };
+  std::vector<Probe> probes;
+  probes.reserve(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    uint32_t column_count = std::min<uint32_t>(keys[i].GetFieldCount(), key_column_count_);
+    Probe probe;
+    probe.length_ = probe.prefix_.SerializeFromKey(keys[i], key_schema_, column_count);
+    probe.position_ = i;
+    if (column_count == key_column_count_ && !FilterMayContain(probe.prefix_)) continue;
+    probes.push_back(probe);
+  }
+  std::sort(probes.begin(), probes.end(), [](const Probe &lhs, const Probe &rhs) {
+    int cmp = memcmp(&lhs.prefix_, &rhs.prefix_, sizeof(KeyType));
+    return cmp != 0 ? cmp < 0 : lhs.length_ < rhs.length_;
+  });
+  auto iter = container_.End();
+  for (size_t i = 0; i < probes.size(); i++) {
+    auto &probe = probes[i];
+    auto &result = results[probe.position_];
+    if (i > 0 && probes[i - 1].length_ == probe.length_ &&
+        memcmp(&probes[i - 1].prefix_, &probe.prefix_, sizeof(KeyType)) == 0) {
+      result = results[probes[i - 1].position_];
+      continue;
+    }
+    if (!iter.Seek(probe.prefix_)) iter = container_.LowerBound(probe.prefix_);
+    for (; iter != container_.End(); ++iter) {
+      if (memcmp(&(*iter).first, &probe.prefix_, probe.length_) != 0) break;
+      result.push_back((*iter).second);
+    }
+  }
+  return DB_SUCCESS;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 dberr_t BPLUSTREE_INDEX_TYPE::Destroy() {
   container_.Destroy();
+  filter_.Reset(0);
+  return DB_SUCCESS;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t BPLUSTREE_INDEX_TYPE::Release(PageReclaimer *reclaimer) {
+  container_.Release(reclaimer);
+  filter_.Reset(0);
   return DB_SUCCESS;
 }
 
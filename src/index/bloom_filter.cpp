@@ -0,0 +1,52 @@
+#include <algorithm>
+
+#include "index/bloom_filter.h"
+
+BloomFilter::BloomFilter(uint32_t bits_per_key)
+        : bits_per_key_(bits_per_key),
+          // k = ln2 * bits per key minimizes the false positive rate
+          num_probes_(std::max(1u, std::min(30u, bits_per_key * 69 / 100))) {
+  Reset(0);
+}
+
+void BloomFilter::Reset(size_t expected_keys) {
+  capacity_ = std::max(MIN_CAPACITY, expected_keys);
+  keys_ = 0;
+  removed_keys_ = 0;
+  bits_.assign(IsEnabled() ? (capacity_ * bits_per_key_ + 63) / 64 : 0, 0);
+}
+
+/*
+ * 64-bit FNV-1a, the two halves drive the probes (double hashing)
+ */
+uint64_t BloomFilter::Hash(const char *data, size_t len) {
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < len; i++) {
+    hash = (hash ^ static_cast<unsigned char>(data[i])) * 1099511628211ull;
+  }
+  return hash;
+}
+
+void BloomFilter::Add(const char *data, size_t len) {
+  keys_++;
+  if (!IsEnabled()) return;
+  uint64_t hash = Hash(data, len);
+  uint32_t h1 = static_cast<uint32_t>(hash), h2 = static_cast<uint32_t>(hash >> 32) | 1;
+  uint64_t num_bits = bits_.size() * 64;
+  for (uint32_t i = 0; i < num_probes_; i++, h1 += h2) {
+    uint64_t bit = h1 % num_bits;
+    bits_[bit / 64] |= 1ull << (bit % 64);
+  }
+}
+
+bool BloomFilter::MayContain(const char *data, size_t len) const {
+  if (!IsEnabled()) return true;
+  uint64_t hash = Hash(data, len);
+  uint32_t h1 = static_cast<uint32_t>(hash), h2 = static_cast<uint32_t>(hash >> 32) | 1;
+  uint64_t num_bits = bits_.size() * 64;
+  for (uint32_t i = 0; i < num_probes_; i++, h1 += h2) {
+    uint64_t bit = h1 % num_bits;
+    if ((bits_[bit / 64] & (1ull << (bit % 64))) == 0) return false;
+  }
+  return true;
+}
@@ -0,0 +1,385 @@
+#include "glog/logging.h"
+#include "index/basic_comparator.h"
+#include "index/extendible_hash_table.h"
+#include "index/generic_key.h"
+#include "page/index_roots_page.h"
+
+INDEX_TEMPLATE_ARGUMENTS
+HASH_TABLE_TYPE::ExtendibleHashTable(index_id_t index_id, BufferPoolManager *buffer_pool_manager,
+                                     const KeyComparator &comparator)
+        : index_id_(index_id),
+          buffer_pool_manager_(buffer_pool_manager),
+          comparator_(comparator) {
+  auto root_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+  directory_page_id_ = INVALID_PAGE_ID;
+  root_page->GetRootId(index_id, &directory_page_id_);
+  buffer_pool_manager->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_TYPE::IsEmpty() const {
+  return directory_page_id_ == INVALID_PAGE_ID;
+}
+
+/*
+ * 32-bit FNV-1a over the stored (trimmed) key bytes
+ */
+INDEX_TEMPLATE_ARGUMENTS
+uint32_t HASH_TABLE_TYPE::Hash(const KeyType &key) {
+  auto bytes = reinterpret_cast<const unsigned char *>(&key);
+  uint32_t hash = 2166136261u;
+  for (uint16_t i = 0, len = StoredKeyLength(key); i < len; i++) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+HashTableDirectoryPage *HASH_TABLE_TYPE::FetchDirectoryPage() {
+  return reinterpret_cast<HashTableDirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id_)->GetData());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+typename HASH_TABLE_TYPE::BucketPage *HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) {
+  return reinterpret_cast<BucketPage *>(buffer_pool_manager_->FetchPage(bucket_page_id)->GetData());
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> &result, Transaction *transaction) {
+  if (IsEmpty()) return false;
+  auto directory = FetchDirectoryPage();
+  uint32_t hash = Hash(key);
+  page_id_t bucket_page_id = directory->GetBucketPageId(hash & directory->GetGlobalDepthMask());
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  ValueType value;
+  bool find = false;
+  while (!find && bucket_page_id != INVALID_PAGE_ID) {
+    auto bucket = FetchBucketPage(bucket_page_id);
+    find = bucket->Lookup(key, hash, value, comparator_);
+    page_id_t next_page_id = bucket->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    bucket_page_id = next_page_id;
+  }
+  if (find) result.push_back(value);
+  return find;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_TYPE::Update(const KeyType &key, const ValueType &value) {
+  if (IsEmpty()) return false;
+  auto directory = FetchDirectoryPage();
+  uint32_t hash = Hash(key);
+  page_id_t bucket_page_id = directory->GetBucketPageId(hash & directory->GetGlobalDepthMask());
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  int index = -1;
+  while (index < 0 && bucket_page_id != INVALID_PAGE_ID) {
+    auto bucket = FetchBucketPage(bucket_page_id);
+    index = bucket->KeyIndex(key, hash, comparator_);
+    if (index >= 0) bucket->SetValueAt(index, value);
+    page_id_t next_page_id = bucket->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, index >= 0);
+    bucket_page_id = next_page_id;
+  }
+  return index >= 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+uint32_t HASH_TABLE_TYPE::GetGlobalDepth() {
+  if (IsEmpty()) return 0;
+  uint32_t global_depth = FetchDirectoryPage()->GetGlobalDepth();
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  return global_depth;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_TYPE::StartNewTable() {
+  page_id_t bucket_page_id;
+  Page *p = buffer_pool_manager_->NewPage(bucket_page_id);
+  if (p == nullptr) throw std::bad_alloc();
+  reinterpret_cast<BucketPage *>(p->GetData())->Init();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  p = buffer_pool_manager_->NewPage(directory_page_id_);
+  if (p == nullptr) throw std::bad_alloc();
+  auto directory = reinterpret_cast<HashTableDirectoryPage *>(p->GetData());
+  directory->Init(directory_page_id_);
+  directory->SetBucketPageId(0, bucket_page_id);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+  UpdateDirectoryPageId(1);
+}
+
+/*
+ * Insert into the bucket the key hashes to, splitting it (and doubling the
+ * directory if needed) until the key fits. A full bucket using every hash bit
+ * of a directory at its largest continues in overflow pages, so the table
+ * holds as many keys as the disk does. Fails only when the key exists.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  if (IsEmpty()) StartNewTable();
+  auto directory = FetchDirectoryPage();
+  uint32_t hash = Hash(key);
+  bool directory_dirty = false;
+  while (true) {
+    uint32_t bucket_idx = hash & directory->GetGlobalDepthMask();
+    page_id_t bucket_page_id = directory->GetBucketPageId(bucket_idx);
+    auto bucket = FetchBucketPage(bucket_page_id);
+    // the overflow pages are searched too, remembering the first with room
+    bool exists = bucket->KeyIndex(key, hash, comparator_) >= 0;
+    page_id_t room_page_id = INVALID_PAGE_ID, last_page_id = bucket_page_id;
+    for (page_id_t page_id = bucket->GetNextPageId(); !exists && page_id != INVALID_PAGE_ID;) {
+      auto overflow = FetchBucketPage(page_id);
+      exists = overflow->KeyIndex(key, hash, comparator_) >= 0;
+      if (room_page_id == INVALID_PAGE_ID && overflow->HasRoomFor(key)) room_page_id = page_id;
+      last_page_id = page_id;
+      page_id_t next_page_id = overflow->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      page_id = next_page_id;
+    }
+    if (exists) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      buffer_pool_manager_->UnpinPage(directory_page_id_, directory_dirty);
+      return false;
+    }
+    if (bucket->HasRoomFor(key)) {
+      bucket->Insert(key, hash, value);
+      buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+      buffer_pool_manager_->UnpinPage(directory_page_id_, directory_dirty);
+      return true;
+    }
+    uint32_t local_depth = directory->GetLocalDepth(bucket_idx);
+    if (local_depth == directory->GetGlobalDepth() && !directory->CanGrow()) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      InsertIntoChain(room_page_id, last_page_id, key, hash, value);
+      buffer_pool_manager_->UnpinPage(directory_page_id_, directory_dirty);
+      return true;
+    }
+    // only buckets that cannot split have overflow pages
+    ASSERT(bucket->GetNextPageId() == INVALID_PAGE_ID, "Splitting a hash bucket with overflow pages.");
+    if (local_depth == directory->GetGlobalDepth()) {
+      directory->IncrGlobalDepth();
+    }
+    // split the bucket by hash bit local_depth
+    page_id_t image_page_id;
+    Page *p = buffer_pool_manager_->NewPage(image_page_id);
+    if (p == nullptr) throw std::bad_alloc();
+    auto image = reinterpret_cast<BucketPage *>(p->GetData());
+    image->Init();
+    uint32_t hash_bit = 1u << local_depth;
+    bucket->SplitTo(image, hash_bit);
+    for (uint32_t i = 0; i < directory->Size(); i++) {
+      if ((i & (hash_bit - 1)) == (hash & (hash_bit - 1))) {
+        directory->SetLocalDepth(i, local_depth + 1);
+        if (i & hash_bit) directory->SetBucketPageId(i, image_page_id);
+      }
+    }
+    directory_dirty = true;
+    buffer_pool_manager_->UnpinPage(image_page_id, true);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  }
+}
+
+/*
+ * Put the key into the overflow page room_page_id, or into a new overflow page
+ * linked after last_page_id when no page of the chain has room
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_TYPE::InsertIntoChain(page_id_t room_page_id, page_id_t last_page_id, const KeyType &key,
+                                      uint32_t hash, const ValueType &value) {
+  BucketPage *page;
+  if (room_page_id == INVALID_PAGE_ID) {
+    Page *p = buffer_pool_manager_->NewPage(room_page_id);
+    if (p == nullptr) throw std::bad_alloc();
+    page = reinterpret_cast<BucketPage *>(p->GetData());
+    page->Init();
+    auto last = FetchBucketPage(last_page_id);
+    last->SetNextPageId(room_page_id);
+    buffer_pool_manager_->UnpinPage(last_page_id, true);
+  } else {
+    page = FetchBucketPage(room_page_id);
+  }
+  page->Insert(key, hash, value);
+  buffer_pool_manager_->UnpinPage(room_page_id, true);
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  if (IsEmpty()) return false;
+  auto directory = FetchDirectoryPage();
+  uint32_t hash = Hash(key);
+  uint32_t bucket_idx = hash & directory->GetGlobalDepthMask();
+  page_id_t bucket_page_id = directory->GetBucketPageId(bucket_idx);
+  // a page of the chain left empty takes over the next page, or is unlinked
+  // when it is the last one, so only an empty bucket has an empty first page
+  bool removed = false, empty = false;
+  for (page_id_t prev_page_id = INVALID_PAGE_ID, page_id = bucket_page_id; !removed && page_id != INVALID_PAGE_ID;) {
+    auto page = FetchBucketPage(page_id);
+    removed = page->Remove(key, hash, comparator_);
+    page_id_t next_page_id = page->GetNextPageId();
+    if (removed && page->IsEmpty() && next_page_id != INVALID_PAGE_ID) {
+      page->CopyFrom(FetchBucketPage(next_page_id));
+      buffer_pool_manager_->UnpinPage(next_page_id, false);
+      buffer_pool_manager_->DeletePage(next_page_id);
+    } else if (removed && page->IsEmpty() && prev_page_id != INVALID_PAGE_ID) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+      FetchBucketPage(prev_page_id)->SetNextPageId(INVALID_PAGE_ID);
+      buffer_pool_manager_->UnpinPage(prev_page_id, true);
+      break;
+    }
+    empty = removed && page_id == bucket_page_id && page->IsEmpty();
+    buffer_pool_manager_->UnpinPage(page_id, removed);
+    prev_page_id = page_id;
+    page_id = next_page_id;
+  }
+  if (empty) Merge(directory, bucket_idx);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, empty);
+  return removed;
+}
+
+/*
+ * Fold the bucket at bucket_idx and its split image into one page while one
+ * of them is empty and both have the same local depth, then halve the
+ * directory as far as possible. A bucket with overflow pages is not folded,
+ * as it could then be split again.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_TYPE::Merge(HashTableDirectoryPage *directory, uint32_t bucket_idx) {
+  while (directory->GetLocalDepth(bucket_idx) > 0) {
+    uint32_t local_depth = directory->GetLocalDepth(bucket_idx);
+    uint32_t image_idx = directory->GetSplitImageIndex(bucket_idx);
+    if (directory->GetLocalDepth(image_idx) != local_depth) break;
+    page_id_t bucket_page_id = directory->GetBucketPageId(bucket_idx);
+    page_id_t image_page_id = directory->GetBucketPageId(image_idx);
+    auto bucket = FetchBucketPage(bucket_page_id);
+    bool bucket_empty = bucket->IsEmpty(), bucket_chained = bucket->GetNextPageId() != INVALID_PAGE_ID;
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    auto image = FetchBucketPage(image_page_id);
+    bool image_empty = image->IsEmpty(), image_chained = image->GetNextPageId() != INVALID_PAGE_ID;
+    buffer_pool_manager_->UnpinPage(image_page_id, false);
+    if (!bucket_empty && !image_empty) break;
+    if (bucket_chained || image_chained) break;
+    page_id_t keep_page_id = bucket_empty ? image_page_id : bucket_page_id;
+    page_id_t drop_page_id = bucket_empty ? bucket_page_id : image_page_id;
+    for (uint32_t i = 0; i < directory->Size(); i++) {
+      page_id_t page_id = directory->GetBucketPageId(i);
+      if (page_id == keep_page_id || page_id == drop_page_id) {
+        directory->SetBucketPageId(i, keep_page_id);
+        directory->SetLocalDepth(i, local_depth - 1);
+      }
+    }
+    buffer_pool_manager_->DeletePage(drop_page_id);
+    while (directory->CanShrink()) directory->DecrGlobalDepth();
+    bucket_idx &= directory->GetGlobalDepthMask();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_TYPE::Destroy() {
+  if (IsEmpty()) return;
+  auto directory = FetchDirectoryPage();
+  // every bucket is deleted from the first slot pointing to it
+  for (uint32_t i = 0; i < directory->Size(); i++) {
+    uint32_t local_depth = directory->GetLocalDepth(i);
+    if ((i & ((1u << local_depth) - 1)) == i) {
+      FreeBucket(buffer_pool_manager_, directory->GetBucketPageId(i));
+    }
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  buffer_pool_manager_->DeletePage(directory_page_id_);
+  directory_page_id_ = INVALID_PAGE_ID;
+  UpdateDirectoryPageId(-1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_TYPE::Release(PageReclaimer *reclaimer) {
+  if (IsEmpty()) return;
+  page_id_t directory_page_id = directory_page_id_;
+  BufferPoolManager *buffer_pool_manager = buffer_pool_manager_;
+  directory_page_id_ = INVALID_PAGE_ID;
+  UpdateDirectoryPageId(-1);
+  reclaimer->Submit([buffer_pool_manager, directory_page_id] { FreePages(buffer_pool_manager, directory_page_id); });
+}
+
+/*
+ * Only the directory and the pages of overflow chains are read, and none of
+ * them is pinned
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_TYPE::FreePages(BufferPoolManager *buffer_pool_manager, page_id_t directory_page_id) {
+  Page page;
+  buffer_pool_manager->ReadPage(directory_page_id, page.GetData());
+  auto directory = reinterpret_cast<HashTableDirectoryPage *>(page.GetData());
+  for (uint32_t i = 0; i < directory->Size(); i++) {
+    uint32_t local_depth = directory->GetLocalDepth(i);
+    if ((i & ((1u << local_depth) - 1)) == i) {
+      FreeBucket(buffer_pool_manager, directory->GetBucketPageId(i));
+    }
+  }
+  buffer_pool_manager->DeletePage(directory_page_id);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_TYPE::FreeBucket(BufferPoolManager *buffer_pool_manager, page_id_t bucket_page_id) {
+  Page page;
+  while (bucket_page_id != INVALID_PAGE_ID) {
+    buffer_pool_manager->ReadPage(bucket_page_id, page.GetData());
+    buffer_pool_manager->DeletePage(bucket_page_id);
+    bucket_page_id = reinterpret_cast<BucketPage *>(page.GetData())->GetNextPageId();
+  }
+}
+
+/*
+ * Update/Insert/Delete the directory page id in the index roots page
+ * @parameter: flag 1 insert, 0 update, -1 delete
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_TYPE::UpdateDirectoryPageId(int flag) {
+  Page *p = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+  IndexRootsPage *r = reinterpret_cast<IndexRootsPage *>(p->GetData());
+  if (flag == 1) r->Insert(index_id_, directory_page_id_);
+  else if (flag == 0) r->Update(index_id_, directory_page_id_);
+  else r->Delete(index_id_);
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_TYPE::Check() {
+  bool all_unpinned = buffer_pool_manager_->CheckAllUnpinned();
+  if (!all_unpinned) {
+    LOG(ERROR) << "problem in page unpin" << endl;
+  }
+  return all_unpinned;
+}
+
+template
+class ExtendibleHashTable<int, int, BasicComparator<int>>;
+
+template
+class ExtendibleHashTable<GenericKey<4>, RowId, GenericComparator<4>>;
+
+template
+class ExtendibleHashTable<GenericKey<8>, RowId, GenericComparator<8>>;
+
+template
+class ExtendibleHashTable<GenericKey<16>, RowId, GenericComparator<16>>;
+
+template
+class ExtendibleHashTable<GenericKey<32>, RowId, GenericComparator<32>>;
+
+template
+class ExtendibleHashTable<GenericKey<64>, RowId, GenericComparator<64>>;
+
+template
+class ExtendibleHashTable<GenericKey<128>, RowId, GenericComparator<128>>;
+
+template
+class ExtendibleHashTable<GenericKey<256>, RowId, GenericComparator<256>>;
@@ -0,0 +1,88 @@
+#include "index/generic_key.h"
+#include "index/hash_index.h"
+
+INDEX_TEMPLATE_ARGUMENTS
+HASH_INDEX_TYPE::HashIndex(index_id_t index_id, IndexSchema *key_schema, BufferPoolManager *buffer_pool_manager)
+        : Index(index_id, key_schema),
+          comparator_(key_schema_),
+          container_(index_id, buffer_pool_manager, comparator_) {
+
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t HASH_INDEX_TYPE::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
+  ASSERT(row_id.Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
+  KeyType index_key;
+  index_key.SerializeFromKey(key, key_schema_);
+
+  bool status = container_.Insert(index_key, row_id, txn);
+
+  if (!status) {
+    return DB_KEY_ALREADY_EXIST;
+  }
+  return DB_SUCCESS;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t HASH_INDEX_TYPE::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
+  KeyType index_key;
+  index_key.SerializeFromKey(key, key_schema_);
+
+  container_.Remove(index_key, txn);
+  return DB_SUCCESS;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t HASH_INDEX_TYPE::RepointEntries(const std::vector<Row> &keys, const std::vector<RowId> &old_row_ids,
+                                        const std::vector<RowId> &row_ids, Transaction *txn) {
+  bool found = true;
+  for (size_t i = 0; i < keys.size(); i++) {
+    KeyType index_key;
+    index_key.SerializeFromKey(keys[i], key_schema_);
+    found = container_.Update(index_key, row_ids[i]) && found;
+  }
+  return found ? DB_SUCCESS : DB_KEY_NOT_FOUND;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t HASH_INDEX_TYPE::ScanKey(const Row &key, vector<RowId> &result, Transaction *txn) {
+  KeyType index_key;
+  index_key.SerializeFromKey(key, key_schema_);
+  if (container_.GetValue(index_key, result, txn)) {
+    return DB_SUCCESS;
+  }
+  return DB_KEY_NOT_FOUND;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t HASH_INDEX_TYPE::Destroy() {
+  container_.Destroy();
+  return DB_SUCCESS;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t HASH_INDEX_TYPE::Release(PageReclaimer *reclaimer) {
+  container_.Release(reclaimer);
+  return DB_SUCCESS;
+}
+
+template
+class HashIndex<GenericKey<4>, RowId, GenericComparator<4>>;
+
+template
+class HashIndex<GenericKey<8>, RowId, GenericComparator<8>>;
+
+template
+class HashIndex<GenericKey<16>, RowId, GenericComparator<16>>;
+
+template
+class HashIndex<GenericKey<32>, RowId, GenericComparator<32>>;
+
+template
+class HashIndex<GenericKey<64>, RowId, GenericComparator<64>>;
+
+template
+class HashIndex<GenericKey<128>, RowId, GenericComparator<128>>;
+
+template
+class HashIndex<GenericKey<256>, RowId, GenericComparator<256>>;
@@ -9,12 +9,28 @@ INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE::IndexIterator(BPlusTree<KeyType, Va
 }
 
 
+INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other) noexcept
+  : tree_(other.tree_), leaf_(other.leaf_), index_(other.index_) {
+  other.leaf_ = nullptr;
+}
+
 INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE::~IndexIterator() {
   if(leaf_ != nullptr) tree_->buffer_pool_manager_->UnpinPage(leaf_->GetPageId(), true);
 }
 
+INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator=(IndexIterator &&other) noexcept {
+  if(this == &other) return *this;
+  if(leaf_ != nullptr) tree_->buffer_pool_manager_->UnpinPage(leaf_->GetPageId(), true);
+  tree_ = other.tree_;
+  leaf_ = other.leaf_;
+  index_ = other.index_;
+  other.leaf_ = nullptr;
+  return *this;
+}
+
 INDEX_TEMPLATE_ARGUMENTS const MappingType &INDEXITERATOR_TYPE::operator*() {
-  return leaf_->GetData()[index_];
+  item_ = leaf_->GetItem(index_);
+  return item_;
 }
 
 INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
@@ -22,11 +38,14 @@ INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
   if(index_ < leaf_->GetSize() - 1){
     index_++;
   } else {
-    page_id_t next = leaf_->GetNextPageId();
-    tree_->buffer_pool_manager_->UnpinPage(leaf_->GetPageId(), true);
-    index_ = 0;
-    if(next == INVALID_PAGE_ID) leaf_ = nullptr;
-    else leaf_ = reinterpret_cast<BPlusTreeLeafPage<KeyType,ValueType,KeyComparator> *>(tree_->buffer_pool_manager_->FetchPage(next)->GetData());
+    // leaves left empty by a blocked redistribution are skipped
+    do {
+      page_id_t next = leaf_->GetNextPageId();
+      tree_->buffer_pool_manager_->UnpinPage(leaf_->GetPageId(), true);
+      index_ = 0;
+      if(next == INVALID_PAGE_ID) leaf_ = nullptr;
+      else leaf_ = reinterpret_cast<BPlusTreeLeafPage<KeyType,ValueType,KeyComparator> *>(tree_->buffer_pool_manager_->FetchPage(next)->GetData());
+    } while(leaf_ != nullptr && leaf_->GetSize() == 0);
   }
   return *this;
 }
@@ -41,6 +60,15 @@ bool INDEXITERATOR_TYPE::operator!=(const IndexIterator &itr) const {
   return !(*this == itr);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+bool INDEXITERATOR_TYPE::Seek(const KeyType &key) {
+  if(leaf_ == nullptr) return false;
+  int index = leaf_->KeyIndex(key, tree_->comparator_);
+  if(index >= leaf_->GetSize()) return false;
+  index_ = index;
+  return true;
+}
+
 template
 class IndexIterator<int, int, BasicComparator<int>>;
 
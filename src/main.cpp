@@ -17,66 +17,29 @@ void InitGoogleLog(char *argv) {
   google::InitGoogleLogging(argv);
 }
 
-void InputCommand(char *input, const int len) {
-  memset(input, 0, len);
+void InputCommand(string &input) {
+  input.clear();
   printf("minisql > ");
-  int i = 0;
-  char ch;
-  while ((ch = getchar()) != ';') {
-    input[i++] = ch;
+  int ch;
+  while ((ch = getchar()) != ';' && ch != EOF) {
+    input.push_back(ch);
   }
-  input[i] = ch;    // ;
+  input.push_back(';');
   getchar();        // remove enter
 }
 
 int main(int argc, char **argv) {
   InitGoogleLog(argv[0]);
-  // command buffer
-  const int buf_size = 1024;
-  char cmd[buf_size];
+  // command buffer, grows with long statements such as multi-row inserts
+  string cmd;
   // execute engine
   ExecuteEngine engine;
-  // for print syntax tree
-  TreeFileManagers syntax_tree_file_mgr("syntax_tree_");
-  [[maybe_unused]] uint32_t syntax_tree_id = 0;
 
   while (1) {
     // read from buffer
-    InputCommand(cmd, buf_size);
-    // create buffer for sql input
-    YY_BUFFER_STATE bp = yy_scan_string(cmd);
-    if (bp == nullptr) {
-      LOG(ERROR) << "Failed to create yy buffer state." << std::endl;
-      exit(1);
-    }
-    yy_switch_to_buffer(bp);
-
-    // init parser module
-    MinisqlParserInit();
-
-    // parse
-    yyparse();
-
-    // parse result handle
-    if (MinisqlParserGetError()) {
-      // error
-      printf("%s\n", MinisqlParserGetErrorMessage());
-    } else {
-#ifdef ENABLE_PARSER_DEBUG
-      printf("[INFO] Sql syntax parse ok!\n");
-      SyntaxTreePrinter printer(MinisqlGetParserRootNode());
-      printer.PrintTree(syntax_tree_file_mgr[syntax_tree_id++]);
-#endif
-    }
-
+    InputCommand(cmd);
     ExecuteContext context;
-    engine.Execute(MinisqlGetParserRootNode(), &context);
-    // sleep(1);
-
-    // clean memory after parse
-    MinisqlParserFinish();
-    yy_delete_buffer(bp);
-    yylex_destroy();
+    engine.ExecuteSql(cmd.c_str(), &context);
 
     cout << context.message_ << endl;
     // quit condition
@@ -1,38 +1,111 @@
+#include <algorithm>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "index/basic_comparator.h"
 #include "index/generic_key.h"
 #include "page/b_plus_tree_internal_page.h"
 
+namespace {
+/*
+ * Order preserving 4-byte head of a key: big-endian leading bytes of byte
+ * comparable keys, the key itself with the sign bit flipped for int keys and
+ * a constant for anything else (every lookup then falls back to full keys).
+ * Exact heads order keys completely and never need a full key comparison.
+ */
+template<typename KeyType, typename KeyComparator>
+struct KeyHead {
+  static constexpr bool exact = false;
+
+  static uint32_t Of(const KeyType &key) {
+    if constexpr (IsByteComparable<KeyComparator>::value && sizeof(KeyType) >= sizeof(uint32_t)) {
+      auto bytes = reinterpret_cast<const unsigned char *>(&key);
+      return uint32_t(bytes[0]) << 24 | uint32_t(bytes[1]) << 16 | uint32_t(bytes[2]) << 8 | uint32_t(bytes[3]);
+    } else {
+      return 0;
+    }
+  }
+};
+
+template<>
+struct KeyHead<int, BasicComparator<int>> {
+  static constexpr bool exact = true;
+
+  static uint32_t Of(const int &key) { return static_cast<uint32_t>(key) ^ 0x80000000u; }
+};
+
+/*
+ * Number of heads in [begin, end) less than head, i.e. the index of the first
+ * head not less than it since heads are sorted. Binary search stops at a window
+ * of a few cache lines which is counted four heads at a time.
+ */
+int LowerBound(const uint32_t *heads, int begin, int end, uint32_t head) {
+  while(end - begin > 16) {
+    int mid = (begin + end) >> 1;
+    if(heads[mid] < head) begin = mid + 1;
+    else end = mid;
+  }
+  int i = begin, less = 0;
+#ifdef __SSE2__
+  // SSE2 only has signed compares, so flip the sign bits of both sides
+  const __m128i flip = _mm_set1_epi32(static_cast<int>(0x80000000u));
+  const __m128i probe = _mm_xor_si128(_mm_set1_epi32(static_cast<int>(head)), flip);
+  for(; i + 4 <= end; i += 4) {
+    __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(heads + i)), flip);
+    less += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(v, probe))));
+  }
+#endif
+  for(; i < end; ++i) less += heads[i] < head;
+  return begin + less;
+}
+}  // namespace
+
 /*****************************************************************************
  * HELPER METHODS AND UTILITIES
  *****************************************************************************/
 /*
  * Init method after creating a new internal page
- * Including set page type, set current size, set page id, set parent id and set
- * max page size
+ * Including set page type, set current size, set page id and set max page size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, int max_size) {
   SetPageType(IndexPageType :: INTERNAL_PAGE);
   SetSize(0);
   SetPageId(page_id);
-  SetParentPageId(parent_id);
   SetMaxSize(max_size);
+  key_heap_begin_ = PAGE_SIZE;
 }
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
- * array offset)
+ * array offset). Trimmed key bytes are padded back with zeros.
  */
 INDEX_TEMPLATE_ARGUMENTS
 KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const {
-  // replace with your own code
-  // assert(index < GetSize());
-  return array_[index].first;
+  KeyType key;
+  memset(reinterpret_cast<char *>(&key), 0, sizeof(KeyType));
+  memcpy(reinterpret_cast<char *>(&key), PageBase() + KeySlots()[index].key_offset_, KeySlots()[index].key_length_);
+  return key;
 }
 
+/*
+ * Replace the key bytes of slot "index". Caller checks CanSetKeyAt first since
+ * the new key may be longer than the old one.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
-  // assert(index < GetSize());
-  array_[index].first = key;
+  assert(CanSetKeyAt(index, key));
+  RemoveKeyBytes(index);
+  uint16_t len = StoredKeyLength(key);
+  key_heap_begin_ -= len;
+  memcpy(PageBase() + key_heap_begin_, reinterpret_cast<const char *>(&key), len);
+  KeySlots()[index].key_offset_ = key_heap_begin_;
+  KeySlots()[index].key_length_ = len;
+  heads_[index] = KeyHead<KeyType, KeyComparator>::Of(key);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanSetKeyAt(int index, const KeyType &key) const {
+  return FreeBytes() + KeySlots()[index].key_length_ >= StoredKeyLength(key);
 }
 
 /*
@@ -41,8 +114,9 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
-  for(int i = GetSize() - 1; i >= 0; --i) 
-    if(array_[i].second == value) return i;
+  auto children = Children();
+  for(int i = GetSize() - 1; i >= 0; --i)
+    if(children[i] == value) return i;
   assert(0);
   return -1;
 }
@@ -53,9 +127,140 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
  */
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const {
-  // replace with your own code
-  // assert(index < GetSize());
-  return array_[index].second;
+  return Children()[index];
+}
+
+/*
+ * Bytes taken by the entry arrays and the key heap
+ */
+INDEX_TEMPLATE_ARGUMENTS
+uint32_t B_PLUS_TREE_INTERNAL_PAGE_TYPE::UsedBytes() const {
+  return GetSize() * INTERNAL_PAGE_ENTRY_SIZE + (PAGE_SIZE - key_heap_begin_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+uint32_t B_PLUS_TREE_INTERNAL_PAGE_TYPE::FreeBytes() const {
+  return key_heap_begin_ - INTERNAL_PAGE_HEADER_SIZE - GetSize() * INTERNAL_PAGE_ENTRY_SIZE;
+}
+
+/*
+ * Whether a child with the given separator can be added without split
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::HasRoomFor(const KeyType &key) const {
+  return GetSize() < GetMaxSize() && FreeBytes() >= INTERNAL_PAGE_ENTRY_SIZE + StoredKeyLength(key);
+}
+
+/*
+ * A page underflows when it is below half of whichever limit, entry count or
+ * bytes, actually bounds it. A non-root internal page also needs two children.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsUnderflow() const {
+  return GetSize() < 2 || (GetSize() < GetMinSize() && UsedBytes() < (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / 2);
+}
+
+/*
+ * Whether sibling (right of me) can be merged into me, with middle_key pulled
+ * down from the parent in place of its invalid first key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanMergeWith(const BPlusTreeInternalPage *sibling,
+                                                  const KeyType &middle_key) const {
+  uint32_t bytes = UsedBytes() + sibling->UsedBytes() - sibling->KeySlots()[0].key_length_ + StoredKeyLength(middle_key);
+  return GetSize() + sibling->GetSize() <= GetMaxSize() && bytes <= PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE;
+}
+
+/*
+ * Put the entry into slot "index", shifting later entries backward.
+ * Caller makes sure there is enough room.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertAt(int index, const KeyType &key, const ValueType &value) {
+  uint16_t len = StoredKeyLength(key);
+  assert(GetSize() < GetMaxSize() && FreeBytes() >= INTERNAL_PAGE_ENTRY_SIZE + len);
+  key_heap_begin_ -= len;
+  memcpy(PageBase() + key_heap_begin_, reinterpret_cast<const char *>(&key), len);
+  OpenEntry(index);
+  heads_[index] = KeyHead<KeyType, KeyComparator>::Of(key);
+  KeySlots()[index].key_offset_ = key_heap_begin_;
+  KeySlots()[index].key_length_ = len;
+  Children()[index] = value;
+}
+
+/*
+ * Make room for entry "index" in each of the three arrays and grow size by
+ * one. Later arrays start further back, so they are moved first.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::OpenEntry(int index) {
+  const size_t width[] = {sizeof(uint32_t), sizeof(KeySlot), sizeof(ValueType)};
+  const size_t start[] = {0, width[0], width[0] + width[1]};
+  auto base = reinterpret_cast<char *>(heads_);
+  size_t n = GetSize();
+  for(int r = 2; r >= 0; --r) {
+    char *src = base + start[r] * n, *dst = base + start[r] * (n + 1);
+    memmove(dst + (index + 1) * width[r], src + index * width[r], (n - index) * width[r]);
+    memmove(dst, src, index * width[r]);
+  }
+  IncreaseSize(1);
+}
+
+/*
+ * Drop entry "index" from each of the three arrays and shrink size by one.
+ * Earlier arrays end further forward, so they are moved first.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CloseEntry(int index) {
+  const size_t width[] = {sizeof(uint32_t), sizeof(KeySlot), sizeof(ValueType)};
+  const size_t start[] = {0, width[0], width[0] + width[1]};
+  auto base = reinterpret_cast<char *>(heads_);
+  size_t n = GetSize();
+  for(int r = 0; r < 3; ++r) {
+    char *src = base + start[r] * n, *dst = base + start[r] * (n - 1);
+    memmove(dst, src, index * width[r]);
+    memmove(dst + index * width[r], src + (index + 1) * width[r], (n - index - 1) * width[r]);
+  }
+  IncreaseSize(-1);
+}
+
+/*
+ * Close the hole the key of entry "index" leaves in the key heap. The slot
+ * itself is left with a zero length key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveKeyBytes(int index) {
+  auto slots = KeySlots();
+  uint16_t ofs = slots[index].key_offset_, len = slots[index].key_length_;
+  memmove(PageBase() + key_heap_begin_ + len, PageBase() + key_heap_begin_, ofs - key_heap_begin_);
+  key_heap_begin_ += len;
+  for(int i = 0; i < GetSize(); ++i) {
+    if(slots[i].key_offset_ < ofs) slots[i].key_offset_ += len;
+  }
+  slots[index].key_offset_ = key_heap_begin_;
+  slots[index].key_length_ = 0;
+}
+
+/*
+ * Keep the first "size" entries only, repack the key heap and pull the key
+ * slot and child arrays forward.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Truncate(int size) {
+  char buf[PAGE_SIZE];
+  uint32_t top = PAGE_SIZE;
+  auto slots = KeySlots();
+  for(int i = 0; i < size; ++i) {
+    top -= slots[i].key_length_;
+    memcpy(buf + top, PageBase() + slots[i].key_offset_, slots[i].key_length_);
+    slots[i].key_offset_ = top;
+  }
+  memcpy(PageBase() + top, buf + top, PAGE_SIZE - top);
+  key_heap_begin_ = top;
+  auto children = Children();
+  SetSize(size);
+  memmove(KeySlots(), slots, size * sizeof(KeySlot));
+  memmove(Children(), children, size * sizeof(ValueType));
 }
 
 /*****************************************************************************
@@ -68,17 +273,30 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const {
  */
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const {
-  // replace with your own code
-  assert(GetSize() > 0);
+  return Children()[LookupIndex(key, comparator)];
+}
 
-  int L = 1, R = GetSize() - 1, p = 0;
+/*
+ * Same as Lookup, but return the slot index of the child
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::LookupIndex(const KeyType &key, const KeyComparator &comparator) const {
+  assert(GetSize() > 0);
+  using Head = KeyHead<KeyType, KeyComparator>;
+  // keys in [1, L) are less than key and keys in [R, size) greater
+  uint32_t head = Head::Of(key);
+  int L = LowerBound(heads_, 1, GetSize(), head);
+  int R = head == UINT32_MAX ? GetSize() : LowerBound(heads_, L, GetSize(), head + 1);
+  if constexpr (Head::exact) return R - 1;
+  int p = L - 1;
+  R--;
   while(L <= R) {
     int mid = (L + R) >> 1;
-    int o = comparator(key, array_[mid].first);
+    int o = comparator(key, KeyAt(mid));
     if(o < 0) R = mid - 1;
     else p = mid, L = mid + 1;
   }
-  return array_[p].second;
+  return p;
 }
 
 /*****************************************************************************
@@ -88,14 +306,15 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyCo
  * Populate new root page with old_value + new_key & new_value
  * When the insertion cause overflow from leaf page all the way upto the root
  * page, you should create a new root page and populate its elements.
- * NOTE: This method is only called within InsertIntoParent()(b_plus_tree.cpp)
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
                                                      const ValueType &new_value) {
-  array_[0].second = old_value;
-  array_[1] = make_pair(new_key, new_value);
-  SetSize(2);
+  KeyType invalid_key;
+  memset(reinterpret_cast<char *>(&invalid_key), 0, sizeof(KeyType));
+  Truncate(0);
+  InsertAt(0, invalid_key, old_value);
+  InsertAt(1, new_key, new_value);
 }
 
 /*
@@ -106,10 +325,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value,
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
                                                     const ValueType &new_value) {
-  int p = ValueIndex(old_value);
-  for(int i = GetSize() - 1; i > p; --i) array_[i + 1] = array_[i];
-  array_[p + 1] = make_pair(new_key, new_value);
-  IncreaseSize(1);
+  InsertAt(ValueIndex(old_value) + 1, new_key, new_value);
   return GetSize();
 }
 
@@ -117,21 +333,27 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value,
  * SPLIT
  *****************************************************************************/
 /*
- * Remove half of key & value pairs from this page to "recipient" page
+ * Remove half of key & value pairs from this page to "recipient" page.
+ * Halves are balanced by bytes, or left_percent of the bytes stay here. The
+ * first key of recipient is the separator that has to be pushed up into the
+ * parent.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient,
-                                                BufferPoolManager *buffer_pool_manager) {
-  
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient, int left_percent) {
+  uint32_t total = UsedBytes();
+  uint32_t prefix = 0;
+  int split = 0;
+  while(split < GetSize() && prefix * 100 < total * left_percent) prefix += EntryBytes(split++);
+  split = std::max(1, std::min(split, GetSize() - 1));
+  recipient->CopyNFrom(this, split, GetSize());
+  Truncate(split);
 }
 
-/* Copy entries into me, starting from {items} and copy {size} entries.
- * Since it is an internal page, for all entries (pages) moved, their parents page now changes to me.
- * So I need to 'adopt' them by changing their parent page id, which needs to be persisted with BufferPoolManger
+/* Copy entries [begin, end) of src into me.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {
-  
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(const BPlusTreeInternalPage *src, int begin, int end) {
+  for(int i = begin; i < end; ++i) InsertAt(GetSize(), src->KeyAt(i), src->ValueAt(i));
 }
 
 /*****************************************************************************
@@ -144,7 +366,8 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, Buf
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
-
+  RemoveKeyBytes(index);
+  CloseEntry(index);
 }
 
 /*
@@ -153,8 +376,9 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
-  // replace with your own code
-  ValueType val{};
+  assert(GetSize() == 1);
+  ValueType val = ValueAt(0);
+  Truncate(0);
   return val;
 }
 
@@ -165,13 +389,12 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
  * Remove all of key & value pairs from this page to "recipient" page.
  * The middle_key is the separation key you should get from the parent. You need
  * to make sure the middle key is added to the recipient to maintain the invariant.
- * You also need to use BufferPoolManager to persist changes to the parent page id for those
- * pages that are moved to the recipient
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                               BufferPoolManager *buffer_pool_manager) {
-
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
+  recipient->CopyLastFrom(std::make_pair(middle_key, ValueAt(0)));
+  recipient->CopyNFrom(this, 1, GetSize());
+  Truncate(0);
 }
 
 /*****************************************************************************
@@ -182,44 +405,40 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient,
  *
  * The middle_key is the separation key you should get from the parent. You need
  * to make sure the middle key is added to the recipient to maintain the invariant.
- * You also need to use BufferPoolManager to persist changes to the parent page id for those
- * pages that are moved to the recipient
+ * Afterwards my first key is the new separation key for the parent.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                                      BufferPoolManager *buffer_pool_manager) {
-
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
+  recipient->CopyLastFrom(std::make_pair(middle_key, ValueAt(0)));
+  Remove(0);
 }
 
 /* Append an entry at the end.
- * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
- * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
-
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const std::pair<KeyType, ValueType> &pair) {
+  InsertAt(GetSize(), pair.first, pair.second);
 }
 
 /*
  * Remove the last key & value pair from this page to head of "recipient" page.
- * You need to handle the original dummy key properly, e.g. updating recipient’s array to position the middle_key at the
- * right place.
- * You also need to use BufferPoolManager to persist changes to the parent page id for those pages that are
- * moved to the recipient
+ * The middle_key takes the place of recipient's invalid first key. My last key
+ * (read it before the move) becomes the new separation key for the parent.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                                       BufferPoolManager *buffer_pool_manager) {
-
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
+  KeyType invalid_key;
+  memset(reinterpret_cast<char *>(&invalid_key), 0, sizeof(KeyType));
+  recipient->CopyFirstFrom(std::make_pair(invalid_key, ValueAt(GetSize() - 1)));
+  recipient->SetKeyAt(1, middle_key);
+  Remove(GetSize() - 1);
 }
 
 /* Append an entry at the beginning.
- * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
- * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
-
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const std::pair<KeyType, ValueType> &pair) {
+  InsertAt(0, pair.first, pair.second);
 }
 
 template
@@ -244,4 +463,4 @@ template
 class BPlusTreeInternalPage<GenericKey<128>, page_id_t, GenericComparator<128>>;
 
 template
-class BPlusTreeInternalPage<GenericKey<256>, page_id_t, GenericComparator<256>>;
\ No newline at end of file
+class BPlusTreeInternalPage<GenericKey<256>, page_id_t, GenericComparator<256>>;
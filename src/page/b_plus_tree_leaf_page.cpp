@@ -9,17 +9,19 @@
 
 /**
  * Init method after creating a new leaf page
- * Including set page type, set current size to zero, set page id/parent id, set
- * next page id and set max size
+ * Including set page type, set current size to zero, set page id, set next page
+ * id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, int max_size) {
   SetPageType(IndexPageType :: LEAF_PAGE);
   SetSize(0);
   SetPageId(page_id);
-  SetParentPageId(parent_id);
   SetMaxSize(max_size);
   next_page_id_ = INVALID_PAGE_ID;
+  key_heap_begin_ = PAGE_SIZE;
+  prefix_offset_ = PAGE_SIZE;
+  prefix_length_ = 0;
 }
 
 /**
@@ -44,7 +46,7 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator
   int L = 0, R = GetSize() - 1, p = GetSize();
   while(L <= R) {
     int mid = (L + R) >> 1;
-    int o = comparator(key, array_[mid].first);
+    int o = comparator(key, KeyAt(mid));
     if(o < 0) p = mid, R = mid - 1;
     else if(o > 0) L = mid + 1;
     else return mid;
@@ -54,12 +56,27 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator
 
 /*
  * Helper method to find and return the key associated with input "index"(a.k.a
- * array offset)
+ * array offset). The key is the page prefix followed by the slot suffix,
+ * padded back with zeros.
  */
 INDEX_TEMPLATE_ARGUMENTS
 KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const {
-  // replace with your own code
-  return array_[index].first;
+  KeyType key;
+  auto bytes = reinterpret_cast<char *>(&key);
+  memset(bytes, 0, sizeof(KeyType));
+  memcpy(bytes, PageBase() + prefix_offset_, prefix_length_);
+  memcpy(bytes + prefix_length_, PageBase() + array_[index].key_offset_, array_[index].key_length_);
+  return key;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+ValueType B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAt(int index) const {
+  return array_[index].value_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetValueAt(int index, const ValueType &value) {
+  array_[index].value_ = value;
 }
 
 /*
@@ -67,27 +84,149 @@ KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const {
  * "index"(a.k.a array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
-  // replace with your own code
-  return array_[index];
+MappingType B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) const {
+  return std::make_pair(KeyAt(index), ValueAt(index));
+}
+
+/*
+ * Bytes taken by the slot directory and the key heap
+ */
+INDEX_TEMPLATE_ARGUMENTS
+uint32_t B_PLUS_TREE_LEAF_PAGE_TYPE::UsedBytes() const {
+  return GetSize() * sizeof(Slot) + (PAGE_SIZE - key_heap_begin_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+uint32_t B_PLUS_TREE_LEAF_PAGE_TYPE::FreeBytes() const {
+  return key_heap_begin_ - LEAF_PAGE_HEADER_SIZE - GetSize() * sizeof(Slot);
+}
+
+/*
+ * Length of the part of the page prefix that key shares
+ */
+INDEX_TEMPLATE_ARGUMENTS
+uint16_t B_PLUS_TREE_LEAF_PAGE_TYPE::CommonPrefixLength(const KeyType &key) const {
+  auto bytes = reinterpret_cast<const char *>(&key);
+  auto prefix = PageBase() + prefix_offset_;
+  uint16_t len = 0;
+  while(len < prefix_length_ && bytes[len] == prefix[len]) len++;
+  return len;
+}
+
+/*
+ * Bytes of key stored in its slot when the page prefix is prefix_length long
+ */
+INDEX_TEMPLATE_ARGUMENTS
+uint16_t B_PLUS_TREE_LEAF_PAGE_TYPE::SuffixLength(const KeyType &key, uint16_t prefix_length) const {
+  uint16_t len = StoredKeyLength(key);
+  return len > prefix_length ? len - prefix_length : 0;
+}
+
+/*
+ * Whether the entry of given key can be inserted without split. A key not
+ * sharing the whole prefix shortens it, and every stored suffix may grow by
+ * the bytes the prefix loses.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::HasRoomFor(const KeyType &key) const {
+  if(GetSize() >= GetMaxSize()) return false;
+  uint16_t common = CommonPrefixLength(key);
+  uint32_t lost = prefix_length_ - common;
+  return FreeBytes() + lost >= sizeof(Slot) + SuffixLength(key, common) + lost * GetSize();
+}
+
+/*
+ * A page underflows when it is below half of whichever limit, entry count or
+ * bytes, actually bounds it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::IsUnderflow() const {
+  return GetSize() < GetMinSize() && UsedBytes() < (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / 2;
+}
+
+/*
+ * Conservative: suffixes may grow when the merged page gets a shorter prefix.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::CanMergeWith(const BPlusTreeLeafPage *sibling) const {
+  uint32_t bytes = UsedBytes() + sibling->UsedBytes() + prefix_length_ * GetSize() +
+                   sibling->prefix_length_ * sibling->GetSize();
+  return GetSize() + sibling->GetSize() <= GetMaxSize() && bytes <= PAGE_SIZE - LEAF_PAGE_HEADER_SIZE;
+}
+
+/*
+ * Put the entry into slot "index", shifting later slots backward. The page is
+ * rebuilt with a shorter prefix if key does not share it.
+ * Caller makes sure there is enough room.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::InsertAt(int index, const KeyType &key, const ValueType &value) {
+  assert(HasRoomFor(key));
+  if(CommonPrefixLength(key) < prefix_length_) {
+    auto items = GetItems(0, GetSize());
+    items.insert(items.begin() + index, std::make_pair(key, value));
+    Rebuild(items);
+    return ;
+  }
+  uint16_t len = SuffixLength(key, prefix_length_);
+  key_heap_begin_ -= len;
+  memcpy(PageBase() + key_heap_begin_, reinterpret_cast<const char *>(&key) + prefix_length_, len);
+  memmove(array_ + index + 1, array_ + index, (GetSize() - index) * sizeof(Slot));
+  array_[index].key_offset_ = key_heap_begin_;
+  array_[index].key_length_ = len;
+  array_[index].value_ = value;
+  IncreaseSize(1);
+}
+
+/*
+ * Drop slot "index" and close the hole its key leaves in the key heap.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAt(int index) {
+  uint16_t ofs = array_[index].key_offset_, len = array_[index].key_length_;
+  memmove(PageBase() + key_heap_begin_ + len, PageBase() + key_heap_begin_, ofs - key_heap_begin_);
+  key_heap_begin_ += len;
+  memmove(array_ + index, array_ + index + 1, (GetSize() - index - 1) * sizeof(Slot));
+  IncreaseSize(-1);
+  for(int i = 0; i < GetSize(); ++i) {
+    if(array_[i].key_offset_ < ofs) array_[i].key_offset_ += len;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<MappingType> B_PLUS_TREE_LEAF_PAGE_TYPE::GetItems(int begin, int end) const {
+  std::vector<MappingType> items;
+  items.reserve(end - begin);
+  for(int i = begin; i < end; ++i) items.push_back(GetItem(i));
+  return items;
 }
 
+/*
+ * Rewrite the page to hold exactly the given sorted items, with the longest
+ * prefix they all share.
+ */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Arrange(BPlusTreeLeafPage *recipient) {
-  int tot = GetSize() + recipient->GetSize();
-  int new_size = (tot + 1) / 2;
-  MappingType *r = recipient->GetData();
-  if(GetSize() < new_size) {
-    int c = new_size - GetSize();
-    for(int i = 0; i < c; ++i) array_[GetSize() + i] = r[i];
-    for(int i = c; i < recipient->GetSize(); ++i) r[i - c] = r[i];
-  } else {
-    int c = GetSize() - new_size;
-    for(int i = recipient->GetSize() - 1; i >= 0; --i) r[i + c] = r[i];
-    for(int i = 0; i < c; ++i) r[i] = array_[GetSize() + i];
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Rebuild(const std::vector<MappingType> &items) {
+  uint16_t prefix_length = 0;
+  if(!items.empty()) {
+    auto first = reinterpret_cast<const char *>(&items[0].first);
+    uint16_t max_length = 0;
+    prefix_length = sizeof(KeyType);
+    for(auto &item : items) {
+      auto bytes = reinterpret_cast<const char *>(&item.first);
+      uint16_t len = 0;
+      while(len < prefix_length && bytes[len] == first[len]) len++;
+      prefix_length = len;
+      max_length = std::max(max_length, StoredKeyLength(item.first));
+    }
+    prefix_length = std::min(prefix_length, max_length);
   }
-  SetSize(new_size);
-  recipient->SetSize(tot - new_size);
+  SetSize(0);
+  key_heap_begin_ = PAGE_SIZE - prefix_length;
+  prefix_offset_ = key_heap_begin_;
+  prefix_length_ = prefix_length;
+  if(!items.empty()) memcpy(PageBase() + prefix_offset_, reinterpret_cast<const char *>(&items[0].first), prefix_length);
+  for(auto &item : items) InsertAt(GetSize(), item.first, item.second);
 }
 
 /*****************************************************************************
@@ -102,13 +241,11 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &valu
   int L = 0, R = GetSize() - 1, p = GetSize();
   while(L <= R) {
     int mid = (L + R) >> 1;
-    int o = comparator(key, array_[mid].first);
+    int o = comparator(key, KeyAt(mid));
     if(o < 0) p = mid, R = mid - 1;
     else L = mid + 1;
   }
-  for(int i = GetSize() - 1; i >= p; --i) array_[i + 1] = array_[i];
-  array_[p] = make_pair(key, value);
-  IncreaseSize(1);
+  InsertAt(p, key, value);
   return GetSize();
 }
 
@@ -116,19 +253,32 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &valu
  * SPLIT
  *****************************************************************************/
 /*
- * Remove half of key & value pairs from this page to "recipient" page
+ * Remove half of key & value pairs from this page to "recipient" page.
+ * Halves are balanced by bytes so that long and short keys split evenly, and
+ * the recipient is linked in right after this page. Under sequential inserts
+ * the caller keeps a larger left_percent of the bytes here instead.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
-  
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient, int left_percent) {
+  uint32_t total = UsedBytes();
+  uint32_t prefix = 0;
+  int split = 0;
+  while(split < GetSize() && prefix * 100 < total * left_percent) prefix += EntryBytes(split++);
+  split = std::max(1, std::min(split, GetSize() - 1));
+  recipient->CopyNFrom(GetItems(split, GetSize()));
+  Rebuild(GetItems(0, split));
+  recipient->SetNextPageId(GetNextPageId());
+  SetNextPageId(recipient->GetPageId());
 }
 
 /*
- * Copy starting from items, and copy {size} number of elements into me.
+ * Append items, all greater than my keys, to me.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {
-
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(const std::vector<MappingType> &items) {
+  auto all = GetItems(0, GetSize());
+  all.insert(all.end(), items.begin(), items.end());
+  Rebuild(all);
 }
 
 /*****************************************************************************
@@ -144,10 +294,10 @@ bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType &value, co
   int L = 0, R = GetSize() - 1;
   while(L <= R) {
     int mid = (L + R) >> 1;
-    int o = comparator(key, array_[mid].first);
+    int o = comparator(key, KeyAt(mid));
     if(o < 0) R = mid - 1;
     else if(o > 0) L = mid + 1;
-    else return value = array_[mid].second, true;
+    else return value = array_[mid].value_, true;
   }
   return false;
 }
@@ -163,7 +313,29 @@ bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType &value, co
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) {
-  return 0;
+  int index = KeyIndex(key, comparator);
+  if(index < GetSize() && comparator(key, KeyAt(index)) == 0) RemoveAt(index);
+  return GetSize();
+}
+
+/*
+ * Remove every key of the sorted keys[0, count) that is in the page, merging
+ * them against the page entries and compacting the page once.
+ * @return  number of pairs removed
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveRecords(const KeyType *keys, int count, const KeyComparator &comparator) {
+  std::vector<MappingType> items = GetItems(0, GetSize()), kept;
+  kept.reserve(items.size());
+  int j = 0;
+  for(auto &item : items) {
+    while(j < count && comparator(keys[j], item.first) < 0) j++;
+    if(j < count && comparator(keys[j], item.first) == 0) continue;
+    kept.push_back(item);
+  }
+  int removed = static_cast<int>(items.size() - kept.size());
+  if(removed > 0) Rebuild(kept);
+  return removed;
 }
 
 /*****************************************************************************
@@ -175,7 +347,9 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
-
+  recipient->CopyNFrom(GetItems(0, GetSize()));
+  recipient->SetNextPageId(GetNextPageId());
+  Rebuild({});
 }
 
 /*****************************************************************************
@@ -187,7 +361,8 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
-
+  recipient->CopyLastFrom(GetItem(0));
+  RemoveAt(0);
 }
 
 /*
@@ -195,7 +370,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient)
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
-
+  InsertAt(GetSize(), item.first, item.second);
 }
 
 /*
@@ -203,7 +378,8 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
-
+  recipient->CopyFirstFrom(GetItem(GetSize() - 1));
+  RemoveAt(GetSize() - 1);
 }
 
 /*
@@ -212,7 +388,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient)
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item) {
-
+  InsertAt(0, item.first, item.second);
 }
 
 template
@@ -237,4 +413,4 @@ template
 class BPlusTreeLeafPage<GenericKey<128>, RowId, GenericComparator<128>>;
 
 template
-class BPlusTreeLeafPage<GenericKey<256>, RowId, GenericComparator<256>>;
\ No newline at end of file
+class BPlusTreeLeafPage<GenericKey<256>, RowId, GenericComparator<256>>;
@@ -8,10 +8,6 @@ bool BPlusTreePage::IsLeafPage() const {
   return page_type_ == IndexPageType :: LEAF_PAGE;
 }
 
-bool BPlusTreePage::IsRootPage() const {
-  return parent_page_id_ == INVALID_PAGE_ID;
-}
-
 void BPlusTreePage::SetPageType(IndexPageType page_type) {
   page_type_ = page_type;
 }
@@ -51,17 +47,6 @@ int BPlusTreePage::GetMinSize() const {
   return max_size_ / 2;
 }
 
-/*
- * Helper methods to get/set parent page id
- */
-page_id_t BPlusTreePage::GetParentPageId() const {
-  return parent_page_id_;
-}
-
-void BPlusTreePage::SetParentPageId(page_id_t parent_page_id) {
-  parent_page_id_ = parent_page_id;
-}
-
 /*
  * Helper methods to get/set self page id
  */
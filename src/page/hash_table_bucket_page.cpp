@@ -0,0 +1,114 @@
+#include "index/basic_comparator.h"
+#include "index/generic_key.h"
+#include "page/hash_table_bucket_page.h"
+
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_BUCKET_TYPE::Init() {
+  size_ = 0;
+  key_heap_begin_ = PAGE_SIZE;
+  next_page_id_ = INVALID_PAGE_ID;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType HASH_TABLE_BUCKET_TYPE::KeyAt(int index) const {
+  KeyType key;
+  memset(&key, 0, sizeof(KeyType));
+  memcpy(&key, PageBase() + array_[index].key_offset_, array_[index].key_length_);
+  return key;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int HASH_TABLE_BUCKET_TYPE::KeyIndex(const KeyType &key, uint32_t hash, const KeyComparator &comparator) const {
+  for (uint32_t i = 0; i < size_; i++) {
+    if (array_[i].hash_ == hash && comparator(KeyAt(i), key) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_BUCKET_TYPE::Lookup(const KeyType &key, uint32_t hash, ValueType &value,
+                                    const KeyComparator &comparator) const {
+  int index = KeyIndex(key, hash, comparator);
+  if (index < 0) return false;
+  value = array_[index].value_;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_BUCKET_TYPE::HasRoomFor(const KeyType &key) const {
+  return FreeBytes() >= sizeof(Slot) + StoredKeyLength(key);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_BUCKET_TYPE::Insert(const KeyType &key, uint32_t hash, const ValueType &value) {
+  uint16_t length = StoredKeyLength(key);
+  ASSERT(FreeBytes() >= sizeof(Slot) + length, "Hash bucket overflow.");
+  key_heap_begin_ -= length;
+  memcpy(PageBase() + key_heap_begin_, &key, length);
+  array_[size_].hash_ = hash;
+  array_[size_].key_offset_ = static_cast<uint16_t>(key_heap_begin_);
+  array_[size_].key_length_ = length;
+  array_[size_].value_ = value;
+  size_++;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_BUCKET_TYPE::Remove(const KeyType &key, uint32_t hash, const KeyComparator &comparator) {
+  int index = KeyIndex(key, hash, comparator);
+  if (index < 0) return false;
+  RemoveAt(index);
+  return true;
+}
+
+/*
+ * Drop the entry at index: close the gap its key left in the heap, then move
+ * the last slot into its place (slots are unordered).
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_BUCKET_TYPE::RemoveAt(int index) {
+  uint16_t offset = array_[index].key_offset_;
+  uint16_t length = array_[index].key_length_;
+  memmove(PageBase() + key_heap_begin_ + length, PageBase() + key_heap_begin_, offset - key_heap_begin_);
+  key_heap_begin_ += length;
+  for (uint32_t i = 0; i < size_; i++) {
+    if (array_[i].key_offset_ < offset) array_[i].key_offset_ += length;
+  }
+  array_[index] = array_[size_ - 1];
+  size_--;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_BUCKET_TYPE::SplitTo(HashTableBucketPage *recipient, uint32_t hash_bit) {
+  for (int i = static_cast<int>(size_) - 1; i >= 0; i--) {
+    if (array_[i].hash_ & hash_bit) {
+      recipient->Insert(KeyAt(i), array_[i].hash_, array_[i].value_);
+      RemoveAt(i);
+    }
+  }
+}
+
+template
+class HashTableBucketPage<int, int, BasicComparator<int>>;
+
+template
+class HashTableBucketPage<GenericKey<4>, RowId, GenericComparator<4>>;
+
+template
+class HashTableBucketPage<GenericKey<8>, RowId, GenericComparator<8>>;
+
+template
+class HashTableBucketPage<GenericKey<16>, RowId, GenericComparator<16>>;
+
+template
+class HashTableBucketPage<GenericKey<32>, RowId, GenericComparator<32>>;
+
+template
+class HashTableBucketPage<GenericKey<64>, RowId, GenericComparator<64>>;
+
+template
+class HashTableBucketPage<GenericKey<128>, RowId, GenericComparator<128>>;
+
+template
+class HashTableBucketPage<GenericKey<256>, RowId, GenericComparator<256>>;
@@ -0,0 +1,33 @@
+#include <cstring>
+
+#include "page/hash_table_directory_page.h"
+
+void HashTableDirectoryPage::Init(page_id_t page_id) {
+  page_id_ = page_id;
+  lsn_ = INVALID_LSN;
+  global_depth_ = 0;
+  memset(local_depths_, 0, sizeof(local_depths_));
+  for (auto &bucket_page_id : bucket_page_ids_) bucket_page_id = INVALID_PAGE_ID;
+}
+
+bool HashTableDirectoryPage::CanShrink() const {
+  if (global_depth_ == 0) return false;
+  for (uint32_t i = 0; i < Size(); i++) {
+    if (local_depths_[i] == global_depth_) return false;
+  }
+  return true;
+}
+
+void HashTableDirectoryPage::IncrGlobalDepth() {
+  uint32_t size = Size();
+  memcpy(local_depths_ + size, local_depths_, size * sizeof(local_depths_[0]));
+  memcpy(bucket_page_ids_ + size, bucket_page_ids_, size * sizeof(bucket_page_ids_[0]));
+  global_depth_++;
+}
+
+void HashTableDirectoryPage::DecrGlobalDepth() {
+  global_depth_--;
+  uint32_t size = Size();
+  memset(local_depths_ + size, 0, size * sizeof(local_depths_[0]));
+  for (uint32_t i = size; i < 2 * size; i++) bucket_page_ids_[i] = INVALID_PAGE_ID;
+}
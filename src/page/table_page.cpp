@@ -12,9 +12,6 @@ bool TablePage::InsertTuple(Row &row, Schema *schema, Transaction *txn,
                             LockManager *lock_manager, LogManager *log_manager) {
   uint32_t serialized_size = row.GetSerializedSize(schema);
   ASSERT(serialized_size > 0, "Can not have empty row.");
-  if (GetFreeSpaceRemaining() < serialized_size + SIZE_TUPLE) {
-    return false;
-  }
   // Try to find a free slot to reuse.
   uint32_t i;
   for (i = 0; i < GetTupleCount(); i++) {
@@ -24,7 +21,8 @@ bool TablePage::InsertTuple(Row &row, Schema *schema, Transaction *txn,
       break;
     }
   }
-  if (i == GetTupleCount() && GetFreeSpaceRemaining() < serialized_size + SIZE_TUPLE) {
+  // A new slot takes room in the slot array as well.
+  if (!MakeRoom(serialized_size + (i == GetTupleCount() ? SIZE_TUPLE : 0))) {
     return false;
   }
   // Otherwise we claim available free space..
@@ -74,34 +72,136 @@ int32_t TablePage::UpdateTuple(const Row &new_row, Row *old_row, Schema *schema,
     return 0;
   }
   uint32_t tuple_size = GetTupleSize(slot_num);
-  // If the tuple is deleted, abort.
-  if (IsDeleted(tuple_size)) {
+  // If the tuple is deleted or only forwards to the tuple, abort.
+  if (IsDeleted(tuple_size) || IsForward(tuple_size)) {
     return 0;
   }
+  tuple_size = TupleBytes(tuple_size);
   // If there is not enough space to update, we need to update via delete followed by an insert (not enough space).
-  if (GetFreeSpaceRemaining() + tuple_size < serialized_size) {
+  if (serialized_size > tuple_size && !MakeRoom(serialized_size - tuple_size)) {
     return 2;
   }
   // Copy out the old value.
   uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
   uint32_t __attribute__((unused)) read_bytes = old_row->DeserializeFrom(GetData() + tuple_offset, schema);
   ASSERT(tuple_size == read_bytes, "Unexpected behavior in tuple deserialize.");
+  // A new version of the same size, such as a changed number, is written over
+  // the old one and no other tuple moves.
+  ResizeTuple(slot_num, serialized_size);
+  new_row.SerializeTo(GetData() + GetTupleOffsetAtSlot(slot_num), schema);
+  return 1;
+}
+
+bool TablePage::ResizeTuple(uint32_t slot_num, uint32_t size) {
+  uint32_t tuple_size = GetTupleSize(slot_num);
+  uint32_t flags = tuple_size - TupleBytes(tuple_size);
+  tuple_size = TupleBytes(tuple_size);
+  if (size == tuple_size) {
+    return true;
+  }
+  if (size > tuple_size && !MakeRoom(size - tuple_size)) {
+    return false;
+  }
+  uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
   uint32_t free_space_pointer = GetFreeSpacePointer();
   ASSERT(tuple_offset >= free_space_pointer, "Offset should appear after current free space position.");
-  memmove(GetData() + free_space_pointer + tuple_size - serialized_size, GetData() + free_space_pointer,
+  memmove(GetData() + free_space_pointer + tuple_size - size, GetData() + free_space_pointer,
           tuple_offset - free_space_pointer);
-  SetFreeSpacePointer(free_space_pointer + tuple_size - serialized_size);
-  new_row.SerializeTo(GetData() + tuple_offset + tuple_size - serialized_size, schema);
-  SetTupleSize(slot_num, serialized_size);
-
-  // Update all tuple offsets.
+  SetFreeSpacePointer(free_space_pointer + tuple_size - size);
+  // Update the offsets of the moved tuples and of the resized one.
   for (uint32_t i = 0; i < GetTupleCount(); ++i) {
     uint32_t tuple_offset_i = GetTupleOffsetAtSlot(i);
     if (GetTupleSize(i) > 0 && tuple_offset_i < tuple_offset + tuple_size) {
-      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size - new_row.GetSerializedSize(schema));
+      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size - size);
     }
   }
-  return 1;
+  SetTupleSize(slot_num, size | flags);
+  return true;
+}
+
+bool TablePage::MakeRoom(uint32_t size) {
+  if (GetFreeSpaceRemaining() >= size) {
+    return true;
+  }
+  if (GetFreeSpaceRemaining() + GetFragmentedSpace() < size) {
+    return false;
+  }
+  Defragment();
+  return true;
+}
+
+uint32_t TablePage::GetFragmentedSpace() {
+  uint32_t used = 0;
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    used += TupleBytes(GetTupleSize(i));
+  }
+  return PAGE_SIZE - GetFreeSpacePointer() - used;
+}
+
+void TablePage::Defragment() {
+  char buf[PAGE_SIZE];
+  uint32_t free_space_pointer = PAGE_SIZE;
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    uint32_t tuple_size = TupleBytes(GetTupleSize(i));
+    if (tuple_size == 0) {
+      continue;
+    }
+    free_space_pointer -= tuple_size;
+    memcpy(buf + free_space_pointer, GetData() + GetTupleOffsetAtSlot(i), tuple_size);
+    SetTupleOffsetAtSlot(i, free_space_pointer);
+  }
+  memcpy(GetData() + free_space_pointer, buf + free_space_pointer, PAGE_SIZE - free_space_pointer);
+  SetFreeSpacePointer(free_space_pointer);
+}
+
+bool TablePage::GetForward(const RowId &rid, RowId *target) {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount() || !IsForward(GetTupleSize(slot_num))) {
+    return false;
+  }
+  int64_t target_id;
+  memcpy(&target_id, GetData() + GetTupleOffsetAtSlot(slot_num), SIZE_FORWARD);
+  *target = RowId(target_id);
+  return true;
+}
+
+bool TablePage::SetForward(const RowId &rid, const RowId &target) {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount() || IsDeleted(GetTupleSize(slot_num))) {
+    return false;
+  }
+  // a tuple serializes to more bytes than a RowId, so this only shrinks it
+  if (!ResizeTuple(slot_num, SIZE_FORWARD)) {
+    return false;
+  }
+  int64_t target_id = target.Get();
+  memcpy(GetData() + GetTupleOffsetAtSlot(slot_num), &target_id, SIZE_FORWARD);
+  SetTupleSize(slot_num, SIZE_FORWARD | FORWARD_MASK);
+  return true;
+}
+
+bool TablePage::RestoreTuple(const RowId &rid, const Row &row, Schema *schema) {
+  uint32_t slot_num = rid.GetSlotNum();
+  ASSERT(slot_num < GetTupleCount() && IsForward(GetTupleSize(slot_num)), "Not a forward slot.");
+  uint32_t serialized_size = row.GetSerializedSize(schema);
+  if (!ResizeTuple(slot_num, serialized_size)) {
+    return false;
+  }
+  row.SerializeTo(GetData() + GetTupleOffsetAtSlot(slot_num), schema);
+  SetTupleSize(slot_num, serialized_size);
+  return true;
+}
+
+void TablePage::MarkMoved(const RowId &rid) {
+  uint32_t slot_num = rid.GetSlotNum();
+  ASSERT(slot_num < GetTupleCount(), "Cannot have more slots than tuples.");
+  SetTupleSize(slot_num, static_cast<uint32_t>(GetTupleSize(slot_num) | MOVED_MASK));
+}
+
+void TablePage::UnmarkMoved(const RowId &rid) {
+  uint32_t slot_num = rid.GetSlotNum();
+  ASSERT(slot_num < GetTupleCount(), "Cannot have more slots than tuples.");
+  SetTupleSize(slot_num, static_cast<uint32_t>(GetTupleSize(slot_num) & ~MOVED_MASK));
 }
 
 void TablePage::ApplyDelete(const RowId &rid, Transaction *txn, LogManager *log_manager) {
@@ -109,27 +209,27 @@ void TablePage::ApplyDelete(const RowId &rid, Transaction *txn, LogManager *log_
   ASSERT(slot_num < GetTupleCount(), "Cannot have more slots than tuples.");
 
   uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
-  uint32_t tuple_size = GetTupleSize(slot_num);
   // Check if this is a delete operation, i.e. commit a delete.
-  if (IsDeleted(tuple_size)) {
-    tuple_size = UnsetDeletedFlag(tuple_size);
-  }
+  uint32_t tuple_size = TupleBytes(GetTupleSize(slot_num));
 
   uint32_t free_space_pointer = GetFreeSpacePointer();
   ASSERT(tuple_offset >= free_space_pointer, "Free space appears before tuples.");
 
-  memmove(GetData() + free_space_pointer + tuple_size, GetData() + free_space_pointer,
-          tuple_offset - free_space_pointer);
-  SetFreeSpacePointer(free_space_pointer + tuple_size);
+  // The tuple stays as a hole unless it borders the free space.
+  if (tuple_offset == free_space_pointer) {
+    SetFreeSpacePointer(free_space_pointer + tuple_size);
+  }
   SetTupleSize(slot_num, 0);
   SetTupleOffsetAtSlot(slot_num, 0);
 
-  // Update all tuple offsets.
-  for (uint32_t i = 0; i < GetTupleCount(); ++i) {
-    uint32_t tuple_offset_i = GetTupleOffsetAtSlot(i);
-    if (GetTupleSize(i) != 0 && tuple_offset_i < tuple_offset) {
-      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size);
-    }
+  // Drop the empty slots at the end, a page without tuples is all free space.
+  uint32_t tuple_count = GetTupleCount();
+  while (tuple_count > 0 && GetTupleSize(tuple_count - 1) == 0) {
+    tuple_count--;
+  }
+  SetTupleCount(tuple_count);
+  if (tuple_count == 0) {
+    SetFreeSpacePointer(PAGE_SIZE);
   }
 }
 
@@ -154,21 +254,21 @@ bool TablePage::GetTuple(Row *row, Schema *schema, Transaction *txn, LockManager
   }
   // Otherwise get the current tuple size too.
   uint32_t tuple_size = GetTupleSize(slot_num);
-  // If the tuple is deleted, abort the transaction.
-  if (IsDeleted(tuple_size)) {
+  // If the tuple is deleted, abort the transaction. A forward slot is followed by the table heap.
+  if (IsDeleted(tuple_size) || IsForward(tuple_size)) {
     return false;
   }
   // At this point, we have at least a shared lock on the RID. Copy the tuple data into our result.
   uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
   uint32_t __attribute__((unused)) read_bytes = row->DeserializeFrom(GetData() + tuple_offset, schema);
-  ASSERT(tuple_size == read_bytes, "Unexpected behavior in tuple deserialize.");
+  ASSERT(TupleBytes(tuple_size) == read_bytes, "Unexpected behavior in tuple deserialize.");
   return true;
 }
 
 bool TablePage::GetFirstTupleRid(RowId *first_rid) {
-  // Find and return the first valid tuple.
+  // Find and return the first valid tuple, moved tuples are found through their forward slots.
   for (uint32_t i = 0; i < GetTupleCount(); i++) {
-    if (!IsDeleted(GetTupleSize(i))) {
+    if (!IsDeleted(GetTupleSize(i)) && !IsMoved(GetTupleSize(i))) {
       first_rid->Set(GetTablePageId(), i);
       return true;
     }
@@ -181,7 +281,7 @@ bool TablePage::GetNextTupleRid(const RowId &cur_rid, RowId *next_rid) {
   ASSERT(cur_rid.GetPageId() == GetTablePageId(), "Wrong table!");
   // Find and return the first valid tuple after our current slot number.
   for (auto i = cur_rid.GetSlotNum() + 1; i < GetTupleCount(); i++) {
-    if (!IsDeleted(GetTupleSize(i))) {
+    if (!IsDeleted(GetTupleSize(i)) && !IsMoved(GetTupleSize(i))) {
       next_rid->Set(GetTablePageId(), i);
       return true;
     }
@@ -598,7 +598,7 @@ char *yytext;
 int yywrap();
 
 extern YYSTYPE yylval;
-#line 585 "../../parser/minisql_lex.c"
+#line 602 "../../parser/minisql_lex.c"
 
 #define INITIAL 0
 
@@ -787,7 +787,7 @@ YY_DECL {
 #line 15 "minisql.l"
 
 
-#line 770 "../../parser/minisql_lex.c"
+#line 791 "../../parser/minisql_lex.c"
 
   if (!(yy_init)) {
     (yy_init) = 1;
@@ -1182,13 +1182,52 @@ YY_DECL {
 #line 208 "minisql.l"
       {
         MinisqlParserMovePos(yylineno, yytext);
+        if (strcmp(yytext, "include") == 0) {
+          return INCLUDE;
+        }
+        if (strcmp(yytext, "analyze") == 0) {
+          return ANALYZE;
+        }
+        if (strcmp(yytext, "join") == 0) {
+          return JOIN;
+        }
+        if (strcmp(yytext, "group") == 0) {
+          return GROUP;
+        }
+        if (strcmp(yytext, "by") == 0) {
+          return BY;
+        }
+        if (strcmp(yytext, "order") == 0) {
+          return ORDER;
+        }
+        if (strcmp(yytext, "asc") == 0) {
+          return ASC;
+        }
+        if (strcmp(yytext, "desc") == 0) {
+          return DESC;
+        }
+        if (strcmp(yytext, "limit") == 0) {
+          return LIMIT;
+        }
+        if (strcmp(yytext, "offset") == 0) {
+          return OFFSET;
+        }
+        if (strcmp(yytext, "copy") == 0) {
+          return COPY;
+        }
+        if (strcmp(yytext, "truncate") == 0) {
+          return TRUNCATE;
+        }
+        if (strcmp(yytext, "vacuum") == 0) {
+          return VACUUM;
+        }
         yylval.syntax_node = CreateSyntaxNode(kNodeIdentifier, yytext);
         return IDENTIFIER;
       }
         YY_BREAK
       case 40:
         YY_RULE_SETUP
-#line 214 "minisql.l"
+#line 253 "minisql.l"
       {
         MinisqlParserMovePos(yylineno, yytext);
         yylval.syntax_node = CreateSyntaxNode(kNodeNumber, yytext);
@@ -1197,7 +1236,7 @@ YY_DECL {
         YY_BREAK
       case 41:
         YY_RULE_SETUP
-#line 220 "minisql.l"
+#line 259 "minisql.l"
       {
         MinisqlParserMovePos(yylineno, yytext);
         yylval.syntax_node = CreateSyntaxNode(kNodeNumber, yytext);
@@ -1206,7 +1245,7 @@ YY_DECL {
         YY_BREAK
       case 42:
         YY_RULE_SETUP
-#line 226 "minisql.l"
+#line 265 "minisql.l"
       {
         MinisqlParserMovePos(yylineno, yytext);
         return EQ;
@@ -1214,7 +1253,7 @@ YY_DECL {
         YY_BREAK
       case 43:
         YY_RULE_SETUP
-#line 231 "minisql.l"
+#line 270 "minisql.l"
       {
         MinisqlParserMovePos(yylineno, yytext);
         return NE;
@@ -1222,7 +1261,7 @@ YY_DECL {
         YY_BREAK
       case 44:
         YY_RULE_SETUP
-#line 236 "minisql.l"
+#line 275 "minisql.l"
       {
         MinisqlParserMovePos(yylineno, yytext);
         return LE;
@@ -1230,7 +1269,7 @@ YY_DECL {
         YY_BREAK
       case 45:
         YY_RULE_SETUP
-#line 241 "minisql.l"
+#line 280 "minisql.l"
       {
         MinisqlParserMovePos(yylineno, yytext);
         return GE;
@@ -1238,7 +1277,7 @@ YY_DECL {
         YY_BREAK
       case 46:
         YY_RULE_SETUP
-#line 246 "minisql.l"
+#line 285 "minisql.l"
       {
         MinisqlParserMovePos(yylineno, yytext);
         return (',');
@@ -1246,7 +1285,7 @@ YY_DECL {
         YY_BREAK
       case 47:
         YY_RULE_SETUP
-#line 251 "minisql.l"
+#line 290 "minisql.l"
       {
         MinisqlParserMovePos(yylineno, yytext);
         return ('*');
@@ -1254,7 +1293,7 @@ YY_DECL {
         YY_BREAK
       case 48:
         YY_RULE_SETUP
-#line 256 "minisql.l"
+#line 295 "minisql.l"
       {
         MinisqlParserMovePos(yylineno, yytext);
         return (';');
@@ -1262,7 +1301,7 @@ YY_DECL {
         YY_BREAK
       case 49:
         YY_RULE_SETUP
-#line 261 "minisql.l"
+#line 300 "minisql.l"
       {
         MinisqlParserMovePos(yylineno, yytext);
         return ('\'');
@@ -1270,7 +1309,7 @@ YY_DECL {
         YY_BREAK
       case 50:
         YY_RULE_SETUP
-#line 266 "minisql.l"
+#line 305 "minisql.l"
       {
         MinisqlParserMovePos(yylineno, yytext);
         return ('<');
@@ -1278,7 +1317,7 @@ YY_DECL {
         YY_BREAK
       case 51:
         YY_RULE_SETUP
-#line 271 "minisql.l"
+#line 310 "minisql.l"
       {
         MinisqlParserMovePos(yylineno, yytext);
         return ('>');
@@ -1286,7 +1325,7 @@ YY_DECL {
         YY_BREAK
       case 52:
         YY_RULE_SETUP
-#line 276 "minisql.l"
+#line 315 "minisql.l"
       {
         MinisqlParserMovePos(yylineno, yytext);
         return ('(');
@@ -1294,7 +1333,7 @@ YY_DECL {
         YY_BREAK
       case 53:
         YY_RULE_SETUP
-#line 281 "minisql.l"
+#line 320 "minisql.l"
       {
         MinisqlParserMovePos(yylineno, yytext);
         return (')');
@@ -1303,15 +1342,24 @@ YY_DECL {
       case 54:
 /* rule 54 can match eol */
         YY_RULE_SETUP
-#line 286 "minisql.l"
+#line 325 "minisql.l"
       {
         MinisqlParserMovePos(yylineno, yytext);
       }
         YY_BREAK
       case 55:
         YY_RULE_SETUP
-#line 290 "minisql.l"
+#line 329 "minisql.l"
       {
+        if (strcmp(yytext, ".") == 0) {
+          MinisqlParserMovePos(yylineno, yytext);
+          return ('.');
+        }
+        if (strcmp(yytext, "?") == 0) {
+          MinisqlParserMovePos(yylineno, yytext);
+          yylval.syntax_node = CreateSyntaxNode(kNodeParameter, NULL);
+          return PARAMETER;
+        }
         char str[128] = {0};
         sprintf(str, "Unrecognized token [%s] in input sql.", yytext);
         MinisqlParserSetError(str);
@@ -1319,10 +1367,10 @@ YY_DECL {
         YY_BREAK
       case 56:
         YY_RULE_SETUP
-#line 296 "minisql.l"
+#line 344 "minisql.l"
         ECHO;
         YY_BREAK
-#line 1314 "../../parser/minisql_lex.c"
+#line 1374 "../../parser/minisql_lex.c"
       case YY_STATE_EOF(INITIAL):
         yyterminate();
 
@@ -2258,7 +2306,7 @@ void yyfree(void *ptr) {
 
 #define YYTABLES_NAME "yytables"
 
-#line 296 "minisql.l"
+#line 344 "minisql.l"
 
 
 int yywrap() {
@@ -113,6 +113,8 @@ const char *GetSyntaxNodeTypeStr(SyntaxNodeType type) {
       return "kNodeString";
     case kNodeNull:
       return "kNodeNull";
+    case kNodeParameter:
+      return "kNodeParameter";
     case kNodeCreateDB:
       return "kNodeCreateDB";
     case kNodeDropDB:
@@ -139,6 +141,18 @@ const char *GetSyntaxNodeTypeStr(SyntaxNodeType type) {
       return "kNodeSelect";
     case kNodeConditions:
       return "kNodeConditions";
+    case kNodeTableList:
+      return "kNodeTableList";
+    case kNodeGroupBy:
+      return "kNodeGroupBy";
+    case kNodeAggregate:
+      return "kNodeAggregate";
+    case kNodeOrderBy:
+      return "kNodeOrderBy";
+    case kNodeOrderKey:
+      return "kNodeOrderKey";
+    case kNodeLimit:
+      return "kNodeLimit";
     case kNodeConnector:
       return "kNodeConnector";
     case kNodeCompareOperator:
@@ -163,12 +177,24 @@ const char *GetSyntaxNodeTypeStr(SyntaxNodeType type) {
       return "kNodeCreateIndex";
     case kNodeDropIndex:
       return "kNodeDropIndex";
+    case kNodeIndexType:
+      return "kNodeIndexType";
+    case kNodeIncludeColumns:
+      return "kNodeIncludeColumns";
     case kNodeTrxBegin:
       return "kNodeTrxBegin";
     case kNodeTrxCommit:
       return "kNodeTrxCommit";
     case kNodeTrxRollback:
       return "kNodeTrxRollback";
+    case kNodeAnalyze:
+      return "kNodeAnalyze";
+    case kNodeCopy:
+      return "kNodeCopy";
+    case kNodeTruncateTable:
+      return "kNodeTruncateTable";
+    case kNodeVacuum:
+      return "kNodeVacuum";
     default:
       return "error type";
   }
@@ -26,23 +26,26 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
 void DiskManager::Close() {
   std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   if (!closed) {
+    WritePhysicalPage(META_PAGE_ID, meta_data_);
     db_io_.close();
     closed = true;
   }
 }
 
 void DiskManager::ReadPage(page_id_t logical_page_id, char *page_data) {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   ASSERT(logical_page_id >= 0, "Invalid page id.");
   ReadPhysicalPage(MapPageId(logical_page_id), page_data);
 }
 
 void DiskManager::WritePage(page_id_t logical_page_id, const char *page_data) {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   ASSERT(logical_page_id >= 0, "Invalid page id.");
   WritePhysicalPage(MapPageId(logical_page_id), page_data);
 }
 
 page_id_t DiskManager::AllocatePage() {
-  
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *> (meta_data_);
   for(uint32_t bitmap_id = 0; ; ++bitmap_id) {
     if((bitmap_id + 1) * BITMAP_SIZE > MAX_VALID_PAGE_ID){
@@ -79,6 +82,7 @@ page_id_t DiskManager::AllocatePage() {
 }
 
 void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   if((size_t)logical_page_id >= MAX_VALID_PAGE_ID){
     LOG(ERROR) << "The logical page id is too big";
   }
@@ -90,7 +94,7 @@ void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
   page_id_t bitmap_offset = logical_page_id % BITMAP_SIZE; // skip the offset
   if(!bitmap_page->IsPageFree(bitmap_offset)){
     bitmap_page->DeAllocatePage(bitmap_offset);
-    WritePhysicalPage(bitmap_id, page_data);
+    WritePhysicalPage(1 + bitmap_id * (BITMAP_SIZE + 1), page_data);
     meta_page->extent_used_page_[bitmap_id]--;
     meta_page->num_allocated_pages_--;
   }
@@ -100,6 +104,7 @@ void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
 }
 
 bool DiskManager::IsPageFree(page_id_t logical_page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   if((size_t)logical_page_id >= MAX_VALID_PAGE_ID){
     LOG(ERROR) << "The logical page id is too big";
   }
@@ -0,0 +1,47 @@
+#include "storage/page_reclaimer.h"
+
+PageReclaimer::~PageReclaimer() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+void PageReclaimer::Submit(std::function<void()> job) {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    jobs_.push_back(std::move(job));
+    if (!worker_.joinable()) {
+      worker_ = std::thread(&PageReclaimer::Run, this);
+    }
+  }
+  cv_.notify_all();
+}
+
+void PageReclaimer::Wait() {
+  std::unique_lock<std::mutex> lock(latch_);
+  cv_.wait(lock, [this] { return jobs_.empty() && !busy_; });
+}
+
+void PageReclaimer::Run() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    cv_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+    // queued jobs still run after stop, their pages would leak otherwise
+    if (jobs_.empty()) {
+      return;
+    }
+    auto job = std::move(jobs_.front());
+    jobs_.pop_front();
+    busy_ = true;
+    lock.unlock();
+    job();
+    lock.lock();
+    busy_ = false;
+    cv_.notify_all();
+  }
+}
@@ -0,0 +1,71 @@
+#include <iterator>
+
+#include "storage/row_id_bitmap.h"
+
+void RowIdBitmap::Add(const RowId &rid) {
+  auto &words = pages_[rid.GetPageId()];
+  uint32_t word = rid.GetSlotNum() / 64;
+  if (word >= words.size()) {
+    words.resize(word + 1, 0);
+  }
+  words[word] |= uint64_t(1) << (rid.GetSlotNum() % 64);
+}
+
+bool RowIdBitmap::Contains(const RowId &rid) const {
+  auto it = pages_.find(rid.GetPageId());
+  if (it == pages_.end()) {
+    return false;
+  }
+  uint32_t word = rid.GetSlotNum() / 64;
+  return word < it->second.size() && (it->second[word] >> (rid.GetSlotNum() % 64) & 1);
+}
+
+void RowIdBitmap::Intersect(const RowIdBitmap &other) {
+  for (auto it = pages_.begin(); it != pages_.end();) {
+    auto other_it = other.pages_.find(it->first);
+    bool empty = true;
+    if (other_it != other.pages_.end()) {
+      auto &words = it->second;
+      const auto &other_words = other_it->second;
+      for (size_t i = 0; i < words.size(); i++) {
+        words[i] &= i < other_words.size() ? other_words[i] : 0;
+        empty = empty && words[i] == 0;
+      }
+    }
+    it = empty ? pages_.erase(it) : std::next(it);
+  }
+}
+
+void RowIdBitmap::Union(const RowIdBitmap &other) {
+  for (const auto &page : other.pages_) {
+    auto &words = pages_[page.first];
+    if (words.size() < page.second.size()) {
+      words.resize(page.second.size(), 0);
+    }
+    for (size_t i = 0; i < page.second.size(); i++) {
+      words[i] |= page.second[i];
+    }
+  }
+}
+
+size_t RowIdBitmap::Size() const {
+  size_t size = 0;
+  for (const auto &page : pages_) {
+    for (auto word : page.second) {
+      size += __builtin_popcountll(word);
+    }
+  }
+  return size;
+}
+
+std::vector<RowId> RowIdBitmap::GetRowIds() const {
+  std::vector<RowId> row_ids;
+  for (const auto &page : pages_) {
+    for (size_t i = 0; i < page.second.size(); i++) {
+      for (uint64_t word = page.second[i]; word != 0; word &= word - 1) {
+        row_ids.emplace_back(page.first, static_cast<uint32_t>(i * 64 + __builtin_ctzll(word)));
+      }
+    }
+  }
+  return row_ids;
+}
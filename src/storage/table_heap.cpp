@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "storage/table_heap.h"
 #include "common/config.h"
 #include "page/table_page.h"
@@ -17,7 +19,7 @@ bool TableHeap::InsertTuple(Row &row, Transaction *txn) {
     buffer_pool_manager_->UnpinPage(last_page_id_,true);   
     return true;
   }
-  auto page=reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id_));
+  auto page=FetchLastPage();
   //buffer_pool_manager_->UnpinPage(last_page_id_,false);
   ASSERT(page->GetNextPageId()==INVALID_PAGE_ID,"Error");
   bool flag=page->InsertTuple(row,schema_,txn,lock_manager_,log_manager_);
@@ -43,6 +45,48 @@ bool TableHeap::InsertTuple(Row &row, Transaction *txn) {
   return true;
 }
 
+bool TableHeap::InsertTuples(std::vector<Row> &rows, Transaction *txn) {
+  for(auto &row : rows) {
+    if(row.GetSerializedSize(schema_) > TablePage::SIZE_MAX_ROW) {
+      printf("Cannot insert this tuple!\n");
+      return false;
+    }
+  }
+  if(rows.empty()) return true;
+  TablePage *page;
+  if(last_page_id_ == 0) {
+    page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(first_page_id_));
+    last_page_id_ = first_page_id_;
+    page->Init(first_page_id_, INVALID_PAGE_ID, log_manager_, txn);
+  } else {
+    page = FetchLastPage();
+  }
+  for(auto &row : rows) {
+    if(page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_)) continue;
+    page_id_t next_page_id;
+    auto next_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(next_page_id));
+    next_page->Init(next_page_id, last_page_id_, log_manager_, txn);
+    page->SetNextPageId(next_page_id);
+    buffer_pool_manager_->UnpinPage(last_page_id_, true);
+    page = next_page;
+    last_page_id_ = next_page_id;
+    page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+  }
+  buffer_pool_manager_->UnpinPage(last_page_id_, true);
+  return true;
+}
+
+TablePage *TableHeap::FetchLastPage() {
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id_));
+  while(page->GetNextPageId() != INVALID_PAGE_ID) {
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(last_page_id_, false);
+    last_page_id_ = next_page_id;
+    page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id_));
+  }
+  return page;
+}
+
 bool TableHeap::MarkDelete(const RowId &rid, Transaction *txn) {
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
@@ -50,11 +94,18 @@ bool TableHeap::MarkDelete(const RowId &rid, Transaction *txn) {
   if (page == nullptr) {
     return false;
   }
-  // Otherwise, mark the tuple as deleted.
+  // Otherwise, mark the tuple as deleted, and a moved version with it.
+  RowId target;
   page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  bool forward = page->GetForward(rid, &target);
+  bool marked = page->MarkDelete(rid, txn, lock_manager_, log_manager_);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  if (forward && marked) {
+    auto target_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(target.GetPageId()));
+    target_page->MarkDelete(target, txn, lock_manager_, log_manager_);
+    buffer_pool_manager_->UnpinPage(target.GetPageId(), true);
+  }
   return true;
 }
 
@@ -64,43 +115,109 @@ bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Transaction *txn) {
     printf("Cannot update this tuple!\n");
     return false;
   }
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));  
-  Row old_row=Row(rid);
-  int32_t flag=page->UpdateTuple(row,&old_row,schema_,txn,lock_manager_,log_manager_);
-  if(flag==0){
-    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
-    return false;
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  RowId target;
+  if(!page->GetForward(rid, &target)) {
+    Row old_row=Row(rid);
+    int32_t flag=page->UpdateTuple(row,&old_row,schema_,txn,lock_manager_,log_manager_);
+    if(flag==0){
+      buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
+      return false;
+    }
+    // the new version goes to another page and the slot forwards to it
+    if(flag==2){
+      Relocate(row, txn);
+      bool __attribute__((unused)) forward=page->SetForward(rid,row.GetRowId());
+      ASSERT(forward,"A tuple always has room for a forward slot.");
+    }
+    row.SetRowId(rid);
+    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+    return true;
   }
-  else if(flag==1){
+  // a moved tuple returns to its own page once that has room again
+  if(page->RestoreTuple(rid,row,schema_)){
     buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+    ApplyDelete(target, txn);
+    row.SetRowId(rid);
     return true;
   }
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
-  return InsertTuple(row, txn);
-  /*
-  RowId nowid,nxtid;
-  bool f=page->GetFirstTupleRid(&nowid);
-  if(f!=0){
-    while(f){
-      f=page->GetNextTupleRid(nowid,&nxtid);
-      page->ApplyDelete(nowid,txn,log_manager_);
-      nowid=nxtid;
-    }
+  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
+  auto target_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(target.GetPageId()));
+  Row old_row=Row(target);
+  int32_t flag=target_page->UpdateTuple(row,&old_row,schema_,txn,lock_manager_,log_manager_);
+  if(flag==2)target_page->ApplyDelete(target,txn,log_manager_);
+  buffer_pool_manager_->UnpinPage(target.GetPageId(), flag!=0);
+  if(flag==0)return false;
+  // the forward slot points to the latest place, there are never chains
+  if(flag==2){
+    Relocate(row, txn);
+    page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+    page->SetForward(rid,row.GetRowId());
+    buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
   }
-  flag=page->UpdateTuple(row,&old_row,schema_,txn,lock_manager_,log_manager_);
-  if(flag==1)buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
-  else buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
-  return (flag==1);*/
+  row.SetRowId(rid);
+  return true;
+}
+
+void TableHeap::Relocate(Row &row, Transaction *txn) {
+  InsertTuple(row, txn);
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(row.GetRowId().GetPageId()));
+  page->MarkMoved(row.GetRowId());
+  buffer_pool_manager_->UnpinPage(row.GetRowId().GetPageId(), true);
+}
+
+bool TableHeap::ReadTuple(TablePage *page, Row *row, Transaction *txn) {
+  RowId target;
+  if(!page->GetForward(row->GetRowId(), &target))return page->GetTuple(row,schema_,txn,lock_manager_);
+  RowId rid=row->GetRowId();
+  auto target_page=reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(target.GetPageId()));
+  row->SetRowId(target);
+  bool flag=target_page->GetTuple(row,schema_,txn,lock_manager_);
+  buffer_pool_manager_->UnpinPage(target.GetPageId(),false);
+  row->SetRowId(rid);
+  return flag;
 }
 
 void TableHeap::ApplyDelete(const RowId &rid, Transaction *txn) {
   // Step1: Find the page which contains the tuple.
-  // Step2: Delete the tuple from the page.
+  // Step2: Delete the tuple from the page, and the version it forwards to.
   ASSERT(!buffer_pool_manager_->IsPageFree(rid.GetPageId()),"The page of the rowid doesn't exist!\n");
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  RowId target;
+  bool forward = page->GetForward(rid, &target);
   page->ApplyDelete(rid,txn,log_manager_);
   buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
+  if(forward) ApplyDelete(target, txn);
+}
+
+bool TableHeap::DeleteTuples(std::vector<RowId> rids, Transaction *txn, std::vector<RowId> *deleted_rids) {
+  std::sort(rids.begin(), rids.end(), [](const RowId &lhs, const RowId &rhs) { return lhs.Get() < rhs.Get(); });
+  std::vector<RowId> targets;
+  bool deleted = true;
+  for(size_t i = 0; i < rids.size();) {
+    page_id_t page_id = rids[i].GetPageId();
+    auto page = buffer_pool_manager_->IsPageFree(page_id) ? nullptr
+                : reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    for(; i < rids.size() && rids[i].GetPageId() == page_id; i++) {
+      if(page == nullptr) {
+        deleted = false;
+        continue;
+      }
+      RowId target;
+      bool forward = page->GetForward(rids[i], &target);
+      if(page->MarkDelete(rids[i], txn, lock_manager_, log_manager_)) {
+        page->ApplyDelete(rids[i], txn, log_manager_);
+        if(forward) targets.push_back(target);
+        if(deleted_rids != nullptr) deleted_rids->push_back(rids[i]);
+      } else {
+        deleted = false;
+      }
+    }
+    if(page != nullptr) buffer_pool_manager_->UnpinPage(page_id, true);
+  }
+  // moved versions are never forward slots themselves
+  if(!targets.empty()) DeleteTuples(std::move(targets), txn);
+  return deleted;
 }
 
 void TableHeap::RollbackDelete(const RowId &rid, Transaction *txn) {
@@ -108,24 +225,136 @@ void TableHeap::RollbackDelete(const RowId &rid, Transaction *txn) {
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   assert(page != nullptr);
   // Rollback the delete.
+  RowId target;
   page->WLatch();
+  bool forward = page->GetForward(rid, &target);
   page->RollbackDelete(rid, txn, log_manager_);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  if(forward) RollbackDelete(target, txn);
+}
+
+void TableHeap::FoldForwards(std::vector<Row> &rows, std::vector<RowId> &old_row_ids,
+                             std::unordered_map<int64_t, size_t> &moved, Transaction *txn) {
+  for(page_id_t page_id=first_page_id_;page_id!=INVALID_PAGE_ID;){
+    auto page=reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    RowId rid,target;
+    for(bool found=page->GetFirstTupleRid(&rid);found;found=page->GetNextTupleRid(rid,&rid)){
+      if(!page->GetForward(rid,&target))continue;
+      auto target_page=target.GetPageId()==page_id?page:
+                       reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(target.GetPageId()));
+      Row row(target);
+      target_page->GetTuple(&row,schema_,txn,lock_manager_);
+      if(page->RestoreTuple(rid,row,schema_)){
+        target_page->ApplyDelete(target,txn,log_manager_);
+      }else{
+        page->ApplyDelete(rid,txn,log_manager_);
+        target_page->UnmarkMoved(target);
+        moved[target.Get()]=rows.size();
+        rows.push_back(row);
+        old_row_ids.push_back(rid);
+      }
+      if(target_page!=page)buffer_pool_manager_->UnpinPage(target.GetPageId(),true);
+    }
+    page_id_t next_page_id=page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id,true);
+    page_id=next_page_id;
+  }
+}
+
+uint32_t TableHeap::Vacuum(std::vector<Row> &rows, std::vector<RowId> &old_row_ids, Transaction *txn) {
+  if(first_page_id_==0)return 0;
+  // rid of a tuple in rows -> its position, a folded tuple may move again
+  std::unordered_map<int64_t, size_t> moved;
+  FoldForwards(rows,old_row_ids,moved,txn);
+  // tuples go to the first page with room, dest, and pages emptied are unlinked
+  uint32_t freed=0;
+  page_id_t dest_id=first_page_id_;
+  auto dest=reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(dest_id));
+  page_id_t prev_id=dest_id;
+  page_id_t page_id=dest->GetNextPageId();
+  while(page_id!=INVALID_PAGE_ID){
+    auto page=reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    RowId rid;
+    bool found=page->GetFirstTupleRid(&rid);
+    while(found&&dest_id!=page_id){
+      Row row(rid);
+      page->GetTuple(&row,schema_,txn,lock_manager_);
+      if(!dest->InsertTuple(row,schema_,txn,lock_manager_,log_manager_)){
+        // dest is full, the next page kept takes over, at the latest this one
+        page_id_t next_id=dest->GetNextPageId();
+        buffer_pool_manager_->UnpinPage(dest_id,true);
+        dest_id=next_id;
+        dest=dest_id==page_id?page:reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(dest_id));
+        continue;
+      }
+      auto itr=moved.find(rid.Get());
+      if(itr!=moved.end()){
+        rows[itr->second].SetRowId(row.GetRowId());
+      }else{
+        rows.push_back(row);
+        old_row_ids.push_back(rid);
+      }
+      page->ApplyDelete(rid,txn,log_manager_);
+      found=page->GetNextTupleRid(rid,&rid);
+    }
+    page_id_t next_page_id=page->GetNextPageId();
+    if(dest_id==page_id){
+      prev_id=page_id;
+    }else if(!page->IsEmpty()){
+      // tuples deleted but not applied yet keep their page
+      prev_id=page_id;
+      buffer_pool_manager_->UnpinPage(page_id,true);
+    }else{
+      auto prev_page=prev_id==dest_id?dest:reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(prev_id));
+      prev_page->SetNextPageId(next_page_id);
+      if(prev_page!=dest)buffer_pool_manager_->UnpinPage(prev_id,true);
+      if(next_page_id!=INVALID_PAGE_ID){
+        auto next_page=reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
+        next_page->SetPrevPageId(prev_id);
+        buffer_pool_manager_->UnpinPage(next_page_id,true);
+      }else{
+        last_page_id_=prev_id;
+      }
+      buffer_pool_manager_->UnpinPage(page_id,false);
+      buffer_pool_manager_->DeletePage(page_id);
+      freed++;
+    }
+    page_id=next_page_id;
+  }
+  buffer_pool_manager_->UnpinPage(dest_id,true);
+  return freed;
 }
 
 void TableHeap::FreeHeap() {
   if(first_page_id_==0)return;
-  auto page=reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  buffer_pool_manager_->UnpinPage(first_page_id_,true);
-  while(true){
-    auto nxtpage=reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page->GetNextPageId()));
-    bool flag=true;
-    if(page->GetNextPageId()==INVALID_PAGE_ID)flag=0;
-    if(flag)buffer_pool_manager_->UnpinPage(page->GetNextPageId(), true);
-    buffer_pool_manager_->DeletePage(page->GetTablePageId());
-    if(!flag)return;
-    page=nxtpage;
+  for(page_id_t page_id=first_page_id_;page_id!=INVALID_PAGE_ID;){
+    auto page=reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    page_id_t next_page_id=page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id,false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id=next_page_id;
+  }
+}
+
+page_id_t TableHeap::Truncate(Transaction *txn) {
+  page_id_t old_first_page_id=first_page_id_;
+  page_id_t page_id;
+  auto page=reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(page_id));
+  page->Init(page_id,INVALID_PAGE_ID,log_manager_,txn);
+  buffer_pool_manager_->UnpinPage(page_id,true);
+  first_page_id_=last_page_id_=page_id;
+  return old_first_page_id;
+}
+
+void TableHeap::FreePages(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id) {
+  if(first_page_id==0)return;
+  TablePage page;
+  for(page_id_t page_id=first_page_id;page_id!=INVALID_PAGE_ID;){
+    buffer_pool_manager->ReadPage(page_id,page.GetData());
+    page_id_t next_page_id=page.GetNextPageId();
+    buffer_pool_manager->DeletePage(page_id);
+    page_id=next_page_id;
   }
 }
 
@@ -135,13 +364,29 @@ bool TableHeap::GetTuple(Row *row, Transaction *txn) {
     return false;
   }
   auto page=reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(row->GetRowId().GetPageId()));
-  bool flag=page->GetTuple(row,schema_,txn,lock_manager_);
+  bool flag=ReadTuple(page,row,txn);
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(),false);
   if(flag)return true;
   printf("Cannot find this tuple!\n");
   return false;
 }
 
+void TableHeap::GetTuples(const std::vector<RowId> &row_ids, std::vector<Row> &rows, Transaction *txn) {
+  TablePage *page=nullptr;
+  for(auto &rid:row_ids){
+    if(page==nullptr||page->GetTablePageId()!=rid.GetPageId()){
+      if(page!=nullptr)buffer_pool_manager_->UnpinPage(page->GetTablePageId(),false);
+      page=nullptr;
+      if(buffer_pool_manager_->IsPageFree(rid.GetPageId()))continue;
+      page=reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+      if(page==nullptr)continue;
+    }
+    Row row(rid);
+    if(ReadTuple(page,&row,txn))rows.push_back(row);
+  }
+  if(page!=nullptr)buffer_pool_manager_->UnpinPage(page->GetTablePageId(),false);
+}
+
 TableIterator TableHeap::Begin(Transaction *txn) {
   if(first_page_id_==0)return TableIterator(-1);
   auto page=reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_)); 
@@ -154,7 +399,7 @@ TableIterator TableHeap::Begin(Transaction *txn) {
     flag=page->GetFirstTupleRid(id);
     if(flag){
       Row row(new_id);
-      page->GetTuple(&row,schema_,txn,lock_manager_);
+      ReadTuple(page,&row,txn);
       TableIterator itr=TableIterator(&row,this,page->GetTablePageId());
       buffer_pool_manager_->UnpinPage(page->GetTablePageId(),false); 
       return itr;
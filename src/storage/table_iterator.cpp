@@ -39,30 +39,30 @@ Row *TableIterator::operator->() {
 
 TableIterator &TableIterator::operator++() {
   auto page=reinterpret_cast<TablePage *>(heap_->buffer_pool_manager_->FetchPage(now_page_));
-  //cout<<row_->GetRowId().GetPageId()<<" "<<row_->GetRowId().GetSlotNum()<<"~~~~"<<endl;
-  bool flag=page->GetTuple(row_,heap_->schema_,nullptr,heap_->lock_manager_);
-  heap_->buffer_pool_manager_->UnpinPage(page->GetTablePageId(),false);
-  ASSERT(flag,"This tuple doesn't exist in this page!");
   RowId new_RowId;
   RowId *rid=&new_RowId;
-  //cout<<row_->GetRowId().GetPageId()<<" "<<row_->GetRowId().GetSlotNum()<<"xxxxx"<<endl;
-  flag=page->GetNextTupleRid(row_->GetRowId(),rid);
+  bool flag=page->GetNextTupleRid(row_->GetRowId(),rid);
   if(flag){
     row_->SetRowId(new_RowId);
-    page->GetTuple(row_,heap_->schema_,nullptr,heap_->lock_manager_);
+    heap_->ReadTuple(page,row_,nullptr);
+    heap_->buffer_pool_manager_->UnpinPage(page->GetTablePageId(),false);
     return *this;
   }
   while(flag==false){
+    heap_->buffer_pool_manager_->UnpinPage(page->GetTablePageId(),false);
     if(page->GetNextPageId()==INVALID_PAGE_ID){
       this->now_page_=-1;
       return *this;
     }
     now_page_=page->GetNextPageId();
     page=reinterpret_cast<TablePage *>(heap_->buffer_pool_manager_->FetchPage(now_page_));
-    heap_->buffer_pool_manager_->UnpinPage(page->GetTablePageId(),false);
     flag=page->GetFirstTupleRid(rid);
-    if(flag)row_->SetRowId(*rid);
+    if(flag){
+      row_->SetRowId(*rid);
+      heap_->ReadTuple(page,row_,nullptr);
+    }
   }
+  heap_->buffer_pool_manager_->UnpinPage(page->GetTablePageId(),false);
   return *this;
 }
 
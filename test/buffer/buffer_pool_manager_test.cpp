@@ -1,6 +1,8 @@
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
@@ -71,4 +73,45 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
 
   delete bpm;
   delete disk_manager;
-}
\ No newline at end of file
+}
+TEST(BufferPoolManagerTest, ConcurrentTest) {
+  const std::string db_name = "bpm_concurrent_test.db";
+  const size_t buffer_pool_size = 16;
+  const int thread_nums = 4, page_nums = 200;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  // every thread writes its own pages and reads them back, evicting the others' pages
+  std::vector<std::thread> threads;
+  std::vector<bool> matched(thread_nums, true);
+  for (int t = 0; t < thread_nums; t++) {
+    threads.emplace_back([&, t]() {
+      std::vector<page_id_t> page_ids;
+      for (int i = 0; i < page_nums; i++) {
+        page_id_t page_id;
+        Page *page = bpm->NewPage(page_id);
+        if (page == nullptr) {
+          matched[t] = false;
+          return;
+        }
+        snprintf(page->GetData(), PAGE_SIZE, "thread %d page %d", t, i);
+        bpm->UnpinPage(page_id, true);
+        page_ids.push_back(page_id);
+      }
+      char expected[64];
+      for (int i = 0; i < page_nums; i++) {
+        Page *page = bpm->FetchPage(page_ids[i]);
+        snprintf(expected, sizeof(expected), "thread %d page %d", t, i);
+        if (page == nullptr || strcmp(page->GetData(), expected) != 0) matched[t] = false;
+        if (page != nullptr) bpm->UnpinPage(page_ids[i], false);
+      }
+    });
+  }
+  for (auto &thread : threads) thread.join();
+  for (int t = 0; t < thread_nums; t++) ASSERT_TRUE(matched[t]);
+  ASSERT_TRUE(bpm->CheckAllUnpinned());
+  disk_manager->Close();
+  remove(db_name.c_str());
+  delete bpm;
+  delete disk_manager;
+}
@@ -135,4 +135,154 @@ TEST(CatalogTest, CatalogIndexTest) {
     ASSERT_EQ(rid.Get(), ret_02[i].Get());
   }
   delete db_02;
-}
\ No newline at end of file
+}
+
+TEST(CatalogTest, CatalogDropTest) {
+  SimpleMemHeap heap;
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  Transaction txn;
+  TableInfo *table_info = nullptr;
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("table-1", schema.get(), &txn, table_info));
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("table-2", schema.get(), &txn, table_info));
+  std::vector<std::string> index_keys{"id"};
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-1", "index-1", index_keys, &txn, index_info));
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-2", "index-2", index_keys, &txn, index_info));
+  // the table and index infos live in the catalog's memory heap, which frees them once
+  ASSERT_EQ(DB_SUCCESS, catalog_01->DropIndex("table-1", "index-1"));
+  ASSERT_EQ(DB_SUCCESS, catalog_01->DropTable("table-1"));
+  ASSERT_EQ(DB_TABLE_NOT_EXIST, catalog_01->GetTable("table-1", table_info));
+  delete db_01;
+  auto db_02 = new DBStorageEngine(db_file_name, false);
+  auto &catalog_02 = db_02->catalog_mgr_;
+  ASSERT_EQ(DB_TABLE_NOT_EXIST, catalog_02->GetTable("table-1", table_info));
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetIndex("table-2", "index-2", index_info));
+  delete db_02;
+}
+
+TEST(CatalogTest, CatalogStatisticsTest) {
+  SimpleMemHeap heap;
+  /** Stage 1: Testing analyze */
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  Transaction txn;
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_TABLE_NOT_EXIST, catalog_01->AnalyzeTable("table-1", &txn));
+  catalog_01->CreateTable("table-1", schema.get(), &txn, table_info);
+  ASSERT_EQ(nullptr, table_info->GetStatistics());
+  // ids 0..3999, 40 distinct names, every tenth name null
+  const int row_nums = 4000;
+  for (int i = 0; i < row_nums; i++) {
+    std::string name = "name" + std::to_string(i % 40);
+    std::vector<Field> fields{
+            Field(TypeId::kTypeInt, i),
+            i % 10 == 0 ? Field(TypeId::kTypeChar) :
+            Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size() + 1, true)
+    };
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, &txn));
+  }
+  ASSERT_EQ(DB_SUCCESS, catalog_01->AnalyzeTable("table-1", &txn));
+  auto *statistics = table_info->GetStatistics();
+  ASSERT_NE(nullptr, statistics);
+  ASSERT_EQ(row_nums, statistics->GetRowCount());
+  ASSERT_GT(statistics->GetPageCount(), 1u);
+  // distinct counts are estimates
+  ASSERT_NEAR(row_nums, statistics->GetColumn(0).distinct_count_, row_nums / 10);
+  ASSERT_NEAR(36, statistics->GetColumn(1).distinct_count_, 4);
+  ASSERT_EQ(row_nums / 10, statistics->GetColumn(1).null_count_);
+  delete db_01;
+  /** Stage 2: Testing statistics loading and estimates */
+  auto db_02 = new DBStorageEngine(db_file_name, false);
+  auto &catalog_02 = db_02->catalog_mgr_;
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetTable("table-1", table_info));
+  statistics = table_info->GetStatistics();
+  ASSERT_NE(nullptr, statistics);
+  ASSERT_EQ(row_nums, statistics->GetRowCount());
+  ASSERT_EQ(0, statistics->EstimateEquality(0, Field(TypeId::kTypeInt, row_nums)));
+  ASSERT_NEAR(1.0 / row_nums, statistics->EstimateEquality(0, Field(TypeId::kTypeInt, 10)), 0.1 / row_nums);
+  ASSERT_NEAR(0.1, statistics->EstimateEquality(1, Field(TypeId::kTypeChar)), 1e-9);
+  Field low(TypeId::kTypeInt, 1000), high(TypeId::kTypeInt, 2000);
+  IndexRange range;
+  range.low_ = &low;
+  ASSERT_NEAR(0.75, statistics->EstimateRange(0, range), 0.07);
+  range.high_ = &high;
+  ASSERT_NEAR(0.25, statistics->EstimateRange(0, range), 0.07);
+  range.low_ = nullptr;
+  ASSERT_NEAR(0.5, statistics->EstimateRange(0, range), 0.07);
+  delete db_02;
+}
+
+TEST(CatalogTest, CatalogTruncateTest) {
+  SimpleMemHeap heap;
+  /** Stage 1: Testing truncate and drop */
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  Transaction txn;
+  TableInfo *table_info = nullptr;
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_TABLE_NOT_EXIST, catalog_01->TruncateTable("table-1", &txn));
+  catalog_01->CreateTable("table-1", schema.get(), &txn, table_info);
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-1", "index-1", {"id"}, &txn, index_info));
+  auto insert = [&](int count) {
+    for (int i = 0; i < count; i++) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, i),
+                                Field(TypeId::kTypeChar, const_cast<char *>("minisql"), 8, true)};
+      Row row(fields);
+      ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, &txn));
+      std::vector<Field> key_fields{Field(TypeId::kTypeInt, i)};
+      Row key(key_fields);
+      ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(key, row.GetRowId(), &txn));
+    }
+  };
+  auto count_rows = [&]() {
+    int count = 0;
+    for (auto itr = table_info->GetTableHeap()->Begin(&txn); itr != table_info->GetTableHeap()->End(); itr++) count++;
+    return count;
+  };
+  insert(5000);
+  ASSERT_EQ(DB_SUCCESS, catalog_01->AnalyzeTable("table-1", &txn));
+  page_id_t old_first_page_id = table_info->GetTableHeap()->GetFirstPageId();
+  ASSERT_EQ(DB_SUCCESS, catalog_01->TruncateTable("table-1", &txn));
+  ASSERT_EQ(nullptr, table_info->GetStatistics());
+  ASSERT_EQ(0, count_rows());
+  std::vector<Field> key_fields{Field(TypeId::kTypeInt, 10)};
+  Row key(key_fields);
+  std::vector<RowId> result;
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index_info->GetIndex()->ScanKey(key, result, &txn));
+  // the old pages go back to the disk manager in the background
+  catalog_01->GetPageReclaimer()->Wait();
+  ASSERT_TRUE(db_01->bpm_->IsPageFree(old_first_page_id));
+  insert(100);
+  ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanKey(key, result, &txn));
+  page_id_t first_page_id = table_info->GetTableHeap()->GetFirstPageId();
+  ASSERT_EQ(table_info->GetRootPageId(), first_page_id);
+  delete db_01;
+  /** Stage 2: Testing the truncated table after loading, then drop */
+  auto db_02 = new DBStorageEngine(db_file_name, false);
+  auto &catalog_02 = db_02->catalog_mgr_;
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetTable("table-1", table_info));
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetIndex("table-1", "index-1", index_info));
+  ASSERT_EQ(nullptr, table_info->GetStatistics());
+  ASSERT_EQ(100, count_rows());
+  ASSERT_EQ(DB_SUCCESS, catalog_02->DropTable("table-1"));
+  catalog_02->GetPageReclaimer()->Wait();
+  ASSERT_TRUE(db_02->bpm_->IsPageFree(first_page_id));
+  delete db_02;
+}
@@ -0,0 +1,81 @@
+#include <map>
+#include <vector>
+
+#include "executor/aggregate.h"
+#include "gtest/gtest.h"
+#include "record/field.h"
+#include "record/schema.h"
+
+using Fields = std::vector<Field>;
+
+/**
+ * (group, value) rows: value i for i in [0, 1000) lands in group i % 100, and
+ * every tenth value is null
+ */
+static std::vector<Row> MakeRows(bool sorted) {
+  std::vector<Row> rows;
+  for (int32_t i = 0; i < 1000; i++) {
+    int32_t value = sorted ? i % 10 * 100 + i / 10 : i;
+    Fields fields{Field(TypeId::kTypeInt, value % 100),
+                  value % 10 == 9 ? Field(TypeId::kTypeInt) : Field(TypeId::kTypeInt, value)};
+    rows.emplace_back(fields);
+  }
+  return rows;
+}
+
+// group -> (count(*), count(value), sum, min, max, avg)
+using Results = std::map<int32_t, std::vector<std::string>>;
+
+TEST(AggregateTest, HashAndStreamAggregateTest) {
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("group", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("value", TypeId::kTypeInt, 1, true, false)
+  };
+  Schema schema(columns);
+  std::vector<Aggregate> aggregates = {
+          {kAggregateCount, Aggregate::ALL_ROWS}, {kAggregateCount, 1}, {kAggregateSum, 1},
+          {kAggregateMin, 1}, {kAggregateMax, 1}, {kAggregateAvg, 1}
+  };
+  auto collect = [](Results &results) {
+    return [&results](const Row &row) {
+      ASSERT_EQ(7u, row.GetFieldCount());
+      auto &values = results[row.GetField(0)->value_.integer_];
+      ASSERT_TRUE(values.empty());
+      for (uint32_t i = 1; i < row.GetFieldCount(); i++) values.push_back(row.GetField(i)->GetString());
+    };
+  };
+  Results in_memory;
+  HashAggregate hash_aggregate(&schema, {0}, aggregates);
+  for (auto &row : MakeRows(false)) hash_aggregate.Add(row);
+  hash_aggregate.Finish(collect(in_memory));
+  ASSERT_FALSE(hash_aggregate.IsSpilled());
+  ASSERT_EQ(100u, in_memory.size());
+  // group 3 holds 3, 103, ..., 903
+  ASSERT_EQ((std::vector<std::string>{"10", "10", "4530", "3", "903", Field(TypeId::kTypeFloat, 453.f).GetString()}),
+            in_memory[3]);
+  // every value of group 9 is null
+  ASSERT_EQ((std::vector<std::string>{"10", "0", "null", "null", "null", "null"}), in_memory[9]);
+
+  // a budget of a few groups sends the others to the partitions
+  Results spilled;
+  HashAggregate small_aggregate(&schema, {0}, aggregates, 1024);
+  for (auto &row : MakeRows(false)) small_aggregate.Add(row);
+  small_aggregate.Finish(collect(spilled));
+  ASSERT_TRUE(small_aggregate.IsSpilled());
+  ASSERT_EQ(in_memory, spilled);
+
+  Results streamed;
+  StreamAggregate stream_aggregate(&schema, {0}, aggregates);
+  for (auto &row : MakeRows(true)) stream_aggregate.Add(row, collect(streamed));
+  stream_aggregate.Finish(collect(streamed));
+  ASSERT_EQ(in_memory, streamed);
+
+  // without group columns there is one group, also for no rows
+  std::vector<Row> groups;
+  HashAggregate total(&schema, {}, aggregates);
+  total.Finish([&](const Row &row) { groups.push_back(row); });
+  ASSERT_EQ(1u, groups.size());
+  ASSERT_EQ("0", groups[0].GetField(0)->GetString());
+  ASSERT_EQ("null", groups[0].GetField(2)->GetString());
+}
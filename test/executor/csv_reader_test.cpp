@@ -0,0 +1,41 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "executor/csv_reader.h"
+#include "gtest/gtest.h"
+
+TEST(CsvReaderTest, ReadRecordTest) {
+  const char *file_name = "csv_reader_test.csv";
+  FILE *file = fopen(file_name, "wb");
+  // quoted commas, quotes and line breaks, nulls, crlf and blank lines
+  fputs("1,plain,2.5\r\n"
+        "2,\"a, \"\"quoted\"\"\nvalue\",\n"
+        "\n"
+        ",\"\",x\n", file);
+  // a record longer than the read buffer
+  std::string long_value(CSV_READ_BUFFER_SIZE + 100, 'v');
+  fprintf(file, "3,%s,\"%s\"", long_value.c_str(), long_value.c_str());
+  fclose(file);
+
+  auto reader = CsvReader::Open(file_name);
+  ASSERT_NE(nullptr, reader);
+  std::vector<std::string> fields;
+  std::vector<bool> nulls;
+  ASSERT_TRUE(reader->ReadRecord(fields, nulls));
+  ASSERT_EQ((std::vector<std::string>{"1", "plain", "2.5"}), fields);
+  ASSERT_EQ((std::vector<bool>{false, false, false}), nulls);
+  ASSERT_TRUE(reader->ReadRecord(fields, nulls));
+  ASSERT_EQ((std::vector<std::string>{"2", "a, \"quoted\"\nvalue", ""}), fields);
+  ASSERT_EQ((std::vector<bool>{false, false, true}), nulls);
+  ASSERT_TRUE(reader->ReadRecord(fields, nulls));
+  ASSERT_EQ(5u, reader->GetLineNumber());
+  ASSERT_EQ((std::vector<std::string>{"", "", "x"}), fields);
+  ASSERT_EQ((std::vector<bool>{true, false, false}), nulls);
+  ASSERT_TRUE(reader->ReadRecord(fields, nulls));
+  ASSERT_EQ((std::vector<std::string>{"3", long_value, long_value}), fields);
+  ASSERT_FALSE(reader->ReadRecord(fields, nulls));
+  ASSERT_EQ(nullptr, CsvReader::Open("csv_reader_test_missing.csv"));
+  remove(file_name);
+}
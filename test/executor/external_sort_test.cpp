@@ -0,0 +1,71 @@
+#include <vector>
+
+#include "executor/external_sort.h"
+#include "gtest/gtest.h"
+#include "record/field.h"
+#include "record/schema.h"
+
+using Fields = std::vector<Field>;
+
+/**
+ * (key, position) pairs of the sorted rows: row i has key (i * 37) % 100, and
+ * every hundredth row a null key
+ */
+static std::vector<std::pair<std::string, int32_t>> SortRows(Schema *schema, bool descending, size_t limit,
+                                                             size_t memory_budget, bool &spilled) {
+  ExternalSort sort(schema, {{0, descending}}, limit, memory_budget);
+  for (int32_t i = 0; i < 1000; i++) {
+    Fields fields{i % 100 == 1 ? Field(TypeId::kTypeInt) : Field(TypeId::kTypeInt, i * 37 % 100),
+                  Field(TypeId::kTypeInt, i)};
+    sort.Add(Row(fields));
+  }
+  std::vector<std::pair<std::string, int32_t>> sorted;
+  sort.Finish([&](const Row &row) {
+    sorted.emplace_back(row.GetField(0)->GetString(), row.GetField(1)->value_.integer_);
+  });
+  spilled = sort.IsSpilled();
+  return sorted;
+}
+
+TEST(ExternalSortTest, InMemorySpilledAndTopNTest) {
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("key", TypeId::kTypeInt, 0, true, false),
+          ALLOC_COLUMN(heap)("position", TypeId::kTypeInt, 1, false, false)
+  };
+  Schema schema(columns);
+  bool spilled;
+  auto in_memory = SortRows(&schema, false, SIZE_MAX, SORT_MEMORY_BUDGET, spilled);
+  ASSERT_FALSE(spilled);
+  ASSERT_EQ(1000u, in_memory.size());
+  // nulls first, then keys in order with equal keys in input order
+  for (size_t i = 0; i < 10; i++) ASSERT_EQ("null", in_memory[i].first);
+  for (size_t i = 1; i < in_memory.size(); i++) {
+    if (in_memory[i].first == "null") continue;
+    int32_t previous = in_memory[i - 1].first == "null" ? -1 : std::stoi(in_memory[i - 1].first);
+    int32_t key = std::stoi(in_memory[i].first);
+    ASSERT_LE(previous, key);
+    if (previous == key) {
+      ASSERT_LT(in_memory[i - 1].second, in_memory[i].second);
+    }
+  }
+
+  // a budget of a few rows sorts in runs merged at the end
+  auto merged = SortRows(&schema, false, SIZE_MAX, 1024, spilled);
+  ASSERT_TRUE(spilled);
+  ASSERT_EQ(in_memory, merged);
+
+  // the top rows keep the keys of the full sort, with or without runs
+  for (size_t memory_budget : {static_cast<size_t>(SORT_MEMORY_BUDGET), static_cast<size_t>(1024)}) {
+    auto top = SortRows(&schema, false, 25, memory_budget, spilled);
+    ASSERT_EQ(25u, top.size());
+    for (size_t i = 0; i < top.size(); i++) ASSERT_EQ(in_memory[i].first, top[i].first);
+  }
+
+  // descending order reverses the keys and puts nulls last
+  auto descending = SortRows(&schema, true, SIZE_MAX, 1024, spilled);
+  ASSERT_EQ(1000u, descending.size());
+  ASSERT_EQ("99", descending.front().first);
+  ASSERT_EQ("null", descending.back().first);
+  for (size_t i = 0; i < descending.size(); i++) ASSERT_EQ(in_memory[999 - i].first, descending[i].first);
+}
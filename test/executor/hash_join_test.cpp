@@ -0,0 +1,67 @@
+#include <map>
+#include <vector>
+
+#include "executor/hash_join.h"
+#include "gtest/gtest.h"
+#include "record/field.h"
+#include "record/schema.h"
+
+using Fields = std::vector<Field>;
+
+/**
+ * Join orders (id, customer) with customers (id, name) on the customer id and
+ * count the matches of every order
+ */
+static std::map<int32_t, int> JoinOrders(size_t memory_budget, bool &spilled) {
+  SimpleMemHeap heap;
+  std::vector<Column *> customer_columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, true, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 16, 1, true, false)
+  };
+  std::vector<Column *> order_columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("customer", TypeId::kTypeInt, 1, true, false)
+  };
+  Schema customers(customer_columns), orders(order_columns);
+  HashJoin join(&customers, {0}, &orders, {1}, memory_budget);
+  // customers 0..99 once, even customers twice more, and one without an id
+  char name[] = "customer";
+  for (int32_t i = 0; i < 100; i++) {
+    for (int copies = i % 2 == 0 ? 3 : 1; copies > 0; copies--) {
+      Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, name, sizeof(name), true)};
+      join.Build(Row(fields));
+    }
+  }
+  Fields nameless{Field(TypeId::kTypeInt), Field(TypeId::kTypeChar, name, sizeof(name), true)};
+  join.Build(Row(nameless));
+  // orders 0..299 reference customer id % 150, order 300 has no customer
+  std::map<int32_t, int> matches;
+  auto emit = [&](const Row &customer, const Row &order) {
+    ASSERT_EQ(CmpBool::kTrue, customer.GetField(0)->CompareEquals(*order.GetField(1)));
+    matches[order.GetField(0)->value_.integer_]++;
+  };
+  for (int32_t i = 0; i <= 300; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), i < 300 ? Field(TypeId::kTypeInt, i % 150) : Field(TypeId::kTypeInt)};
+    join.Probe(Row(fields), emit);
+  }
+  join.Finish(emit);
+  spilled = join.IsSpilled();
+  return matches;
+}
+
+TEST(HashJoinTest, InMemoryAndSpilledTest) {
+  bool spilled;
+  auto in_memory = JoinOrders(HASH_JOIN_MEMORY_BUDGET, spilled);
+  ASSERT_FALSE(spilled);
+  // orders of customers 100..149 and the order without a customer find nothing
+  ASSERT_EQ(200u, in_memory.size());
+  for (auto &entry : in_memory) {
+    int32_t customer = entry.first % 150;
+    ASSERT_LT(customer, 100);
+    ASSERT_EQ(customer % 2 == 0 ? 3 : 1, entry.second);
+  }
+  // a budget of a few rows moves the join to the partitions
+  auto partitioned = JoinOrders(1024, spilled);
+  ASSERT_TRUE(spilled);
+  ASSERT_EQ(in_memory, partitioned);
+}
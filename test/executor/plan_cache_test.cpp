@@ -0,0 +1,87 @@
+#include <string>
+
+#include "executor/plan_cache.h"
+#include "gtest/gtest.h"
+
+extern "C" {
+int yyparse(void);
+#include "parser/minisql_lex.h"
+#include "parser/parser.h"
+}
+
+/**
+ * Parse sql and cache its tree, return whether it was cached
+ */
+static bool ParseAndInsert(PlanCache &cache, const char *sql) {
+  PlanCache::Statement statement;
+  PlanCache::Normalize(sql, statement);
+  YY_BUFFER_STATE bp = yy_scan_string(sql);
+  yy_switch_to_buffer(bp);
+  MinisqlParserInit();
+  yyparse();
+  EXPECT_FALSE(MinisqlParserGetError());
+  cache.Insert(statement, MinisqlGetParserRootNode());
+  MinisqlParserFinish();
+  yy_delete_buffer(bp);
+  yylex_destroy();
+  return cache.Lookup(statement) != nullptr;
+}
+
+static pSyntaxNode Lookup(PlanCache &cache, const char *sql) {
+  PlanCache::Statement statement;
+  PlanCache::Normalize(sql, statement);
+  return cache.Lookup(statement);
+}
+
+TEST(PlanCacheTest, NormalizeTest) {
+  PlanCache::Statement statement;
+  PlanCache::Normalize("insert  into t1 values(-1, \"a \\\" b\",\n 2.5, null);", statement);
+  ASSERT_EQ("insert into t1 values(?,?,?,null);", statement.shape_);
+  ASSERT_EQ(3u, statement.literals_.size());
+  ASSERT_EQ(kNodeNumber, statement.literals_[0].first);
+  ASSERT_EQ("-1", statement.literals_[0].second);
+  ASSERT_EQ(kNodeString, statement.literals_[1].first);
+  ASSERT_EQ("a \\\" b", statement.literals_[1].second);
+  ASSERT_EQ("2.5", statement.literals_[2].second);
+  // blanks are kept where they separate tokens
+  PlanCache::Normalize("select * from t where a-1 < = .5 and b <>2;", statement);
+  ASSERT_EQ("select*from t where a?< =?and b<>?;", statement.shape_);
+}
+
+TEST(PlanCacheTest, BindAndEvictTest) {
+  PlanCache cache(2);
+  ASSERT_EQ(nullptr, Lookup(cache, "insert into t values(1, \"a\", 2.5);"));
+  ASSERT_TRUE(ParseAndInsert(cache, "insert into t values(1, \"a\", 2.5);"));
+  pSyntaxNode ast = Lookup(cache, "insert into t values(7,\"bc\", -3);");
+  ASSERT_NE(nullptr, ast);
+  ASSERT_EQ(kNodeInsert, ast->type_);
+  pSyntaxNode value = ast->child_->next_->child_;
+  ASSERT_STREQ("7", value->val_);
+  ASSERT_STREQ("bc", value->next_->val_);
+  ASSERT_STREQ("-3", value->next_->next_->val_);
+  ASSERT_EQ(2u, cache.GetHitCount());
+  // other shapes miss, statements other than dml are not cached
+  ASSERT_EQ(nullptr, Lookup(cache, "insert into t values(1, null, 2.5);"));
+  ASSERT_FALSE(ParseAndInsert(cache, "create table u(id int, primary key(id));"));
+
+  // the least recently used shape goes first
+  ASSERT_TRUE(ParseAndInsert(cache, "select * from t where id = 1;"));
+  ASSERT_NE(nullptr, Lookup(cache, "insert into t values(2, \"b\", 1);"));
+  ASSERT_TRUE(ParseAndInsert(cache, "delete from t where id = 1;"));
+  ASSERT_EQ(2u, cache.GetSize());
+  ASSERT_EQ(nullptr, Lookup(cache, "select * from t where id = 2;"));
+  ASSERT_NE(nullptr, Lookup(cache, "insert into t values(3, \"c\", 1);"));
+  ASSERT_NE(nullptr, Lookup(cache, "delete from t where id = 3;"));
+}
+
+TEST(PlanCacheTest, LiteralKindTest) {
+  PlanCache cache(2);
+  ASSERT_TRUE(ParseAndInsert(cache, "select * from t where name = \"a\" and id = 1;"));
+  // the same shape with a number where the tree has a string, or the reverse, misses
+  ASSERT_EQ(nullptr, Lookup(cache, "select * from t where name = 2 and id = 1;"));
+  ASSERT_EQ(nullptr, Lookup(cache, "select * from t where name = \"b\" and id = \"1\";"));
+  ASSERT_EQ(1u, cache.GetHitCount());
+  pSyntaxNode ast = Lookup(cache, "select * from t where name = \"b\" and id = 2;");
+  ASSERT_NE(nullptr, ast);
+  ASSERT_EQ(2u, cache.GetHitCount());
+}
@@ -0,0 +1,196 @@
+#include <cstdio>
+#include <string>
+
+#include "executor/execute_engine.h"
+#include "gtest/gtest.h"
+
+TEST(PreparedStatementTest, BindExecuteAndCursorTest) {
+  ExecuteEngine engine;
+  ExecuteContext context;
+  engine.ExecuteSql("create database prepared_statement_test;", &context);
+  ASSERT_EQ(DB_SUCCESS, engine.ExecuteSql("use prepared_statement_test;", &context));
+  ASSERT_EQ(DB_SUCCESS, engine.ExecuteSql("create table t(id int, name char(16), score float, primary key(id));",
+                                          &context));
+  std::string message;
+  auto insert = engine.Prepare("insert into t values(?, ?, ?);", message);
+  ASSERT_NE(nullptr, insert);
+  ASSERT_EQ(3u, insert->GetParameterCount());
+  ASSERT_EQ(DB_FAILED, insert->Execute()->GetStatus());
+  for (int32_t i = 0; i < 100; i++) {
+    insert->Bind(0, i);
+    // quotes need no escaping in bound strings
+    insert->Bind(1, "\"name\" " + std::to_string(i));
+    if (i % 10 == 0) {
+      insert->BindNull(2);
+    } else {
+      insert->Bind(2, i + 0.25f);
+    }
+    ASSERT_EQ(DB_SUCCESS, insert->Execute()->GetStatus());
+  }
+  ASSERT_EQ(DB_FAILED, insert->Bind(3, 0));
+
+  auto select = engine.Prepare("select name, score, id from t where id >= ? and id < ?;", message);
+  ASSERT_NE(nullptr, select);
+  select->Bind(0, 10);
+  select->Bind(1, 20);
+  auto cursor = select->Execute();
+  ASSERT_EQ(DB_SUCCESS, cursor->GetStatus());
+  ASSERT_EQ(3u, cursor->GetColumnCount());
+  ASSERT_EQ("score", cursor->GetColumnName(1));
+  ASSERT_EQ(10u, cursor->GetRowCount());
+  int32_t expected = 10;
+  while (cursor->Next()) {
+    ASSERT_EQ(expected, cursor->GetField(2).value_.integer_);
+    ASSERT_EQ("\"name\" " + std::to_string(expected), std::string(cursor->GetField(0).GetData()));
+    ASSERT_EQ(expected == 10, cursor->GetField(1).IsNull());
+    if (expected != 10) {
+      ASSERT_EQ(expected + 0.25f, cursor->GetField(1).value_.float_);
+    }
+    expected++;
+  }
+  ASSERT_EQ(20, expected);
+  // rebinding one parameter keeps the other
+  select->Bind(0, 95);
+  ASSERT_EQ(0u, select->Execute()->GetRowCount());
+
+  ASSERT_EQ(nullptr, engine.Prepare("select from t;", message));
+  ASSERT_FALSE(message.empty());
+  // parameters need a prepared statement
+  ExecuteContext shell;
+  ASSERT_EQ(DB_FAILED, engine.ExecuteSql("select * from t where id = ?;", &shell));
+  engine.ExecuteSql("drop database prepared_statement_test;", &context);
+  remove("prepared_statement_test");
+}
+
+TEST(PreparedStatementTest, MultiRowInsertTest) {
+  ExecuteEngine engine;
+  ExecuteContext context;
+  engine.ExecuteSql("create database multi_row_insert_test;", &context);
+  ASSERT_EQ(DB_SUCCESS, engine.ExecuteSql("use multi_row_insert_test;", &context));
+  ASSERT_EQ(DB_SUCCESS, engine.ExecuteSql("create table t(id int, name char(16), primary key(id));", &context));
+  ASSERT_EQ(DB_SUCCESS, engine.ExecuteSql("create index name_index on t(name);", &context));
+  // batches of 4 rows, inserted in descending id order
+  std::string message;
+  auto insert = engine.Prepare("insert into t values(?, ?), (?, ?), (?, ?), (?, ?);", message);
+  ASSERT_NE(nullptr, insert);
+  ASSERT_EQ(8u, insert->GetParameterCount());
+  for (int32_t batch = 249; batch >= 0; batch--) {
+    for (int32_t i = 0; i < 4; i++) {
+      insert->Bind(2 * i, batch * 4 + i);
+      insert->Bind(2 * i + 1, "name " + std::to_string(batch * 4 + i));
+    }
+    ASSERT_EQ(DB_SUCCESS, insert->Execute()->GetStatus());
+  }
+  // a duplicate inside the batch or with the table leaves the table as it was
+  ASSERT_EQ(DB_FAILED, engine.ExecuteSql("insert into t values(1000, \"a\"), (1001, \"b\"), (1000, \"c\");", &context));
+  ASSERT_EQ(DB_FAILED, engine.ExecuteSql("insert into t values(1000, \"a\"), (1001, \"name 7\");", &context));
+  ASSERT_EQ(DB_FAILED, engine.ExecuteSql("insert into t values(1000, \"a\"), (1001);", &context));
+  ASSERT_EQ(DB_SUCCESS, engine.ExecuteSql("insert into t values(1000, \"a\"), (1001, \"b\");", &context));
+
+  auto select = engine.Prepare("select id from t where id >= ?;", message);
+  select->Bind(0, 0);
+  auto cursor = select->Execute();
+  ASSERT_EQ(1002u, cursor->GetRowCount());
+  auto lookup = engine.Prepare("select id from t where name = ?;", message);
+  for (int32_t id : {0, 517, 999, 1001}) {
+    lookup->Bind(0, id == 1001 ? "b" : "name " + std::to_string(id));
+    cursor = lookup->Execute();
+    ASSERT_TRUE(cursor->Next());
+    ASSERT_EQ(id, cursor->GetField(0).value_.integer_);
+  }
+  lookup->Bind(0, "c");
+  ASSERT_EQ(0u, lookup->Execute()->GetRowCount());
+  engine.ExecuteSql("drop database multi_row_insert_test;", &context);
+  remove("multi_row_insert_test");
+}
+
+TEST(PreparedStatementTest, MultiRowInsertAfterReopenTest) {
+  const char *csv_name = "multi_row_reopen_test.csv";
+  std::string message;
+  auto engine = new ExecuteEngine();
+  ExecuteContext context;
+  engine->ExecuteSql("create database multi_row_reopen_test;", &context);
+  ASSERT_EQ(DB_SUCCESS, engine->ExecuteSql("use multi_row_reopen_test;", &context));
+  ASSERT_EQ(DB_SUCCESS, engine->ExecuteSql("create table t(id int, name char(32), primary key(id));", &context));
+  // one statement fills many pages
+  std::string sql = "insert into t values";
+  for (int32_t i = 0; i < 3000; i++) {
+    sql += (i == 0 ? "(" : ", (") + std::to_string(i) + ", \"name of row " + std::to_string(i) + "\")";
+  }
+  ASSERT_EQ(DB_SUCCESS, engine->ExecuteSql((sql + ";").c_str(), &context));
+  delete engine;
+  // a reopened table only knows its first page, multi-row INSERT and COPY append after the last one
+  engine = new ExecuteEngine();
+  ASSERT_EQ(DB_SUCCESS, engine->ExecuteSql("use multi_row_reopen_test;", &context));
+  ASSERT_EQ(DB_SUCCESS, engine->ExecuteSql("insert into t values(3000, \"a\"), (3001, \"b\");", &context));
+  FILE *csv = fopen(csv_name, "w");
+  fputs("3002,c\n3003,d\n", csv);
+  fclose(csv);
+  ASSERT_EQ(DB_SUCCESS, engine->ExecuteSql((std::string("copy t from \"") + csv_name + "\";").c_str(), &context));
+  auto select = engine->Prepare("select id from t where name <> ?;", message);
+  select->Bind(0, "");
+  ASSERT_EQ(3004u, select->Execute()->GetRowCount());
+  auto lookup = engine->Prepare("select id from t where id = ?;", message);
+  for (int32_t id : {0, 1500, 2999, 3001, 3003}) {
+    lookup->Bind(0, id);
+    auto cursor = lookup->Execute();
+    ASSERT_TRUE(cursor->Next());
+    ASSERT_EQ(id, cursor->GetField(0).value_.integer_);
+  }
+  engine->ExecuteSql("drop database multi_row_reopen_test;", &context);
+  delete engine;
+  remove("multi_row_reopen_test");
+  remove(csv_name);
+}
+
+TEST(PreparedStatementTest, UpdateTooLargeRowTest) {
+  ExecuteEngine engine;
+  ExecuteContext context;
+  std::string message;
+  std::string long_value(1500, 'a');
+  engine.ExecuteSql("create database update_large_row_test;", &context);
+  ASSERT_EQ(DB_SUCCESS, engine.ExecuteSql("use update_large_row_test;", &context));
+  ASSERT_EQ(DB_SUCCESS, engine.ExecuteSql("create table t(id int, a char(2000), b char(2000), c char(2000), "
+                                          "primary key(id));", &context));
+  ASSERT_EQ(DB_SUCCESS, engine.ExecuteSql("insert into t values(1, \"x\", \"y\", \"z\"), (2, \"x\", \"y\", \"z\");",
+                                          &context));
+  ASSERT_EQ(DB_SUCCESS, engine.ExecuteSql(("insert into t values(3, \"x\", \"" + long_value + "\", \"" + long_value +
+                                           "\");").c_str(), &context));
+  // the last row outgrows a page, so none of the rows changes
+  ASSERT_EQ(DB_FAILED, engine.ExecuteSql(("update t set a = \"" + long_value + "\";").c_str(), &context));
+  auto select = engine.Prepare("select id from t where a = ?;", message);
+  select->Bind(0, "x");
+  ASSERT_EQ(3u, select->Execute()->GetRowCount());
+  ASSERT_EQ(DB_SUCCESS, engine.ExecuteSql("update t set a = \"w\";", &context));
+  select->Bind(0, "w");
+  ASSERT_EQ(3u, select->Execute()->GetRowCount());
+  engine.ExecuteSql("drop database update_large_row_test;", &context);
+  remove("update_large_row_test");
+}
+
+TEST(PreparedStatementTest, UpdateIndexFailureTest) {
+  ExecuteEngine engine;
+  ExecuteContext context;
+  std::string message;
+  engine.ExecuteSql("create database update_index_failure_test;", &context);
+  ASSERT_EQ(DB_SUCCESS, engine.ExecuteSql("use update_index_failure_test;", &context));
+  ASSERT_EQ(DB_SUCCESS, engine.ExecuteSql("create table t(id int, v int, primary key(id));", &context));
+  ASSERT_EQ(DB_SUCCESS, engine.ExecuteSql("create index hv on t(v) using hash;", &context));
+  ASSERT_EQ(DB_SUCCESS, engine.ExecuteSql("insert into t values(1, 10), (2, 20), (3, 30);", &context));
+  // a hash index only finds the clash of the two new keys once the first row is updated
+  ASSERT_EQ(DB_FAILED, engine.ExecuteSql("update t set v = 5 where id < 3;", &context));
+  auto select = engine.Prepare("select id from t where v = ?;", message);
+  for (int32_t id = 1; id <= 3; id++) {
+    select->Bind(0, id * 10);
+    auto cursor = select->Execute();
+    ASSERT_TRUE(cursor->Next());
+    ASSERT_EQ(id, cursor->GetField(0).value_.integer_);
+  }
+  select->Bind(0, 5);
+  ASSERT_EQ(0u, select->Execute()->GetRowCount());
+  auto scan = engine.Prepare("select id from t where id > ? and v < 15;", message);
+  scan->Bind(0, 0);
+  ASSERT_EQ(1u, scan->Execute()->GetRowCount());
+  engine.ExecuteSql("drop database update_index_failure_test;", &context);
+  remove("update_index_failure_test");
+}
@@ -1,8 +1,10 @@
+#include <set>
 #include <string>
 
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "index/b_plus_tree_index.h"
+#include "index/bloom_filter.h"
 #include "index/generic_key.h"
 
 static const std::string db_name = "bp_tree_index_test.db";
@@ -34,6 +36,46 @@ TEST(BPlusTreeTests, BPlusTreeIndexGenericKeyTest) {
   ASSERT_EQ(0, comparator(k1, k2));
 }
 
+TEST(BPlusTreeTests, GenericKeyOrderTest) {
+  using INDEX_KEY_TYPE = GenericKey<32>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, true, false),
+          ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 1, true, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 16, 2, true, false)
+  };
+  const TableSchema key_schema(columns);
+  INDEX_COMPARATOR_TYPE comparator(const_cast<TableSchema *>(&key_schema));
+  // keys listed in ascending order, nulls first
+  std::vector<std::vector<Field>> sorted_fields;
+  for (int id : {-100000, -1, 0, 1, 256, 100000}) {
+    for (float account : {-12.5f, -0.25f, 0.0f, 0.25f, 3.0f}) {
+      for (const char *name : {"", "a", "ab", "b"}) {
+        sorted_fields.push_back({Field(TypeId::kTypeInt, id), Field(TypeId::kTypeFloat, account),
+                                 Field(TypeId::kTypeChar, const_cast<char *>(name), strlen(name), true)});
+      }
+    }
+  }
+  sorted_fields.insert(sorted_fields.begin(), {Field(TypeId::kTypeInt), Field(TypeId::kTypeFloat),
+                                               Field(TypeId::kTypeChar)});
+  std::vector<INDEX_KEY_TYPE> keys(sorted_fields.size());
+  for (size_t i = 0; i < sorted_fields.size(); i++) {
+    Row row(sorted_fields[i]);
+    keys[i].SerializeFromKey(row, const_cast<TableSchema *>(&key_schema));
+    if (i > 0) {
+      ASSERT_LT(comparator(keys[i - 1], keys[i]), 0);
+    }
+  }
+  // round trip
+  Row row(INVALID_ROWID);
+  keys.back().DeserializeToKey(row, const_cast<TableSchema *>(&key_schema));
+  ASSERT_EQ(3, row.GetFieldCount());
+  for (uint32_t i = 0; i < row.GetFieldCount(); i++) {
+    ASSERT_EQ(CmpBool::kTrue, row.GetField(i)->CompareEquals(sorted_fields.back()[i]));
+  }
+}
+
 TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
   using INDEX_KEY_TYPE = GenericKey<32>;
   using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
@@ -78,4 +120,386 @@ TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
     ASSERT_EQ(i, (*iter).second.GetSlotNum());
     i++;
   }
-}
\ No newline at end of file
+}
+TEST(BPlusTreeTests, BloomFilterTest) {
+  BloomFilter filter;
+  const int n = 10000;
+  for (int i = 0; i < n; i++) {
+    filter.Add(reinterpret_cast<const char *>(&i), sizeof(int));
+  }
+  ASSERT_TRUE(filter.NeedsRebuild());
+  filter.Reset(n);
+  for (int i = 0; i < n; i++) {
+    filter.Add(reinterpret_cast<const char *>(&i), sizeof(int));
+  }
+  ASSERT_FALSE(filter.NeedsRebuild());
+  int false_positives = 0;
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(filter.MayContain(reinterpret_cast<const char *>(&i), sizeof(int)));
+    int absent = n + i;
+    false_positives += filter.MayContain(reinterpret_cast<const char *>(&absent), sizeof(int));
+  }
+  // about 1% expected with 10 bits per key
+  ASSERT_LT(false_positives, n / 50);
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexFilterTest) {
+  using INDEX_KEY_TYPE = GenericKey<8>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<8>;
+  using BP_TREE_INDEX = BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false)
+  };
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, {0}, &heap);
+  auto *index = ALLOC(heap, BP_TREE_INDEX)(0, index_schema, engine.bpm_);
+  const int n = 5000;
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, 2 * i)};
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(row, RowId(1000, i), nullptr));
+  }
+  for (int i = 0; i < 2 * n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    Row row(fields);
+    std::vector<RowId> ret;
+    ASSERT_EQ(i % 2 == 0 ? DB_SUCCESS : DB_KEY_NOT_FOUND, index->ScanKey(row, ret, nullptr));
+  }
+  // removed keys are not found, also after the filter is rebuilt
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, 2 * i)};
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(row, RowId(1000, i), nullptr));
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_KEY_NOT_FOUND, index->ScanKey(row, ret, nullptr));
+  }
+  // a reopened index rebuilds its filter from the tree
+  std::vector<Field> fields{Field(TypeId::kTypeInt, 42)};
+  Row row(fields);
+  ASSERT_EQ(DB_SUCCESS, index->InsertEntry(row, RowId(1000, 42), nullptr));
+  auto *reopened = ALLOC(heap, BP_TREE_INDEX)(0, index_schema, engine.bpm_);
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_SUCCESS, reopened->ScanKey(row, ret, nullptr));
+  ASSERT_EQ(42u, ret[0].GetSlotNum());
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexIncludeTest) {
+  using INDEX_KEY_TYPE = GenericKey<32>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
+  using BP_TREE_INDEX = BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 16, 1, true, false),
+          ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 2, true, false)
+  };
+  const TableSchema table_schema(columns);
+  // unique on name, account only stored
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, {1, 2}, &heap);
+  auto *index = ALLOC(heap, BP_TREE_INDEX)(0, index_schema, engine.bpm_, 1);
+  const std::vector<std::string> names{"a", "ab", "b", "bc", "c"};
+  for (uint32_t i = 0; i < names.size(); i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(names[i].c_str()), names[i].size() + 1, true),
+                              Field(TypeId::kTypeFloat, 1.5f * i)};
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(row, RowId(1000, i), nullptr));
+  }
+  // the include column takes no part in uniqueness
+  std::vector<Field> duplicate_fields{Field(TypeId::kTypeChar, const_cast<char *>("ab"), 3, true),
+                                      Field(TypeId::kTypeFloat, 100.0f)};
+  Row duplicate(duplicate_fields);
+  ASSERT_EQ(DB_KEY_ALREADY_EXIST, index->InsertEntry(duplicate, RowId(1000, 99), nullptr));
+  for (uint32_t i = 0; i < names.size(); i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(names[i].c_str()), names[i].size() + 1, true)};
+    Row key(fields);
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(key, ret, nullptr));
+    ASSERT_EQ(1u, ret.size());
+    ASSERT_EQ(i, ret[0].GetSlotNum());
+    // index-only read of the stored columns
+    std::vector<Row> entries;
+    ASSERT_EQ(DB_SUCCESS, index->ScanEntries(key, IndexRange(), entries, nullptr));
+    ASSERT_EQ(1u, entries.size());
+    ASSERT_EQ(i, entries[0].GetRowId().GetSlotNum());
+    // decoded char values do not count a terminator
+    Field name(TypeId::kTypeChar, const_cast<char *>(names[i].c_str()), names[i].size(), true);
+    ASSERT_EQ(CmpBool::kTrue, entries[0].GetField(0)->CompareEquals(name));
+    ASSERT_EQ(CmpBool::kTrue, entries[0].GetField(1)->CompareEquals(Field(TypeId::kTypeFloat, 1.5f * i)));
+  }
+  std::vector<Field> absent_fields{Field(TypeId::kTypeChar, const_cast<char *>("abc"), 4, true)};
+  Row absent(absent_fields);
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index->ScanKey(absent, ret, nullptr));
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexRangeTest) {
+  using INDEX_KEY_TYPE = GenericKey<32>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
+  using BP_TREE_INDEX = BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("account", TypeId::kTypeInt, 1, false, false)
+  };
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, {0, 1}, &heap);
+  auto *index = ALLOC(heap, BP_TREE_INDEX)(0, index_schema, engine.bpm_);
+  // (id, account) for id in [0, 3), account in [0, 100)
+  for (int id = 0; id < 3; id++) {
+    for (int account = 0; account < 100; account++) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, id), Field(TypeId::kTypeInt, account)};
+      Row row(fields);
+      ASSERT_EQ(DB_SUCCESS, index->InsertEntry(row, RowId(id, account), nullptr));
+    }
+  }
+  std::vector<Field> prefix_fields{Field(TypeId::kTypeInt, 1)};
+  Row prefix(prefix_fields);
+  // prefix only
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(prefix, ret, nullptr));
+  ASSERT_EQ(100u, ret.size());
+  for (uint32_t i = 0; i < ret.size(); i++) {
+    ASSERT_EQ(1, ret[i].GetPageId());
+    ASSERT_EQ(i, ret[i].GetSlotNum());
+  }
+  // prefix and a range on the next column
+  Field low(TypeId::kTypeInt, 10), high(TypeId::kTypeInt, 20);
+  IndexRange range;
+  range.low_ = &low;
+  range.high_ = &high;
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanRange(prefix, range, ret, nullptr));
+  ASSERT_EQ(11u, ret.size());
+  ASSERT_EQ(10u, ret.front().GetSlotNum());
+  ASSERT_EQ(20u, ret.back().GetSlotNum());
+  range.low_inclusive_ = range.high_inclusive_ = false;
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanRange(prefix, range, ret, nullptr));
+  ASSERT_EQ(9u, ret.size());
+  ASSERT_EQ(11u, ret.front().GetSlotNum());
+  ASSERT_EQ(19u, ret.back().GetSlotNum());
+  // open ends stay within the prefix
+  range = IndexRange();
+  range.high_ = &high;
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanRange(prefix, range, ret, nullptr));
+  ASSERT_EQ(21u, ret.size());
+  ASSERT_EQ(1, ret.front().GetPageId());
+  ASSERT_EQ(0u, ret.front().GetSlotNum());
+  range = IndexRange();
+  range.low_ = &low;
+  range.low_inclusive_ = false;
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanRange(prefix, range, ret, nullptr));
+  ASSERT_EQ(89u, ret.size());
+  ASSERT_EQ(1, ret.back().GetPageId());
+  // range on the first column without a prefix
+  std::vector<Field> no_fields;
+  Row empty(no_fields);
+  Field first(TypeId::kTypeInt, 1);
+  range = IndexRange();
+  range.low_ = &first;
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanRange(empty, range, ret, nullptr));
+  ASSERT_EQ(200u, ret.size());
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexScanKeysTest) {
+  using INDEX_KEY_TYPE = GenericKey<32>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
+  using BP_TREE_INDEX = BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("account", TypeId::kTypeInt, 1, false, false)
+  };
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, {0, 1}, &heap);
+  auto *index = ALLOC(heap, BP_TREE_INDEX)(0, index_schema, engine.bpm_);
+  // even ids only, spread over many leaves
+  for (int id = 0; id < 4000; id += 2) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, id), Field(TypeId::kTypeInt, id % 7)};
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(row, RowId(id, 0), nullptr));
+  }
+  // unsorted keys with duplicates and misses, full keys and id prefixes
+  std::vector<Row> keys;
+  for (int i = 0; i < 600; i++) {
+    int id = (i * 7919) % 4100;
+    std::vector<Field> fields{Field(TypeId::kTypeInt, id)};
+    if (i % 3 == 0) fields.emplace_back(TypeId::kTypeInt, id % 7);
+    keys.emplace_back(fields);
+  }
+  keys.push_back(keys.front());
+  std::vector<std::vector<RowId>> results;
+  ASSERT_EQ(DB_SUCCESS, index->ScanKeys(keys, results, nullptr));
+  ASSERT_EQ(keys.size(), results.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    std::vector<RowId> expected;
+    index->ScanKey(keys[i], expected, nullptr);
+    ASSERT_EQ(expected, results[i]);
+    int id = keys[i].GetField(0)->value_.integer_;
+    ASSERT_EQ(id % 2 == 0 && id < 4000 ? 1u : 0u, results[i].size());
+  }
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexInsertEntriesTest) {
+  using INDEX_KEY_TYPE = GenericKey<32>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
+  using BP_TREE_INDEX = BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 12, 1, false, false)
+  };
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, {0, 1}, &heap);
+  auto *index = ALLOC(heap, BP_TREE_INDEX)(0, index_schema, engine.bpm_);
+  auto make_entries = [](int begin, int end, int step, std::vector<Row> &keys, std::vector<RowId> &row_ids) {
+    keys.clear();
+    row_ids.clear();
+    // shuffled, the index sorts them
+    for (int i = begin; i < end; i += step) {
+      int id = begin + (i - begin) * 7919 % (end - begin);
+      std::string name = "name" + std::to_string(id);
+      std::vector<Field> fields{Field(TypeId::kTypeInt, id),
+                                Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size() + 1, true)};
+      keys.emplace_back(fields);
+      row_ids.emplace_back(id, 0);
+    }
+  };
+  // an empty tree is built bottom-up
+  std::vector<Row> keys;
+  std::vector<RowId> row_ids;
+  make_entries(0, 20000, 2, keys, row_ids);
+  ASSERT_EQ(DB_SUCCESS, index->InsertEntries(keys, row_ids, nullptr));
+  // a filled one takes the entries one by one
+  make_entries(1, 20001, 2, keys, row_ids);
+  ASSERT_EQ(DB_SUCCESS, index->InsertEntries(keys, row_ids, nullptr));
+  int expected = 0;
+  for (auto iter = index->GetBeginIterator(); iter != index->GetEndIterator(); ++iter, expected++) {
+    ASSERT_EQ(RowId(expected, 0), (*iter).second);
+  }
+  ASSERT_EQ(20000, expected);
+  for (auto &key : keys) {
+    std::vector<RowId> result;
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(key, result, nullptr));
+    ASSERT_EQ(1u, result.size());
+  }
+  // duplicates among the entries or with the tree leave the index alone
+  make_entries(30000, 30010, 1, keys, row_ids);
+  keys.push_back(keys.front());
+  row_ids.push_back(row_ids.front());
+  ASSERT_EQ(DB_KEY_ALREADY_EXIST, index->InsertEntries(keys, row_ids, nullptr));
+  make_entries(19990, 20010, 1, keys, row_ids);
+  ASSERT_EQ(DB_KEY_ALREADY_EXIST, index->InsertEntries(keys, row_ids, nullptr));
+  for (auto &key : keys) {
+    std::vector<RowId> result;
+    ASSERT_EQ(key.GetField(0)->value_.integer_ < 20000 ? DB_SUCCESS : DB_KEY_NOT_FOUND,
+              index->ScanKey(key, result, nullptr));
+  }
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexReserveEntryTest) {
+  using INDEX_KEY_TYPE = GenericKey<32>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
+  using BP_TREE_INDEX = BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 16, 1, true, false)
+  };
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, {0}, &heap);
+  auto *index = ALLOC(heap, BP_TREE_INDEX)(0, index_schema, engine.bpm_);
+  auto make_key = [](int32_t id) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, id)};
+    return Row(fields);
+  };
+  // keys reserved while others split the leaves are still completed in place
+  const int32_t n = 5000;
+  std::vector<IndexReservation> reservations(n);
+  for (int32_t i = 0; i < n; i++) {
+    int32_t id = i * 7 % n;
+    ASSERT_EQ(DB_SUCCESS, index->ReserveEntry(make_key(id), reservations[id], nullptr));
+    ASSERT_NE(INVALID_PAGE_ID, reservations[id].leaf_page_id_);
+    ASSERT_EQ(DB_KEY_ALREADY_EXIST, index->ReserveEntry(make_key(id), reservations[id], nullptr));
+    ASSERT_EQ(DB_KEY_ALREADY_EXIST, index->InsertEntry(make_key(id), RowId(0, id), nullptr));
+  }
+  for (int32_t id = 0; id < n; id++) {
+    if (id % 10 == 0) {
+      index->CancelEntry(make_key(id), reservations[id], nullptr);
+    } else {
+      ASSERT_EQ(DB_SUCCESS, index->CompleteEntry(make_key(id), RowId(id, 0), reservations[id], nullptr));
+    }
+  }
+  for (int32_t id = 0; id < n; id++) {
+    std::vector<RowId> ret;
+    if (id % 10 == 0) {
+      ASSERT_EQ(DB_KEY_NOT_FOUND, index->ScanKey(make_key(id), ret, nullptr));
+      ASSERT_EQ(DB_SUCCESS, index->InsertEntry(make_key(id), RowId(id, 0), nullptr));
+      continue;
+    }
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(make_key(id), ret, nullptr));
+    ASSERT_EQ(1u, ret.size());
+    ASSERT_EQ(id, ret[0].GetPageId());
+  }
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexRepointEntriesTest) {
+  using INDEX_KEY_TYPE = GenericKey<32>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
+  using BP_TREE_INDEX = BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 16, 1, true, false)
+  };
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, {0}, &heap);
+  auto *index = ALLOC(heap, BP_TREE_INDEX)(0, index_schema, engine.bpm_);
+  auto meta_page = reinterpret_cast<DiskFileMetaPage *>(engine.disk_mgr_->GetMetaData());
+  const int32_t n = 20000;
+  std::vector<Row> keys;
+  std::vector<RowId> old_row_ids, row_ids;
+  for (int32_t i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    keys.emplace_back(fields);
+    old_row_ids.emplace_back(i, 0);
+  }
+  ASSERT_EQ(DB_SUCCESS, index->InsertEntries(keys, old_row_ids, nullptr));
+  uint32_t allocated = meta_page->GetAllocatedPages();
+  // every third entry moves, shuffled, and the tree keeps its pages
+  std::vector<Row> moved_keys;
+  std::vector<RowId> moved_old_row_ids;
+  for (int32_t i = 0; i < n; i += 3) {
+    int32_t id = i * 7919 % n;
+    moved_keys.push_back(keys[id]);
+    moved_old_row_ids.push_back(old_row_ids[id]);
+    row_ids.emplace_back(id, 1);
+  }
+  ASSERT_EQ(DB_SUCCESS, index->RepointEntries(moved_keys, moved_old_row_ids, row_ids, nullptr));
+  ASSERT_EQ(allocated, meta_page->GetAllocatedPages());
+  std::set<int32_t> moved;
+  for (auto &row_id : row_ids) moved.insert(row_id.GetPageId());
+  for (int32_t i = 0; i < n; i++) {
+    std::vector<RowId> result;
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(keys[i], result, nullptr));
+    ASSERT_EQ(RowId(i, moved.count(i) ? 1 : 0), result[0]);
+  }
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
@@ -2,6 +2,7 @@
 #include "gtest/gtest.h"
 #include "index/b_plus_tree.h"
 #include "index/basic_comparator.h"
+#include "index/generic_key.h"
 #include "utils/tree_file_mgr.h"
 #include "utils/utils.h"
 
@@ -48,8 +49,10 @@ TEST(BPlusTreeTests, SampleTest) {
   ASSERT_TRUE(tree.Check());
   // Delete half keys
   for (int i = 0; i < n / 2; i++) {
-    tree.Remove(delete_seq[i]);
+    ASSERT_TRUE(tree.Remove(delete_seq[i]));
   }
+  // keys already gone are not removed again
+  ASSERT_FALSE(tree.Remove(delete_seq[0]));
   tree.PrintTree(mgr[1]);
   // Check valid
   ans.clear();
@@ -60,4 +63,208 @@ TEST(BPlusTreeTests, SampleTest) {
     ASSERT_TRUE(tree.GetValue(delete_seq[i], ans));
     ASSERT_EQ(kv_map[delete_seq[i]], ans[ans.size() - 1]);
   }
-}
\ No newline at end of file
+}
+
+TEST(BPlusTreeTests, VariableLengthKeyTest) {
+  using KeyType = GenericKey<128>;
+  using ComparatorType = GenericComparator<128>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 100, 0, false, false)
+  };
+  const TableSchema table_schema(columns);
+  auto *key_schema = Schema::ShallowCopySchema(&table_schema, {0}, &heap);
+  ComparatorType comparator(key_schema);
+  BPlusTree<KeyType, RowId, ComparatorType> tree(0, engine.bpm_, comparator);
+  auto make_key = [&](const std::string &name) {
+    std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    KeyType key;
+    key.SerializeFromKey(row, key_schema);
+    return key;
+  };
+  // Short and long keys mixed, far fewer bytes than the padded key class
+  const int n = 3000;
+  std::map<std::string, RowId> kv_map;
+  std::vector<std::string> names;
+  for (int i = 0; i < n; i++) {
+    std::string name(1 + RandomUtils::RandomInt(0, 60), 'a' + i % 26);
+    name += std::to_string(i);
+    names.push_back(name);
+    kv_map[name] = RowId(i, i);
+  }
+  ShuffleArray(names);
+  for (auto &name : names) {
+    ASSERT_TRUE(tree.Insert(make_key(name), kv_map[name]));
+  }
+  ASSERT_FALSE(tree.Insert(make_key(names[0]), RowId(0, 0)));
+  ASSERT_TRUE(tree.Check());
+  std::vector<RowId> ans;
+  for (auto &name : names) {
+    ans.clear();
+    ASSERT_TRUE(tree.GetValue(make_key(name), ans));
+    ASSERT_EQ(kv_map[name].Get(), ans[0].Get());
+  }
+  // Remove two thirds of the keys, trees must shrink back correctly
+  for (int i = 0; i < n * 2 / 3; i++) {
+    tree.Remove(make_key(names[i]));
+    kv_map.erase(names[i]);
+  }
+  ASSERT_TRUE(tree.Check());
+  for (int i = 0; i < n; i++) {
+    ans.clear();
+    ASSERT_EQ(i >= n * 2 / 3, tree.GetValue(make_key(names[i]), ans));
+  }
+  // Iterator yields the remaining keys in order
+  auto expect = kv_map.begin();
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter, ++expect) {
+    ASSERT_TRUE(expect != kv_map.end());
+    ASSERT_EQ(expect->second.Get(), (*iter).second.Get());
+  }
+  ASSERT_TRUE(expect == kv_map.end());
+  ASSERT_TRUE(tree.Check());
+  // Drain the tree
+  for (int i = n * 2 / 3; i < n; i++) {
+    tree.Remove(make_key(names[i]));
+  }
+  ASSERT_TRUE(tree.IsEmpty());
+  ASSERT_TRUE(tree.Check());
+}
+
+TEST(BPlusTreeTests, SequentialInsertTest) {
+  DBStorageEngine engine(db_name);
+  BasicComparator<int> comparator;
+  const int max_size = 64;
+  BPlusTree<int, int, BasicComparator<int>> tree(0, engine.bpm_, comparator, max_size, max_size);
+  const int n = 5000;
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(tree.Insert(i, 2 * i));
+  }
+  ASSERT_FALSE(tree.Insert(n - 1, 0));
+  ASSERT_TRUE(tree.Check());
+  // leaves on the left are left nearly full instead of half full
+  int leaf_count = 0;
+  Page *page = tree.FindLeafPage(0, true);
+  while (true) {
+    auto leaf = reinterpret_cast<BPlusTreeLeafPage<int, int, BasicComparator<int>> *>(page->GetData());
+    leaf_count++;
+    page_id_t next_page_id = leaf->GetNextPageId();
+    engine.bpm_->UnpinPage(page->GetPageId(), false);
+    if (next_page_id == INVALID_PAGE_ID) break;
+    page = engine.bpm_->FetchPage(next_page_id);
+  }
+  ASSERT_LT(leaf_count, n / (max_size * 3 / 4));
+  // keys out of order still go through the regular path
+  for (int i = n + 100; i > n; i--) {
+    ASSERT_TRUE(tree.Insert(i, 2 * i));
+  }
+  int expected = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    if (expected == n) expected++;
+    ASSERT_EQ(expected, (*iter).first);
+    ASSERT_EQ(2 * expected, (*iter).second);
+    expected++;
+  }
+  ASSERT_EQ(n + 101, expected);
+  ASSERT_TRUE(tree.Check());
+}
+
+TEST(BPlusTreeTests, InsertSortedTest) {
+  DBStorageEngine engine(db_name);
+  BasicComparator<int> comparator;
+  BPlusTree<int, int, BasicComparator<int>> tree(0, engine.bpm_, comparator, 8, 8);
+  using Items = std::vector<std::pair<int, int>>;
+  // even keys one by one, then the odd ones in sorted runs spreading over many leaves
+  const int n = 2000;
+  vector<int> keys;
+  for (int i = 0; i < n; i += 2) keys.push_back(i);
+  ShuffleArray(keys);
+  for (int key : keys) {
+    ASSERT_TRUE(tree.Insert(key, 2 * key));
+  }
+  for (int run = 0; run < 4; run++) {
+    Items items;
+    for (int i = 1 + 2 * run; i < n; i += 8) items.emplace_back(i, 2 * i);
+    ASSERT_EQ(items.size(), tree.InsertSorted(items));
+    ASSERT_TRUE(tree.Check());
+  }
+  int expected = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ(expected, (*iter).first);
+    ASSERT_EQ(2 * expected, (*iter).second);
+    expected++;
+  }
+  ASSERT_EQ(n, expected);
+  // the run stops at the first key already in the tree
+  ASSERT_EQ(2u, tree.InsertSorted(Items{{n, 0}, {n + 1, 0}, {n + 1, 0}, {n + 3, 0}}));
+  ASSERT_EQ(0u, tree.InsertSorted(Items{{7, 0}}));
+  ASSERT_TRUE(tree.Check());
+}
+
+TEST(BPlusTreeTests, RemoveSortedTest) {
+  DBStorageEngine engine(db_name);
+  BasicComparator<int> comparator;
+  BPlusTree<int, int, BasicComparator<int>> tree(0, engine.bpm_, comparator, 8, 8);
+  const int n = 2000;
+  vector<int> keys;
+  for (int i = 0; i < n; i++) keys.push_back(i);
+  ShuffleArray(keys);
+  for (int key : keys) {
+    ASSERT_TRUE(tree.Insert(key, 2 * key));
+  }
+  // two of every three keys, then a dense range, then keys not in the tree
+  vector<int> removed;
+  for (int i = 0; i < n; i++) {
+    if (i % 3 != 0) removed.push_back(i);
+  }
+  ASSERT_EQ(removed.size(), tree.RemoveSorted(removed));
+  ASSERT_TRUE(tree.Check());
+  removed.clear();
+  for (int i = 300; i < 1500; i += 3) removed.push_back(i);
+  ASSERT_EQ(removed.size(), tree.RemoveSorted(removed));
+  ASSERT_EQ(0u, tree.RemoveSorted(vector<int>{1, 2, 301, n + 5}));
+  ASSERT_TRUE(tree.Check());
+  int expected = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ(expected, (*iter).first);
+    ASSERT_EQ(2 * expected, (*iter).second);
+    expected += expected == 297 ? 1203 : 3;
+  }
+  ASSERT_EQ(2001, expected);
+  // emptying the tree leaves no root behind
+  removed.clear();
+  for (int i = 0; i < n; i += 3) removed.push_back(i);
+  tree.RemoveSorted(removed);
+  ASSERT_TRUE(tree.IsEmpty());
+  ASSERT_TRUE(tree.Check());
+}
+
+TEST(BPlusTreeTests, FillAfterMergeTest) {
+  DBStorageEngine engine(db_name);
+  BasicComparator<int> comparator;
+  BPlusTree<int, int, BasicComparator<int>> tree(0, engine.bpm_, comparator, 4, 4);
+  BPlusTree<int, int, BasicComparator<int>> other(1, engine.bpm_, comparator, 4, 4);
+  for (int i = 0; i < 5; i++) {
+    ASSERT_TRUE(tree.Insert(i, i));
+  }
+  page_id_t leaf_page_id;
+  uint64_t freed_pages;
+  ASSERT_TRUE(tree.Reserve(100, leaf_page_id, freed_pages));
+  // the leaf of the reservation is merged away and its page goes to another tree
+  for (int i = 0; i < 5; i++) {
+    tree.Remove(i);
+  }
+  ASSERT_TRUE(engine.bpm_->IsPageFree(leaf_page_id));
+  ASSERT_TRUE(other.Insert(100, 7));
+  ASSERT_FALSE(engine.bpm_->IsPageFree(leaf_page_id));
+  tree.Fill(100, 42, leaf_page_id, freed_pages);
+  vector<int> result;
+  ASSERT_TRUE(tree.GetValue(100, result));
+  ASSERT_EQ(42, result[0]);
+  result.clear();
+  ASSERT_TRUE(other.GetValue(100, result));
+  ASSERT_EQ(7, result[0]);
+  ASSERT_TRUE(tree.Check());
+  ASSERT_TRUE(other.Check());
+}
@@ -0,0 +1,165 @@
+#include "common/instance.h"
+#include "gtest/gtest.h"
+#include "index/basic_comparator.h"
+#include "index/extendible_hash_table.h"
+#include "index/generic_key.h"
+#include "index/hash_index.h"
+#include "utils/utils.h"
+
+static const std::string db_name = "hash_index_test.db";
+
+TEST(HashIndexTests, ExtendibleHashTableTest) {
+  DBStorageEngine engine(db_name);
+  BasicComparator<int> comparator;
+  ExtendibleHashTable<int, int, BasicComparator<int>> table(0, engine.bpm_, comparator);
+  auto meta_page = reinterpret_cast<DiskFileMetaPage *>(engine.disk_mgr_->GetMetaData());
+  uint32_t allocated = meta_page->GetAllocatedPages();
+  // more keys than the buckets of the largest directory hold
+  const int n = 160000;
+  vector<int> keys;
+  for (int i = 0; i < n; i++) {
+    keys.push_back(i);
+  }
+  ShuffleArray(keys);
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(table.Insert(keys[i], keys[i] * 2));
+  }
+  ASSERT_FALSE(table.Insert(keys[0], 0));
+  ASSERT_TRUE(table.Check());
+  // the directory grew as far as it can, the buckets continue in overflow pages
+  ASSERT_EQ(static_cast<uint32_t>(HASH_DIRECTORY_MAX_DEPTH), table.GetGlobalDepth());
+  ASSERT_GT(meta_page->GetAllocatedPages(), allocated + 1 + HASH_DIRECTORY_ARRAY_SIZE);
+  vector<int> ans;
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(table.GetValue(i, ans));
+    ASSERT_EQ(i * 2, ans.back());
+  }
+  ASSERT_FALSE(table.GetValue(n, ans));
+  ASSERT_TRUE(table.Check());
+  // remove half of the keys
+  ShuffleArray(keys);
+  for (int i = 0; i < n / 2; i++) {
+    ASSERT_TRUE(table.Remove(keys[i]));
+  }
+  ASSERT_FALSE(table.Remove(keys[0]));
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(i >= n / 2, table.GetValue(keys[i], ans));
+  }
+  // removing the rest frees the overflow pages and merges every bucket back into one
+  for (int i = n / 2; i < n; i++) {
+    ASSERT_TRUE(table.Remove(keys[i]));
+  }
+  ASSERT_EQ(0u, table.GetGlobalDepth());
+  ASSERT_EQ(allocated + 2, meta_page->GetAllocatedPages());
+  ASSERT_TRUE(table.Check());
+  table.Destroy();
+  ASSERT_TRUE(table.IsEmpty());
+}
+
+TEST(HashIndexTests, ReleaseTest) {
+  DBStorageEngine engine(db_name);
+  BasicComparator<int> comparator;
+  ExtendibleHashTable<int, int, BasicComparator<int>> table(0, engine.bpm_, comparator);
+  auto meta_page = reinterpret_cast<DiskFileMetaPage *>(engine.disk_mgr_->GetMetaData());
+  uint32_t allocated = meta_page->GetAllocatedPages();
+  for (int i = 0; i < 20000; i++) {
+    ASSERT_TRUE(table.Insert(i, i));
+  }
+  ASSERT_GT(meta_page->GetAllocatedPages(), allocated + 2);
+  // the table is empty at once, its pages are freed by the reclaimer
+  PageReclaimer reclaimer;
+  table.Release(&reclaimer);
+  ASSERT_TRUE(table.IsEmpty());
+  vector<int> ans;
+  ASSERT_FALSE(table.GetValue(0, ans));
+  reclaimer.Wait();
+  ASSERT_EQ(allocated, meta_page->GetAllocatedPages());
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  // the table starts over on new pages
+  ASSERT_TRUE(table.Insert(1, 1));
+  ASSERT_TRUE(table.GetValue(1, ans));
+  table.Destroy();
+}
+
+TEST(HashIndexTests, HashIndexGenericKeyTest) {
+  using INDEX_KEY_TYPE = GenericKey<32>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
+  using HASH_INDEX = HashIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 16, 1, true, false)
+  };
+  std::vector<uint32_t> index_key_map{0, 1};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map, &heap);
+  auto *index = ALLOC(heap, HASH_INDEX)(0, index_schema, engine.bpm_);
+  const int n = 3000;
+  auto make_key = [](int i) {
+    return std::vector<Field>{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>("minisql"), 7, true)};
+  };
+  for (int i = 0; i < n; i++) {
+    auto fields = make_key(i);
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(row, RowId(1000, i), nullptr));
+  }
+  auto fields = make_key(7);
+  Row duplicate(fields);
+  ASSERT_EQ(DB_KEY_ALREADY_EXIST, index->InsertEntry(duplicate, RowId(1000, 7), nullptr));
+  for (int i = 0; i < n; i++) {
+    auto fields = make_key(i);
+    Row row(fields);
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(row, ret, nullptr));
+    ASSERT_EQ(RowId(1000, i).Get(), ret[0].Get());
+  }
+  for (int i = 0; i < n; i += 2) {
+    auto fields = make_key(i);
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(row, RowId(1000, i), nullptr));
+  }
+  for (int i = 0; i < n; i++) {
+    auto fields = make_key(i);
+    Row row(fields);
+    std::vector<RowId> ret;
+    ASSERT_EQ(i % 2 == 0 ? DB_KEY_NOT_FOUND : DB_SUCCESS, index->ScanKey(row, ret, nullptr));
+  }
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  ASSERT_EQ(DB_SUCCESS, index->Destroy());
+}
+
+TEST(HashIndexTests, HashIndexRepointEntriesTest) {
+  using INDEX_KEY_TYPE = GenericKey<32>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
+  using HASH_INDEX = HashIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false)
+  };
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, {0}, &heap);
+  auto *index = ALLOC(heap, HASH_INDEX)(0, index_schema, engine.bpm_);
+  const int n = 3000;
+  std::vector<Row> keys;
+  std::vector<RowId> old_row_ids, row_ids;
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    keys.emplace_back(fields);
+    old_row_ids.emplace_back(i, 0);
+    row_ids.emplace_back(i, 1);
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(keys.back(), old_row_ids.back(), nullptr));
+  }
+  ASSERT_EQ(DB_SUCCESS, index->RepointEntries(keys, old_row_ids, row_ids, nullptr));
+  for (int i = 0; i < n; i++) {
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(keys[i], ret, nullptr));
+    ASSERT_EQ(RowId(i, 1), ret[0]);
+  }
+  // keys not in the index are reported
+  std::vector<Field> fields{Field(TypeId::kTypeInt, n)};
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index->RepointEntries({Row(fields)}, {RowId(n, 0)}, {RowId(n, 1)}, nullptr));
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  ASSERT_EQ(DB_SUCCESS, index->Destroy());
+}
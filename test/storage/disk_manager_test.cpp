@@ -55,4 +55,40 @@ TEST(DiskManagerTest, FreePageAllocationTest/*DISABLED_FreePageAllocationTest*/)
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 2, meta_page->GetExtentUsedPage(0));
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 3, meta_page->GetExtentUsedPage(1));
   remove(db_name.c_str());
-}
\ No newline at end of file
+}
+
+TEST(DiskManagerTest, ReopenTest) {
+  std::string db_name = "disk_reopen_test.db";
+  remove(db_name.c_str());
+  auto *disk_mgr = new DiskManager(db_name);
+  char data[PAGE_SIZE] = "data of page 2";
+  for (int i = 0; i < 10; i++) {
+    ASSERT_EQ(i, disk_mgr->AllocatePage());
+  }
+  disk_mgr->WritePage(2, data);
+  disk_mgr->DeAllocatePage(3);
+  disk_mgr->DeAllocatePage(5);
+  disk_mgr->Close();
+  delete disk_mgr;
+  // the freed pages and the page counts survive, the meta page is intact
+  for (int reopen = 0; reopen < 3; reopen++) {
+    disk_mgr = new DiskManager(db_name);
+    auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData());
+    ASSERT_EQ(8u, meta_page->GetAllocatedPages());
+    ASSERT_EQ(1u, meta_page->GetExtentNums());
+    ASSERT_EQ(8u, meta_page->GetExtentUsedPage(0));
+    ASSERT_TRUE(disk_mgr->IsPageFree(3));
+    ASSERT_TRUE(disk_mgr->IsPageFree(5));
+    ASSERT_FALSE(disk_mgr->IsPageFree(4));
+    char buf[PAGE_SIZE];
+    disk_mgr->ReadPage(2, buf);
+    ASSERT_STREQ(data, buf);
+    disk_mgr->Close();
+    delete disk_mgr;
+  }
+  disk_mgr = new DiskManager(db_name);
+  ASSERT_EQ(3, disk_mgr->AllocatePage());
+  disk_mgr->Close();
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
@@ -0,0 +1,38 @@
+#include "gtest/gtest.h"
+#include "storage/row_id_bitmap.h"
+
+TEST(RowIdBitmapTest, SetOperationTest) {
+  RowIdBitmap evens, threes;
+  for (uint32_t slot = 0; slot < 200; slot++) {
+    // pages added out of order come back sorted
+    for (page_id_t page_id : {7, 3}) {
+      if (slot % 2 == 0) evens.Add(RowId(page_id, slot));
+      if (slot % 3 == 0) threes.Add(RowId(page_id, slot));
+    }
+  }
+  ASSERT_EQ(200u, evens.Size());
+  ASSERT_TRUE(evens.Contains(RowId(3, 198)));
+  ASSERT_FALSE(evens.Contains(RowId(3, 199)));
+  ASSERT_FALSE(evens.Contains(RowId(5, 0)));
+  auto row_ids = evens.GetRowIds();
+  ASSERT_EQ(200u, row_ids.size());
+  for (uint32_t i = 0; i < row_ids.size(); i++) {
+    ASSERT_EQ(i < 100 ? 3 : 7, row_ids[i].GetPageId());
+    ASSERT_EQ(i % 100 * 2, row_ids[i].GetSlotNum());
+  }
+  RowIdBitmap both = evens;
+  both.Intersect(threes);
+  ASSERT_EQ(68u, both.Size());
+  for (auto &rid : both.GetRowIds()) {
+    ASSERT_EQ(0u, rid.GetSlotNum() % 6);
+  }
+  RowIdBitmap either = evens;
+  either.Union(threes);
+  ASSERT_EQ(200u + 134u - 68u, either.Size());
+  // intersecting with pages not present drops them
+  RowIdBitmap other;
+  other.Add(RowId(3, 1));
+  either.Intersect(other);
+  ASSERT_EQ(0u, either.Size());
+  ASSERT_TRUE(either.Empty());
+}
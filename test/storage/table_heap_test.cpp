@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <vector>
 #include <unordered_map>
 
@@ -5,6 +6,7 @@
 #include "gtest/gtest.h"
 #include "record/field.h"
 #include "record/schema.h"
+#include "storage/row_id_bitmap.h"
 #include "storage/table_heap.h"
 #include "utils/utils.h"
 
@@ -49,8 +51,275 @@ TEST(TableHeapTest, TableHeapSampleTest) {
     for (size_t j = 0; j < schema.get()->GetColumnCount(); j++) {
       ASSERT_EQ(CmpBool::kTrue, row.GetField(j)->CompareEquals(row_kv.second->at(j)));
     }
-    // free spaces
+  }
+  // read the tuples back in page order, each page once
+  RowIdBitmap bitmap;
+  for (auto row_kv : row_values) {
+    bitmap.Add(RowId(row_kv.first));
+  }
+  std::vector<Row> rows;
+  table_heap->GetTuples(bitmap.GetRowIds(), rows, nullptr);
+  ASSERT_EQ(row_nums, rows.size());
+  for (auto &row : rows) {
+    auto *fields = row_values[row.GetRowId().Get()];
+    for (size_t j = 0; j < schema.get()->GetColumnCount(); j++) {
+      ASSERT_EQ(CmpBool::kTrue, row.GetField(j)->CompareEquals(fields->at(j)));
+    }
+  }
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  // free spaces
+  for (auto row_kv : row_values) {
     delete row_kv.second;
   }
 }
 
+
+TEST(TableHeapTest, InsertAfterReopenTest) {
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  const int row_nums = 3000;
+  char name[] = "name of a tuple";
+  auto make_rows = [&](int begin, int end) {
+    std::vector<Row> rows;
+    for (int i = begin; i < end; i++) {
+      Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, name, sizeof(name), true)};
+      rows.emplace_back(fields);
+    }
+    return rows;
+  };
+  auto engine = new DBStorageEngine(db_file_name);
+  TableHeap *table_heap = TableHeap::Create(engine->bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  auto rows = make_rows(0, row_nums);
+  ASSERT_TRUE(table_heap->InsertTuples(rows, nullptr));
+  page_id_t first_page_id = table_heap->GetFirstPageId();
+  delete engine;
+  // a loaded heap only knows its first page, appends must still go to the last one
+  engine = new DBStorageEngine(db_file_name, false);
+  table_heap = TableHeap::Create(engine->bpm_, first_page_id, schema.get(), nullptr, nullptr, &heap);
+  rows = make_rows(row_nums, row_nums + 2);
+  ASSERT_TRUE(table_heap->InsertTuples(rows, nullptr));
+  ASSERT_NE(first_page_id, rows[0].GetRowId().GetPageId());
+  Row row(make_rows(row_nums + 2, row_nums + 3)[0]);
+  ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  std::vector<bool> found(row_nums + 3, false);
+  for (auto itr = table_heap->Begin(nullptr); itr != table_heap->End(); itr++) {
+    int32_t id = itr->GetField(0)->value_.integer_;
+    ASSERT_FALSE(found[id]);
+    found[id] = true;
+  }
+  ASSERT_EQ(found.end(), std::find(found.begin(), found.end(), false));
+  ASSERT_TRUE(engine->bpm_->CheckAllUnpinned());
+  delete engine;
+}
+
+TEST(TableHeapTest, UpdateInPlaceTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  const int row_nums = 1000;
+  char name[] = "name of a tuple";
+  std::vector<RowId> row_ids;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, name, sizeof(name), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    row_ids.push_back(row.GetRowId());
+  }
+  // a new counter value is written over the old one, a shorter name shrinks
+  // the tuple inside its page; both keep the row id
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i + 1),
+                  Field(TypeId::kTypeChar, name, i % 2 == 0 ? sizeof(name) : 5, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->UpdateTuple(row, row_ids[i], nullptr));
+    ASSERT_EQ(row_ids[i].Get(), row.GetRowId().Get());
+  }
+  for (int i = 0; i < row_nums; i++) {
+    Row row(row_ids[i]);
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    ASSERT_EQ(i + 1, row.GetField(0)->value_.integer_);
+    ASSERT_EQ(i % 2 == 0 ? sizeof(name) : 5, row.GetField(1)->GetLength());
+  }
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
+
+TEST(TableHeapTest, ForwardTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 256, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  const int row_nums = 1000;
+  char name[200];
+  memset(name, 'a', sizeof(name) - 1);
+  name[sizeof(name) - 1] = 0;
+  std::vector<RowId> row_ids;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, name, 4, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    row_ids.push_back(row.GetRowId());
+  }
+  // the pages are full, grown tuples move away but keep their row id
+  auto update = [&](int i, uint32_t len) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, name, len, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->UpdateTuple(row, row_ids[i], nullptr));
+    ASSERT_EQ(row_ids[i].Get(), row.GetRowId().Get());
+  };
+  auto check = [&](int count, uint32_t len) {
+    std::unordered_map<int64_t, int> seen;
+    for (auto itr = table_heap->Begin(nullptr); itr != table_heap->End(); itr++) {
+      ASSERT_EQ(0, seen[itr->GetRowId().Get()]++);
+      int32_t id = itr->GetField(0)->value_.integer_;
+      ASSERT_EQ(row_ids[id].Get(), itr->GetRowId().Get());
+      ASSERT_EQ(len, itr->GetField(1)->GetLength());
+    }
+    ASSERT_EQ(count, seen.size());
+  };
+  for (int i = 0; i < row_nums; i++) update(i, sizeof(name));
+  for (int i = 0; i < row_nums; i++) {
+    Row row(row_ids[i]);
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    ASSERT_EQ(i, row.GetField(0)->value_.integer_);
+    ASSERT_EQ(row_ids[i].Get(), row.GetRowId().Get());
+  }
+  check(row_nums, sizeof(name));
+  // moved tuples are updated where they are, and shrunk ones go back home
+  for (int i = 0; i < row_nums; i++) update(i, sizeof(name) - 1);
+  check(row_nums, sizeof(name) - 1);
+  for (int i = 0; i < row_nums; i++) update(i, 4);
+  check(row_nums, 4);
+  for (int i = 0; i < row_nums; i++) update(i, sizeof(name));
+  // deleting through the forward slot removes the moved version too
+  for (int i = 0; i < row_nums; i += 2) {
+    ASSERT_TRUE(table_heap->MarkDelete(row_ids[i], nullptr));
+    table_heap->ApplyDelete(row_ids[i], nullptr);
+  }
+  check(row_nums / 2, sizeof(name));
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
+
+TEST(TableHeapTest, DeleteTuplesTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  const int row_nums = 1000;
+  char name[] = "name of a tuple that grows";
+  std::vector<RowId> row_ids, victims;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, name, 4, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    row_ids.push_back(row.GetRowId());
+  }
+  // some tuples leave a forward slot behind, their moved version goes too
+  for (int i = 0; i < row_nums; i += 7) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, name, sizeof(name), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->UpdateTuple(row, row_ids[i], nullptr));
+  }
+  for (int i = row_nums - 1; i >= 0; i--) {
+    if (i % 3 != 0) victims.push_back(row_ids[i]);
+  }
+  ASSERT_TRUE(table_heap->DeleteTuples(victims, nullptr));
+  int count = 0;
+  for (auto itr = table_heap->Begin(nullptr); itr != table_heap->End(); itr++) {
+    ASSERT_EQ(0, itr->GetField(0)->value_.integer_ % 3);
+    count++;
+  }
+  ASSERT_EQ((row_nums + 2) / 3, count);
+  // deleting them again fails, only the tuples still there are reported
+  std::vector<RowId> deleted;
+  ASSERT_FALSE(table_heap->DeleteTuples({victims[0], row_ids[0]}, nullptr, &deleted));
+  ASSERT_EQ(1, deleted.size());
+  ASSERT_EQ(row_ids[0], deleted[0]);
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
+
+TEST(TableHeapTest, VacuumTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  auto page_count = [&]() {
+    int count = 0;
+    for (page_id_t page_id = table_heap->GetFirstPageId(); page_id != INVALID_PAGE_ID; count++) {
+      auto page = reinterpret_cast<TablePage *>(engine.bpm_->FetchPage(page_id));
+      engine.bpm_->UnpinPage(page_id, false);
+      page_id = page->GetNextPageId();
+    }
+    return count;
+  };
+  const int row_nums = 2000;
+  char name[] = "name of a tuple that grows";
+  std::vector<RowId> row_ids, victims;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, name, 4, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    row_ids.push_back(row.GetRowId());
+  }
+  // forward slots are folded as well
+  for (int i = 0; i < row_nums; i += 12) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, name, sizeof(name), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->UpdateTuple(row, row_ids[i], nullptr));
+  }
+  for (int i = 0; i < row_nums; i++) {
+    if (i % 4 != 0) victims.push_back(row_ids[i]);
+  }
+  ASSERT_TRUE(table_heap->DeleteTuples(victims, nullptr));
+  int pages = page_count();
+  std::vector<Row> rows;
+  std::vector<RowId> old_row_ids;
+  uint32_t freed = table_heap->Vacuum(rows, old_row_ids, nullptr);
+  ASSERT_GT(freed, 0u);
+  ASSERT_EQ(pages - static_cast<int>(freed), page_count());
+  // a quarter of the tuples fill about a quarter of the pages
+  ASSERT_LE(page_count(), pages / 4 + 2);
+  ASSERT_EQ(rows.size(), old_row_ids.size());
+  std::unordered_map<int64_t, RowId> new_row_ids;
+  for (size_t i = 0; i < rows.size(); i++) new_row_ids[old_row_ids[i].Get()] = rows[i].GetRowId();
+  for (int i = 0; i < row_nums; i += 4) {
+    auto itr = new_row_ids.find(row_ids[i].Get());
+    Row row(itr == new_row_ids.end() ? row_ids[i] : itr->second);
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    ASSERT_EQ(i, row.GetField(0)->value_.integer_);
+    ASSERT_EQ(i % 12 == 0 ? sizeof(name) : 4, row.GetField(1)->GetLength());
+  }
+  int count = 0;
+  for (auto itr = table_heap->Begin(nullptr); itr != table_heap->End(); itr++) {
+    ASSERT_EQ(0, itr->GetField(0)->value_.integer_ % 4);
+    count++;
+  }
+  ASSERT_EQ(row_nums / 4, count);
+  // the heap keeps growing at its new last page
+  Fields fields{Field(TypeId::kTypeInt, row_nums), Field(TypeId::kTypeChar, name, 4, true)};
+  Row row(fields);
+  ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+  ASSERT_LE(page_count(), pages - static_cast<int>(freed) + 1);
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}